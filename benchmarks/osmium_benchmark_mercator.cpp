@@ -4,16 +4,19 @@
 
 */
 
+#include <osmium/geom/coordinates.hpp>
 #include <osmium/geom/mercator_projection.hpp>
 #include <osmium/geom/wkb.hpp>
 #include <osmium/handler.hpp>
 #include <osmium/io/any_input.hpp>
 #include <osmium/visitor.hpp>
 
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
 #include <string>
+#include <vector>
 
 struct GeomHandler : public osmium::handler::Handler {
 
@@ -25,19 +28,82 @@ struct GeomHandler : public osmium::handler::Handler {
 
 };
 
+// Projects the location of each node on its own.
+struct SingleHandler : public osmium::handler::Handler {
+
+    osmium::geom::MercatorProjection projection;
+    double sum = 0.0;
+
+    void node(const osmium::Node& node) {
+        const auto c = projection(node.location());
+        sum += c.x + c.y;
+    }
+
+};
+
+// Collects the locations of nodes and projects them in batches.
+struct BatchHandler : public osmium::handler::Handler {
+
+    enum {
+        batch_size = 1024
+    };
+
+    osmium::geom::MercatorProjection projection;
+    std::vector<osmium::Location> locations;
+    std::vector<osmium::geom::Coordinates> coordinates;
+    double sum = 0.0;
+
+    BatchHandler() {
+        locations.reserve(batch_size);
+        coordinates.resize(batch_size);
+    }
+
+    void flush() {
+        projection(locations.data(), coordinates.data(), locations.size());
+        for (std::size_t i = 0; i < locations.size(); ++i) {
+            sum += coordinates[i].x + coordinates[i].y;
+        }
+        locations.clear();
+    }
+
+    void node(const osmium::Node& node) {
+        locations.push_back(node.location());
+        if (locations.size() == batch_size) {
+            flush();
+        }
+    }
+
+};
+
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " OSMFILE\n";
+    if (argc != 2 && argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE [wkb|single|batch]\n";
         return 1;
     }
 
     try {
         const std::string input_filename{argv[1]};
+        const std::string mode{argc == 3 ? argv[2] : "wkb"};
 
         osmium::io::Reader reader{input_filename};
 
-        GeomHandler handler;
-        osmium::apply(reader, handler);
+        if (mode == "wkb") {
+            GeomHandler handler;
+            osmium::apply(reader, handler);
+        } else if (mode == "single") {
+            SingleHandler handler;
+            osmium::apply(reader, handler);
+            std::cout << handler.sum << '\n';
+        } else if (mode == "batch") {
+            BatchHandler handler;
+            osmium::apply(reader, handler);
+            handler.flush();
+            std::cout << handler.sum << '\n';
+        } else {
+            std::cerr << "Unknown mode '" << mode << "'\n";
+            return 1;
+        }
+
         reader.close();
     } catch (const std::exception& e) {
         std::cerr << e.what() << '\n';
@@ -46,4 +112,3 @@ int main(int argc, char* argv[]) {
 
     return 0;
 }
-
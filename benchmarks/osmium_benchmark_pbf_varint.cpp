@@ -0,0 +1,188 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+  Compares decoding of packed delta-encoded varints (as used in PBF files
+  for node IDs, coordinates and way node references) using the scalar
+  varint_range/DeltaDecode classes and the block decoder.
+
+*/
+
+#include <osmium/handler.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/io/detail/pbf_decoder.hpp>
+#include <osmium/io/detail/pbf_varint.hpp>
+#include <osmium/util/delta.hpp>
+#include <osmium/visitor.hpp>
+
+#include <protozero/varint.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Same number of nodes per block as the PBF writer uses
+const std::size_t nodes_per_block = 8000;
+
+class PackedArrays {
+
+    std::vector<std::string> m_arrays;
+    std::string m_current;
+    int64_t m_last = 0;
+    std::size_t m_count = 0;
+
+public:
+
+    void add(const int64_t value) {
+        const auto delta = static_cast<int64_t>(static_cast<uint64_t>(value) - static_cast<uint64_t>(m_last));
+        protozero::write_varint(std::back_inserter(m_current), protozero::encode_zigzag64(delta));
+        m_last = value;
+        ++m_count;
+    }
+
+    void finish_array() {
+        if (!m_current.empty()) {
+            m_arrays.push_back(std::move(m_current));
+            m_current.clear();
+        }
+        m_last = 0;
+    }
+
+    const std::vector<std::string>& arrays() const noexcept {
+        return m_arrays;
+    }
+
+    std::size_t count() const noexcept {
+        return m_count;
+    }
+
+}; // class PackedArrays
+
+struct CollectHandler : public osmium::handler::Handler {
+
+    PackedArrays ids;
+    PackedArrays lats;
+    PackedArrays lons;
+    PackedArrays refs;
+    std::size_t nodes_in_block = 0;
+
+    void node(const osmium::Node& node) {
+        ids.add(node.id());
+        lons.add(node.location().x());
+        lats.add(node.location().y());
+        if (++nodes_in_block == nodes_per_block) {
+            finish_block();
+        }
+    }
+
+    void way(const osmium::Way& way) {
+        for (const auto& nr : way.nodes()) {
+            refs.add(nr.ref());
+        }
+        refs.finish_array();
+    }
+
+    void finish_block() {
+        ids.finish_array();
+        lats.finish_array();
+        lons.finish_array();
+        nodes_in_block = 0;
+    }
+
+}; // struct CollectHandler
+
+static int64_t decode_scalar(const std::vector<std::string>& arrays) {
+    int64_t sum = 0;
+    for (const auto& array : arrays) {
+        osmium::io::detail::varint_range range{protozero::data_view{array.data(), array.size()}};
+        osmium::DeltaDecode<int64_t> value;
+        while (!range.empty()) {
+            sum += value.update(range.next_sint64());
+        }
+    }
+    return sum;
+}
+
+static int64_t decode_block(const std::vector<std::string>& arrays) {
+    int64_t sum = 0;
+    std::vector<int64_t> values;
+    for (const auto& array : arrays) {
+        // There can't be more values than bytes
+        if (values.size() < array.size() + osmium::io::detail::packed_delta_sint64_padding) {
+            values.resize(array.size() + osmium::io::detail::packed_delta_sint64_padding);
+        }
+        const std::size_t size = osmium::io::detail::decode_packed_delta_sint64(array.data(), array.data() + array.size(), values.data());
+        for (std::size_t i = 0; i < size; ++i) {
+            sum += values[i];
+        }
+    }
+    return sum;
+}
+
+template <typename TFunc>
+static int64_t run(const char* name, const PackedArrays& data, TFunc&& func) {
+    const int repeat = 20;
+    int64_t result = 0;
+
+    // Use the fastest run to reduce noise
+    auto best = std::chrono::nanoseconds::max();
+    for (int i = 0; i < repeat; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        result = func(data.arrays());
+        const auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start));
+    }
+
+    const auto values = static_cast<double>(data.count());
+    std::cout << "  " << name << ": " << (values > 0 ? static_cast<double>(best.count()) / values : 0.0) << " ns/value\n";
+
+    return result;
+}
+
+static bool compare(const char* name, const PackedArrays& data) {
+    std::cout << name << " (" << data.count() << " values):\n";
+    const auto scalar = run("scalar", data, decode_scalar);
+    const auto block = run("block ", data, decode_block);
+    if (scalar != block) {
+        std::cerr << "Results differ for " << name << "!\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE\n";
+        return 1;
+    }
+
+    try {
+        const std::string input_filename{argv[1]};
+
+        osmium::io::Reader reader{input_filename, osmium::osm_entity_bits::node | osmium::osm_entity_bits::way};
+
+        CollectHandler handler;
+        osmium::apply(reader, handler);
+        reader.close();
+        handler.finish_block();
+
+        const bool ok = compare("ids", handler.ids) &&
+                        compare("lats", handler.lats) &&
+                        compare("lons", handler.lons) &&
+                        compare("refs", handler.refs);
+        if (!ok) {
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,110 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/geodesic.hpp>
+#include <osmium/geom/haversine.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+
+// Only reads the data and sets the locations to find out how much time
+// the length calculations take in the other modes.
+struct NoneHandler : public osmium::handler::Handler {
+
+    double length = 0.0;
+
+};
+
+// Adds up the haversine distances of all segments one by one.
+struct SegmentsHandler : public osmium::handler::Handler {
+
+    double length = 0.0;
+
+    void way(const osmium::Way& way) {
+        const auto& nodes = way.nodes();
+        for (std::size_t i = 1; i < nodes.size(); ++i) {
+            length += osmium::geom::haversine::distance(nodes[i - 1].location(), nodes[i].location());
+        }
+    }
+
+};
+
+// Calculates the haversine length of each way in one go.
+struct HaversineHandler : public osmium::handler::Handler {
+
+    double length = 0.0;
+
+    void way(const osmium::Way& way) {
+        length += osmium::geom::haversine::distance(way.nodes());
+    }
+
+};
+
+// Calculates the length of each way on the WGS84 ellipsoid.
+struct GeodesicHandler : public osmium::handler::Handler {
+
+    double length = 0.0;
+
+    void way(const osmium::Way& way) {
+        length += osmium::geom::geodesic::distance(way.nodes());
+    }
+
+};
+
+template <typename THandler>
+double run(const std::string& input_filename) {
+    osmium::io::Reader reader{input_filename, osmium::osm_entity_bits::node | osmium::osm_entity_bits::way};
+    index_type index;
+    location_handler_type location_handler{index};
+    location_handler.ignore_errors();
+    THandler handler;
+    osmium::apply(reader, location_handler, handler);
+    reader.close();
+    return handler.length;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2 && argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE [none|segments|haversine|geodesic]\n";
+        return 1;
+    }
+
+    try {
+        const std::string input_filename{argv[1]};
+        const std::string mode{argc == 3 ? argv[2] : "haversine"};
+
+        double length = 0.0;
+        if (mode == "none") {
+            length = run<NoneHandler>(input_filename);
+        } else if (mode == "segments") {
+            length = run<SegmentsHandler>(input_filename);
+        } else if (mode == "haversine") {
+            length = run<HaversineHandler>(input_filename);
+        } else if (mode == "geodesic") {
+            length = run<GeodesicHandler>(input_filename);
+        } else {
+            std::cerr << "Unknown mode '" << mode << "'\n";
+            return 1;
+        }
+
+        std::cout << length << '\n';
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/handler.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/util/string_matcher.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+
+// Matches the keys and values of all tags against a string matcher. With
+// the matcher always_false only the tags are visited, this is the
+// baseline.
+struct MatchHandler : public osmium::handler::Handler {
+
+    osmium::StringMatcher matcher;
+    uint64_t tags = 0;
+    uint64_t matches = 0;
+
+    explicit MatchHandler(osmium::StringMatcher m) :
+        matcher(std::move(m)) {
+    }
+
+    void osm_object(const osmium::OSMObject& object) {
+        for (const auto& tag : object.tags()) {
+            ++tags;
+            if (matcher(tag.key())) {
+                ++matches;
+            }
+            if (matcher(tag.value())) {
+                ++matches;
+            }
+        }
+    }
+
+};
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE none|prefix|substring|list\n";
+        return 1;
+    }
+
+    try {
+        const std::string input_filename{argv[1]};
+        const std::string mode{argv[2]};
+
+        osmium::StringMatcher matcher;
+        if (mode == "prefix") {
+            matcher = osmium::StringMatcher::prefix{"addr:"};
+        } else if (mode == "substring") {
+            matcher = osmium::StringMatcher::substring{"strasse"};
+        } else if (mode == "list") {
+            matcher = osmium::StringMatcher::list{{"motorway", "trunk", "primary", "secondary", "tertiary", "unclassified", "residential", "service", "track", "path", "footway"}};
+        } else if (mode != "none") {
+            std::cerr << "Unknown mode: " << mode << '\n';
+            return 1;
+        }
+
+        osmium::io::Reader reader{input_filename};
+        MatchHandler handler{matcher};
+        osmium::apply(reader, handler);
+        reader.close();
+
+        std::cout << "tags=" << handler.tags << " matches=" << handler.matches << '\n';
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/handler.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/tags/compiled_tags_filter.hpp>
+#include <osmium/tags/tags_filter.hpp>
+#include <osmium/visitor.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Build a filter similar in size to what a map style would use.
+osmium::TagsFilter create_filter() {
+    static const std::vector<std::string> keys = {
+        "aerialway", "aeroway", "amenity", "barrier", "boundary", "building",
+        "craft", "emergency", "historic", "landuse", "leisure", "man_made",
+        "military", "natural", "office", "place", "power", "public_transport",
+        "railway", "route", "shop", "sport", "tourism", "waterway"
+    };
+
+    static const std::vector<std::string> values = {
+        "yes", "station", "platform", "parking", "school", "hospital",
+        "restaurant", "cafe", "forest", "water", "park", "residential",
+        "retail", "industrial"
+    };
+
+    osmium::TagsFilter filter{false};
+
+    filter.add_rule(false, "highway", osmium::StringMatcher::list{{"proposed", "construction", "abandoned"}});
+    for (const auto& value : {"motorway", "trunk", "primary", "secondary", "tertiary", "unclassified", "residential", "service", "track", "path", "footway"}) {
+        filter.add_rule(true, "highway", value);
+    }
+    for (const auto& key : keys) {
+        filter.add_rule(false, key, "no");
+        for (const auto& value : values) {
+            filter.add_rule(true, key, value);
+        }
+    }
+    filter.add_rule(true, osmium::StringMatcher::prefix{"addr:"});
+
+    return filter;
+}
+
+template <typename TFilter>
+struct FilterHandler : public osmium::handler::Handler {
+
+    const TFilter& filter;
+    uint64_t counter = 0;
+    uint64_t all = 0;
+
+    explicit FilterHandler(const TFilter& f) :
+        filter(f) {
+    }
+
+    void osm_object(const osmium::OSMObject& object) {
+        ++all;
+        if (std::any_of(object.tags().cbegin(), object.tags().cend(), std::cref(filter))) {
+            ++counter;
+        }
+    }
+
+};
+
+template <typename TFilter>
+void run(const std::string& input_filename, const TFilter& filter) {
+    osmium::io::Reader reader{input_filename};
+
+    FilterHandler<TFilter> handler{filter};
+    osmium::apply(reader, handler);
+    reader.close();
+
+    std::cout << "rules=" << filter.count() << " r_all=" << handler.all << " r_counter=" << handler.counter << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE plain|compiled\n";
+        return 1;
+    }
+
+    try {
+        const std::string input_filename{argv[1]};
+        const std::string mode{argv[2]};
+
+        const auto filter = create_filter();
+
+        if (mode == "plain") {
+            run(input_filename, filter);
+        } else if (mode == "compiled") {
+            const osmium::CompiledTagsFilter compiled_filter{filter};
+            run(input_filename, compiled_filter);
+        } else {
+            std::cerr << "Unknown mode: " << mode << '\n';
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
+
@@ -0,0 +1,132 @@
+/*
+
+  The code in this file is released into the Public Domain.
+
+*/
+
+#include <osmium/geom/mercator_projection.hpp>
+#include <osmium/geom/wkb.hpp>
+#include <osmium/handler.hpp>
+#include <osmium/handler/node_locations_for_ways.hpp>
+#include <osmium/index/map/flex_mem.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using index_type = osmium::index::map::FlexMem<osmium::unsigned_object_id_type, osmium::Location>;
+using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
+
+// The output is collected in a buffer which is "flushed" (cleared) when
+// it gets larger than this, like when writing the data for a PostgreSQL
+// COPY command.
+constexpr const std::size_t max_output_size = 1024UL * 1024UL;
+
+// Creates each geometry as a new string and appends it to the output.
+struct StringHandler : public osmium::handler::Handler {
+
+    osmium::geom::WKBFactory<osmium::geom::MercatorProjection> factory{osmium::geom::wkb_type::ewkb, osmium::geom::out_type::hex};
+    std::string out;
+    std::size_t bytes = 0;
+
+    void flush() {
+        bytes += out.size();
+        out.clear();
+    }
+
+    void node(const osmium::Node& node) {
+        out += factory.create_point(node);
+        if (out.size() > max_output_size) {
+            flush();
+        }
+    }
+
+    void way(const osmium::Way& way) {
+        try {
+            out += factory.create_linestring(way);
+        } catch (const osmium::geometry_error&) {
+        } catch (const osmium::invalid_location&) {
+        }
+        if (out.size() > max_output_size) {
+            flush();
+        }
+    }
+
+};
+
+// Creates each geometry directly in the output buffer.
+struct BufferHandler : public osmium::handler::Handler {
+
+    std::string out;
+    osmium::geom::WKBBufferFactory<osmium::geom::MercatorProjection> factory{out, osmium::geom::wkb_type::ewkb, osmium::geom::out_type::hex};
+    std::size_t bytes = 0;
+
+    void flush() {
+        bytes += out.size();
+        out.clear();
+    }
+
+    void node(const osmium::Node& node) {
+        factory.create_point(node);
+        if (out.size() > max_output_size) {
+            flush();
+        }
+    }
+
+    void way(const osmium::Way& way) {
+        try {
+            factory.create_linestring(way);
+        } catch (const osmium::geometry_error&) {
+        } catch (const osmium::invalid_location&) {
+        }
+        if (out.size() > max_output_size) {
+            flush();
+        }
+    }
+
+};
+
+template <typename THandler>
+std::size_t run(const std::string& input_filename) {
+    osmium::io::Reader reader{input_filename};
+
+    index_type index;
+    location_handler_type location_handler{index};
+    location_handler.ignore_errors();
+
+    THandler handler;
+    osmium::apply(reader, location_handler, handler);
+    reader.close();
+
+    handler.flush();
+    return handler.bytes;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " OSMFILE string|buffer\n";
+        return 1;
+    }
+
+    try {
+        const std::string input_filename{argv[1]};
+        const std::string mode{argv[2]};
+
+        if (mode == "string") {
+            std::cout << run<StringHandler>(input_filename) << '\n';
+        } else if (mode == "buffer") {
+            std::cout << run<BufferHandler>(input_filename) << '\n';
+        } else {
+            std::cerr << "Unknown mode '" << mode << "'\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -2,6 +2,9 @@
 #
 #  run_benchmark_mercator.sh
 #
+#  Runs the benchmark creating WKB points and then only projecting the node
+#  locations one by one and in batches.
+#
 
 set -e
 
@@ -15,8 +18,10 @@ echo "# file size num mem time cpu_kernel cpu_user cpu_percent cmd options"
 for data in $OB_DATA_FILES; do
     filename=`basename $data`
     filesize=`stat --format="%s" --dereference $data`
-    for n in $OB_SEQ; do
-        $OB_TIME_CMD -f "$filename $filesize $n $OB_TIME_FORMAT" $CMD $data 2>&1 >/dev/null | sed -e "s%$DATA_DIR/%%" | sed -e "s%$OB_DIR/%%"
+    for mode in wkb single batch; do
+        for n in $OB_SEQ; do
+            $OB_TIME_CMD -f "$filename $filesize $n $OB_TIME_FORMAT" $CMD $data $mode 2>&1 >/dev/null | sed -e "s%$DATA_DIR/%%" | sed -e "s%$OB_DIR/%%"
+        done
     done
 done
 
@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+#  run_benchmark_road_length.sh
+#
+#  Runs the benchmark calculating the length of all ways segment by segment,
+#  for whole ways at once and on the WGS84 ellipsoid. The "none" mode only
+#  reads the data for comparison.
+#
+
+set -e
+
+BENCHMARK_NAME=road_length
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+CMD=$OB_DIR/osmium_benchmark_$BENCHMARK_NAME
+
+echo "# file size num mem time cpu_kernel cpu_user cpu_percent cmd options"
+for data in $OB_DATA_FILES; do
+    filename=`basename $data`
+    filesize=`stat --format="%s" --dereference $data`
+    for mode in none segments haversine geodesic; do
+        for n in $OB_SEQ; do
+            $OB_TIME_CMD -f "$filename $filesize $n $OB_TIME_FORMAT" $CMD $data $mode 2>&1 >/dev/null | sed -e "s%$DATA_DIR/%%" | sed -e "s%$OB_DIR/%%"
+        done
+    done
+done
+
@@ -0,0 +1,27 @@
+#!/bin/sh
+#
+#  run_benchmark_string_matcher.sh
+#
+#  Match keys and values of all tags against prefix, substring, and list
+#  string matchers. Mode "none" only reads the data and visits the tags.
+#
+
+set -e
+
+BENCHMARK_NAME=string_matcher
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+CMD=$OB_DIR/osmium_benchmark_$BENCHMARK_NAME
+
+echo "# file size num mem time cpu_kernel cpu_user cpu_percent cmd options"
+for data in $OB_DATA_FILES; do
+    filename=`basename $data`
+    filesize=`stat --format="%s" --dereference $data`
+    for mode in none prefix substring list; do
+        for n in $OB_SEQ; do
+            $OB_TIME_CMD -f "$filename $filesize $n $OB_TIME_FORMAT" $CMD $data $mode 2>&1 >/dev/null | sed -e "s%$DATA_DIR/%%" | sed -e "s%$OB_DIR/%%"
+        done
+    done
+done
+
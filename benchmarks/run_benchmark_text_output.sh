@@ -0,0 +1,29 @@
+#!/bin/sh
+#
+#  run_benchmark_text_output.sh
+#
+#  Will read the input file and write it to /dev/null in each of the text
+#  output formats (OPL, XML, debug, and IDs). This mostly measures how fast
+#  numbers, coordinates, and timestamps are formatted. Subtract the times
+#  needed for the "count" benchmark to (roughly) get the write times.
+#
+
+set -e
+
+BENCHMARK_NAME=text_output
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+CMD=$OB_DIR/osmium_benchmark_$BENCHMARK_NAME
+
+echo "# file size num mem time cpu_kernel cpu_user cpu_percent cmd options"
+for data in $OB_DATA_FILES; do
+    filename=`basename $data`
+    filesize=`stat --format="%s" --dereference $data`
+    for format in opl xml debug ids; do
+        for n in $OB_SEQ; do
+            $OB_TIME_CMD -f "$filename $filesize $n $OB_TIME_FORMAT" $CMD $data /dev/null $format 2>&1 >/dev/null | sed -e "s%$DATA_DIR/%%" | sed -e "s%$OB_DIR/%%"
+        done
+    done
+done
+
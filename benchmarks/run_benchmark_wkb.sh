@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+#  run_benchmark_wkb.sh
+#
+#  Creates hex-encoded EWKB points for all nodes and linestrings for all
+#  ways, once with each geometry in a new string and once written directly
+#  into a reused output buffer.
+#
+
+set -e
+
+BENCHMARK_NAME=wkb
+
+. @CMAKE_BINARY_DIR@/benchmarks/setup.sh
+
+CMD=$OB_DIR/osmium_benchmark_$BENCHMARK_NAME
+
+echo "# file size num mem time cpu_kernel cpu_user cpu_percent cmd options"
+for data in $OB_DATA_FILES; do
+    filename=`basename $data`
+    filesize=`stat --format="%s" --dereference $data`
+    for mode in string buffer; do
+        for n in $OB_SEQ; do
+            $OB_TIME_CMD -f "$filename $filesize $n $OB_TIME_FORMAT" $CMD $data $mode 2>&1 >/dev/null | sed -e "s%$DATA_DIR/%%" | sed -e "s%$OB_DIR/%%"
+        done
+    done
+done
+
@@ -8,6 +8,9 @@
 #  subtract the times needed for the "count" benchmark to (roughly) get the
 #  write times.
 #
+#  The file is written with the default settings and again with the string
+#  tables sorted by frequency and blocks with a target size of 4 MBytes.
+#
 
 set -e
 
@@ -21,8 +24,10 @@ echo "# file size num mem time cpu_kernel cpu_user cpu_percent cmd options"
 for data in $OB_DATA_FILES; do
     filename=`basename $data`
     filesize=`stat --format="%s" --dereference $data`
-    for n in $OB_SEQ; do
-        $OB_TIME_CMD -f "$filename $filesize $n $OB_TIME_FORMAT" $CMD $data /dev/null 2>&1 >/dev/null | sed -e "s%$DATA_DIR/%%" | sed -e "s%$OB_DIR/%%"
+    for format in pbf pbf,pbf_sort_stringtable=true,pbf_block_size=4000000; do
+        for n in $OB_SEQ; do
+            $OB_TIME_CMD -f "$filename $filesize $n $OB_TIME_FORMAT" $CMD $data /dev/null $format 2>&1 >/dev/null | sed -e "s%$DATA_DIR/%%" | sed -e "s%$OB_DIR/%%"
+        done
     done
 done
 
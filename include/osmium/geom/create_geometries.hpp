@@ -0,0 +1,257 @@
+#ifndef OSMIUM_GEOM_CREATE_GEOMETRIES_HPP
+#define OSMIUM_GEOM_CREATE_GEOMETRIES_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/geom/factory.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/area.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace geom {
+
+        /**
+         * The geometry created from a way or area by create_geometries().
+         */
+        template <typename TGeometry>
+        struct geometry_result {
+
+            /// The way or area this geometry was created from.
+            const osmium::OSMObject* object;
+
+            /// The geometry. Default constructed if there was an error.
+            TGeometry geometry{};
+
+            /// Error message if the geometry couldn't be created.
+            std::string error{};
+
+            explicit geometry_result(const osmium::OSMObject* obj) noexcept :
+                object(obj) {
+            }
+
+            /// Was the geometry created successfully?
+            bool valid() const noexcept {
+                return error.empty();
+            }
+
+        }; // struct geometry_result
+
+        namespace detail {
+
+            class WKBBufferFactoryImpl;
+
+            /**
+             * Factories writing all geometries into one output buffer
+             * can't be used from several threads at once.
+             */
+            template <typename TFactory>
+            struct writes_to_shared_output : std::false_type {
+            };
+
+            template <typename TProjection>
+            struct writes_to_shared_output<GeometryFactory<WKBBufferFactoryImpl, TProjection>> : std::true_type {
+            };
+
+            /**
+             * Creates the geometries for some ways and areas. Submitted to
+             * the thread pool by create_geometries(). Every task uses its
+             * own copy of the factory.
+             */
+            template <typename TFactory>
+            class GeometriesBlock {
+
+                using geometry_type = typename TFactory::linestring_type;
+
+                TFactory m_factory;
+                const osmium::OSMObject* const* m_begin;
+                const osmium::OSMObject* const* m_end;
+
+            public:
+
+                GeometriesBlock(const TFactory& factory, const osmium::OSMObject* const* begin, const osmium::OSMObject* const* end) :
+                    m_factory(factory),
+                    m_begin(begin),
+                    m_end(end) {
+                }
+
+                std::vector<geometry_result<geometry_type>> operator()() {
+                    std::vector<geometry_result<geometry_type>> results;
+                    results.reserve(static_cast<std::size_t>(m_end - m_begin));
+
+                    for (auto it = m_begin; it != m_end; ++it) {
+                        results.emplace_back(*it);
+                        auto& result = results.back();
+                        try {
+                            if ((*it)->type() == osmium::item_type::way) {
+                                result.geometry = m_factory.create_linestring(*static_cast<const osmium::Way*>(*it));
+                            } else {
+                                result.geometry = m_factory.create_multipolygon(*static_cast<const osmium::Area*>(*it));
+                            }
+                        } catch (const osmium::geometry_error& e) {
+                            result.error = e.what();
+                        } catch (const osmium::invalid_location& e) {
+                            result.error = e.what();
+                        }
+                    }
+
+                    return results;
+                }
+
+            }; // class GeometriesBlock
+
+        } // namespace detail
+
+        /**
+         * Create geometries for all ways and areas in a buffer on the
+         * threads of a thread pool. Ways become linestrings, areas become
+         * multipolygons, all other objects are ignored. The locations must
+         * already be set on the node references.
+         *
+         * The objects are split into blocks of block_size objects, each
+         * block is handled by one task with its own copy of the factory.
+         * The results are returned in the order of the objects in the
+         * buffer. If a geometry can't be created, the error message is
+         * stored in the result instead.
+         *
+         * The factory must create geometries that don't depend on the
+         * factory, like the WKBFactory, WKTFactory, and GeoJSONFactory do.
+         * Linestrings and multipolygons must have the same type. The
+         * WKBBufferFactory can not be used, because all copies would
+         * append to the same output buffer.
+         *
+         * If any other exception than osmium::geometry_error or
+         * osmium::invalid_location is thrown while creating the geometries,
+         * it is rethrown after all tasks have finished.
+         *
+         * @code
+         * osmium::geom::WKBFactory<> factory{osmium::geom::wkb_type::ewkb, osmium::geom::out_type::hex};
+         * for (const auto& result : osmium::geom::create_geometries(pool, buffer, factory)) {
+         *     if (result.valid()) {
+         *         write(result.object->id(), result.geometry);
+         *     }
+         * }
+         * @endcode
+         *
+         * @param pool Thread pool to use.
+         * @param buffer Buffer with the ways and areas. The results point
+         *               into this buffer.
+         * @param factory The geometry factory which is copied for each task.
+         * @param block_size Number of objects handled in one task.
+         */
+        template <typename TFactory>
+        std::vector<geometry_result<typename TFactory::linestring_type>> create_geometries(osmium::thread::Pool& pool, const osmium::memory::Buffer& buffer, const TFactory& factory, std::size_t block_size = 1000) {
+            static_assert(std::is_same<typename TFactory::linestring_type, typename TFactory::multipolygon_type>::value,
+                          "Factory must create linestrings and multipolygons of the same type");
+            static_assert(!detail::writes_to_shared_output<TFactory>::value,
+                          "Factory must not write all geometries into the same output buffer");
+
+            using result_type = std::vector<geometry_result<typename TFactory::linestring_type>>;
+
+            std::vector<const osmium::OSMObject*> objects;
+            for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                if (object.type() == osmium::item_type::way || object.type() == osmium::item_type::area) {
+                    objects.push_back(&object);
+                }
+            }
+
+            if (block_size == 0) {
+                block_size = 1;
+            }
+
+            std::vector<std::future<result_type>> futures;
+            futures.reserve(objects.size() / block_size + 1);
+            try {
+                for (std::size_t n = 0; n < objects.size(); n += block_size) {
+                    const auto end = std::min(n + block_size, objects.size());
+                    futures.push_back(pool.submit(detail::GeometriesBlock<TFactory>{factory, objects.data() + n, objects.data() + end}));
+                }
+            } catch (...) {
+                for (auto& future : futures) {
+                    future.wait();
+                }
+                throw;
+            }
+
+            // All futures must be waited for even if one of them has an
+            // exception, because the tasks use the objects vector.
+            result_type results;
+            results.reserve(objects.size());
+            std::exception_ptr exception;
+            for (auto& future : futures) {
+                try {
+                    for (auto& result : future.get()) {
+                        results.push_back(std::move(result));
+                    }
+                } catch (...) {
+                    if (!exception) {
+                        exception = std::current_exception();
+                    }
+                }
+            }
+
+            if (exception) {
+                std::rethrow_exception(exception);
+            }
+
+            return results;
+        }
+
+        /**
+         * Create geometries for all ways and areas in a buffer using the
+         * default thread pool. See above for details.
+         */
+        template <typename TFactory>
+        std::vector<geometry_result<typename TFactory::linestring_type>> create_geometries(const osmium::memory::Buffer& buffer, const TFactory& factory, std::size_t block_size = 1000) {
+            return create_geometries(osmium::thread::Pool::default_instance(), buffer, factory, block_size);
+        }
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_CREATE_GEOMETRIES_HPP
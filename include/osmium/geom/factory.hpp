@@ -49,7 +49,9 @@ DEALINGS IN THE SOFTWARE.
 #include <cstddef>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -132,6 +134,12 @@ namespace osmium {
                 return Coordinates{location.lon(), location.lat()};
             }
 
+            void operator()(const osmium::Location* locations, Coordinates* out, std::size_t count) const {
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i] = Coordinates{locations[i]};
+                }
+            }
+
             static int epsg() noexcept {
                 return 4326;
             }
@@ -142,27 +150,166 @@ namespace osmium {
 
         }; // class IdentityProjection
 
+        namespace detail {
+
+            /**
+             * Is true if TProjection has an operator() projecting an
+             * array of locations at once.
+             */
+            template <typename TProjection, typename = void>
+            struct has_batch_projection : std::false_type {
+            };
+
+            template <typename TProjection>
+            struct has_batch_projection<TProjection, decltype(std::declval<const TProjection&>()(std::declval<const osmium::Location*>(), std::declval<Coordinates*>(), std::size_t{}))> : std::true_type {
+            };
+
+            template <typename TProjection>
+            inline void project_locations(const TProjection& projection, const osmium::Location* locations, Coordinates* out, std::size_t count, std::true_type /*has_batch_projection*/) {
+                projection(locations, out, count);
+            }
+
+            template <typename TProjection>
+            inline void project_locations(const TProjection& projection, const osmium::Location* locations, Coordinates* out, std::size_t count, std::false_type /*has_batch_projection*/) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i] = projection(locations[i]);
+                }
+            }
+
+            /**
+             * Project count locations with the given projection. Uses the
+             * batch interface of the projection if it has one.
+             */
+            template <typename TProjection>
+            inline void project_locations(const TProjection& projection, const osmium::Location* locations, Coordinates* out, std::size_t count) {
+                project_locations(projection, locations, out, count, has_batch_projection<TProjection>{});
+            }
+
+            /**
+             * Is true if the geometry implementation TGeomImpl can add
+             * an array of coordinates at once. It must then have the
+             * functions linestring_add_locations(), polygon_add_locations(),
+             * and multipolygon_add_locations().
+             */
+            template <typename TGeomImpl, typename = void>
+            struct has_add_locations : std::false_type {
+            };
+
+            template <typename TGeomImpl>
+            struct has_add_locations<TGeomImpl, decltype(std::declval<TGeomImpl&>().linestring_add_locations(std::declval<const Coordinates*>(), std::size_t{}))> : std::true_type {
+            };
+
+            /**
+             * Is true if the geometry implementation TGeomImpl has a
+             * rollback() function which is called when creating a geometry
+             * fails.
+             */
+            template <typename TGeomImpl, typename = void>
+            struct has_rollback : std::false_type {
+            };
+
+            template <typename TGeomImpl>
+            struct has_rollback<TGeomImpl, decltype(std::declval<TGeomImpl&>().rollback())> : std::true_type {
+            };
+
+            template <typename TGeomImpl>
+            inline void rollback(TGeomImpl& impl, std::true_type /*has_rollback*/) {
+                impl.rollback();
+            }
+
+            template <typename TGeomImpl>
+            inline void rollback(TGeomImpl& /*impl*/, std::false_type /*has_rollback*/) noexcept {
+            }
+
+        } // namespace detail
+
         /**
          * Geometry factory.
          */
         template <typename TGeomImpl, typename TProjection = IdentityProjection>
         class GeometryFactory {
 
+            TProjection m_projection;
+            TGeomImpl m_impl;
+
+            // Reused for projecting all locations of a linestring or ring
+            // at once.
+            std::vector<osmium::Location> m_locations;
+            std::vector<Coordinates> m_coordinates;
+
             /**
-             * Add all points of an outer or inner ring to a multipolygon.
+             * Project the locations of all nodes from it to end into
+             * m_coordinates. If unique is set, consecutive nodes with the
+             * same location are only used once.
+             *
+             * @returns The number of coordinates.
              */
-            void add_points(const osmium::NodeRefList& nodes) {
+            template <typename TIter>
+            std::size_t project(TIter it, TIter end, bool unique) {
+                m_locations.clear();
                 osmium::Location last_location;
-                for (const osmium::NodeRef& node_ref : nodes) {
-                    if (last_location != node_ref.location()) {
-                        last_location = node_ref.location();
-                        m_impl.multipolygon_add_location(m_projection(last_location));
+                for (; it != end; ++it) {
+                    if (!unique || last_location != it->location()) {
+                        last_location = it->location();
+                        m_locations.push_back(last_location);
                     }
                 }
+
+                m_coordinates.resize(m_locations.size());
+                detail::project_locations(m_projection, m_locations.data(), m_coordinates.data(), m_locations.size());
+
+                return m_coordinates.size();
             }
 
-            TProjection m_projection;
-            TGeomImpl m_impl;
+            // Add the first num_points coordinates from m_coordinates to
+            // the geometry. Uses one call to the geometry implementation
+            // if it supports adding many coordinates at once.
+
+            void linestring_add_coordinates(std::size_t num_points, std::true_type /*has_add_locations*/) {
+                m_impl.linestring_add_locations(m_coordinates.data(), num_points);
+            }
+
+            void linestring_add_coordinates(std::size_t num_points, std::false_type /*has_add_locations*/) {
+                for (std::size_t i = 0; i < num_points; ++i) {
+                    m_impl.linestring_add_location(m_coordinates[i]);
+                }
+            }
+
+            void polygon_add_coordinates(std::size_t num_points, std::true_type /*has_add_locations*/) {
+                m_impl.polygon_add_locations(m_coordinates.data(), num_points);
+            }
+
+            void polygon_add_coordinates(std::size_t num_points, std::false_type /*has_add_locations*/) {
+                for (std::size_t i = 0; i < num_points; ++i) {
+                    m_impl.polygon_add_location(m_coordinates[i]);
+                }
+            }
+
+            void multipolygon_add_coordinates(std::size_t num_points, std::true_type /*has_add_locations*/) {
+                m_impl.multipolygon_add_locations(m_coordinates.data(), num_points);
+            }
+
+            void multipolygon_add_coordinates(std::size_t num_points, std::false_type /*has_add_locations*/) {
+                for (std::size_t i = 0; i < num_points; ++i) {
+                    m_impl.multipolygon_add_location(m_coordinates[i]);
+                }
+            }
+
+            /**
+             * Add all points of an outer or inner ring to a multipolygon.
+             */
+            void add_points(const osmium::NodeRefList& nodes) {
+                const std::size_t num_points = project(nodes.cbegin(), nodes.cend(), true);
+                multipolygon_add_coordinates(num_points, detail::has_add_locations<TGeomImpl>{});
+            }
+
+            /**
+             * Called if creating a geometry failed. Lets the geometry
+             * implementation clean up if it supports this.
+             */
+            void rollback() {
+                detail::rollback(m_impl, detail::has_rollback<TGeomImpl>{});
+            }
 
         public:
 
@@ -238,24 +385,15 @@ namespace osmium {
 
             template <typename TIter>
             size_t fill_linestring(TIter it, TIter end) {
-                size_t num_points = 0;
-                for (; it != end; ++it, ++num_points) {
-                    m_impl.linestring_add_location(m_projection(it->location()));
-                }
+                const size_t num_points = project(it, end, false);
+                linestring_add_coordinates(num_points, detail::has_add_locations<TGeomImpl>{});
                 return num_points;
             }
 
             template <typename TIter>
             size_t fill_linestring_unique(TIter it, TIter end) {
-                size_t num_points = 0;
-                osmium::Location last_location;
-                for (; it != end; ++it) {
-                    if (last_location != it->location()) {
-                        last_location = it->location();
-                        m_impl.linestring_add_location(m_projection(last_location));
-                        ++num_points;
-                    }
-                }
+                const size_t num_points = project(it, end, true);
+                linestring_add_coordinates(num_points, detail::has_add_locations<TGeomImpl>{});
                 return num_points;
             }
 
@@ -264,34 +402,39 @@ namespace osmium {
             }
 
             linestring_type create_linestring(const osmium::WayNodeList& wnl, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
-                linestring_start();
-                size_t num_points = 0;
-
-                if (un == use_nodes::unique) {
-                    switch (dir) {
-                        case direction::forward:
-                            num_points = fill_linestring_unique(wnl.cbegin(), wnl.cend());
-                            break;
-                        case direction::backward:
-                            num_points = fill_linestring_unique(wnl.crbegin(), wnl.crend());
-                            break;
+                try {
+                    linestring_start();
+                    size_t num_points = 0;
+
+                    if (un == use_nodes::unique) {
+                        switch (dir) {
+                            case direction::forward:
+                                num_points = fill_linestring_unique(wnl.cbegin(), wnl.cend());
+                                break;
+                            case direction::backward:
+                                num_points = fill_linestring_unique(wnl.crbegin(), wnl.crend());
+                                break;
+                        }
+                    } else {
+                        switch (dir) {
+                            case direction::forward:
+                                num_points = fill_linestring(wnl.cbegin(), wnl.cend());
+                                break;
+                            case direction::backward:
+                                num_points = fill_linestring(wnl.crbegin(), wnl.crend());
+                                break;
+                        }
                     }
-                } else {
-                    switch (dir) {
-                        case direction::forward:
-                            num_points = fill_linestring(wnl.cbegin(), wnl.cend());
-                            break;
-                        case direction::backward:
-                            num_points = fill_linestring(wnl.crbegin(), wnl.crend());
-                            break;
+
+                    if (num_points < 2) {
+                        throw osmium::geometry_error{"need at least two points for linestring"};
                     }
-                }
 
-                if (num_points < 2) {
-                    throw osmium::geometry_error{"need at least two points for linestring"};
+                    return linestring_finish(num_points);
+                } catch (...) {
+                    rollback();
+                    throw;
                 }
-
-                return linestring_finish(num_points);
             }
 
             linestring_type create_linestring(const osmium::Way& way, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
@@ -311,24 +454,15 @@ namespace osmium {
 
             template <typename TIter>
             size_t fill_polygon(TIter it, TIter end) {
-                size_t num_points = 0;
-                for (; it != end; ++it, ++num_points) {
-                    m_impl.polygon_add_location(m_projection(it->location()));
-                }
+                const size_t num_points = project(it, end, false);
+                polygon_add_coordinates(num_points, detail::has_add_locations<TGeomImpl>{});
                 return num_points;
             }
 
             template <typename TIter>
             size_t fill_polygon_unique(TIter it, TIter end) {
-                size_t num_points = 0;
-                osmium::Location last_location;
-                for (; it != end; ++it) {
-                    if (last_location != it->location()) {
-                        last_location = it->location();
-                        m_impl.polygon_add_location(m_projection(last_location));
-                        ++num_points;
-                    }
-                }
+                const size_t num_points = project(it, end, true);
+                polygon_add_coordinates(num_points, detail::has_add_locations<TGeomImpl>{});
                 return num_points;
             }
 
@@ -337,34 +471,39 @@ namespace osmium {
             }
 
             polygon_type create_polygon(const osmium::WayNodeList& wnl, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
-                polygon_start();
-                size_t num_points = 0;
-
-                if (un == use_nodes::unique) {
-                    switch (dir) {
-                        case direction::forward:
-                            num_points = fill_polygon_unique(wnl.cbegin(), wnl.cend());
-                            break;
-                        case direction::backward:
-                            num_points = fill_polygon_unique(wnl.crbegin(), wnl.crend());
-                            break;
+                try {
+                    polygon_start();
+                    size_t num_points = 0;
+
+                    if (un == use_nodes::unique) {
+                        switch (dir) {
+                            case direction::forward:
+                                num_points = fill_polygon_unique(wnl.cbegin(), wnl.cend());
+                                break;
+                            case direction::backward:
+                                num_points = fill_polygon_unique(wnl.crbegin(), wnl.crend());
+                                break;
+                        }
+                    } else {
+                        switch (dir) {
+                            case direction::forward:
+                                num_points = fill_polygon(wnl.cbegin(), wnl.cend());
+                                break;
+                            case direction::backward:
+                                num_points = fill_polygon(wnl.crbegin(), wnl.crend());
+                                break;
+                        }
                     }
-                } else {
-                    switch (dir) {
-                        case direction::forward:
-                            num_points = fill_polygon(wnl.cbegin(), wnl.cend());
-                            break;
-                        case direction::backward:
-                            num_points = fill_polygon(wnl.crbegin(), wnl.crend());
-                            break;
+
+                    if (num_points < 4) {
+                        throw osmium::geometry_error{"need at least four points for polygon"};
                     }
-                }
 
-                if (num_points < 4) {
-                    throw osmium::geometry_error{"need at least four points for polygon"};
+                    return polygon_finish(num_points);
+                } catch (...) {
+                    rollback();
+                    throw;
                 }
-
-                return polygon_finish(num_points);
             }
 
             polygon_type create_polygon(const osmium::Way& way, use_nodes un = use_nodes::unique, direction dir = direction::forward) {
@@ -413,8 +552,12 @@ namespace osmium {
                     m_impl.multipolygon_polygon_finish();
                     return m_impl.multipolygon_finish();
                 } catch (osmium::geometry_error& e) {
+                    rollback();
                     e.set_id("area", area.id());
                     throw;
+                } catch (...) {
+                    rollback();
+                    throw;
                 }
             }
 
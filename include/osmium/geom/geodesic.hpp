@@ -0,0 +1,281 @@
+#ifndef OSMIUM_GEOM_GEODESIC_HPP
+#define OSMIUM_GEOM_GEODESIC_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/haversine.hpp>
+#include <osmium/geom/util.hpp>
+#include <osmium/osm/node_ref_list.hpp>
+
+#include <cmath>
+#include <cstddef>
+
+namespace osmium {
+
+    namespace geom {
+
+        /**
+         * @brief Functions to calculate distances on the WGS84 ellipsoid.
+         *
+         * These are more accurate than the functions in the haversine
+         * namespace which assume a spherical Earth, but slower. Distances
+         * are calculated with Vincenty's inverse formula which is accurate
+         * to below a millimeter.
+         *
+         * @attention Vincenty's formula doesn't converge for some nearly
+         *            antipodal points (within about half a degree of being
+         *            antipodal). For those the spherical haversine distance is
+         *            returned instead which can be off by up to about 0.5%
+         *            or tens of kilometers. This doesn't happen for the
+         *            segments of OSM ways but it can for distances between
+         *            arbitrary points.
+         *
+         * Short segments, as they are typical for OSM ways, use a fast path
+         * based on the radii of curvature of the ellipsoid at the mean
+         * latitude of the segment. Its error is well below a millimeter
+         * for the segments it is used for.
+         *
+         * See https://en.wikipedia.org/wiki/Vincenty%27s_formulae
+         */
+        namespace geodesic {
+
+            /// @brief Semi-major axis of the WGS84 ellipsoid
+            constexpr const double WGS84_A = 6378137.0;
+
+            /// @brief Flattening of the WGS84 ellipsoid
+            constexpr const double WGS84_F = 1.0 / 298.257223563;
+
+            /// @brief Semi-minor axis of the WGS84 ellipsoid
+            constexpr const double WGS84_B = WGS84_A * (1.0 - WGS84_F);
+
+            /// @brief Square of the first eccentricity of the WGS84 ellipsoid
+            constexpr const double WGS84_E2 = WGS84_F * (2.0 - WGS84_F);
+
+            /**
+             * Segments with latitude and longitude differences below this
+             * (in degrees) use the fast path.
+             */
+            constexpr const double FAST_PATH_MAX_DELTA = 0.01;
+
+            namespace detail {
+
+                /**
+                 * A point with the values needed for the distance
+                 * calculations that only depend on the point itself. They
+                 * are calculated once for each point and used for both
+                 * segments the point is part of.
+                 */
+                struct point {
+
+                    double lon;
+                    double lat;
+                    double sin_lat;
+                    double sin_u; // sine of reduced latitude
+                    double cos_u; // cosine of reduced latitude
+
+                    point(const double x, const double y) noexcept :
+                        lon(x),
+                        lat(y),
+                        sin_lat(std::sin(deg_to_rad(y))) {
+                        const double tan_u = (1.0 - WGS84_F) * std::tan(deg_to_rad(y));
+                        cos_u = 1.0 / std::sqrt(1.0 + tan_u * tan_u);
+                        sin_u = tan_u * cos_u;
+                    }
+
+                }; // struct point
+
+                /// Longitude difference normalized to [-180, 180].
+                inline double lon_delta(const point& p1, const point& p2) noexcept {
+                    double delta = p2.lon - p1.lon;
+                    if (delta > 180.0) {
+                        delta -= 360.0;
+                    } else if (delta < -180.0) {
+                        delta += 360.0;
+                    }
+                    return delta;
+                }
+
+                /**
+                 * Distance between two close points using the meridional
+                 * and prime vertical radii of curvature at the mean
+                 * latitude.
+                 */
+                inline double short_distance(const point& p1, const point& p2, const double delta_lon) noexcept {
+                    const double sin_lat = (p1.sin_lat + p2.sin_lat) * 0.5;
+                    const double w2 = 1.0 - WGS84_E2 * sin_lat * sin_lat;
+                    const double w = std::sqrt(w2);
+                    const double n = WGS84_A / w; // prime vertical radius
+                    const double m = n * (1.0 - WGS84_E2) / w2; // meridional radius
+                    const double cos_lat = std::sqrt(1.0 - sin_lat * sin_lat);
+
+                    const double dx = n * cos_lat * deg_to_rad(delta_lon);
+                    const double dy = m * deg_to_rad(p2.lat - p1.lat);
+                    return std::sqrt(dx * dx + dy * dy);
+                }
+
+                /**
+                 * Distance between two points using Vincenty's inverse
+                 * formula. If the iteration doesn't converge, which can
+                 * only happen for nearly antipodal points, the much less
+                 * accurate spherical distance is returned.
+                 */
+                inline double vincenty_distance(const point& p1, const point& p2, const double delta_lon) noexcept {
+                    const double l = deg_to_rad(delta_lon);
+                    double lambda = l;
+
+                    double sin_sigma = 0.0;
+                    double cos_sigma = 0.0;
+                    double sigma = 0.0;
+                    double cos2_alpha = 0.0;
+                    double cos_2sigma_m = 0.0;
+
+                    for (int iterations = 0; iterations < 100; ++iterations) {
+                        const double sin_lambda = std::sin(lambda);
+                        const double cos_lambda = std::cos(lambda);
+                        const double a = p2.cos_u * sin_lambda;
+                        const double b = p1.cos_u * p2.sin_u - p1.sin_u * p2.cos_u * cos_lambda;
+                        sin_sigma = std::sqrt(a * a + b * b);
+                        if (sin_sigma == 0.0) {
+                            return 0.0; // coincident points
+                        }
+                        cos_sigma = p1.sin_u * p2.sin_u + p1.cos_u * p2.cos_u * cos_lambda;
+                        sigma = std::atan2(sin_sigma, cos_sigma);
+                        const double sin_alpha = p1.cos_u * p2.cos_u * sin_lambda / sin_sigma;
+                        cos2_alpha = 1.0 - sin_alpha * sin_alpha;
+                        cos_2sigma_m = cos2_alpha == 0.0 ? 0.0 : cos_sigma - 2.0 * p1.sin_u * p2.sin_u / cos2_alpha; // equatorial line if 0
+                        const double c = WGS84_F / 16.0 * cos2_alpha * (4.0 + WGS84_F * (4.0 - 3.0 * cos2_alpha));
+                        const double lambda_prev = lambda;
+                        lambda = l + (1.0 - c) * WGS84_F * sin_alpha *
+                                 (sigma + c * sin_sigma * (cos_2sigma_m + c * cos_sigma * (-1.0 + 2.0 * cos_2sigma_m * cos_2sigma_m)));
+                        if (std::abs(lambda - lambda_prev) < 1e-12) {
+                            const double u2 = cos2_alpha * (WGS84_A * WGS84_A - WGS84_B * WGS84_B) / (WGS84_B * WGS84_B);
+                            const double ca = 1.0 + u2 / 16384.0 * (4096.0 + u2 * (-768.0 + u2 * (320.0 - 175.0 * u2)));
+                            const double cb = u2 / 1024.0 * (256.0 + u2 * (-128.0 + u2 * (74.0 - 47.0 * u2)));
+                            const double delta_sigma = cb * sin_sigma * (cos_2sigma_m + cb / 4.0 * (cos_sigma * (-1.0 + 2.0 * cos_2sigma_m * cos_2sigma_m) -
+                                                       cb / 6.0 * cos_2sigma_m * (-3.0 + 4.0 * sin_sigma * sin_sigma) * (-3.0 + 4.0 * cos_2sigma_m * cos_2sigma_m)));
+                            return WGS84_B * ca * (sigma - delta_sigma);
+                        }
+                    }
+
+                    return osmium::geom::haversine::distance(osmium::geom::Coordinates{p1.lon, p1.lat},
+                                                             osmium::geom::Coordinates{p2.lon, p2.lat});
+                }
+
+                inline double distance(const point& p1, const point& p2) noexcept {
+                    const double delta_lon = lon_delta(p1, p2);
+                    if (std::abs(delta_lon) < FAST_PATH_MAX_DELTA && std::abs(p2.lat - p1.lat) < FAST_PATH_MAX_DELTA) {
+                        return short_distance(p1, p2, delta_lon);
+                    }
+                    return vincenty_distance(p1, p2, delta_lon);
+                }
+
+                /**
+                 * Adds up the lengths of the segments between consecutive
+                 * points.
+                 */
+                class length_accumulator {
+
+                    point m_prev{0.0, 0.0};
+                    double m_sum = 0.0;
+                    bool m_empty = true;
+
+                public:
+
+                    void add(const double lon, const double lat) noexcept {
+                        const point p{lon, lat};
+                        if (!m_empty) {
+                            m_sum += distance(m_prev, p);
+                        }
+                        m_prev = p;
+                        m_empty = false;
+                    }
+
+                    double sum() const noexcept {
+                        return m_sum;
+                    }
+
+                }; // class length_accumulator
+
+            } // namespace detail
+
+            /**
+             * Calculate distance in meters between two sets of coordinates
+             * on the WGS84 ellipsoid. See the namespace documentation for
+             * the accuracy of nearly antipodal points.
+             *
+             * @pre @code c1.valid() && c2.valid() @endcode
+             */
+            inline double distance(const osmium::geom::Coordinates& c1, const osmium::geom::Coordinates& c2) noexcept {
+                return detail::distance(detail::point{c1.x, c1.y}, detail::point{c2.x, c2.y});
+            }
+
+            /**
+             * Calculate length in meters of the line through count
+             * coordinates on the WGS84 ellipsoid.
+             *
+             * @pre All coordinates must be valid.
+             */
+            inline double distance(const osmium::geom::Coordinates* coordinates, const std::size_t count) noexcept {
+                detail::length_accumulator acc;
+
+                for (const auto* it = coordinates; it != coordinates + count; ++it) {
+                    acc.add(it->x, it->y);
+                }
+
+                return acc.sum();
+            }
+
+            /**
+             * Calculate length of node list on the WGS84 ellipsoid.
+             *
+             * @throws osmium::invalid_location if any location is invalid.
+             */
+            inline double distance(const osmium::NodeRefList& nrl) {
+                detail::length_accumulator acc;
+
+                for (const auto& node_ref : nrl) {
+                    const auto& location = node_ref.location();
+                    acc.add(location.lon(), location.lat());
+                }
+
+                return acc.sum();
+            }
+
+        } // namespace geodesic
+
+    } // namespace geom
+
+} // namespace osmium
+
+#endif // OSMIUM_GEOM_GEODESIC_HPP
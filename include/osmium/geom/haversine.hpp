@@ -39,7 +39,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/way.hpp>
 
 #include <cmath>
-#include <iterator>
+#include <cstddef>
 
 namespace osmium {
 
@@ -72,34 +72,88 @@ namespace osmium {
                 return 2.0 * EARTH_RADIUS_IN_METERS * std::asin(std::sqrt(lath + tmp * lonh));
             }
 
+            namespace detail {
+
+                /**
+                 * Adds up the lengths of the segments between consecutive
+                 * points. The cosine of the latitude is calculated only
+                 * once for each point instead of twice for each segment.
+                 * The result is the same as adding up distance() for all
+                 * segments.
+                 */
+                class length_accumulator {
+
+                    double m_sum = 0.0;
+                    double m_lon = 0.0;
+                    double m_lat = 0.0;
+                    double m_cos_lat = 0.0;
+                    bool m_empty = true;
+
+                public:
+
+                    void add(const double lon, const double lat) noexcept {
+                        const double cos_lat = std::cos(deg_to_rad(lat));
+                        if (!m_empty) {
+                            double lonh = std::sin(deg_to_rad(m_lon - lon) * 0.5);
+                            lonh *= lonh;
+                            double lath = std::sin(deg_to_rad(m_lat - lat) * 0.5);
+                            lath *= lath;
+                            const double tmp = m_cos_lat * cos_lat;
+                            m_sum += 2.0 * EARTH_RADIUS_IN_METERS * std::asin(std::sqrt(lath + tmp * lonh));
+                        }
+                        m_lon = lon;
+                        m_lat = lat;
+                        m_cos_lat = cos_lat;
+                        m_empty = false;
+                    }
+
+                    double sum() const noexcept {
+                        return m_sum;
+                    }
+
+                }; // class length_accumulator
+
+            } // namespace detail
+
             /**
-             * Calculate length of way.
+             * Calculate length in meters of the line through count
+             * coordinates.
+             *
+             * @pre All coordinates must be valid.
              */
-            inline double distance(const osmium::WayNodeList& wnl) {
-                double sum_length = 0;
+            inline double distance(const osmium::geom::Coordinates* coordinates, const std::size_t count) noexcept {
+                detail::length_accumulator acc;
 
-                for (const auto* it = wnl.begin(); it != wnl.end(); ++it) {
-                    if (std::next(it) != wnl.end()) {
-                        sum_length += distance(it->location(), std::next(it)->location());
-                    }
+                for (const auto* it = coordinates; it != coordinates + count; ++it) {
+                    acc.add(it->x, it->y);
                 }
 
-                return sum_length;
+                return acc.sum();
             }
 
             /**
              * Calculate length of node list.
+             *
+             * @throws osmium::invalid_location if any location is invalid.
              */
             inline double distance(const osmium::NodeRefList& nrl) {
-                double sum_length = 0;
+                detail::length_accumulator acc;
 
-                for (const auto* it = nrl.begin(); it != nrl.end(); ++it) {
-                    if (std::next(it) != nrl.end()) {
-                        sum_length += distance(it->location(), std::next(it)->location());
-                    }
+                for (const auto& node_ref : nrl) {
+                    const auto& location = node_ref.location();
+                    acc.add(location.lon(), location.lat());
                 }
 
-                return sum_length;
+                return acc.sum();
+            }
+
+            /**
+             * Calculate length of way.
+             *
+             * @throws osmium::invalid_location if any location is invalid.
+             */
+            inline double distance(const osmium::WayNodeList& wnl) {
+                return distance(static_cast<const osmium::NodeRefList&>(wnl));
             }
 
         } // namespace haversine
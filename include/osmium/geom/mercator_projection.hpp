@@ -38,8 +38,15 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/location.hpp>
 
 #include <cmath>
+#include <cstddef>
 #include <string>
 
+#if !defined(OSMIUM_USE_SLOW_MERCATOR_PROJECTION) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+# include <emmintrin.h>
+# define OSMIUM_MERCATOR_USE_SSE2
+#endif
+
 namespace osmium {
 
     namespace geom {
@@ -61,16 +68,19 @@ namespace osmium {
             inline double lat_to_y(double lat) {
                 return lat_to_y_with_tan(lat);
             }
+
+            inline void lat_to_y(const Coordinates* in, Coordinates* out, std::size_t count) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i].y = lat_to_y_with_tan(in[i].y);
+                }
+            }
 #else
 
             // This is a much faster implementation than the canonical
             // implementation using the tan() function. For details
             // see https://github.com/osmcode/mercator-projection .
-            inline double lat_to_y(double lat) { // not constexpr because math functions aren't
-                if (lat < -78.0 || lat > 78.0) {
-                    return lat_to_y_with_tan(lat);
-                }
-
+            // Only valid for latitudes between -78 and +78 degrees.
+            constexpr inline double lat_to_y_with_polynomial(double lat) noexcept {
                 return earth_radius_for_epsg3857 *
                     ((((((((((-3.1112583378460085319e-23  * lat +
                                2.0465852743943268009e-19) * lat +
@@ -94,6 +104,92 @@ namespace osmium {
                               -3.4554675198786337842e-4)  * lat +
                               -5.4367203601085991108e-4)  * lat + 1.0);
             }
+
+            inline double lat_to_y(double lat) { // not constexpr because math functions aren't
+                if (lat < -78.0 || lat > 78.0) {
+                    return lat_to_y_with_tan(lat);
+                }
+
+                return lat_to_y_with_polynomial(lat);
+            }
+
+#ifdef OSMIUM_MERCATOR_USE_SSE2
+            // Same polynomial as above for two latitudes at once.
+            inline __m128d lat_to_y_with_polynomial(__m128d lat) noexcept {
+                static const double numerator[] = {
+                    -3.1112583378460085319e-23,
+                     2.0465852743943268009e-19,
+                     6.4905282018672673884e-18,
+                    -1.9685447939983315591e-14,
+                    -2.2022588158115104182e-13,
+                     5.1617537365509453239e-10,
+                     2.5380136069803016519e-9,
+                    -5.1448323697228488745e-6,
+                    -9.4888671473357768301e-6,
+                     1.7453292518154191887e-2
+                };
+                static const double denominator[] = {
+                    -1.9741136066814230637e-22,
+                    -1.258514031244679556e-20,
+                     4.8141483273572351796e-17,
+                     8.6876090870176172185e-16,
+                    -2.3298743439377541768e-12,
+                    -1.9300094785736130185e-11,
+                     4.3251609106864178231e-8,
+                     1.7301944508516974048e-7,
+                    -3.4554675198786337842e-4,
+                    -5.4367203601085991108e-4
+                };
+
+                __m128d n = _mm_set1_pd(numerator[0]);
+                __m128d d = _mm_set1_pd(denominator[0]);
+                for (int i = 1; i < 10; ++i) {
+                    n = _mm_add_pd(_mm_mul_pd(n, lat), _mm_set1_pd(numerator[i]));
+                    d = _mm_add_pd(_mm_mul_pd(d, lat), _mm_set1_pd(denominator[i]));
+                }
+                n = _mm_mul_pd(n, lat);
+                d = _mm_add_pd(_mm_mul_pd(d, lat), _mm_set1_pd(1.0));
+
+                // Same order of operations as the scalar version so that
+                // the results are bit-identical.
+                return _mm_div_pd(_mm_mul_pd(_mm_set1_pd(earth_radius_for_epsg3857), n), d);
+            }
+#endif
+
+            /**
+             * Convert the latitudes (y) of count coordinates in "in" and
+             * write the results into the y member of the coordinates in
+             * "out". "in" and "out" can be the same.
+             *
+             * If all latitudes are in the range of the polynomial, it is
+             * evaluated for two of them at a time with SSE2 if available.
+             * Latitudes outside this range are rare, if there are any, the
+             * slower code is used for the whole batch.
+             */
+            inline void lat_to_y(const Coordinates* in, Coordinates* out, std::size_t count) {
+                bool in_range = true;
+                for (std::size_t i = 0; i < count; ++i) {
+                    in_range &= (in[i].y >= -78.0) & (in[i].y <= 78.0);
+                }
+
+                if (in_range) {
+                    std::size_t i = 0;
+#ifdef OSMIUM_MERCATOR_USE_SSE2
+                    for (; i + 2 <= count; i += 2) {
+                        const __m128d y = lat_to_y_with_polynomial(_mm_set_pd(in[i + 1].y, in[i].y));
+                        out[i].y = _mm_cvtsd_f64(y);
+                        out[i + 1].y = _mm_cvtsd_f64(_mm_unpackhi_pd(y, y));
+                    }
+#endif
+                    for (; i < count; ++i) {
+                        out[i].y = lat_to_y_with_polynomial(in[i].y);
+                    }
+                } else {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        out[i].y = lat_to_y(in[i].y);
+                    }
+                }
+            }
 #endif
 
             constexpr inline double x_to_lon(double x) {
@@ -124,6 +220,21 @@ namespace osmium {
             return Coordinates{detail::lon_to_x(c.x), detail::lat_to_y(c.y)};
         }
 
+        /**
+         * Convert count coordinates from WGS84 lon/lat to web mercator.
+         * This is faster than calling lonlat_to_mercator() for each of
+         * them. The input and output can be the same array.
+         *
+         * @pre All coordinates must be valid and in valid range, see
+         *      lonlat_to_mercator().
+         */
+        inline void lonlat_to_mercator(const Coordinates* in, Coordinates* out, std::size_t count) {
+            detail::lat_to_y(in, out, count);
+            for (std::size_t i = 0; i < count; ++i) {
+                out[i].x = detail::lon_to_x(in[i].x);
+            }
+        }
+
         /**
          * Convert the coordinates from web mercator to WGS84 lon/lat.
          *
@@ -161,6 +272,26 @@ namespace osmium {
                 return Coordinates{detail::lon_to_x(location.lon()), detail::lat_to_y(location.lat())};
             }
 
+            /**
+             * Do coordinate transformation for count locations at once and
+             * write the results into "out".
+             *
+             * @throws osmium::invalid_location if any of the locations is
+             *         invalid.
+             * @pre Locations must be in valid range, see above.
+             */
+            void operator()(const osmium::Location* locations, Coordinates* out, std::size_t count) const {
+                for (std::size_t i = 0; i < count; ++i) {
+                    if (!locations[i].valid()) {
+                        throw osmium::invalid_location{"invalid location"};
+                    }
+                }
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i] = Coordinates{locations[i].lon_without_check(), locations[i].lat_without_check()};
+                }
+                lonlat_to_mercator(out, out, count);
+            }
+
             static int epsg() noexcept {
                 return 3857;
             }
@@ -175,4 +306,6 @@ namespace osmium {
 
 } // namespace osmium
 
+#undef OSMIUM_MERCATOR_USE_SSE2
+
 #endif // OSMIUM_GEOM_MERCATOR_PROJECTION_HPP
@@ -56,6 +56,7 @@ DEALINGS IN THE SOFTWARE.
 # undef ACCEPT_USE_OF_DEPRECATED_PROJ_API_H
 #endif
 
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -130,6 +131,29 @@ namespace osmium {
             return c;
         }
 
+        /**
+         * Transform count coordinates from one CRS into another in place.
+         * Uses a single call to the proj library for all of them.
+         *
+         * Coordinates have to be in radians and are produced in radians.
+         *
+         * @throws osmium::projection_error if the projection fails
+         *
+         * @deprecated Only supports the old PROJ API.
+         */
+        inline OSMIUM_DEPRECATED void transform(const CRS& src, const CRS& dest, Coordinates* c, std::size_t count) {
+            static_assert(sizeof(Coordinates) == 2 * sizeof(double), "Coordinates must contain exactly two doubles");
+            if (count == 0) {
+                return;
+            }
+            // Point offset 2, because x and y of all coordinates are
+            // interleaved in the array.
+            const int result = pj_transform(src.get(), dest.get(), static_cast<long>(count), 2, &c->x, &c->y, nullptr); // NOLINT(google-runtime-int)
+            if (result != 0) {
+                throw osmium::projection_error{std::string{"projection failed: "} + pj_strerrno(result)};
+            }
+        }
+
         /**
          * Functor that does projection from WGS84 (EPSG:4326) to the given
          * CRS.
@@ -196,6 +220,44 @@ namespace osmium {
                 return c;
             }
 
+            /**
+             * Do coordinate transformation for count locations at once and
+             * write the results into "out". For CRSs other than 4326 and
+             * 3857 the proj library is called only once for all of them.
+             *
+             * @throws osmium::invalid_location if any of the locations is
+             *         invalid.
+             * @throws osmium::projection_error if the projection fails.
+             * @pre Locations must be in valid range (depends on projection
+             *      used).
+             */
+            void operator()(const osmium::Location* locations, Coordinates* out, std::size_t count) const {
+                if (m_epsg == 4326) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        out[i] = Coordinates{locations[i]};
+                    }
+                    return;
+                }
+
+                if (m_epsg == 3857) {
+                    MercatorProjection{}(locations, out, count);
+                    return;
+                }
+
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i] = Coordinates{deg_to_rad(locations[i].lon()), deg_to_rad(locations[i].lat())};
+                }
+
+                transform(m_crs_wgs84, m_crs_user, out, count);
+
+                if (m_crs_user.is_latlong()) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        out[i].x = rad_to_deg(out[i].x);
+                        out[i].y = rad_to_deg(out[i].y);
+                    }
+                }
+            }
+
             int epsg() const noexcept {
                 return m_epsg;
             }
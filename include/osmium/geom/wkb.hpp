@@ -40,6 +40,7 @@ DEALINGS IN THE SOFTWARE.
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <string>
 
 namespace osmium {
@@ -76,35 +77,101 @@ namespace osmium {
                 return out;
             }
 
-            class WKBFactoryImpl {
+            /**
+             * Convert the data in str starting at offset to hex in place.
+             */
+            inline void convert_to_hex_in_place(std::string& str, const std::size_t offset) {
+                static const char* lookup_hex = "0123456789ABCDEF";
+                const std::size_t size = str.size() - offset;
+                str.resize(offset + size * 2);
+
+                // Work backwards, so that no byte is overwritten before
+                // it is converted.
+                for (std::size_t i = size; i > 0; --i) {
+                    const auto c = static_cast<unsigned int>(str[offset + i - 1]);
+                    str[offset + i * 2 - 2] = lookup_hex[(c >> 4U) & 0xfU];
+                    str[offset + i * 2 - 1] = lookup_hex[ c        & 0xfU];
+                }
+            }
 
-                /**
-                * Type of WKB geometry.
-                * These definitions are from
-                * 99-049_OpenGIS_Simple_Features_Specification_For_SQL_Rev_1.1.pdf (for WKB)
-                * and https://trac.osgeo.org/postgis/browser/trunk/doc/ZMSgeoms.txt (for EWKB).
-                * They are used to encode geometries into the WKB format.
-                */
-                enum wkbGeometryType : uint32_t {
-                    wkbPoint               = 1,
-                    wkbLineString          = 2,
-                    wkbPolygon             = 3,
-                    wkbMultiPoint          = 4,
-                    wkbMultiLineString     = 5,
-                    wkbMultiPolygon        = 6,
-                    wkbGeometryCollection  = 7,
-
-                    // SRID-presence flag (EWKB)
-                    wkbSRID                = 0x20000000
-                }; // enum wkbGeometryType
+            /**
+            * Type of WKB geometry.
+            * These definitions are from
+            * 99-049_OpenGIS_Simple_Features_Specification_For_SQL_Rev_1.1.pdf (for WKB)
+            * and https://trac.osgeo.org/postgis/browser/trunk/doc/ZMSgeoms.txt (for EWKB).
+            * They are used to encode geometries into the WKB format.
+            */
+            enum wkbGeometryType : uint32_t {
+                wkbPoint               = 1,
+                wkbLineString          = 2,
+                wkbPolygon             = 3,
+                wkbMultiPoint          = 4,
+                wkbMultiLineString     = 5,
+                wkbMultiPolygon        = 6,
+                wkbGeometryCollection  = 7,
+
+                // SRID-presence flag (EWKB)
+                wkbSRID                = 0x20000000
+            }; // enum wkbGeometryType
+
+            /**
+            * Byte order marker in WKB geometry.
+            */
+            enum class wkb_byte_order_type : uint8_t {
+                XDR = 0,         // Big Endian
+                NDR = 1          // Little Endian
+            }; // enum class wkb_byte_order_type
+
+            /**
+             * Append the header of a WKB geometry to str. If add_length is
+             * set, space for the length is added after the header.
+             *
+             * @returns The offset of the length in str.
+             */
+            inline std::size_t wkb_header(std::string& str, wkbGeometryType type, wkb_type wtype, int srid, bool add_length) {
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+                str_push(str, wkb_byte_order_type::NDR);
+#else
+                str_push(str, wkb_byte_order_type::XDR);
+#endif
+                if (wtype == wkb_type::ewkb) {
+                    str_push(str, type | wkbSRID);
+                    str_push(str, srid);
+                } else {
+                    str_push(str, type);
+                }
+                const std::size_t offset = str.size();
+                if (add_length) {
+                    str_push(str, static_cast<uint32_t>(0));
+                }
+                return offset;
+            }
 
-                /**
-                * Byte order marker in WKB geometry.
-                */
-                enum class wkb_byte_order_type : uint8_t {
-                    XDR = 0,         // Big Endian
-                    NDR = 1          // Little Endian
-                }; // enum class wkb_byte_order_type
+            /**
+             * Set the length (number of points, rings, or polygons) at
+             * offset in str.
+             *
+             * @throws geometry_error if the size doesn't fit into 32 bit.
+             */
+            inline void wkb_set_size(std::string& str, const std::size_t offset, const std::size_t size) {
+                if (size > std::numeric_limits<uint32_t>::max()) {
+                    throw geometry_error{"Too many points in geometry"};
+                }
+                const auto s = static_cast<uint32_t>(size);
+                std::copy_n(reinterpret_cast<const char*>(&s), sizeof(uint32_t), &str[offset]);
+            }
+
+            /**
+             * Append count coordinates to str. The x and y members of the
+             * coordinates are in the same order and byte order as in WKB,
+             * so they are copied in one go.
+             */
+            inline void wkb_append_coordinates(std::string& str, const osmium::geom::Coordinates* coordinates, std::size_t count) {
+                static_assert(sizeof(osmium::geom::Coordinates) == 2 * sizeof(double), "Coordinates must contain exactly two doubles");
+                str.append(reinterpret_cast<const char*>(coordinates), count * sizeof(osmium::geom::Coordinates));
+            }
+
+            class WKBFactoryImpl {
 
                 std::string m_data;
                 uint32_t m_points = 0;
@@ -120,30 +187,11 @@ namespace osmium {
                 std::size_t m_ring_size_offset = 0;
 
                 std::size_t header(std::string& str, wkbGeometryType type, bool add_length) const {
-#if __BYTE_ORDER == __LITTLE_ENDIAN
-                    str_push(str, wkb_byte_order_type::NDR);
-#else
-                    str_push(str, wkb_byte_order_type::XDR);
-#endif
-                    if (m_wkb_type == wkb_type::ewkb) {
-                        str_push(str, type | wkbSRID);
-                        str_push(str, m_srid);
-                    } else {
-                        str_push(str, type);
-                    }
-                    const std::size_t offset = str.size();
-                    if (add_length) {
-                        str_push(str, static_cast<uint32_t>(0));
-                    }
-                    return offset;
+                    return wkb_header(str, type, m_wkb_type, m_srid, add_length);
                 }
 
                 void set_size(const std::size_t offset, const std::size_t size) {
-                    if (size > std::numeric_limits<uint32_t>::max()) {
-                        throw geometry_error{"Too many points in geometry"};
-                    }
-                    const auto s = static_cast<uint32_t>(size);
-                    std::copy_n(reinterpret_cast<const char*>(&s), sizeof(uint32_t), &m_data[offset]);
+                    wkb_set_size(m_data, offset, size);
                 }
 
             public:
@@ -187,6 +235,10 @@ namespace osmium {
                     str_push(m_data, xy.y);
                 }
 
+                void linestring_add_locations(const osmium::geom::Coordinates* coordinates, std::size_t count) {
+                    wkb_append_coordinates(m_data, coordinates, count);
+                }
+
                 linestring_type linestring_finish(std::size_t num_points) {
                     set_size(m_linestring_size_offset, num_points);
                     std::string data;
@@ -215,6 +267,10 @@ namespace osmium {
                     str_push(m_data, xy.y);
                 }
 
+                void polygon_add_locations(const osmium::geom::Coordinates* coordinates, std::size_t count) {
+                    wkb_append_coordinates(m_data, coordinates, count);
+                }
+
                 polygon_type polygon_finish(std::size_t num_points) {
                     set_size(m_ring_size_offset, num_points);
                     std::string data;
@@ -275,6 +331,11 @@ namespace osmium {
                     ++m_points;
                 }
 
+                void multipolygon_add_locations(const osmium::geom::Coordinates* coordinates, std::size_t count) {
+                    wkb_append_coordinates(m_data, coordinates, count);
+                    m_points += static_cast<uint32_t>(count);
+                }
+
                 multipolygon_type multipolygon_finish() {
                     set_size(m_multipolygon_size_offset, m_polygons);
                     std::string data;
@@ -291,11 +352,231 @@ namespace osmium {
 
             }; // class WKBFactoryImpl
 
+            /**
+             * Like WKBFactoryImpl, but the geometries are appended to an
+             * output buffer given by the caller instead of being returned
+             * as new strings. All functions creating a geometry return the
+             * number of bytes appended to the buffer.
+             */
+            class WKBBufferFactoryImpl {
+
+                std::string* m_out;
+                int m_srid;
+                wkb_type m_wkb_type;
+                out_type m_out_type;
+
+                // Size of the output buffer before the current geometry
+                // was started. These are mutable so that make_point(),
+                // which is const, can remove an unfinished geometry.
+                mutable std::size_t m_start = 0;
+                mutable bool m_unfinished = false;
+
+                uint32_t m_points = 0;
+                std::size_t m_linestring_size_offset = 0;
+                std::size_t m_polygons = 0;
+                std::size_t m_rings = 0;
+                std::size_t m_multipolygon_size_offset = 0;
+                std::size_t m_polygon_size_offset = 0;
+                std::size_t m_ring_size_offset = 0;
+
+                std::size_t start(wkbGeometryType type, bool add_length) {
+                    rollback();
+                    m_start = m_out->size();
+                    m_unfinished = true;
+                    return wkb_header(*m_out, type, m_wkb_type, m_srid, add_length);
+                }
+
+                std::size_t finish() {
+                    m_unfinished = false;
+                    if (m_out_type == out_type::hex) {
+                        convert_to_hex_in_place(*m_out, m_start);
+                    }
+                    return m_out->size() - m_start;
+                }
+
+                void set_size(const std::size_t offset, const std::size_t size) {
+                    wkb_set_size(*m_out, offset, size);
+                }
+
+                // Make sure count more coordinates and the conversion of
+                // the current geometry to hex fit into the output buffer
+                // without reallocating it more than once.
+                void reserve_locations(const std::size_t count) {
+                    std::size_t size = m_out->size() + count * 2 * sizeof(double);
+                    if (m_out_type == out_type::hex) {
+                        size += size - m_start;
+                    }
+                    if (size > m_out->capacity()) {
+                        m_out->reserve(std::max(size, 2 * m_out->capacity()));
+                    }
+                }
+
+            public:
+
+                using point_type        = std::size_t;
+                using linestring_type   = std::size_t;
+                using polygon_type      = std::size_t;
+                using multipolygon_type = std::size_t;
+                using ring_type         = std::size_t;
+
+                WKBBufferFactoryImpl(int srid, std::string& out, wkb_type wtype = wkb_type::wkb, out_type otype = out_type::binary) :
+                    m_out(&out),
+                    m_srid(srid),
+                    m_wkb_type(wtype),
+                    m_out_type(otype) {
+                }
+
+                /**
+                 * Remove the incomplete geometry from the end of the
+                 * output buffer if creating it was not finished, for
+                 * instance because of an exception.
+                 */
+                void rollback() const {
+                    if (m_unfinished) {
+                        m_out->resize(m_start);
+                        m_unfinished = false;
+                    }
+                }
+
+                /* Point */
+
+                point_type make_point(const osmium::geom::Coordinates& xy) const {
+                    rollback();
+                    const std::size_t start = m_out->size();
+                    wkb_header(*m_out, wkbPoint, m_wkb_type, m_srid, false);
+                    wkb_append_coordinates(*m_out, &xy, 1);
+
+                    if (m_out_type == out_type::hex) {
+                        convert_to_hex_in_place(*m_out, start);
+                    }
+
+                    return m_out->size() - start;
+                }
+
+                /* LineString */
+
+                void linestring_start() {
+                    m_linestring_size_offset = start(wkbLineString, true);
+                }
+
+                void linestring_add_location(const osmium::geom::Coordinates& xy) {
+                    wkb_append_coordinates(*m_out, &xy, 1);
+                }
+
+                void linestring_add_locations(const osmium::geom::Coordinates* coordinates, std::size_t count) {
+                    reserve_locations(count);
+                    wkb_append_coordinates(*m_out, coordinates, count);
+                }
+
+                linestring_type linestring_finish(std::size_t num_points) {
+                    set_size(m_linestring_size_offset, num_points);
+                    return finish();
+                }
+
+                /* Polygon */
+
+                void polygon_start() {
+                    set_size(start(wkbPolygon, true), 1);
+                    m_ring_size_offset = m_out->size();
+                    str_push(*m_out, static_cast<uint32_t>(0));
+                }
+
+                void polygon_add_location(const osmium::geom::Coordinates& xy) {
+                    wkb_append_coordinates(*m_out, &xy, 1);
+                }
+
+                void polygon_add_locations(const osmium::geom::Coordinates* coordinates, std::size_t count) {
+                    reserve_locations(count);
+                    wkb_append_coordinates(*m_out, coordinates, count);
+                }
+
+                polygon_type polygon_finish(std::size_t num_points) {
+                    set_size(m_ring_size_offset, num_points);
+                    return finish();
+                }
+
+                /* MultiPolygon */
+
+                void multipolygon_start() {
+                    m_polygons = 0;
+                    m_multipolygon_size_offset = start(wkbMultiPolygon, true);
+                }
+
+                void multipolygon_polygon_start() {
+                    ++m_polygons;
+                    m_rings = 0;
+                    m_polygon_size_offset = wkb_header(*m_out, wkbPolygon, m_wkb_type, m_srid, true);
+                }
+
+                void multipolygon_polygon_finish() {
+                    set_size(m_polygon_size_offset, m_rings);
+                }
+
+                void multipolygon_outer_ring_start() {
+                    ++m_rings;
+                    m_points = 0;
+                    m_ring_size_offset = m_out->size();
+                    str_push(*m_out, static_cast<uint32_t>(0));
+                }
+
+                void multipolygon_outer_ring_finish() {
+                    set_size(m_ring_size_offset, m_points);
+                }
+
+                void multipolygon_inner_ring_start() {
+                    ++m_rings;
+                    m_points = 0;
+                    m_ring_size_offset = m_out->size();
+                    str_push(*m_out, static_cast<uint32_t>(0));
+                }
+
+                void multipolygon_inner_ring_finish() {
+                    set_size(m_ring_size_offset, m_points);
+                }
+
+                void multipolygon_add_location(const osmium::geom::Coordinates& xy) {
+                    wkb_append_coordinates(*m_out, &xy, 1);
+                    ++m_points;
+                }
+
+                void multipolygon_add_locations(const osmium::geom::Coordinates* coordinates, std::size_t count) {
+                    reserve_locations(count);
+                    wkb_append_coordinates(*m_out, coordinates, count);
+                    m_points += static_cast<uint32_t>(count);
+                }
+
+                multipolygon_type multipolygon_finish() {
+                    set_size(m_multipolygon_size_offset, m_polygons);
+                    return finish();
+                }
+
+            }; // class WKBBufferFactoryImpl
+
         } // namespace detail
 
         template <typename TProjection = IdentityProjection>
         using WKBFactory = GeometryFactory<osmium::geom::detail::WKBFactoryImpl, TProjection>;
 
+        /**
+         * WKB factory appending the geometries to an output buffer given
+         * in the constructor. Creating a geometry doesn't allocate memory
+         * once the buffer is large enough, so the buffer should be reused,
+         * for instance by clearing it after its content is written out.
+         * The functions creating geometries return the number of bytes
+         * appended to the buffer.
+         *
+         * @code
+         * std::string buffer;
+         * osmium::geom::WKBBufferFactory<> factory{buffer, osmium::geom::wkb_type::ewkb, osmium::geom::out_type::hex};
+         * factory.create_linestring(way);
+         * @endcode
+         *
+         * If creating a geometry fails with an exception, the buffer is
+         * left unchanged.
+         */
+        template <typename TProjection = IdentityProjection>
+        using WKBBufferFactory = GeometryFactory<osmium::geom::detail::WKBBufferFactoryImpl, TProjection>;
+
     } // namespace geom
 
 } // namespace osmium
@@ -47,6 +47,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/io/debug_output.hpp> // IWYU pragma: export
 #include <osmium/io/ids_output.hpp> // IWYU pragma: export
+#include <osmium/io/o5m_output.hpp> // IWYU pragma: export
 #include <osmium/io/opl_output.hpp> // IWYU pragma: export
 #include <osmium/io/pbf_output.hpp> // IWYU pragma: export
 #include <osmium/io/xml_output.hpp> // IWYU pragma: export
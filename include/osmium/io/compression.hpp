@@ -33,6 +33,8 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/io/detail/direct_io.hpp>
+#include <osmium/io/detail/io_uring.hpp>
 #include <osmium/io/detail/read_write.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file_compression.hpp>
@@ -229,12 +231,23 @@ namespace osmium {
 
             std::size_t m_file_size = 0;
             int m_fd;
+            std::unique_ptr<osmium::io::detail::DirectFileWriter> m_direct_writer;
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+            std::unique_ptr<osmium::io::detail::UringFileWriter> m_uring_writer;
+#endif
 
         public:
 
             NoCompressor(const int fd, const fsync sync) :
                 Compressor(sync),
                 m_fd(fd) {
+                if (fd >= 0 && osmium::io::detail::has_direct_io(fd)) {
+                    m_direct_writer.reset(new osmium::io::detail::DirectFileWriter{fd});
+                    return;
+                }
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+                m_uring_writer = osmium::io::detail::make_uring_writer(fd);
+#endif
             }
 
             NoCompressor(const NoCompressor&) = delete;
@@ -252,12 +265,38 @@ namespace osmium {
             }
 
             void write(const std::string& data) override {
+                if (m_direct_writer) {
+                    m_direct_writer->write(data.data(), data.size());
+                    m_file_size += data.size();
+                    return;
+                }
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+                if (m_uring_writer) {
+                    m_uring_writer->write(data);
+                    m_file_size += data.size();
+                    return;
+                }
+#endif
                 osmium::io::detail::reliable_write(m_fd, data.data(), data.size());
                 m_file_size += data.size();
             }
 
             void close() override {
                 if (m_fd >= 0) {
+                    // The file descriptor is only forgotten after all data
+                    // was written, so that it is still closed (from the
+                    // destructor) if writing the rest of the data fails.
+                    if (m_direct_writer) {
+                        std::unique_ptr<osmium::io::detail::DirectFileWriter> writer{std::move(m_direct_writer)};
+                        writer->finish();
+                    }
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+                    if (m_uring_writer) {
+                        std::unique_ptr<osmium::io::detail::UringFileWriter> writer{std::move(m_uring_writer)};
+                        writer->flush();
+                    }
+#endif
+
                     const int fd = m_fd;
                     m_fd = -1;
 
@@ -316,11 +355,19 @@ namespace osmium {
             const char* m_buffer = nullptr;
             std::size_t m_buffer_size = 0;
             std::size_t m_offset = 0;
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+            std::unique_ptr<osmium::io::detail::UringFileReader> m_uring_reader;
+#endif
 
         public:
 
             explicit NoDecompressor(const int fd) :
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+                m_fd(fd),
+                m_uring_reader(osmium::io::detail::make_uring_reader(fd, osmium::io::Decompressor::input_buffer_size)) {
+#else
                 m_fd(fd) {
+#endif
             }
 
             NoDecompressor(const char* buffer, const std::size_t size) :
@@ -352,12 +399,22 @@ namespace osmium {
                         buffer.append(m_buffer, size);
                     }
                 } else {
-                    buffer.resize(osmium::io::Decompressor::input_buffer_size);
                     if (want_buffered_pages_removed()) {
                         osmium::io::detail::remove_buffered_pages(m_fd, m_offset);
                     }
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+                    if (m_uring_reader) {
+                        buffer = m_uring_reader->read();
+                    } else {
+                        buffer.resize(osmium::io::Decompressor::input_buffer_size);
+                        const auto nread = detail::reliable_read(m_fd, &*buffer.begin(), osmium::io::Decompressor::input_buffer_size);
+                        buffer.resize(std::string::size_type(nread));
+                    }
+#else
+                    buffer.resize(osmium::io::Decompressor::input_buffer_size);
                     const auto nread = detail::reliable_read(m_fd, &*buffer.begin(), osmium::io::Decompressor::input_buffer_size);
                     buffer.resize(std::string::size_type(nread));
+#endif
                 }
 
                 m_offset += buffer.size();
@@ -368,6 +425,10 @@ namespace osmium {
 
             void close() override {
                 if (m_fd >= 0) {
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+                    // Wait for outstanding reads before closing the file
+                    m_uring_reader.reset();
+#endif
                     if (want_buffered_pages_removed()) {
                         osmium::io::detail::remove_buffered_pages(m_fd);
                     }
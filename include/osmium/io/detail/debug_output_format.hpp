@@ -115,6 +115,8 @@ namespace osmium {
 
                 debug_output_options m_options;
 
+                osmium::detail::iso_timestamp_formatter m_timestamp_formatter;
+
                 const char* m_utf8_prefix = "";
                 const char* m_utf8_suffix = "";
 
@@ -215,7 +217,7 @@ namespace osmium {
 
                 void write_timestamp(const osmium::Timestamp& timestamp) {
                     if (timestamp.valid()) {
-                        *m_out += timestamp.to_iso();
+                        m_timestamp_formatter.append(*m_out, uint32_t(timestamp));
                         *m_out += " (";
                         output_int(timestamp.seconds_since_epoch());
                         *m_out += ')';
@@ -0,0 +1,292 @@
+#ifndef OSMIUM_IO_DETAIL_DIRECT_IO_HPP
+#define OSMIUM_IO_DETAIL_DIRECT_IO_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <system_error>
+
+#ifndef _MSC_VER
+# include <unistd.h>
+#else
+# include <io.h>
+#endif
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            enum : std::size_t {
+                // Alignment needed for buffers, file offsets, and sizes of
+                // reads and writes with O_DIRECT. This is large enough for
+                // all common logical block sizes.
+                direct_io_alignment = 4096UL,
+
+                // Size of the buffers used for direct I/O
+                direct_io_buffer_size = 4UL * 1024UL * 1024UL
+            };
+
+            /**
+             * Switch the file descriptor to direct I/O (O_DIRECT), which
+             * bypasses the page cache. This is only done for regular files.
+             *
+             * @returns true if direct I/O is now enabled.
+             */
+            inline bool enable_direct_io(const int fd) noexcept {
+#if defined(__linux__) && defined(O_DIRECT)
+                struct stat s; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                if (fd < 0 || ::fstat(fd, &s) != 0 || !S_ISREG(s.st_mode)) { // NOLINT(hicpp-signed-bitwise)
+                    return false;
+                }
+                const int flags = ::fcntl(fd, F_GETFL);
+                return flags >= 0 && ::fcntl(fd, F_SETFL, flags | O_DIRECT) == 0; // NOLINT(hicpp-signed-bitwise)
+#else
+                (void)fd;
+                return false;
+#endif
+            }
+
+            /**
+             * Switch off direct I/O (O_DIRECT) for the file descriptor.
+             *
+             * @returns true if direct I/O was enabled before and is now
+             *          disabled.
+             */
+            inline bool disable_direct_io(const int fd) noexcept {
+#if defined(__linux__) && defined(O_DIRECT)
+                const int flags = ::fcntl(fd, F_GETFL);
+                if (flags < 0 || !(flags & O_DIRECT)) { // NOLINT(hicpp-signed-bitwise)
+                    return false;
+                }
+                return ::fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0; // NOLINT(hicpp-signed-bitwise)
+#else
+                (void)fd;
+                return false;
+#endif
+            }
+
+            /**
+             * Is direct I/O (O_DIRECT) enabled for the file descriptor?
+             */
+            inline bool has_direct_io(const int fd) noexcept {
+#if defined(__linux__) && defined(O_DIRECT)
+                const int flags = ::fcntl(fd, F_GETFL);
+                return flags >= 0 && (flags & O_DIRECT); // NOLINT(hicpp-signed-bitwise)
+#else
+                (void)fd;
+                return false;
+#endif
+            }
+
+            /**
+             * Memory buffer of direct_io_buffer_size bytes aligned to
+             * direct_io_alignment.
+             */
+            class AlignedBuffer {
+
+                std::unique_ptr<char[]> m_memory;
+                char* m_data;
+
+            public:
+
+                AlignedBuffer() :
+                    m_memory(new char[direct_io_buffer_size + direct_io_alignment]),
+                    m_data(m_memory.get() + (direct_io_alignment - reinterpret_cast<std::uintptr_t>(m_memory.get()) % direct_io_alignment) % direct_io_alignment) {
+                }
+
+                char* data() noexcept {
+                    return m_data;
+                }
+
+                const char* data() const noexcept {
+                    return m_data;
+                }
+
+                static constexpr std::size_t size() noexcept {
+                    return direct_io_buffer_size;
+                }
+
+            }; // class AlignedBuffer
+
+            /**
+             * Reads a file opened with direct I/O sequentially. The data
+             * is always read in full aligned blocks into an aligned buffer
+             * and copied out from there. If the file system does not
+             * support direct I/O, it is switched off again and the file is
+             * read normally.
+             */
+            class DirectFileReader {
+
+                AlignedBuffer m_buffer{};
+                std::size_t m_size = 0;
+                std::size_t m_pos = 0;
+                int m_fd;
+
+                void fill() {
+                    m_pos = 0;
+                    m_size = 0;
+                    while (true) {
+#ifdef _WIN32
+                        const auto nread = ::_read(m_fd, m_buffer.data(), static_cast<unsigned int>(m_buffer.size()));
+#else
+                        const auto nread = ::read(m_fd, m_buffer.data(), m_buffer.size());
+#endif
+                        if (nread >= 0) {
+                            m_size = static_cast<std::size_t>(nread);
+                            return;
+                        }
+                        if (errno == EINVAL && disable_direct_io(m_fd)) {
+                            continue;
+                        }
+                        if (errno != EINTR) {
+                            throw std::system_error{errno, std::system_category(), "Read failed"};
+                        }
+                    }
+                }
+
+            public:
+
+                explicit DirectFileReader(const int fd) :
+                    m_fd(fd) {
+                }
+
+                /**
+                 * Read exactly size bytes from the file into buffer.
+                 *
+                 * @returns true if size bytes could be read
+                 *          false if EOF was encountered
+                 * @throws std::system_error On error.
+                 */
+                bool read_exactly(char* buffer, std::size_t size) {
+                    while (size > 0) {
+                        if (m_pos == m_size) {
+                            fill();
+                            if (m_size == 0) {
+                                return false;
+                            }
+                        }
+                        const std::size_t len = std::min(size, m_size - m_pos);
+                        std::memcpy(buffer, m_buffer.data() + m_pos, len);
+                        m_pos += len;
+                        buffer += len;
+                        size -= len;
+                    }
+                    return true;
+                }
+
+            }; // class DirectFileReader
+
+            /**
+             * Writes to a file opened with direct I/O. Data is collected
+             * in an aligned buffer and written out in full aligned blocks.
+             * When finish() is called, direct I/O is switched off and the
+             * rest of the data is written normally. If the file system
+             * does not support direct I/O, it is switched off right away.
+             */
+            class DirectFileWriter {
+
+                AlignedBuffer m_buffer{};
+                std::size_t m_size = 0;
+                int m_fd;
+
+                void write_out(const char* data, std::size_t size) {
+                    while (size > 0) {
+                        const auto length = ::write(m_fd, data, static_cast<unsigned int>(size));
+                        if (length >= 0) {
+                            data += length;
+                            size -= static_cast<std::size_t>(length);
+                        } else if (errno == EINVAL && disable_direct_io(m_fd)) {
+                            continue;
+                        } else if (errno != EINTR) {
+                            throw std::system_error{errno, std::system_category(), "Write failed"};
+                        }
+                    }
+                }
+
+            public:
+
+                explicit DirectFileWriter(const int fd) :
+                    m_fd(fd) {
+                }
+
+                /**
+                 * Queue the data for writing.
+                 *
+                 * @throws std::system_error On error.
+                 */
+                void write(const char* data, std::size_t size) {
+                    while (size > 0) {
+                        const std::size_t len = std::min(size, m_buffer.size() - m_size);
+                        std::memcpy(m_buffer.data() + m_size, data, len);
+                        m_size += len;
+                        data += len;
+                        size -= len;
+                        if (m_size == m_buffer.size()) {
+                            write_out(m_buffer.data(), m_size);
+                            m_size = 0;
+                        }
+                    }
+                }
+
+                /**
+                 * Write out all remaining data and switch off direct I/O.
+                 *
+                 * @throws std::system_error On error.
+                 */
+                void finish() {
+                    const std::size_t aligned_size = m_size - m_size % direct_io_alignment;
+                    write_out(m_buffer.data(), aligned_size);
+                    disable_direct_io(m_fd);
+                    write_out(m_buffer.data() + aligned_size, m_size - aligned_size);
+                    m_size = 0;
+                }
+
+            }; // class DirectFileWriter
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_DIRECT_IO_HPP
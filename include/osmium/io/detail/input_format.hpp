@@ -38,7 +38,9 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/file.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/read_tags_filter.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/thread/pool.hpp>
 
@@ -64,7 +66,10 @@ namespace osmium {
                 std::promise<osmium::io::Header>& header_promise;
                 std::atomic<std::size_t>* offset_ptr;
                 osmium::osm_entity_bits::type read_which_entities;
+                osmium::Box read_bbox;
+                osmium::io::read_tags_filter tags_filter;
                 osmium::io::read_meta read_metadata;
+                osmium::io::detail::object_parts read_parts;
                 osmium::io::buffers_type buffers_kind;
                 bool want_buffered_pages_removed;
             };
@@ -77,6 +82,7 @@ namespace osmium {
                 queue_wrapper<std::string> m_input_queue;
                 osmium::osm_entity_bits::type m_read_which_entities;
                 osmium::io::read_meta m_read_metadata;
+                object_parts m_read_parts;
                 bool m_header_is_done;
 
             protected:
@@ -93,6 +99,10 @@ namespace osmium {
                     return m_read_metadata;
                 }
 
+                const object_parts& read_parts() const noexcept {
+                    return m_read_parts;
+                }
+
                 bool header_is_done() const noexcept {
                     return m_header_is_done;
                 }
@@ -131,6 +141,7 @@ namespace osmium {
                     m_input_queue(args.input_queue),
                     m_read_which_entities(args.read_which_entities),
                     m_read_metadata(args.read_metadata),
+                    m_read_parts(args.read_parts),
                     m_header_is_done(false) {
                 }
 
@@ -203,6 +214,10 @@ namespace osmium {
                     return m_buffer;
                 }
 
+                osmium::io::buffers_type buffers_kind() const noexcept {
+                    return m_buffers_kind;
+                }
+
                 void flush_nested_buffer() {
                     if (m_buffer.has_nested_buffers()) {
                         std::unique_ptr<osmium::memory::Buffer> buffer_ptr{m_buffer.get_last_nested()};
@@ -216,12 +231,12 @@ namespace osmium {
                     }
                 }
 
-                void maybe_new_buffer(osmium::item_type current_type) {
-                    if (m_buffers_kind == buffers_type::any) {
-                        return;
-                    }
-
-                    if (is_different_type(current_type) && m_buffer.committed() > 0) {
+                /**
+                 * Send the current buffer to the output queue (if it is
+                 * not empty) and start a new one.
+                 */
+                void flush_buffer() {
+                    if (m_buffer.committed() > 0) {
                         osmium::memory::Buffer new_buffer{initial_buffer_size,
                                                           osmium::memory::Buffer::auto_grow::internal};
                         using std::swap;
@@ -230,6 +245,16 @@ namespace osmium {
                     }
                 }
 
+                void maybe_new_buffer(osmium::item_type current_type) {
+                    if (m_buffers_kind == buffers_type::any) {
+                        return;
+                    }
+
+                    if (is_different_type(current_type)) {
+                        flush_buffer();
+                    }
+                }
+
             }; // class ParserWithBuffer
 
             /**
@@ -0,0 +1,717 @@
+#ifndef OSMIUM_IO_DETAIL_IO_URING_HPP
+#define OSMIUM_IO_DETAIL_IO_URING_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+/**
+ * @file
+ *
+ * Optional io_uring backend for reading and writing uncompressed files.
+ *
+ * This is only compiled in on Linux if OSMIUM_WITH_IO_URING is defined
+ * before any Osmium headers are included. It uses the io_uring system
+ * calls directly, no liburing is needed. If the kernel does not support
+ * io_uring (or it is blocked, for instance by a seccomp filter), or if
+ * the file descriptor does not refer to a regular file, the callers fall
+ * back to the normal blocking read(2)/write(2) code path. The backend can
+ * also be switched off at runtime by setting the environment variable
+ * OSMIUM_USE_IO_URING to "off".
+ */
+
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+
+#include <osmium/io/error.hpp>
+#include <osmium/util/config.hpp>
+
+#include <linux/io_uring.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            enum : unsigned {
+                // Number of reads or writes kept in flight at the same time
+                uring_queue_depth = 8U
+            };
+
+            enum : std::size_t {
+                // Max 1 GByte per read or write request
+                uring_max_request_size = 1024UL * 1024UL * 1024UL
+            };
+
+            /**
+             * Minimal wrapper around an io_uring submission and completion
+             * queue pair using the raw system calls.
+             */
+            class IoUring {
+
+                int m_fd = -1;
+
+                void* m_sq_ring = MAP_FAILED;
+                std::size_t m_sq_ring_size = 0;
+                void* m_cq_ring = MAP_FAILED;
+                std::size_t m_cq_ring_size = 0;
+                io_uring_sqe* m_sqes = nullptr;
+                std::size_t m_sqes_size = 0;
+
+                unsigned* m_sq_tail = nullptr;
+                unsigned* m_sq_array = nullptr;
+                unsigned m_sq_mask = 0;
+                unsigned m_sq_local_tail = 0;
+                unsigned m_to_submit = 0;
+
+                unsigned* m_cq_head = nullptr;
+                unsigned* m_cq_tail = nullptr;
+                unsigned m_cq_mask = 0;
+                io_uring_cqe* m_cqes = nullptr;
+
+                template <typename T>
+                T* at(void* base, const uint32_t offset) const noexcept {
+                    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+                }
+
+                int enter(const unsigned to_submit, const unsigned min_complete, const unsigned flags) noexcept {
+                    return static_cast<int>(::syscall(__NR_io_uring_enter, m_fd, to_submit, min_complete, flags, nullptr, 0));
+                }
+
+                bool setup(const unsigned entries) noexcept {
+                    io_uring_params params; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                    std::memset(&params, 0, sizeof(params));
+
+                    m_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+                    if (m_fd < 0) {
+                        return false;
+                    }
+
+                    // Non-vectored reads and writes need Linux 5.6, which
+                    // is also the version introducing this feature flag.
+                    if (!(params.features & IORING_FEAT_RW_CUR_POS)) { // NOLINT(hicpp-signed-bitwise)
+                        return false;
+                    }
+
+                    m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                    m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+                    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP; // NOLINT(hicpp-signed-bitwise)
+                    if (single_mmap) {
+                        m_sq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+                    }
+
+                    m_sq_ring = ::mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQ_RING); // NOLINT(hicpp-signed-bitwise)
+                    if (m_sq_ring == MAP_FAILED) {
+                        return false;
+                    }
+
+                    if (!single_mmap) {
+                        m_cq_ring = ::mmap(nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_CQ_RING); // NOLINT(hicpp-signed-bitwise)
+                        if (m_cq_ring == MAP_FAILED) {
+                            return false;
+                        }
+                    }
+
+                    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+                    void* sqes = ::mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, IORING_OFF_SQES); // NOLINT(hicpp-signed-bitwise)
+                    if (sqes == MAP_FAILED) {
+                        return false;
+                    }
+                    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+                    void* cq_ring = single_mmap ? m_sq_ring : m_cq_ring;
+
+                    m_sq_tail = at<unsigned>(m_sq_ring, params.sq_off.tail);
+                    m_sq_array = at<unsigned>(m_sq_ring, params.sq_off.array);
+                    m_sq_mask = *at<unsigned>(m_sq_ring, params.sq_off.ring_mask);
+                    m_sq_local_tail = *m_sq_tail;
+
+                    m_cq_head = at<unsigned>(cq_ring, params.cq_off.head);
+                    m_cq_tail = at<unsigned>(cq_ring, params.cq_off.tail);
+                    m_cq_mask = *at<unsigned>(cq_ring, params.cq_off.ring_mask);
+                    m_cqes = at<io_uring_cqe>(cq_ring, params.cq_off.cqes);
+
+                    return true;
+                }
+
+                void cleanup() noexcept {
+                    if (m_sqes) {
+                        ::munmap(m_sqes, m_sqes_size);
+                        m_sqes = nullptr;
+                    }
+                    if (m_cq_ring != MAP_FAILED) {
+                        ::munmap(m_cq_ring, m_cq_ring_size);
+                        m_cq_ring = MAP_FAILED;
+                    }
+                    if (m_sq_ring != MAP_FAILED) {
+                        ::munmap(m_sq_ring, m_sq_ring_size);
+                        m_sq_ring = MAP_FAILED;
+                    }
+                    if (m_fd >= 0) {
+                        ::close(m_fd);
+                        m_fd = -1;
+                    }
+                }
+
+            public:
+
+                /**
+                 * Set up an io_uring instance with the given number of
+                 * entries. Check valid() afterwards to find out whether
+                 * this worked.
+                 */
+                explicit IoUring(const unsigned entries) noexcept {
+                    if (!setup(entries)) {
+                        cleanup();
+                    }
+                }
+
+                IoUring(const IoUring&) = delete;
+                IoUring& operator=(const IoUring&) = delete;
+
+                IoUring(IoUring&&) = delete;
+                IoUring& operator=(IoUring&&) = delete;
+
+                ~IoUring() noexcept {
+                    cleanup();
+                }
+
+                bool valid() const noexcept {
+                    return m_fd >= 0;
+                }
+
+                /**
+                 * Get the next free submission queue entry. The caller
+                 * must make sure that there are never more requests in
+                 * flight than the number of entries given in the
+                 * constructor. The entry is cleared and queued for the
+                 * next call to submit().
+                 */
+                io_uring_sqe* get_sqe() noexcept {
+                    const unsigned index = m_sq_local_tail & m_sq_mask;
+                    io_uring_sqe* sqe = &m_sqes[index];
+                    std::memset(sqe, 0, sizeof(io_uring_sqe));
+                    m_sq_array[index] = index;
+                    ++m_sq_local_tail;
+                    ++m_to_submit;
+                    return sqe;
+                }
+
+                /**
+                 * Hand all queued submission queue entries to the kernel.
+                 *
+                 * @throws std::system_error If the kernel reports an error.
+                 */
+                void submit(const unsigned min_complete = 0) {
+                    __atomic_store_n(m_sq_tail, m_sq_local_tail, __ATOMIC_RELEASE);
+                    if (m_to_submit == 0 && min_complete == 0) {
+                        return;
+                    }
+                    const unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0; // NOLINT(hicpp-signed-bitwise)
+                    int ret = 0;
+                    do {
+                        ret = enter(m_to_submit, min_complete, flags);
+                        if (ret < 0 && errno != EINTR) {
+                            throw std::system_error{errno, std::system_category(), "io_uring_enter failed"};
+                        }
+                    } while (ret < 0);
+                    m_to_submit -= std::min(m_to_submit, static_cast<unsigned>(ret));
+                }
+
+                /**
+                 * Wait for the next completion and return its user data
+                 * and result.
+                 *
+                 * @throws std::system_error If the kernel reports an error.
+                 */
+                std::pair<uint64_t, int32_t> wait() {
+                    const unsigned head = *m_cq_head;
+                    while (head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) {
+                        submit(1);
+                    }
+                    const io_uring_cqe& cqe = m_cqes[head & m_cq_mask];
+                    const std::pair<uint64_t, int32_t> result{cqe.user_data, cqe.res};
+                    __atomic_store_n(m_cq_head, head + 1, __ATOMIC_RELEASE);
+                    return result;
+                }
+
+            }; // class IoUring
+
+            /**
+             * Returns the current file offset if the file descriptor
+             * refers to a regular file that can be accessed using
+             * io_uring with explicit offsets, -1 otherwise. Files opened
+             * in append mode can not be used for writing, because the
+             * kernel ignores offsets for them.
+             */
+            inline int64_t uring_usable_offset(const int fd, const bool for_writing) noexcept {
+                if (!osmium::config::use_io_uring()) {
+                    return -1;
+                }
+
+                struct stat s; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
+                if (::fstat(fd, &s) != 0 || !S_ISREG(s.st_mode)) { // NOLINT(hicpp-signed-bitwise)
+                    return -1;
+                }
+
+                if (for_writing) {
+                    const int flags = ::fcntl(fd, F_GETFL);
+                    if (flags < 0 || (flags & O_APPEND)) { // NOLINT(hicpp-signed-bitwise)
+                        return -1;
+                    }
+                }
+
+                return ::lseek(fd, 0, SEEK_CUR);
+            }
+
+            /**
+             * Reads a regular file sequentially in blocks, keeping several
+             * reads in flight to overlap I/O with processing. The blocks
+             * are read directly into the strings returned from read(), so
+             * no data is copied when using read(). read_exactly(), which
+             * the PBF parser needs to read data split at blob boundaries,
+             * copies the data out of the blocks.
+             *
+             * Use make_uring_reader() to create an instance.
+             */
+            class UringFileReader {
+
+                struct request {
+                    std::string data{};
+                    uint64_t offset = 0;
+                    std::size_t filled = 0;
+                    int error = 0;
+                    bool done = false;
+                };
+
+                IoUring m_ring{uring_queue_depth};
+                std::vector<request> m_requests{uring_queue_depth};
+
+                // Data from the last block for read_exactly().
+                std::string m_current{};
+                std::size_t m_current_pos = 0;
+
+                uint64_t m_offset;
+                std::size_t m_block_size;
+                std::size_t m_first = 0;
+                std::size_t m_in_flight = 0;
+                int m_fd;
+                bool m_eof = false;
+
+                void submit_read(const std::size_t slot) {
+                    request& req = m_requests[slot];
+                    const std::size_t len = std::min(req.data.size() - req.filled, static_cast<std::size_t>(uring_max_request_size));
+
+                    io_uring_sqe* sqe = m_ring.get_sqe();
+                    sqe->opcode = IORING_OP_READ;
+                    sqe->fd = m_fd;
+                    sqe->off = req.offset + req.filled;
+                    sqe->addr = reinterpret_cast<uint64_t>(&req.data[req.filled]);
+                    sqe->len = static_cast<uint32_t>(len);
+                    sqe->user_data = slot;
+                }
+
+                void fill() {
+                    while (!m_eof && m_in_flight < m_requests.size()) {
+                        const std::size_t slot = (m_first + m_in_flight) % m_requests.size();
+                        request& req = m_requests[slot];
+                        req.data.resize(m_block_size);
+                        req.offset = m_offset;
+                        req.filled = 0;
+                        req.error = 0;
+                        req.done = false;
+                        m_offset += m_block_size;
+                        ++m_in_flight;
+                        submit_read(slot);
+                    }
+                    m_ring.submit();
+                }
+
+                void reap_one() {
+                    const auto completion = m_ring.wait();
+                    const auto slot = static_cast<std::size_t>(completion.first);
+                    const int32_t res = completion.second;
+                    request& req = m_requests[slot];
+
+                    if (res == -EINTR || res == -EAGAIN) {
+                        submit_read(slot);
+                        m_ring.submit();
+                    } else if (res < 0) {
+                        req.error = -res;
+                        req.done = true;
+                    } else if (res == 0) {
+                        // Reads after the end of the file. Stop creating
+                        // new requests.
+                        m_eof = true;
+                        req.done = true;
+                    } else {
+                        req.filled += static_cast<std::size_t>(res);
+                        if (req.filled < req.data.size()) {
+                            submit_read(slot);
+                            m_ring.submit();
+                        } else {
+                            req.done = true;
+                        }
+                    }
+                }
+
+                bool has_pending() const noexcept {
+                    for (std::size_t n = 0; n < m_in_flight; ++n) {
+                        if (!m_requests[(m_first + n) % m_requests.size()].done) {
+                            return true;
+                        }
+                    }
+                    return false;
+                }
+
+                std::string next_block() {
+                    fill();
+                    if (m_in_flight == 0) {
+                        return {};
+                    }
+
+                    request& req = m_requests[m_first];
+                    while (!req.done) {
+                        reap_one();
+                    }
+
+                    std::string result{std::move(req.data)};
+                    req.data = std::string{};
+                    m_first = (m_first + 1) % m_requests.size();
+                    --m_in_flight;
+
+                    if (req.error) {
+                        throw std::system_error{req.error, std::system_category(), "Read failed"};
+                    }
+
+                    if (req.filled < m_block_size) {
+                        m_eof = true;
+                    }
+                    result.resize(req.filled);
+
+                    fill();
+
+                    return result;
+                }
+
+            public:
+
+                UringFileReader(const int fd, const uint64_t offset, const std::size_t block_size) :
+                    m_offset(offset),
+                    m_block_size(block_size),
+                    m_fd(fd) {
+                }
+
+                UringFileReader(const UringFileReader&) = delete;
+                UringFileReader& operator=(const UringFileReader&) = delete;
+
+                UringFileReader(UringFileReader&&) = delete;
+                UringFileReader& operator=(UringFileReader&&) = delete;
+
+                ~UringFileReader() noexcept {
+                    // The kernel might still be writing into our buffers,
+                    // so we have to wait for all outstanding requests.
+                    try {
+                        while (has_pending()) {
+                            reap_one();
+                        }
+                    } catch (...) {
+                        // If waiting fails, leak the buffers instead of
+                        // freeing memory the kernel might still access.
+                        new std::vector<request>{std::move(m_requests)}; // NOLINT(cppcoreguidelines-owning-memory)
+                    }
+                }
+
+                bool valid() const noexcept {
+                    return m_ring.valid();
+                }
+
+                /**
+                 * Read the next block of data from the file. Returns an
+                 * empty string on EOF.
+                 *
+                 * @throws std::system_error On error.
+                 */
+                std::string read() {
+                    if (m_current_pos < m_current.size()) {
+                        std::string result{m_current.substr(m_current_pos)};
+                        m_current.clear();
+                        m_current_pos = 0;
+                        return result;
+                    }
+                    return next_block();
+                }
+
+                /**
+                 * Read exactly size bytes from the file into buffer. The
+                 * data is copied from the blocks read from the file.
+                 *
+                 * @returns true if size bytes could be read
+                 *          false if EOF was encountered
+                 * @throws std::system_error On error.
+                 */
+                bool read_exactly(char* buffer, std::size_t size) {
+                    while (size > 0) {
+                        if (m_current_pos == m_current.size()) {
+                            m_current = next_block();
+                            m_current_pos = 0;
+                            if (m_current.empty()) {
+                                return false;
+                            }
+                        }
+                        const std::size_t len = std::min(size, m_current.size() - m_current_pos);
+                        std::memcpy(buffer, m_current.data() + m_current_pos, len);
+                        m_current_pos += len;
+                        buffer += len;
+                        size -= len;
+                    }
+                    return true;
+                }
+
+            }; // class UringFileReader
+
+            /**
+             * Writes to a regular file keeping several writes in flight.
+             * Every write goes to an explicit file offset, so the data
+             * ends up in the right order even if the writes complete out
+             * of order. Errors might only be reported on a later call to
+             * write() or on flush().
+             *
+             * Use make_uring_writer() to create an instance.
+             */
+            class UringFileWriter {
+
+                struct request {
+                    std::string data{};
+                    uint64_t offset = 0;
+                    std::size_t written = 0;
+                    bool in_use = false;
+                };
+
+                IoUring m_ring{uring_queue_depth};
+                std::vector<request> m_requests{uring_queue_depth};
+                uint64_t m_offset;
+                std::size_t m_in_flight = 0;
+                int m_fd;
+                int m_error = 0;
+                bool m_no_progress = false;
+
+                void submit_write(const std::size_t slot) {
+                    const request& req = m_requests[slot];
+                    const std::size_t len = std::min(req.data.size() - req.written, static_cast<std::size_t>(uring_max_request_size));
+
+                    io_uring_sqe* sqe = m_ring.get_sqe();
+                    sqe->opcode = IORING_OP_WRITE;
+                    sqe->fd = m_fd;
+                    sqe->off = req.offset + req.written;
+                    sqe->addr = reinterpret_cast<uint64_t>(req.data.data() + req.written);
+                    sqe->len = static_cast<uint32_t>(len);
+                    sqe->user_data = slot;
+                }
+
+                void reap_one() {
+                    const auto completion = m_ring.wait();
+                    const auto slot = static_cast<std::size_t>(completion.first);
+                    const int32_t res = completion.second;
+                    request& req = m_requests[slot];
+
+                    if (res == 0) {
+                        // Nothing written although there was data left,
+                        // retrying would never end.
+                        m_no_progress = true;
+                    } else if (res > 0 || res == -EINTR || res == -EAGAIN) {
+                        if (res > 0) {
+                            req.written += static_cast<std::size_t>(res);
+                        }
+                        if (req.written < req.data.size()) {
+                            submit_write(slot);
+                            m_ring.submit();
+                            return;
+                        }
+                    } else if (m_error == 0) {
+                        m_error = -res;
+                    }
+
+                    req.in_use = false;
+                    --m_in_flight;
+                }
+
+                void check_error() const {
+                    if (m_error) {
+                        throw std::system_error{m_error, std::system_category(), "Write failed"};
+                    }
+                    if (m_no_progress) {
+                        throw osmium::io_error{"Write failed: no data written"};
+                    }
+                }
+
+            public:
+
+                UringFileWriter(const int fd, const uint64_t offset) :
+                    m_offset(offset),
+                    m_fd(fd) {
+                }
+
+                UringFileWriter(const UringFileWriter&) = delete;
+                UringFileWriter& operator=(const UringFileWriter&) = delete;
+
+                UringFileWriter(UringFileWriter&&) = delete;
+                UringFileWriter& operator=(UringFileWriter&&) = delete;
+
+                ~UringFileWriter() noexcept {
+                    // The kernel might still be reading from our buffers,
+                    // so we have to wait for all outstanding requests.
+                    try {
+                        while (m_in_flight > 0) {
+                            reap_one();
+                        }
+                    } catch (...) {
+                        // If waiting fails, leak the buffers instead of
+                        // freeing memory the kernel might still access.
+                        new std::vector<request>{std::move(m_requests)}; // NOLINT(cppcoreguidelines-owning-memory)
+                    }
+                }
+
+                bool valid() const noexcept {
+                    return m_ring.valid();
+                }
+
+                /**
+                 * Queue the data for writing. The data is copied.
+                 *
+                 * @throws std::system_error On error.
+                 * @throws osmium::io_error If a write made no progress.
+                 */
+                void write(const std::string& data) {
+                    check_error();
+                    if (data.empty()) {
+                        return;
+                    }
+
+                    while (m_in_flight == m_requests.size()) {
+                        reap_one();
+                    }
+                    check_error();
+
+                    const auto it = std::find_if(m_requests.begin(), m_requests.end(), [](const request& req) {
+                        return !req.in_use;
+                    });
+                    it->data.assign(data);
+                    it->offset = m_offset;
+                    it->written = 0;
+                    it->in_use = true;
+                    m_offset += data.size();
+                    ++m_in_flight;
+
+                    submit_write(static_cast<std::size_t>(it - m_requests.begin()));
+                    m_ring.submit();
+                }
+
+                /**
+                 * Wait for all outstanding writes to finish and set the
+                 * file offset to the end of the written data.
+                 *
+                 * @throws std::system_error On error.
+                 * @throws osmium::io_error If a write made no progress.
+                 */
+                void flush() {
+                    while (m_in_flight > 0) {
+                        reap_one();
+                    }
+                    check_error();
+                    if (::lseek(m_fd, static_cast<off_t>(m_offset), SEEK_SET) < 0) {
+                        throw std::system_error{errno, std::system_category(), "Seek failed"};
+                    }
+                }
+
+            }; // class UringFileWriter
+
+            /**
+             * Create an io_uring based reader for the file descriptor
+             * reading blocks of the given size. Returns nullptr if
+             * io_uring can not be used, in which case the caller should
+             * fall back to blocking reads.
+             */
+            inline std::unique_ptr<UringFileReader> make_uring_reader(const int fd, const std::size_t block_size) {
+                const int64_t offset = uring_usable_offset(fd, false);
+                if (offset < 0) {
+                    return nullptr;
+                }
+                std::unique_ptr<UringFileReader> reader{new UringFileReader{fd, static_cast<uint64_t>(offset), block_size}};
+                if (!reader->valid()) {
+                    return nullptr;
+                }
+                return reader;
+            }
+
+            /**
+             * Create an io_uring based writer for the file descriptor.
+             * Returns nullptr if io_uring can not be used, in which case
+             * the caller should fall back to blocking writes.
+             */
+            inline std::unique_ptr<UringFileWriter> make_uring_writer(const int fd) {
+                const int64_t offset = uring_usable_offset(fd, true);
+                if (offset < 0) {
+                    return nullptr;
+                }
+                std::unique_ptr<UringFileWriter> writer{new UringFileWriter{fd, static_cast<uint64_t>(offset)}};
+                if (!writer->valid()) {
+                    return nullptr;
+                }
+                return writer;
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_WITH_IO_URING && __linux__
+
+#endif // OSMIUM_IO_DETAIL_IO_URING_HPP
@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/builder/osm_object_builder.hpp>
 #include <osmium/io/detail/input_format.hpp>
+#include <osmium/io/detail/o5m.hpp>
 #include <osmium/io/detail/queue_util.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file_format.hpp>
@@ -51,6 +52,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
 #include <osmium/thread/util.hpp>
+#include <osmium/util/config.hpp>
 #include <osmium/util/delta.hpp>
 
 #include <protozero/exception.hpp>
@@ -74,169 +76,76 @@ namespace osmium {
         class Builder;
     } // namespace builder
 
-    /**
-     * Exception thrown when the o5m deocder failed. The exception contains
-     * (if available) information about the place where the error happened
-     * and the type of error.
-     */
-    struct o5m_error : public io_error {
-
-        explicit o5m_error(const char* what) :
-            io_error(std::string{"o5m format error: "} + what) {
-        }
-
-    }; // struct o5m_error
-
     namespace io {
 
         namespace detail {
 
-            // Implementation of the o5m/o5c file formats according to the
-            // description at https://wiki.openstreetmap.org/wiki/O5m .
-
             class ReferenceTable {
 
-                // The following settings are from the o5m description:
-
-                // The maximum number of entries in this table.
-                enum {
-                    number_of_entries = 15000U
-                };
-
                 // The size of one entry in the table.
                 enum {
                     entry_size = 256U
                 };
 
-                // The maximum length of a string in the table including
-                // two \0 bytes.
-                enum {
-                    max_length = 250U + 2U
-                };
-
-                // The data is stored in this string. It is default constructed
-                // and then resized on demand the first time something is added.
-                // This is done because the ReferenceTable is in a O5mParser
-                // object which will be copied from one thread to another. This
-                // way the string is still small when it is copied.
-                std::string m_table;
+                // The data is stored in this array. It is allocated the
+                // first time something is added and it is not initialized.
+                // This is done because the ReferenceTable is in a O5mDecoder
+                // object which is created for every chunk of data decoded on
+                // the thread pool. This way the memory is only allocated if
+                // it is needed and only the pages actually used by entries
+                // are touched.
+                std::unique_ptr<char[]> m_table;
 
                 unsigned int current_entry = 0;
 
+                // Number of entries added since the last clear(), up to
+                // the number of entries in the table. Only these entries
+                // can be referenced.
+                unsigned int used_entries = 0;
+
             public:
 
-                void clear() {
+                void clear() noexcept {
                     current_entry = 0;
+                    used_entries = 0;
                 }
 
                 void add(const char* string, std::size_t size) {
                     assert(string);
 
-                    if (m_table.empty()) {
-                        m_table.resize(entry_size * number_of_entries);
+                    if (!m_table) {
+                        m_table.reset(new char[entry_size * o5m_string_table_entries]);
                     }
-                    if (size <= max_length) {
+                    if (size <= o5m_max_string_length) {
                         std::copy_n(string, size, &m_table[current_entry * entry_size]);
-                        if (++current_entry == number_of_entries) {
+                        if (++current_entry == o5m_string_table_entries) {
                             current_entry = 0;
                         }
+                        if (used_entries < o5m_string_table_entries) {
+                            ++used_entries;
+                        }
                     }
                 }
 
                 const char* get(uint64_t index) const {
-                    if (m_table.empty() || index == 0 || index > number_of_entries) {
+                    if (index == 0 || index > used_entries) {
                         throw o5m_error{"reference to non-existing string in table"};
                     }
-                    const auto entry = (current_entry + number_of_entries - index) % number_of_entries;
+                    const auto entry = (current_entry + o5m_string_table_entries - index) % o5m_string_table_entries;
                     return &m_table[entry * entry_size];
                 }
 
             }; // class ReferenceTable
 
-            class O5mParser final : public ParserWithBuffer {
-
-                osmium::io::Header m_header{};
-
-                std::string m_input{};
-
-                const char* m_data;
-                const char* m_end;
+            /**
+             * Decodes the node, way, and relation datasets of an o5m file.
+             * This keeps the string reference table and the delta decoders
+             * which are valid from one reset dataset to the next.
+             */
+            class O5mDecoder {
 
                 ReferenceTable m_reference_table;
 
-                static int64_t zvarint(const char** data, const char* end) {
-                    return protozero::decode_zigzag64(protozero::decode_varint(data, end));
-                }
-
-                bool ensure_bytes_available(std::size_t need_bytes) {
-                    if (static_cast<std::size_t>(m_end - m_data) >= need_bytes) {
-                        return true;
-                    }
-
-                    if (input_done() && (m_input.size() < need_bytes)) {
-                        return false;
-                    }
-
-                    m_input.erase(0, m_data - m_input.data());
-
-                    while (m_input.size() < need_bytes) {
-                        const std::string data{get_input()};
-                        if (input_done()) {
-                            return false;
-                        }
-                        m_input.append(data);
-                    }
-
-                    m_data = m_input.data();
-                    m_end = m_input.data() + m_input.size();
-
-                    return true;
-                }
-
-                void check_header_magic() {
-                    static const unsigned char header_magic[] = { 0xff, 0xe0, 0x04, 'o', '5' };
-
-                    if (std::strncmp(reinterpret_cast<const char*>(header_magic), m_data, sizeof(header_magic)) != 0) {
-                        throw o5m_error{"wrong header magic"};
-                    }
-
-                    m_data += sizeof(header_magic);
-                }
-
-                void check_file_type() {
-                    if (*m_data == 'm') {         // o5m data file
-                        m_header.set_has_multiple_object_versions(false);
-                    } else if (*m_data == 'c') {  // o5c change file
-                        m_header.set_has_multiple_object_versions(true);
-                    } else {
-                        throw o5m_error{"wrong header magic"};
-                    }
-
-                    m_data++;
-                }
-
-                void check_file_format_version() {
-                    if (*m_data != '2') {
-                        throw o5m_error{"wrong header magic"};
-                    }
-
-                    m_data++;
-                }
-
-                void decode_header() {
-                    if (! ensure_bytes_available(7)) { // overall length of header
-                        throw o5m_error{"file too short (incomplete header info)"};
-                    }
-
-                    check_header_magic();
-                    check_file_type();
-                    check_file_format_version();
-                }
-
-                void mark_header_as_done() {
-                    set_header_value(m_header);
-                }
-
                 osmium::DeltaDecode<osmium::object_id_type> m_delta_id;
 
                 osmium::DeltaDecode<int64_t> m_delta_timestamp;
@@ -247,19 +156,10 @@ namespace osmium {
                 osmium::DeltaDecode<osmium::object_id_type> m_delta_way_node_id;
                 std::array<osmium::DeltaDecode<osmium::object_id_type>, 3> m_delta_member_ids;
 
-                void reset() {
-                    m_reference_table.clear();
+                object_parts m_read_parts;
 
-                    m_delta_id.clear();
-                    m_delta_timestamp.clear();
-                    m_delta_changeset.clear();
-                    m_delta_lon.clear();
-                    m_delta_lat.clear();
-
-                    m_delta_way_node_id.clear();
-                    m_delta_member_ids[0].clear();
-                    m_delta_member_ids[1].clear();
-                    m_delta_member_ids[2].clear();
+                static int64_t zvarint(const char** data, const char* end) {
+                    return protozero::decode_zigzag64(protozero::decode_varint(data, end));
                 }
 
                 const char* decode_string(const char** dataptr, const char* const end) {
@@ -295,9 +195,13 @@ namespace osmium {
 
                     const char* user = ++data;
 
-                    if (uid == 0 && update_pointer) {
-                        m_reference_table.add("\0\0", 2);
-                        *dataptr = data;
+                    // Anonymous users have no user name, not even the
+                    // null byte at its end.
+                    if (uid == 0) {
+                        if (update_pointer) {
+                            m_reference_table.add("\0\0", 2);
+                            *dataptr = data;
+                        }
                         return {0, ""};
                     }
 
@@ -315,9 +219,11 @@ namespace osmium {
                     return {static_cast<osmium::user_id_type>(uid), user};
                 }
 
-                void decode_tags(osmium::builder::Builder& parent, const char** dataptr, const char* const end) {
-                    osmium::builder::TagListBuilder builder{parent};
-
+                // The strings of the tags have to be decoded even if the
+                // tags are not needed, because they go into the reference
+                // table.
+                template <typename TFunc>
+                void decode_tag_strings(const char** dataptr, const char* const end, TFunc&& func) {
                     while (*dataptr != end) {
                         const bool update_pointer = (**dataptr == 0x00);
                         const char* data = decode_string(dataptr, end);
@@ -345,10 +251,22 @@ namespace osmium {
                             *dataptr = data;
                         }
 
-                        builder.add_tag(start, value);
+                        std::forward<TFunc>(func)(start, value);
                     }
                 }
 
+                void decode_tags(osmium::builder::Builder& parent, const char** dataptr, const char* const end) {
+                    if (!m_read_parts.tags) {
+                        decode_tag_strings(dataptr, end, [](const char* /*key*/, const char* /*value*/) {});
+                        return;
+                    }
+
+                    osmium::builder::TagListBuilder builder{parent};
+                    decode_tag_strings(dataptr, end, [&builder](const char* key, const char* value) {
+                        builder.add_tag(key, value);
+                    });
+                }
+
                 const char* decode_info(osmium::OSMObject& object, const char** dataptr, const char* const end) {
                     const char* user = "";
 
@@ -382,8 +300,8 @@ namespace osmium {
                     return user;
                 }
 
-                void decode_node(const char* data, const char* const end) {
-                    osmium::builder::NodeBuilder builder{buffer()};
+                void decode_node(osmium::memory::Buffer& buffer, const char* data, const char* const end) {
+                    osmium::builder::NodeBuilder builder{buffer};
 
                     builder.set_id(m_delta_id.update(zvarint(&data, end)));
 
@@ -404,8 +322,8 @@ namespace osmium {
                     }
                 }
 
-                void decode_way(const char* data, const char* const end) {
-                    osmium::builder::WayBuilder builder{buffer()};
+                void decode_way(osmium::memory::Buffer& buffer, const char* data, const char* const end) {
+                    osmium::builder::WayBuilder builder{buffer};
 
                     builder.set_id(m_delta_id.update(zvarint(&data, end)));
 
@@ -422,10 +340,17 @@ namespace osmium {
                                 throw o5m_error{"way nodes ref section too long"};
                             }
 
-                            osmium::builder::WayNodeListBuilder wn_builder{builder};
+                            if (m_read_parts.way_nodes) {
+                                osmium::builder::WayNodeListBuilder wn_builder{builder};
 
-                            while (data < end_refs) {
-                                wn_builder.add_node_ref(m_delta_way_node_id.update(zvarint(&data, end)));
+                                while (data < end_refs) {
+                                    wn_builder.add_node_ref(m_delta_way_node_id.update(zvarint(&data, end)));
+                                }
+                            } else {
+                                // The delta decoder must see all IDs.
+                                while (data < end_refs) {
+                                    m_delta_way_node_id.update(zvarint(&data, end));
+                                }
                             }
                         }
 
@@ -469,8 +394,8 @@ namespace osmium {
                     return {member_type, role};
                 }
 
-                void decode_relation(const char* data, const char* const end) {
-                    osmium::builder::RelationBuilder builder{buffer()};
+                void decode_relation(osmium::memory::Buffer& buffer, const char* data, const char* const end) {
+                    osmium::builder::RelationBuilder builder{buffer};
 
                     builder.set_id(m_delta_id.update(zvarint(&data, end)));
 
@@ -497,7 +422,7 @@ namespace osmium {
                                 const auto type_role = decode_role(&data, end);
                                 const auto i = osmium::item_type_to_nwr_index(type_role.first);
                                 const auto ref = m_delta_member_ids[i].update(delta_id);
-                                rml_builder.add_member(type_role.first, ref, type_role.second);
+                                rml_builder.add_member(type_role.first, ref, m_read_parts.member_roles ? type_role.second : "");
                             }
                         }
 
@@ -507,6 +432,223 @@ namespace osmium {
                     }
                 }
 
+            public:
+
+                explicit O5mDecoder(const object_parts& read_parts = object_parts{}) :
+                    m_read_parts(read_parts) {
+                }
+
+                void reset() {
+                    m_reference_table.clear();
+
+                    m_delta_id.clear();
+                    m_delta_timestamp.clear();
+                    m_delta_changeset.clear();
+                    m_delta_lon.clear();
+                    m_delta_lat.clear();
+
+                    m_delta_way_node_id.clear();
+                    m_delta_member_ids[0].clear();
+                    m_delta_member_ids[1].clear();
+                    m_delta_member_ids[2].clear();
+                }
+
+                /**
+                 * Decode a node, way, or relation dataset from the data
+                 * between data and end into the buffer. The object is
+                 * not committed.
+                 */
+                void decode_object(osmium::memory::Buffer& buffer, o5m_dataset_type ds_type, const char* data, const char* const end) {
+                    switch (ds_type) {
+                        case o5m_dataset_type::node:
+                            decode_node(buffer, data, end);
+                            break;
+                        case o5m_dataset_type::way:
+                            decode_way(buffer, data, end);
+                            break;
+                        case o5m_dataset_type::relation:
+                            decode_relation(buffer, data, end);
+                            break;
+                        default:
+                            assert(false && "not an object dataset");
+                            break;
+                    }
+                }
+
+            }; // class O5mDecoder
+
+            // Returns the type of the OSM object in an o5m dataset or
+            // item_type::undefined if it is not an object dataset.
+            inline osmium::item_type o5m_object_type(const o5m_dataset_type ds_type) noexcept {
+                switch (ds_type) {
+                    case o5m_dataset_type::node:
+                        return osmium::item_type::node;
+                    case o5m_dataset_type::way:
+                        return osmium::item_type::way;
+                    case o5m_dataset_type::relation:
+                        return osmium::item_type::relation;
+                    default:
+                        break;
+                }
+                return osmium::item_type::undefined;
+            }
+
+            /**
+             * Decodes a chunk of o5m data into a buffer. The chunk must
+             * only contain complete datasets and must start at a reset
+             * dataset (or at the beginning of the data after the header),
+             * so it can be decoded independently of all other chunks.
+             * Objects of this class are submitted to the thread pool.
+             */
+            class O5mChunkParser {
+
+                std::shared_ptr<std::string> m_input;
+                osmium::osm_entity_bits::type m_read_types;
+                object_parts m_read_parts;
+
+            public:
+
+                O5mChunkParser(std::string&& input, const osmium::osm_entity_bits::type read_types, const object_parts& read_parts = object_parts{}) :
+                    m_input(std::make_shared<std::string>(std::move(input))),
+                    m_read_types(read_types),
+                    m_read_parts(read_parts) {
+                }
+
+                osmium::memory::Buffer operator()() {
+                    // o5m is a compact format, objects in the buffer need
+                    // a few times more space than in the input
+                    osmium::memory::Buffer buffer{m_input->size() * 4, osmium::memory::Buffer::auto_grow::yes};
+                    O5mDecoder decoder{m_read_parts};
+
+                    const char* data = m_input->data();
+                    const char* const end = data + m_input->size();
+                    while (data != end) {
+                        const auto ds_type = static_cast<o5m_dataset_type>(*data++);
+                        if (ds_type > o5m_dataset_type::jump) {
+                            if (ds_type == o5m_dataset_type::reset) {
+                                decoder.reset();
+                            }
+                            continue;
+                        }
+
+                        // The length was checked when the chunk was cut.
+                        const auto length = protozero::decode_varint(&data, end);
+                        const auto type = o5m_object_type(ds_type);
+                        if (type != osmium::item_type::undefined &&
+                            (m_read_types & osmium::osm_entity_bits::from_item_type(type))) {
+                            decoder.decode_object(buffer, ds_type, data, data + length);
+                            buffer.commit();
+                        }
+                        data += length;
+                    }
+
+                    return buffer;
+                }
+
+            }; // class O5mChunkParser
+
+            class O5mParser final : public ParserWithBuffer {
+
+                enum {
+                    chunk_size = 1024UL * 1024UL
+                };
+
+                // Data between two reset datasets is decoded in one piece.
+                // If there is more than this without a reset, it is decoded
+                // in the parser thread instead of on the thread pool.
+                enum {
+                    max_segment_size = 4UL * chunk_size
+                };
+
+                osmium::io::Header m_header{};
+
+                std::string m_input{};
+
+                const char* m_data;
+                const char* m_end;
+
+                O5mDecoder m_decoder;
+
+                // These are only used when decoding on the thread pool. They
+                // are offsets into m_input of the next dataset, the start of
+                // the data not yet sent to the pool, and the last reset.
+                std::size_t m_pos = 0;
+                std::size_t m_chunk_begin = 0;
+                std::size_t m_segment_begin = 0;
+
+                static int64_t zvarint(const char** data, const char* end) {
+                    return protozero::decode_zigzag64(protozero::decode_varint(data, end));
+                }
+
+                bool ensure_bytes_available(std::size_t need_bytes) {
+                    if (static_cast<std::size_t>(m_end - m_data) >= need_bytes) {
+                        return true;
+                    }
+
+                    if (input_done() && (m_input.size() < need_bytes)) {
+                        return false;
+                    }
+
+                    m_input.erase(0, m_data - m_input.data());
+
+                    while (m_input.size() < need_bytes) {
+                        const std::string data{get_input()};
+                        if (input_done()) {
+                            return false;
+                        }
+                        m_input.append(data);
+                    }
+
+                    m_data = m_input.data();
+                    m_end = m_input.data() + m_input.size();
+
+                    return true;
+                }
+
+                void check_header_magic() {
+                    static const unsigned char header_magic[] = { 0xff, 0xe0, 0x04, 'o', '5' };
+
+                    if (std::strncmp(reinterpret_cast<const char*>(header_magic), m_data, sizeof(header_magic)) != 0) {
+                        throw o5m_error{"wrong header magic"};
+                    }
+
+                    m_data += sizeof(header_magic);
+                }
+
+                void check_file_type() {
+                    if (*m_data == 'm') {         // o5m data file
+                        m_header.set_has_multiple_object_versions(false);
+                    } else if (*m_data == 'c') {  // o5c change file
+                        m_header.set_has_multiple_object_versions(true);
+                    } else {
+                        throw o5m_error{"wrong header magic"};
+                    }
+
+                    m_data++;
+                }
+
+                void check_file_format_version() {
+                    if (*m_data != '2') {
+                        throw o5m_error{"wrong header magic"};
+                    }
+
+                    m_data++;
+                }
+
+                void decode_header() {
+                    if (! ensure_bytes_available(7)) { // overall length of header
+                        throw o5m_error{"file too short (incomplete header info)"};
+                    }
+
+                    check_header_magic();
+                    check_file_type();
+                    check_file_format_version();
+                }
+
+                void mark_header_as_done() {
+                    set_header_value(m_header);
+                }
+
                 void decode_bbox(const char* data, const char* const end) {
                     const auto sw_lon = zvarint(&data, end);
                     const auto sw_lat = zvarint(&data, end);
@@ -523,24 +665,12 @@ namespace osmium {
                     m_header.set("timestamp", timestamp);
                 }
 
-                enum class dataset_type : unsigned char {
-                    node         = 0x10,
-                    way          = 0x11,
-                    relation     = 0x12,
-                    bounding_box = 0xdb,
-                    timestamp    = 0xdc,
-                    header       = 0xe0,
-                    sync         = 0xee,
-                    jump         = 0xef,
-                    reset        = 0xff
-                };
-
                 void decode_data() {
                     while (ensure_bytes_available(1)) {
-                        const auto ds_type = static_cast<dataset_type>(*m_data++);
-                        if (ds_type > dataset_type::jump) {
-                            if (ds_type == dataset_type::reset) {
-                                reset();
+                        const auto ds_type = static_cast<o5m_dataset_type>(*m_data++);
+                        if (ds_type > o5m_dataset_type::jump) {
+                            if (ds_type == o5m_dataset_type::reset) {
+                                m_decoder.reset();
                             }
                         } else {
                             ensure_bytes_available(protozero::max_varint_length);
@@ -557,34 +687,34 @@ namespace osmium {
                             }
 
                             switch (ds_type) {
-                                case dataset_type::node:
+                                case o5m_dataset_type::node:
                                     mark_header_as_done();
                                     if (read_types() & osmium::osm_entity_bits::node) {
                                         maybe_new_buffer(osmium::item_type::node);
-                                        decode_node(m_data, m_data + length);
+                                        m_decoder.decode_object(buffer(), ds_type, m_data, m_data + length);
                                         buffer().commit();
                                     }
                                     break;
-                                case dataset_type::way:
+                                case o5m_dataset_type::way:
                                     mark_header_as_done();
                                     if (read_types() & osmium::osm_entity_bits::way) {
                                         maybe_new_buffer(osmium::item_type::way);
-                                        decode_way(m_data, m_data + length);
+                                        m_decoder.decode_object(buffer(), ds_type, m_data, m_data + length);
                                         buffer().commit();
                                     }
                                     break;
-                                case dataset_type::relation:
+                                case o5m_dataset_type::relation:
                                     mark_header_as_done();
                                     if (read_types() & osmium::osm_entity_bits::relation) {
                                         maybe_new_buffer(osmium::item_type::relation);
-                                        decode_relation(m_data, m_data + length);
+                                        m_decoder.decode_object(buffer(), ds_type, m_data, m_data + length);
                                         buffer().commit();
                                     }
                                     break;
-                                case dataset_type::bounding_box:
+                                case o5m_dataset_type::bounding_box:
                                     decode_bbox(m_data, m_data + length);
                                     break;
-                                case dataset_type::timestamp:
+                                case o5m_dataset_type::timestamp:
                                     decode_timestamp(m_data, m_data + length);
                                     break;
                                 default:
@@ -606,12 +736,160 @@ namespace osmium {
                     flush_final_buffer();
                 }
 
+                // Make sure at least need_bytes bytes are available in
+                // m_input after m_pos. Data before m_chunk_begin is not
+                // needed any more and removed if more input is read.
+                bool fill_input(std::size_t need_bytes) {
+                    if (m_input.size() - m_pos >= need_bytes) {
+                        return true;
+                    }
+
+                    m_input.erase(0, m_chunk_begin);
+                    m_pos -= m_chunk_begin;
+                    m_segment_begin -= m_chunk_begin;
+                    m_chunk_begin = 0;
+
+                    while (m_input.size() - m_pos < need_bytes) {
+                        const std::string data{get_input()};
+                        if (input_done()) {
+                            return false;
+                        }
+                        m_input.append(data);
+                    }
+
+                    return true;
+                }
+
+                void send_chunk(const std::size_t end) {
+                    if (end > m_chunk_begin) {
+                        send_to_output_queue(get_pool().submit(O5mChunkParser{m_input.substr(m_chunk_begin, end - m_chunk_begin), read_types(), read_parts()}));
+                        m_chunk_begin = end;
+                    }
+                }
+
+                // Cut the input at reset datasets into chunks and decode
+                // them on the thread pool. The chunks are sent to the output
+                // queue in order. Segments between two resets that are too
+                // large to be put into one chunk, or that contain objects
+                // of different types when buffers_type::single is requested,
+                // are decoded in this thread.
+                void run_in_chunks() {
+                    const bool split_by_type = buffers_kind() != osmium::io::buffers_type::any;
+
+                    bool serial = false; // decoding current segment in this thread
+                    bool segment_has_objects = false;
+                    osmium::item_type last_type = osmium::item_type::undefined;
+
+                    m_input.erase(0, m_data - m_input.data());
+
+                    while (fill_input(1)) {
+                        const auto ds_type = static_cast<o5m_dataset_type>(m_input[m_pos]);
+                        if (ds_type > o5m_dataset_type::jump) {
+                            if (ds_type == o5m_dataset_type::reset) {
+                                if (serial) {
+                                    flush_buffer();
+                                    serial = false;
+                                    m_chunk_begin = m_pos;
+                                } else if (m_pos - m_chunk_begin >= chunk_size) {
+                                    send_chunk(m_pos);
+                                }
+                                m_segment_begin = m_pos;
+                                segment_has_objects = false;
+                            }
+                            ++m_pos;
+                            if (serial) {
+                                m_chunk_begin = m_pos;
+                            }
+                            continue;
+                        }
+
+                        fill_input(1 + protozero::max_varint_length);
+
+                        const char* data = m_input.data() + m_pos + 1;
+                        uint64_t length = 0;
+                        try {
+                            length = protozero::decode_varint(&data, m_input.data() + m_input.size());
+                        } catch (const protozero::end_of_buffer_exception&) {
+                            throw o5m_error{"premature end of file"};
+                        }
+
+                        const std::size_t header_size = data - (m_input.data() + m_pos);
+                        if (length > std::numeric_limits<std::size_t>::max() - header_size ||
+                            !fill_input(header_size + length)) {
+                            throw o5m_error{"premature end of file"};
+                        }
+
+                        data = m_input.data() + m_pos + header_size;
+                        const std::size_t next_pos = m_pos + header_size + length;
+
+                        const auto type = o5m_object_type(ds_type);
+                        if (type != osmium::item_type::undefined) {
+                            mark_header_as_done();
+                            if (read_types() == osmium::osm_entity_bits::nothing) {
+                                break;
+                            }
+                            if (read_types() & osmium::osm_entity_bits::from_item_type(type)) {
+                                if (serial) {
+                                    maybe_new_buffer(type);
+                                    m_decoder.decode_object(buffer(), ds_type, data, data + length);
+                                    buffer().commit();
+                                    flush_nested_buffer();
+                                } else {
+                                    bool switch_to_serial = next_pos - m_segment_begin > max_segment_size;
+                                    if (split_by_type && last_type != osmium::item_type::undefined && type != last_type) {
+                                        if (segment_has_objects) {
+                                            switch_to_serial = true;
+                                        } else {
+                                            send_chunk(m_segment_begin);
+                                        }
+                                    }
+                                    if (switch_to_serial) {
+                                        // Send everything up to the last
+                                        // reset to the pool and decode the
+                                        // current segment again from there.
+                                        send_chunk(m_segment_begin);
+                                        serial = true;
+                                        m_decoder.reset();
+                                        m_pos = m_segment_begin;
+                                        if (static_cast<o5m_dataset_type>(m_input[m_pos]) == o5m_dataset_type::reset) {
+                                            ++m_pos;
+                                        }
+                                        m_chunk_begin = m_pos;
+                                        continue;
+                                    }
+                                    segment_has_objects = true;
+                                }
+                                last_type = type;
+                            }
+                        } else if (!header_is_done()) {
+                            if (ds_type == o5m_dataset_type::bounding_box) {
+                                decode_bbox(data, data + length);
+                            } else if (ds_type == o5m_dataset_type::timestamp) {
+                                decode_timestamp(data, data + length);
+                            }
+                        }
+
+                        m_pos = next_pos;
+                        if (serial) {
+                            m_chunk_begin = m_pos;
+                        }
+                    }
+
+                    if (!serial && read_types() != osmium::osm_entity_bits::nothing) {
+                        send_chunk(m_pos);
+                    }
+
+                    mark_header_as_done();
+                    flush_final_buffer();
+                }
+
             public:
 
                 explicit O5mParser(parser_arguments& args) :
                     ParserWithBuffer(args),
                     m_data(m_input.data()),
-                    m_end(m_data) {
+                    m_end(m_data),
+                    m_decoder(read_parts()) {
                 }
 
                 O5mParser(const O5mParser&) = delete;
@@ -626,6 +904,12 @@ namespace osmium {
                     osmium::thread::set_thread_name("_osmium_o5m_in");
 
                     decode_header();
+
+                    if (osmium::config::use_pool_threads_for_o5m_parsing()) {
+                        run_in_chunks();
+                        return;
+                    }
+
                     decode_data();
                 }
 
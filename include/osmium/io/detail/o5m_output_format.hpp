@@ -0,0 +1,396 @@
+#ifndef OSMIUM_IO_DETAIL_O5M_OUTPUT_FORMAT_HPP
+#define OSMIUM_IO_DETAIL_O5M_OUTPUT_FORMAT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/detail/o5m.hpp>
+#include <osmium/io/detail/output_format.hpp>
+#include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/changeset.hpp>
+#include <osmium/osm/item_type.hpp>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/metadata_options.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/object.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/tag.hpp>
+#include <osmium/osm/timestamp.hpp>
+#include <osmium/osm/types.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/delta.hpp>
+#include <osmium/visitor.hpp>
+
+#include <protozero/varint.hpp>
+
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            struct o5m_output_options {
+
+                /**
+                 * Which metadata of objects should be added? The o5m format
+                 * can only store metadata for objects with a version, so if
+                 * the version is not added, no metadata is added at all.
+                 */
+                osmium::metadata_options add_metadata;
+
+                /**
+                 * Write an o5c change file instead of an o5m data file?
+                 * Set from the file option "o5c_change_format". It is
+                 * always set for files with multiple object versions,
+                 * like files with the suffix ".o5c".
+                 */
+                bool change_format = false;
+
+            }; // struct o5m_output_options
+
+            /**
+             * Writes out one buffer with OSM data in o5m format.
+             *
+             * Every block starts with a reset dataset, so the string
+             * reference table and the delta encoding start from scratch
+             * and the blocks can be encoded independently of each other
+             * on the thread pool. This also allows readers to decode the
+             * blocks in parallel.
+             *
+             * The o5m format can't store changesets, they are ignored.
+             * Visible nodes with an undefined location are written without
+             * location (and without tags, which o5m doesn't allow in that
+             * case). Readers will see them as deleted nodes.
+             */
+            class O5mOutputBlock : public OutputBlock {
+
+                o5m_output_options m_options;
+
+                // Strings (and string pairs) in the reference table of the
+                // reader mapped to the number of strings added to the table
+                // before them.
+                std::unordered_map<std::string, uint64_t> m_strings;
+                uint64_t m_string_count = 0;
+
+                // Data of the current dataset, the length must be written
+                // before the data, so it is assembled here first.
+                std::string m_data;
+
+                // Reference section of ways and relations.
+                std::string m_refs;
+
+                // Used to assemble strings.
+                std::string m_string;
+
+                osmium::DeltaEncode<osmium::object_id_type> m_delta_id;
+
+                osmium::DeltaEncode<int64_t> m_delta_timestamp;
+                osmium::DeltaEncode<osmium::changeset_id_type> m_delta_changeset;
+                osmium::DeltaEncode<int64_t> m_delta_lon;
+                osmium::DeltaEncode<int64_t> m_delta_lat;
+
+                osmium::DeltaEncode<osmium::object_id_type> m_delta_way_node_id;
+                std::array<osmium::DeltaEncode<osmium::object_id_type>, 3> m_delta_member_ids;
+
+                static void write_varint(std::string& out, uint64_t value) {
+                    protozero::write_varint(std::back_inserter(out), value);
+                }
+
+                static void write_zvarint(std::string& out, int64_t value) {
+                    write_varint(out, protozero::encode_zigzag64(value));
+                }
+
+                // Write the string in m_string either as reference into the
+                // string table or inline.
+                void write_string(std::string& out) {
+                    const auto it = m_strings.find(m_string);
+                    if (it != m_strings.end() && m_string_count - it->second <= o5m_string_table_entries) {
+                        write_varint(out, m_string_count - it->second);
+                        return;
+                    }
+
+                    out += '\0';
+                    out += m_string;
+
+                    if (m_string.size() <= o5m_max_string_length) {
+                        m_strings[m_string] = m_string_count++;
+                    }
+                }
+
+                void write_user(osmium::user_id_type uid, const char* user) {
+                    // Anonymous users (uid 0) are always written inline
+                    // without a user name. Some readers don't handle
+                    // references to them correctly. The reader will still
+                    // add them to its string table.
+                    if (uid == 0) {
+                        m_data.append(3, '\0');
+                        ++m_string_count;
+                        return;
+                    }
+
+                    m_string.clear();
+                    write_varint(m_string, uid);
+                    m_string += '\0';
+                    m_string += user;
+                    m_string += '\0';
+                    write_string(m_data);
+                }
+
+                void write_info(const osmium::OSMObject& object) {
+                    const auto& add = m_options.add_metadata;
+
+                    if (!add.version() || object.version() == 0) {
+                        m_data += '\0';
+                        return;
+                    }
+
+                    write_varint(m_data, object.version());
+
+                    const int64_t timestamp = add.timestamp() ? uint32_t(object.timestamp()) : 0;
+                    write_zvarint(m_data, m_delta_timestamp.update(timestamp));
+                    if (timestamp != 0) {
+                        write_zvarint(m_data, m_delta_changeset.update(add.changeset() ? object.changeset() : 0));
+                        if (add.uid()) {
+                            write_user(object.uid(), add.user() ? object.user() : "");
+                        } else {
+                            write_user(0, "");
+                        }
+                    }
+                }
+
+                void write_tags(const osmium::TagList& tags) {
+                    for (const auto& tag : tags) {
+                        m_string.assign(tag.key());
+                        m_string += '\0';
+                        m_string += tag.value();
+                        m_string += '\0';
+                        write_string(m_data);
+                    }
+                }
+
+                void write_refs() {
+                    write_varint(m_data, m_refs.size());
+                    m_data += m_refs;
+                }
+
+                void write_dataset(o5m_dataset_type ds_type) {
+                    *m_out += static_cast<char>(ds_type);
+                    write_varint(*m_out, m_data.size());
+                    *m_out += m_data;
+                }
+
+                void write_object_start(const osmium::OSMObject& object) {
+                    m_data.clear();
+                    write_zvarint(m_data, m_delta_id.update(object.id()));
+                    write_info(object);
+                }
+
+            public:
+
+                O5mOutputBlock(osmium::memory::Buffer&& buffer, const o5m_output_options& options) :
+                    OutputBlock(std::move(buffer)),
+                    m_options(options) {
+                }
+
+                std::string operator()() {
+                    *m_out += static_cast<char>(o5m_dataset_type::reset);
+
+                    osmium::apply(m_input_buffer->cbegin(), m_input_buffer->cend(), *this);
+
+                    std::string out;
+                    using std::swap;
+                    swap(out, *m_out);
+
+                    return out;
+                }
+
+                void node(const osmium::Node& node) {
+                    write_object_start(node);
+
+                    // Deleted nodes and nodes without location are written
+                    // without location and tags.
+                    if (node.visible() && node.location().is_defined()) {
+                        write_zvarint(m_data, m_delta_lon.update(node.location().x()));
+                        write_zvarint(m_data, m_delta_lat.update(node.location().y()));
+                        write_tags(node.tags());
+                    }
+
+                    write_dataset(o5m_dataset_type::node);
+                }
+
+                void way(const osmium::Way& way) {
+                    write_object_start(way);
+
+                    // Deleted ways are written without references and tags.
+                    if (way.visible()) {
+                        m_refs.clear();
+                        for (const auto& node_ref : way.nodes()) {
+                            write_zvarint(m_refs, m_delta_way_node_id.update(node_ref.ref()));
+                        }
+                        write_refs();
+                        write_tags(way.tags());
+                    }
+
+                    write_dataset(o5m_dataset_type::way);
+                }
+
+                void relation(const osmium::Relation& relation) {
+                    write_object_start(relation);
+
+                    // Deleted relations are written without references and
+                    // tags.
+                    if (relation.visible()) {
+                        m_refs.clear();
+                        for (const auto& member : relation.members()) {
+                            const auto index = osmium::item_type_to_nwr_index(member.type());
+                            write_zvarint(m_refs, m_delta_member_ids[index].update(member.ref()));
+                            m_string.assign(1, static_cast<char>('0' + index));
+                            m_string += member.role();
+                            m_string += '\0';
+                            write_string(m_refs);
+                        }
+                        write_refs();
+                        write_tags(relation.tags());
+                    }
+
+                    write_dataset(o5m_dataset_type::relation);
+                }
+
+                void changeset(const osmium::Changeset& /*changeset*/) noexcept {
+                    // Changesets can't be stored in o5m files.
+                }
+
+            }; // class O5mOutputBlock
+
+            class O5mOutputFormat : public osmium::io::detail::OutputFormat {
+
+                o5m_output_options m_options;
+
+                static void write_varint(std::string& out, uint64_t value) {
+                    protozero::write_varint(std::back_inserter(out), value);
+                }
+
+                static void write_zvarint(std::string& out, int64_t value) {
+                    write_varint(out, protozero::encode_zigzag64(value));
+                }
+
+                static void write_dataset(std::string& out, o5m_dataset_type ds_type, const std::string& data) {
+                    out += static_cast<char>(ds_type);
+                    write_varint(out, data.size());
+                    out += data;
+                }
+
+            public:
+
+                O5mOutputFormat(osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) :
+                    OutputFormat(pool, output_queue) {
+                    m_options.add_metadata  = osmium::metadata_options{file.get("add_metadata")};
+                    m_options.change_format = file.has_multiple_object_versions() || file.is_true("o5c_change_format");
+                }
+
+                O5mOutputFormat(const O5mOutputFormat&) = delete;
+                O5mOutputFormat& operator=(const O5mOutputFormat&) = delete;
+
+                O5mOutputFormat(O5mOutputFormat&&) = delete;
+                O5mOutputFormat& operator=(O5mOutputFormat&&) = delete;
+
+                ~O5mOutputFormat() noexcept override = default;
+
+                void write_header(const osmium::io::Header& header) final {
+                    std::string out;
+
+                    out += static_cast<char>(o5m_dataset_type::reset);
+                    write_dataset(out, o5m_dataset_type::header, m_options.change_format ? "o5c2" : "o5m2");
+
+                    const osmium::Box box = header.joined_boxes();
+                    if (box.valid()) {
+                        std::string data;
+                        write_zvarint(data, box.bottom_left().x());
+                        write_zvarint(data, box.bottom_left().y());
+                        write_zvarint(data, box.top_right().x());
+                        write_zvarint(data, box.top_right().y());
+                        write_dataset(out, o5m_dataset_type::bounding_box, data);
+                    }
+
+                    const std::string timestamp{header.get("o5m_timestamp", header.get("timestamp"))};
+                    if (!timestamp.empty()) {
+                        std::string data;
+                        write_zvarint(data, uint32_t(osmium::Timestamp{timestamp.c_str()}));
+                        write_dataset(out, o5m_dataset_type::timestamp, data);
+                    }
+
+                    send_to_output_queue(std::move(out));
+                }
+
+                void write_buffer(osmium::memory::Buffer&& buffer) final {
+                    m_output_queue.push(m_pool.submit(O5mOutputBlock{std::move(buffer), m_options}));
+                }
+
+                void write_end() final {
+                    send_to_output_queue(std::string(1, static_cast<char>(o5m_dataset_type::end_of_file)));
+                }
+
+            }; // class O5mOutputFormat
+
+            // we want the register_output_format() function to run, setting
+            // the variable is only a side-effect, it will never be used
+            const bool registered_o5m_output = osmium::io::detail::OutputFormatFactory::instance().register_output_format(osmium::io::file_format::o5m,
+                [](osmium::thread::Pool& pool, const osmium::io::File& file, future_string_queue_type& output_queue) {
+                    return new osmium::io::detail::O5mOutputFormat(pool, file, output_queue);
+            });
+
+            // dummy function to silence the unused variable warning from above
+            inline bool get_registered_o5m_output() noexcept {
+                return registered_o5m_output;
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_O5M_OUTPUT_FORMAT_HPP
@@ -38,8 +38,13 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/item_type.hpp>
 #include <osmium/thread/util.hpp>
+#include <osmium/util/config.hpp>
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -98,8 +103,80 @@ namespace osmium {
                 }
             }
 
+            // Returns the type of the OSM object in an OPL line starting
+            // with the character c. This is used to decide when to start
+            // a new buffer, so changesets are lumped together with ways.
+            inline osmium::item_type opl_line_type(const char c) noexcept {
+                switch (c) {
+                    case 'n':
+                        return osmium::item_type::node;
+                    case 'w':
+                        return osmium::item_type::way;
+                    case 'r':
+                        return osmium::item_type::relation;
+                    case 'c':
+                        return osmium::item_type::way;
+                    default:
+                        break;
+                }
+                return osmium::item_type::undefined;
+            }
+
+            inline bool is_opl_line_end(const char c) noexcept {
+                return c == '\n' || c == '\r';
+            }
+
+            /**
+             * Parses a chunk of OPL data containing only complete lines
+             * (except maybe at the very end of the input) into a buffer.
+             * Objects of this class are submitted to the thread pool.
+             */
+            class OPLChunkParser {
+
+                std::shared_ptr<std::string> m_input;
+                uint64_t m_first_line;
+                osmium::osm_entity_bits::type m_read_types;
+                object_parts m_read_parts;
+
+            public:
+
+                OPLChunkParser(std::string&& input, const uint64_t first_line, const osmium::osm_entity_bits::type read_types, const object_parts& read_parts = object_parts{}) :
+                    m_input(std::make_shared<std::string>(std::move(input))),
+                    m_first_line(first_line),
+                    m_read_types(read_types),
+                    m_read_parts(read_parts) {
+                }
+
+                osmium::memory::Buffer operator()() {
+                    std::string& input = *m_input;
+                    osmium::memory::Buffer buffer{input.size(), osmium::memory::Buffer::auto_grow::yes};
+
+                    uint64_t line_count = m_first_line;
+                    char* data = &input[0];
+                    char* const end = data + input.size();
+                    while (data < end) {
+                        char* eol = std::find_if(data, end, is_opl_line_end);
+                        if (eol != end) {
+                            *eol = '\0';
+                        }
+                        if (*data != '\0') {
+                            opl_parse_line(line_count, data, buffer, m_read_types, m_read_parts);
+                            ++line_count;
+                        }
+                        data = eol + 1;
+                    }
+
+                    return buffer;
+                }
+
+            }; // class OPLChunkParser
+
             class OPLParser final : public ParserWithBuffer {
 
+                enum {
+                    chunk_size = 1024UL * 1024UL
+                };
+
                 uint64_t m_line_count = 0;
 
             public:
@@ -118,30 +195,92 @@ namespace osmium {
                 ~OPLParser() noexcept override = default;
 
                 void parse_line(const char* data) {
-                    switch (*data) {
-                        case 'n':
-                            maybe_new_buffer(osmium::item_type::node);
-                            break;
-                        case 'w':
-                            maybe_new_buffer(osmium::item_type::way);
-                            break;
-                        case 'r':
-                            maybe_new_buffer(osmium::item_type::relation);
-                            break;
-                        case 'c':
-                            maybe_new_buffer(osmium::item_type::way);
-                            break;
+                    const auto type = opl_line_type(*data);
+                    if (type != osmium::item_type::undefined) {
+                        maybe_new_buffer(type);
                     }
 
-                    if (opl_parse_line(m_line_count, data, buffer(), read_types())) {
+                    if (opl_parse_line(m_line_count, data, buffer(), read_types(), read_parts())) {
                         flush_nested_buffer();
                     }
                     ++m_line_count;
                 }
 
+                void send_chunk(const std::string& data, const std::size_t begin, const std::size_t end, const uint64_t lines) {
+                    send_to_output_queue(get_pool().submit(OPLChunkParser{data.substr(begin, end - begin), m_line_count, read_types(), read_parts()}));
+                    m_line_count += lines;
+                }
+
+                // Cut the input into chunks of complete lines and parse
+                // them on the thread pool. The chunks are sent to the
+                // output queue in order. Line numbers (for error messages)
+                // and the split into buffers with objects of only one type
+                // are the same as when parsing line by line.
+                void run_in_chunks() {
+                    const bool split_by_type = buffers_kind() != osmium::io::buffers_type::any;
+
+                    std::string data;
+                    std::size_t begin = 0; // start of current chunk
+                    std::size_t end = 0; // end of last complete line in chunk
+                    uint64_t lines = 0; // number of non-empty lines in chunk
+                    bool in_line = false;
+                    osmium::item_type last_type = osmium::item_type::undefined;
+
+                    while (!input_done()) {
+                        std::size_t pos = data.size();
+                        data.append(get_input());
+
+                        for (; pos < data.size(); ++pos) {
+                            const char c = data[pos];
+                            if (is_opl_line_end(c)) {
+                                if (in_line) {
+                                    ++lines;
+                                    in_line = false;
+                                }
+                                end = pos + 1;
+                            } else if (!in_line) {
+                                in_line = true;
+                                if (split_by_type) {
+                                    const auto type = opl_line_type(c);
+                                    if (type != osmium::item_type::undefined &&
+                                        (read_types() & osmium::osm_entity_bits::from_item_type(type))) {
+                                        if (last_type != osmium::item_type::undefined && type != last_type && end > begin) {
+                                            send_chunk(data, begin, end, lines);
+                                            begin = end;
+                                            lines = 0;
+                                        }
+                                        last_type = type;
+                                    }
+                                }
+                            }
+                        }
+
+                        if (end - begin >= chunk_size) {
+                            send_chunk(data, begin, end, lines);
+                            begin = end;
+                            lines = 0;
+                        }
+
+                        if (begin > 0) {
+                            data.erase(0, begin);
+                            end -= begin;
+                            begin = 0;
+                        }
+                    }
+
+                    if (!data.empty()) {
+                        send_chunk(data, 0, data.size(), lines);
+                    }
+                }
+
                 void run() override {
                     osmium::thread::set_thread_name("_osmium_opl_in");
 
+                    if (osmium::config::use_pool_threads_for_opl_parsing()) {
+                        run_in_chunks();
+                        return;
+                    }
+
                     line_by_line(*this);
 
                     flush_final_buffer();
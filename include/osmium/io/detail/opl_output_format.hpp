@@ -88,6 +88,8 @@ namespace osmium {
 
                 opl_output_options m_options;
 
+                osmium::detail::iso_timestamp_formatter m_timestamp_formatter;
+
                 void append_encoded_string(const char* data) {
                     osmium::io::detail::append_utf8_encoded_string(*m_out, data);
                 }
@@ -99,7 +101,9 @@ namespace osmium {
 
                 void write_field_timestamp(char c, const osmium::Timestamp& timestamp) {
                     *m_out += c;
-                    *m_out += timestamp.to_iso();
+                    if (timestamp.valid()) {
+                        m_timestamp_formatter.append(*m_out, uint32_t(timestamp));
+                    }
                 }
 
                 void write_tags(const osmium::TagList& tags) {
@@ -156,12 +160,12 @@ namespace osmium {
                     *m_out += ' ';
                     *m_out += x;
                     if (not_undefined) {
-                        osmium::detail::append_location_coordinate_to_string(std::back_inserter(*m_out), location.x());
+                        osmium::detail::append_coordinate_to_string(*m_out, location.x());
                     }
                     *m_out += ' ';
                     *m_out += y;
                     if (not_undefined) {
-                        osmium::detail::append_location_coordinate_to_string(std::back_inserter(*m_out), location.y());
+                        osmium::detail::append_coordinate_to_string(*m_out, location.y());
                     }
                 }
 
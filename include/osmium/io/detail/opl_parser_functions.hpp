@@ -36,6 +36,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/builder/osm_object_builder.hpp>
 #include <osmium/io/detail/string_util.hpp>
 #include <osmium/io/error.hpp>
+#include <osmium/io/file_format.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/box.hpp>
 #include <osmium/osm/changeset.hpp>
@@ -48,12 +49,34 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/way.hpp>
 
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <iterator>
 #include <limits>
 #include <stdexcept>
 #include <string>
+#include <utility>
+
+// The SSE2 version of opl_find_special() reads whole aligned 16 byte blocks
+// which can extend past the end of the string. This is safe, because an
+// aligned block never crosses a page boundary, but address sanitizers would
+// complain about it.
+#if defined(__has_feature)
+# if __has_feature(address_sanitizer)
+#  define OSMIUM_OPL_NO_SSE2
+# endif
+#endif
+
+#if !defined(OSMIUM_OPL_NO_SSE2) && !defined(__SANITIZE_ADDRESS__) && \
+    (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+# include <emmintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+# endif
+# define OSMIUM_OPL_USE_SSE2
+#endif
 
 namespace osmium {
 
@@ -179,6 +202,65 @@ namespace osmium {
                 throw opl_error{"hex escape too long", s};
             }
 
+#ifdef OSMIUM_OPL_USE_SSE2
+            // Bit mask with a bit set for every byte in the block that is
+            // the end of the string, a space, tab, comma, equal sign, or
+            // percent sign.
+            inline unsigned int opl_special_chars_mask(const __m128i block) noexcept {
+                __m128i m = _mm_cmpeq_epi8(block, _mm_setzero_si128());
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(block, _mm_set1_epi8(' ')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(block, _mm_set1_epi8('\t')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(block, _mm_set1_epi8(',')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(block, _mm_set1_epi8('=')));
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(block, _mm_set1_epi8('%')));
+                return static_cast<unsigned int>(_mm_movemask_epi8(m));
+            }
+
+            inline unsigned int opl_count_trailing_zeros(const unsigned int mask) noexcept {
+                assert(mask != 0);
+# ifdef _MSC_VER
+                unsigned long index = 0; // NOLINT(google-runtime-int)
+                _BitScanForward(&index, mask);
+                return static_cast<unsigned int>(index);
+# else
+                return static_cast<unsigned int>(__builtin_ctz(mask));
+# endif
+            }
+#endif
+
+            /**
+             * Find the next character in a string that ends an OPL string
+             * (end of string, space, tab, comma, or equal sign) or starts
+             * an escape (percent sign).
+             *
+             * If SSE2 is available, 16 bytes are checked at a time.
+             */
+            inline const char* opl_find_special(const char* s) noexcept {
+#ifdef OSMIUM_OPL_USE_SSE2
+                // Start with the aligned block containing s and ignore the
+                // bytes before s. Aligned loads never cross page boundaries,
+                // so this never reads from memory that's not accessible.
+                const auto offset = static_cast<unsigned int>(reinterpret_cast<std::uintptr_t>(s) & 15U);
+                const auto* block = reinterpret_cast<const __m128i*>(s - offset);
+                unsigned int mask = opl_special_chars_mask(_mm_load_si128(block)) >> offset;
+                if (mask != 0) {
+                    return s + opl_count_trailing_zeros(mask);
+                }
+                while (true) {
+                    ++block;
+                    mask = opl_special_chars_mask(_mm_load_si128(block));
+                    if (mask != 0) {
+                        return reinterpret_cast<const char*>(block) + opl_count_trailing_zeros(mask);
+                    }
+                }
+#else
+                while (*s != '\0' && *s != ' ' && *s != '\t' && *s != ',' && *s != '=' && *s != '%') {
+                    ++s;
+                }
+                return s;
+#endif
+            }
+
             /**
              * Parse a string up to end of string or next space, tab, comma, or
              * equal sign.
@@ -192,18 +274,38 @@ namespace osmium {
                 assert(*data);
                 const char* s = *data;
                 while (true) {
-                    if (*s == '\0' || *s == ' ' || *s == '\t' || *s == ',' || *s == '=') {
+                    const char* end = opl_find_special(s);
+                    result.append(s, end);
+                    s = end;
+                    if (*s != '%') {
                         break;
                     }
-                    if (*s == '%') {
-                        ++s;
-                        opl_parse_escaped(&s, result);
-                    } else {
-                        result += *s;
-                        ++s;
-                    }
+                    ++s;
+                    opl_parse_escaped(&s, result);
+                }
+                *data = s;
+            }
+
+            /**
+             * Parse a string like opl_parse_string(), but without copying
+             * it if it doesn't contain any escapes. In that case the
+             * returned pointer and length refer to the input data,
+             * otherwise the unescaped string is assembled in the tmp
+             * string and the returned pointer and length refer to that.
+             */
+            inline std::pair<const char*, std::size_t> opl_parse_string_ref(const char** data, std::string& tmp) {
+                assert(data);
+                assert(*data);
+                const char* start = *data;
+                const char* s = opl_find_special(start);
+                if (*s != '%') {
+                    *data = s;
+                    return std::make_pair(start, static_cast<std::size_t>(s - start));
                 }
+                tmp.assign(start, static_cast<std::size_t>(s - start));
                 *data = s;
+                opl_parse_string(data, tmp);
+                return std::make_pair(tmp.data(), tmp.size());
             }
 
             template <typename T>
@@ -309,19 +411,17 @@ namespace osmium {
              */
             inline void opl_parse_tags(const char* s, osmium::memory::Buffer& buffer, osmium::builder::Builder* parent_builder = nullptr) {
                 osmium::builder::TagListBuilder builder{buffer, parent_builder};
-                std::string key;
-                std::string value;
+                std::string key_tmp;
+                std::string value_tmp;
                 while (true) {
-                    opl_parse_string(&s, key);
+                    const auto key = opl_parse_string_ref(&s, key_tmp);
                     opl_parse_char(&s, '=');
-                    opl_parse_string(&s, value);
-                    builder.add_tag(key, value);
+                    const auto value = opl_parse_string_ref(&s, value_tmp);
+                    builder.add_tag(key.first, key.second, value.first, value.second);
                     if (*s == ' ' || *s == '\t' || *s == '\0') {
                         break;
                     }
                     opl_parse_char(&s, ',');
-                    key.clear();
-                    value.clear();
                 }
             }
 
@@ -368,7 +468,7 @@ namespace osmium {
                 }
             }
 
-            inline void opl_parse_node(const char** data, osmium::memory::Buffer& buffer) {
+            inline void opl_parse_node(const char** data, osmium::memory::Buffer& buffer, const object_parts& read_parts = object_parts{}) {
                 osmium::builder::NodeBuilder builder{buffer};
 
                 builder.set_id(opl_parse_id(data));
@@ -385,7 +485,8 @@ namespace osmium {
                 bool has_lon = false;
                 bool has_lat = false;
 
-                std::string user;
+                std::string user_tmp;
+                std::pair<const char*, std::size_t> user{"", 0};
                 osmium::Location location;
                 while (**data) {
                     opl_parse_space(data);
@@ -435,7 +536,7 @@ namespace osmium {
                                 throw opl_error{"Duplicate attribute: user (u)"};
                             }
                             has_user = true;
-                            opl_parse_string(data, user);
+                            user = opl_parse_string_ref(data, user_tmp);
                             break;
                         case 'T':
                             if (has_tags) {
@@ -475,14 +576,14 @@ namespace osmium {
                     builder.set_location(location);
                 }
 
-                builder.set_user(user);
+                builder.set_user(user.first, static_cast<osmium::string_size_type>(user.second));
 
-                if (tags_begin) {
+                if (tags_begin && read_parts.tags) {
                     opl_parse_tags(tags_begin, buffer, &builder);
                 }
             }
 
-            inline void opl_parse_way(const char** data, osmium::memory::Buffer& buffer) {
+            inline void opl_parse_way(const char** data, osmium::memory::Buffer& buffer, const object_parts& read_parts = object_parts{}) {
                 osmium::builder::WayBuilder builder{buffer};
 
                 builder.set_id(opl_parse_id(data));
@@ -501,7 +602,8 @@ namespace osmium {
                 bool has_tags = false;
                 bool has_nodes = false;
 
-                std::string user;
+                std::string user_tmp;
+                std::pair<const char*, std::size_t> user{"", 0};
                 while (**data) {
                     opl_parse_space(data);
                     const char c = **data;
@@ -550,7 +652,7 @@ namespace osmium {
                                 throw opl_error{"Duplicate attribute: user (u)"};
                             }
                             has_user = true;
-                            opl_parse_string(data, user);
+                            user = opl_parse_string_ref(data, user_tmp);
                             break;
                         case 'T':
                             if (has_tags) {
@@ -576,16 +678,25 @@ namespace osmium {
                     }
                 }
 
-                builder.set_user(user);
+                builder.set_user(user.first, static_cast<osmium::string_size_type>(user.second));
 
-                if (tags_begin) {
+                if (tags_begin && read_parts.tags) {
                     opl_parse_tags(tags_begin, buffer, &builder);
                 }
 
-                opl_parse_way_nodes(nodes_begin, nodes_end, buffer, &builder);
+                if (read_parts.way_nodes) {
+                    opl_parse_way_nodes(nodes_begin, nodes_end, buffer, &builder);
+                }
             }
 
-            inline void opl_parse_relation_members(const char* s, const char* e, osmium::memory::Buffer& buffer, osmium::builder::RelationBuilder* parent_builder = nullptr) {
+            /**
+             * Parse a list of members in the format "tID@role,tID@role,..."
+             *
+             * Members will be added to the buffer using a
+             * RelationMemberListBuilder. If with_roles is false, all
+             * members get an empty role.
+             */
+            inline void opl_parse_relation_members(const char* s, const char* e, osmium::memory::Buffer& buffer, osmium::builder::RelationBuilder* parent_builder = nullptr, const bool with_roles = true) {
                 if (s == e) {
                     return;
                 }
@@ -609,9 +720,18 @@ namespace osmium {
                         builder.add_member(type, ref, "");
                         return;
                     }
-                    std::string role;
-                    opl_parse_string(&s, role);
-                    builder.add_member(type, ref, role);
+                    if (with_roles) {
+                        std::string role;
+                        opl_parse_string(&s, role);
+                        builder.add_member(type, ref, role);
+                    } else {
+                        // Commas in roles are always escaped, so we can
+                        // skip to the next one.
+                        while (s < e && *s != ',' && *s != '=') {
+                            ++s;
+                        }
+                        builder.add_member(type, ref, "");
+                    }
 
                     if (s == e) {
                         return;
@@ -620,7 +740,7 @@ namespace osmium {
                 }
             }
 
-            inline void opl_parse_relation(const char** data, osmium::memory::Buffer& buffer) {
+            inline void opl_parse_relation(const char** data, osmium::memory::Buffer& buffer, const object_parts& read_parts = object_parts{}) {
                 osmium::builder::RelationBuilder builder{buffer};
 
                 builder.set_id(opl_parse_id(data));
@@ -639,7 +759,8 @@ namespace osmium {
                 bool has_tags = false;
                 bool has_members = false;
 
-                std::string user;
+                std::string user_tmp;
+                std::pair<const char*, std::size_t> user{"", 0};
                 while (**data) {
                     opl_parse_space(data);
                     const char c = **data;
@@ -688,7 +809,7 @@ namespace osmium {
                                 throw opl_error{"Duplicate attribute: user (u)"};
                             }
                             has_user = true;
-                            opl_parse_string(data, user);
+                            user = opl_parse_string_ref(data, user_tmp);
                             break;
                         case 'T':
                             if (has_tags) {
@@ -714,18 +835,18 @@ namespace osmium {
                     }
                 }
 
-                builder.set_user(user);
+                builder.set_user(user.first, static_cast<osmium::string_size_type>(user.second));
 
-                if (tags_begin) {
+                if (tags_begin && read_parts.tags) {
                     opl_parse_tags(tags_begin, buffer, &builder);
                 }
 
                 if (members_begin != members_end) {
-                    opl_parse_relation_members(members_begin, members_end, buffer, &builder);
+                    opl_parse_relation_members(members_begin, members_end, buffer, &builder, read_parts.member_roles);
                 }
             }
 
-            inline void opl_parse_changeset(const char** data, osmium::memory::Buffer& buffer) {
+            inline void opl_parse_changeset(const char** data, osmium::memory::Buffer& buffer, const object_parts& read_parts = object_parts{}) {
                 osmium::builder::ChangesetBuilder builder{buffer};
 
                 builder.set_id(opl_parse_changeset_id(data));
@@ -745,7 +866,8 @@ namespace osmium {
                 bool has_max_y = false;
 
                 osmium::Box box;
-                std::string user;
+                std::string user_tmp;
+                std::pair<const char*, std::size_t> user{"", 0};
                 while (**data) {
                     opl_parse_space(data);
                     const char c = **data;
@@ -794,7 +916,7 @@ namespace osmium {
                                 throw opl_error{"Duplicate attribute: user (u)"};
                             }
                             has_user = true;
-                            opl_parse_string(data, user);
+                            user = opl_parse_string_ref(data, user_tmp);
                             break;
                         case 'x':
                             if (has_min_x) {
@@ -850,9 +972,9 @@ namespace osmium {
                 }
 
                 builder.set_bounds(box);
-                builder.set_user(user);
+                builder.set_user(user.first, static_cast<osmium::string_size_type>(user.second));
 
-                if (tags_begin) {
+                if (tags_begin && read_parts.tags) {
                     opl_parse_tags(tags_begin, buffer, &builder);
                 }
             }
@@ -860,7 +982,8 @@ namespace osmium {
             inline bool opl_parse_line(uint64_t line_count,
                                        const char* data,
                                        osmium::memory::Buffer& buffer,
-                                       osmium::osm_entity_bits::type read_types = osmium::osm_entity_bits::all) {
+                                       osmium::osm_entity_bits::type read_types = osmium::osm_entity_bits::all,
+                                       const object_parts& read_parts = object_parts{}) {
                 const char* start_of_line = data;
                 try {
                     switch (*data) {
@@ -873,7 +996,7 @@ namespace osmium {
                         case 'n':
                             if (read_types & osmium::osm_entity_bits::node) {
                                 ++data;
-                                opl_parse_node(&data, buffer);
+                                opl_parse_node(&data, buffer, read_parts);
                                 buffer.commit();
                                 return true;
                             }
@@ -881,7 +1004,7 @@ namespace osmium {
                         case 'w':
                             if (read_types & osmium::osm_entity_bits::way) {
                                 ++data;
-                                opl_parse_way(&data, buffer);
+                                opl_parse_way(&data, buffer, read_parts);
                                 buffer.commit();
                                 return true;
                             }
@@ -889,7 +1012,7 @@ namespace osmium {
                         case 'r':
                             if (read_types & osmium::osm_entity_bits::relation) {
                                 ++data;
-                                opl_parse_relation(&data, buffer);
+                                opl_parse_relation(&data, buffer, read_parts);
                                 buffer.commit();
                                 return true;
                             }
@@ -897,7 +1020,7 @@ namespace osmium {
                         case 'c':
                             if (read_types & osmium::osm_entity_bits::changeset) {
                                 ++data;
-                                opl_parse_changeset(&data, buffer);
+                                opl_parse_changeset(&data, buffer, read_parts);
                                 buffer.commit();
                                 return true;
                             }
@@ -919,5 +1042,7 @@ namespace osmium {
 
 } // namespace osmium
 
+#undef OSMIUM_OPL_USE_SSE2
+#undef OSMIUM_OPL_NO_SSE2
 
 #endif // OSMIUM_IO_DETAIL_OPL_PARSER_FUNCTIONS_HPP
@@ -40,6 +40,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/io/file_format.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/thread/pool.hpp>
+#include <osmium/util/number_format.hpp>
 
 #include <array>
 #include <cstdint>
@@ -71,28 +72,10 @@ namespace osmium {
                     m_out(std::make_shared<std::string>()) {
                 }
 
-                // Simple function to convert integer to string. This is much
-                // faster than using sprintf, but could be further optimized.
-                // See https://github.com/miloyip/itoa-benchmark .
+                // Append integer in decimal to the output string.
                 void output_int(int64_t value) {
-                    if (value < 0) {
-                        *m_out += '-';
-                        value = -value;
-                    }
-
-                    char temp[20];
-                    char *t = temp;
-                    do {
-                        *t++ = static_cast<char>(value % 10) + '0'; // NOLINT(bugprone-narrowing-conversions, cppcoreguidelines-narrowing-conversions)
-                        value /= 10;
-                    } while (value > 0);
-
-                    const auto old_size = m_out->size();
-                    m_out->resize(old_size + (t - temp));
-                    char* data = &(*m_out)[old_size];
-                    do {
-                        *data++ = *--t;
-                    } while (t != temp);
+                    char buffer[20];
+                    m_out->append(buffer, osmium::detail::format_integer(buffer, value));
                 }
 
             }; // class OutputBlock;
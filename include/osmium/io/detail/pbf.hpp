@@ -73,6 +73,9 @@ namespace osmium {
 
             const int64_t resolution_convert = lonlat_resolution / osmium::detail::coordinate_precision;
 
+            // value of the format field in the Osmium blob index
+            const char* const blob_index_format = "OsmiumBlobIndex";
+
             enum class pbf_compression : uint8_t {
                 none = 0,
                 zlib = 1,
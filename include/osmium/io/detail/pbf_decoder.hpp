@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <limits>
@@ -44,10 +45,13 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/builder/osm_object_builder.hpp>
 #include <osmium/io/detail/pbf.hpp> // IWYU pragma: export
+#include <osmium/io/detail/pbf_varint.hpp>
 #include <osmium/io/detail/protobuf_tags.hpp>
 #include <osmium/io/detail/zlib.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/node_columns.hpp>
+#include <osmium/io/read_tags_filter.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
@@ -134,8 +138,145 @@ namespace osmium {
 
             }; // class varint_range
 
+            /**
+             * Array of values decoded from a packed, zigzag- and
+             * delta-encoded sint64 field. This is used for the IDs of
+             * dense nodes and the node references of ways which usually
+             * have small deltas. Decoding all of them in one go is faster
+             * than decoding them one by one in that case. The memory is
+             * reused when the array is decoded again.
+             */
+            class delta_sint64_array {
+
+                std::vector<int64_t> m_values;
+                std::size_t m_size = 0;
+
+            public:
+
+                void decode(const data_view& data) {
+                    // Each varint has at least one byte, so this is enough
+                    if (m_values.size() < data.size() + packed_delta_sint64_padding) {
+                        m_values.resize(data.size() + packed_delta_sint64_padding);
+                    }
+                    m_size = decode_packed_delta_sint64(data.data(), data.data() + data.size(), m_values.data());
+                }
+
+                std::size_t size() const noexcept {
+                    return m_size;
+                }
+
+                int64_t operator[](const std::size_t n) const noexcept {
+                    return m_values[n];
+                }
+
+            }; // class delta_sint64_array
+
             using osm_string_len_type = std::pair<const char*, osmium::string_size_type>;
 
+            /**
+             * Evaluates a read_tags_filter on the tags of objects in a PBF
+             * primitive block. The results for keys are cached by their
+             * index in the string table of the block, so each key is only
+             * matched once per block. Only keys for which the result
+             * depends on the value need a full check of the tag.
+             */
+            class stringtable_tags_filter {
+
+                enum class key_result : uint8_t {
+                    unknown   = 0,
+                    no_match  = 1,
+                    match     = 2,
+                    check_tag = 3
+                };
+
+                const read_tags_filter& m_filter;
+
+                // Copies of the strings from the string table, each with
+                // a terminating zero byte, because the matchers need C
+                // strings.
+                std::string m_strings;
+                std::vector<std::size_t> m_offsets;
+
+                std::vector<key_result> m_key_results;
+
+                const char* c_str(const uint32_t index) const {
+                    return m_strings.data() + m_offsets.at(index);
+                }
+
+                key_result get_key_result(const uint32_t index) {
+                    auto& result = m_key_results.at(index);
+                    if (result == key_result::unknown) {
+                        switch (m_filter.match_key(c_str(index))) {
+                            case tags_filter_key_result::no_match:
+                                result = key_result::no_match;
+                                break;
+                            case tags_filter_key_result::match:
+                                result = key_result::match;
+                                break;
+                            default:
+                                result = key_result::check_tag;
+                                break;
+                        }
+                    }
+                    return result;
+                }
+
+            public:
+
+                explicit stringtable_tags_filter(const read_tags_filter& filter) :
+                    m_filter(filter) {
+                }
+
+                /**
+                 * Set the string table of the block. Must be called before
+                 * any of the matching functions.
+                 */
+                void set_stringtable(const std::vector<osm_string_len_type>& stringtable) {
+                    std::size_t size = 0;
+                    for (const auto& str : stringtable) {
+                        size += str.second + 1;
+                    }
+
+                    m_strings.clear();
+                    m_strings.reserve(size);
+                    m_offsets.clear();
+                    m_offsets.reserve(stringtable.size());
+                    for (const auto& str : stringtable) {
+                        m_offsets.push_back(m_strings.size());
+                        m_strings.append(str.first, str.second);
+                        m_strings += '\0';
+                    }
+
+                    m_key_results.assign(stringtable.size(), key_result::unknown);
+                }
+
+                /**
+                 * Is the filter used for objects of the specified type?
+                 */
+                bool applies_to(const osmium::osm_entity_bits::type entity) const noexcept {
+                    return m_filter.applies_to(entity);
+                }
+
+                /**
+                 * Does the tag with the specified key and value indexes
+                 * into the string table match?
+                 *
+                 * @throws std::out_of_range If an index is out of range.
+                 */
+                bool match(const uint32_t key, const uint32_t value) {
+                    switch (get_key_result(key)) {
+                        case key_result::match:
+                            return true;
+                        case key_result::no_match:
+                            return false;
+                        default:
+                            break;
+                    }
+                    return m_filter(c_str(key), c_str(value));
+                }
+
+            }; // class stringtable_tags_filter
+
             class PBFPrimitiveBlockDecoder {
 
                 enum {
@@ -156,6 +297,12 @@ namespace osmium {
 
                 osmium::io::read_meta m_read_metadata;
 
+                object_parts m_read_parts;
+
+                delta_sint64_array m_ids;
+
+                stringtable_tags_filter m_tags_filter;
+
                 void decode_stringtable(const data_view& data) {
                     if (!m_stringtable.empty()) {
                         throw osmium::pbf_error{"more than one stringtable in pbf file"};
@@ -194,6 +341,10 @@ namespace osmium {
                                 pbf_primitive_block.skip();
                         }
                     }
+
+                    if (m_tags_filter.applies_to(m_read_types)) {
+                        m_tags_filter.set_stringtable(m_stringtable);
+                    }
                 }
 
                 void decode_primitive_block_data() {
@@ -300,7 +451,7 @@ namespace osmium {
                 }
 
                 void build_tag_list(osmium::builder::Builder& parent, varint_range& keys, varint_range& vals) {
-                    if (keys.empty() || vals.empty()) {
+                    if (!m_read_parts.tags || keys.empty() || vals.empty()) {
                         return;
                     }
 
@@ -312,6 +463,79 @@ namespace osmium {
                     } while (!keys.empty() && !vals.empty());
                 }
 
+                /**
+                 * Check whether any of the tags of a (non-dense) node, way,
+                 * or relation match the tags filter without decoding the
+                 * object.
+                 */
+                template <typename TMessage>
+                bool tags_match(const data_view& data) {
+                    varint_range keys;
+                    varint_range vals;
+
+                    protozero::pbf_message<TMessage> pbf_object{data};
+                    while (pbf_object.next()) {
+                        switch (pbf_object.tag_and_type()) {
+                            case protozero::tag_and_type(TMessage::packed_uint32_keys, protozero::pbf_wire_type::length_delimited):
+                                keys = varint_range{pbf_object.get_view()};
+                                break;
+                            case protozero::tag_and_type(TMessage::packed_uint32_vals, protozero::pbf_wire_type::length_delimited):
+                                vals = varint_range{pbf_object.get_view()};
+                                break;
+                            default:
+                                pbf_object.skip();
+                        }
+                    }
+
+                    while (!keys.empty() && !vals.empty()) {
+                        if (m_tags_filter.match(keys.next_uint32(), vals.next_uint32())) {
+                            return true;
+                        }
+                    }
+
+                    return false;
+                }
+
+                /**
+                 * Check whether any of the tags of the next dense node
+                 * match the tags filter. The tags of the node are consumed
+                 * from the range.
+                 */
+                bool dense_node_tags_match(varint_range& tags) {
+                    bool result = false;
+                    while (!tags.empty()) {
+                        const auto key = tags.next_uint32();
+                        if (key == 0) {
+                            break;
+                        }
+                        if (tags.empty()) {
+                            throw osmium::pbf_error{"PBF format error"}; // this is against the spec, keys/vals must come in pairs
+                        }
+                        const auto value = tags.next_uint32();
+                        if (!result) {
+                            result = m_tags_filter.match(key, value);
+                        }
+                    }
+                    return result;
+                }
+
+                /**
+                 * Check the tags of the next dense node against the tags
+                 * filter (if there is one for nodes). If the node should
+                 * be skipped, its tags are consumed from the range.
+                 */
+                bool skip_dense_node(varint_range& tags) {
+                    if (!m_tags_filter.applies_to(osmium::osm_entity_bits::node)) {
+                        return false;
+                    }
+                    varint_range node_tags{tags};
+                    if (dense_node_tags_match(node_tags)) {
+                        return false;
+                    }
+                    tags = node_tags;
+                    return true;
+                }
+
                 int32_t convert_pbf_lon(const int64_t c) const noexcept {
                     return int32_t((c * m_granularity + m_lon_offset) / resolution_convert);
                 }
@@ -321,6 +545,10 @@ namespace osmium {
                 }
 
                 void decode_node(const data_view& data) {
+                    if (m_tags_filter.applies_to(osmium::osm_entity_bits::node) && !tags_match<OSMFormat::Node>(data)) {
+                        return;
+                    }
+
                     osmium::builder::NodeBuilder builder{m_buffer};
                     osmium::Node& node = builder.object();
 
@@ -378,11 +606,15 @@ namespace osmium {
                 }
 
                 void decode_way(const data_view& data) {
+                    if (m_tags_filter.applies_to(osmium::osm_entity_bits::way) && !tags_match<OSMFormat::Way>(data)) {
+                        return;
+                    }
+
                     osmium::builder::WayBuilder builder{m_buffer};
 
                     varint_range keys;
                     varint_range vals;
-                    varint_range refs;
+                    data_view refs;
                     varint_range lats;
                     varint_range lons;
 
@@ -408,7 +640,7 @@ namespace osmium {
                                 }
                                 break;
                             case protozero::tag_and_type(OSMFormat::Way::packed_sint64_refs, protozero::pbf_wire_type::length_delimited):
-                                refs = varint_range{pbf_way.get_view()};
+                                refs = pbf_way.get_view();
                                 break;
                             case protozero::tag_and_type(OSMFormat::Way::packed_sint64_lat, protozero::pbf_wire_type::length_delimited):
                                 lats = varint_range{pbf_way.get_view()};
@@ -423,19 +655,19 @@ namespace osmium {
 
                     builder.set_user(user.first, user.second);
 
-                    if (!refs.empty()) {
+                    if (m_read_parts.way_nodes && !refs.empty()) {
                         osmium::builder::WayNodeListBuilder wnl_builder{builder};
-                        osmium::DeltaDecode<int64_t> ref;
+                        m_ids.decode(refs);
                         if (lats.empty()) {
-                            while (!refs.empty()) {
-                                wnl_builder.add_node_ref(ref.update(refs.next_sint64()));
+                            for (std::size_t i = 0; i < m_ids.size(); ++i) {
+                                wnl_builder.add_node_ref(m_ids[i]);
                             }
                         } else {
                             osmium::DeltaDecode<int64_t> lon;
                             osmium::DeltaDecode<int64_t> lat;
-                            while (!refs.empty() && !lons.empty() && !lats.empty()) {
+                            for (std::size_t i = 0; i < m_ids.size() && !lons.empty() && !lats.empty(); ++i) {
                                 wnl_builder.add_node_ref(
-                                    ref.update(refs.next_sint64()),
+                                    m_ids[i],
                                     osmium::Location{convert_pbf_lon(lon.update(lons.next_sint64())),
                                                      convert_pbf_lat(lat.update(lats.next_sint64()))}
                                 );
@@ -447,6 +679,10 @@ namespace osmium {
                 }
 
                 void decode_relation(const data_view& data) {
+                    if (m_tags_filter.applies_to(osmium::osm_entity_bits::relation) && !tags_match<OSMFormat::Relation>(data)) {
+                        return;
+                    }
+
                     osmium::builder::RelationBuilder builder{m_buffer};
 
                     varint_range keys;
@@ -493,10 +729,12 @@ namespace osmium {
                     builder.set_user(user.first, user.second);
 
                     if (!refs.empty()) {
+                        const osm_string_len_type empty_string{"", 0};
                         osmium::builder::RelationMemberListBuilder rml_builder{builder};
                         osmium::DeltaDecode<int64_t> ref;
                         while (!roles.empty() && !refs.empty() && !types.empty()) {
-                            const auto& r = m_stringtable.at(roles.next_int32());
+                            const auto role_index = roles.next_int32();
+                            const auto& r = m_read_parts.member_roles ? m_stringtable.at(role_index) : empty_string;
                             const int type = types.next_int32();
                             if (type < 0 || type > 2) {
                                 throw osmium::pbf_error{"unknown relation member type"};
@@ -513,7 +751,24 @@ namespace osmium {
                     build_tag_list(builder, keys, vals);
                 }
 
+                static void skip_tags_of_dense_node(varint_range& tags) {
+                    while (!tags.empty()) {
+                        if (tags.next_uint32() == 0) {
+                            return;
+                        }
+                        if (tags.empty()) {
+                            throw osmium::pbf_error{"PBF format error"}; // this is against the spec, keys/vals must come in pairs
+                        }
+                        tags.next_uint32();
+                    }
+                }
+
                 void build_tag_list_from_dense_nodes(osmium::builder::NodeBuilder& builder, varint_range& tags) {
+                    if (!m_read_parts.tags) {
+                        skip_tags_of_dense_node(tags);
+                        return;
+                    }
+
                     osmium::builder::TagListBuilder tl_builder{builder};
                     while (!tags.empty()) {
                         const auto idx = tags.next_int32();
@@ -530,7 +785,7 @@ namespace osmium {
                 }
 
                 void decode_dense_nodes_without_metadata(const data_view& data) {
-                    varint_range ids;
+                    data_view ids;
                     varint_range lats;
                     varint_range lons;
                     varint_range tags;
@@ -539,7 +794,7 @@ namespace osmium {
                     while (pbf_dense_nodes.next()) {
                         switch (pbf_dense_nodes.tag_and_type()) {
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_id, protozero::pbf_wire_type::length_delimited):
-                                ids = varint_range{pbf_dense_nodes.get_view()};
+                                ids = pbf_dense_nodes.get_view();
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lat, protozero::pbf_wire_type::length_delimited):
                                 lats = varint_range{pbf_dense_nodes.get_view()};
@@ -555,25 +810,31 @@ namespace osmium {
                         }
                     }
 
-                    osmium::DeltaDecode<int64_t> dense_id;
+                    m_ids.decode(ids);
+
                     osmium::DeltaDecode<int64_t> dense_latitude;
                     osmium::DeltaDecode<int64_t> dense_longitude;
 
-                    while (!ids.empty()) {
+                    for (std::size_t i = 0; i < m_ids.size(); ++i) {
                         if (lons.empty() ||
                             lats.empty()) {
                             // this is against the spec, must have same number of elements
                             throw osmium::pbf_error{"PBF format error"};
                         }
 
+                        const auto lon = dense_longitude.update(lons.next_sint64());
+                        const auto lat = dense_latitude.update(lats.next_sint64());
+
+                        if (skip_dense_node(tags)) {
+                            continue;
+                        }
+
                         {
                             osmium::builder::NodeBuilder builder{m_buffer};
                             osmium::Node& node = builder.object();
 
-                            node.set_id(dense_id.update(ids.next_sint64()));
+                            node.set_id(m_ids[i]);
 
-                            const auto lon = dense_longitude.update(lons.next_sint64());
-                            const auto lat = dense_latitude.update(lats.next_sint64());
                             builder.object().set_location(osmium::Location{
                                     convert_pbf_lon(lon),
                                     convert_pbf_lat(lat)
@@ -591,7 +852,7 @@ namespace osmium {
                 void decode_dense_nodes(const data_view& data) {
                     bool has_info = false;
 
-                    varint_range ids;
+                    data_view ids;
                     varint_range lats;
                     varint_range lons;
                     varint_range tags;
@@ -606,7 +867,7 @@ namespace osmium {
                     while (pbf_dense_nodes.next()) {
                         switch (pbf_dense_nodes.tag_and_type()) {
                             case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_id, protozero::pbf_wire_type::length_delimited):
-                                ids = varint_range{pbf_dense_nodes.get_view()};
+                                ids = pbf_dense_nodes.get_view();
                                 break;
                             case protozero::tag_and_type(OSMFormat::DenseNodes::optional_DenseInfo_denseinfo, protozero::pbf_wire_type::length_delimited):
                                 {
@@ -652,7 +913,8 @@ namespace osmium {
                         }
                     }
 
-                    osmium::DeltaDecode<int64_t> dense_id;
+                    m_ids.decode(ids);
+
                     osmium::DeltaDecode<int64_t> dense_latitude;
                     osmium::DeltaDecode<int64_t> dense_longitude;
                     osmium::DeltaDecode<int64_t> dense_uid;
@@ -660,20 +922,48 @@ namespace osmium {
                     osmium::DeltaDecode<int64_t> dense_changeset;
                     osmium::DeltaDecode<int64_t> dense_timestamp;
 
-                    while (!ids.empty()) {
+                    for (std::size_t i = 0; i < m_ids.size(); ++i) {
                         if (lons.empty() ||
                             lats.empty()) {
                             // this is against the spec, must have same number of elements
                             throw osmium::pbf_error{"PBF format error"};
                         }
 
+                        if (skip_dense_node(tags)) {
+                            // All fields are delta encoded, so they have
+                            // to be decoded even if the node is skipped.
+                            if (has_info) {
+                                if (!versions.empty()) {
+                                    versions.next_int32();
+                                }
+                                if (!changesets.empty()) {
+                                    dense_changeset.update(changesets.next_sint64());
+                                }
+                                if (!timestamps.empty()) {
+                                    dense_timestamp.update(timestamps.next_sint64());
+                                }
+                                if (!uids.empty()) {
+                                    dense_uid.update(uids.next_sint32());
+                                }
+                                if (!visibles.empty()) {
+                                    visibles.next_int32();
+                                }
+                                if (!user_sids.empty()) {
+                                    dense_user_sid.update(user_sids.next_sint32());
+                                }
+                            }
+                            dense_longitude.update(lons.next_sint64());
+                            dense_latitude.update(lats.next_sint64());
+                            continue;
+                        }
+
                         {
                             bool visible = true;
 
                             osmium::builder::NodeBuilder builder{m_buffer};
                             osmium::Node& node = builder.object();
 
-                            node.set_id(dense_id.update(ids.next_sint64()));
+                            node.set_id(m_ids[i]);
 
                             if (has_info) {
                                 if (!versions.empty()) {
@@ -740,12 +1030,160 @@ namespace osmium {
                     }
                 }
 
+                uint32_t check_string_index(const uint32_t index) const {
+                    if (index >= m_stringtable.size()) {
+                        throw osmium::pbf_error{"string id out of range"};
+                    }
+                    return index;
+                }
+
+                void add_node_column(node_columns& columns, const int64_t id, const int64_t lon, const int64_t lat, const bool visible) {
+                    columns.ids.push_back(id);
+                    if (visible) {
+                        columns.x.push_back(convert_pbf_lon(lon));
+                        columns.y.push_back(convert_pbf_lat(lat));
+                    } else {
+                        columns.x.push_back(osmium::Location::undefined_coordinate);
+                        columns.y.push_back(osmium::Location::undefined_coordinate);
+                    }
+                }
+
+                void decode_node_column(const data_view& data, node_columns& columns, const bool with_tags) {
+                    int64_t id = 0;
+                    varint_range keys;
+                    varint_range vals;
+                    int64_t lon = std::numeric_limits<int64_t>::max();
+                    int64_t lat = std::numeric_limits<int64_t>::max();
+                    bool visible = true;
+
+                    protozero::pbf_message<OSMFormat::Node> pbf_node{data};
+                    while (pbf_node.next()) {
+                        switch (pbf_node.tag_and_type()) {
+                            case protozero::tag_and_type(OSMFormat::Node::required_sint64_id, protozero::pbf_wire_type::varint):
+                                id = pbf_node.get_sint64();
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Node::packed_uint32_keys, protozero::pbf_wire_type::length_delimited):
+                                keys = varint_range{pbf_node.get_view()};
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Node::packed_uint32_vals, protozero::pbf_wire_type::length_delimited):
+                                vals = varint_range{pbf_node.get_view()};
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Node::optional_Info_info, protozero::pbf_wire_type::length_delimited):
+                                {
+                                    protozero::pbf_message<OSMFormat::Info> pbf_info{pbf_node.get_view()};
+                                    while (pbf_info.next(OSMFormat::Info::optional_bool_visible, protozero::pbf_wire_type::varint)) {
+                                        visible = pbf_info.get_bool();
+                                    }
+                                }
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Node::required_sint64_lat, protozero::pbf_wire_type::varint):
+                                lat = pbf_node.get_sint64();
+                                break;
+                            case protozero::tag_and_type(OSMFormat::Node::required_sint64_lon, protozero::pbf_wire_type::varint):
+                                lon = pbf_node.get_sint64();
+                                break;
+                            default:
+                                pbf_node.skip();
+                        }
+                    }
+
+                    if (visible && (lon == std::numeric_limits<int64_t>::max() ||
+                                    lat == std::numeric_limits<int64_t>::max())) {
+                        throw osmium::pbf_error{"illegal coordinate format"};
+                    }
+
+                    add_node_column(columns, id, lon, lat, visible);
+
+                    if (with_tags) {
+                        while (!keys.empty() && !vals.empty()) {
+                            columns.tags.push_back(check_string_index(keys.next_uint32()));
+                            columns.tags.push_back(check_string_index(vals.next_uint32()));
+                        }
+                        columns.tag_offsets.push_back(static_cast<uint32_t>(columns.tags.size() / 2));
+                    }
+                }
+
+                void decode_dense_node_columns(const data_view& data, node_columns& columns, const bool with_tags) {
+                    data_view ids;
+                    varint_range lats;
+                    varint_range lons;
+                    varint_range tags;
+                    varint_range visibles;
+
+                    protozero::pbf_message<OSMFormat::DenseNodes> pbf_dense_nodes{data};
+                    while (pbf_dense_nodes.next()) {
+                        switch (pbf_dense_nodes.tag_and_type()) {
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_id, protozero::pbf_wire_type::length_delimited):
+                                ids = pbf_dense_nodes.get_view();
+                                break;
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::optional_DenseInfo_denseinfo, protozero::pbf_wire_type::length_delimited):
+                                {
+                                    protozero::pbf_message<OSMFormat::DenseInfo> pbf_dense_info{pbf_dense_nodes.get_message()};
+                                    while (pbf_dense_info.next(OSMFormat::DenseInfo::packed_bool_visible, protozero::pbf_wire_type::length_delimited)) {
+                                        visibles = varint_range{pbf_dense_info.get_view()};
+                                    }
+                                }
+                                break;
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lat, protozero::pbf_wire_type::length_delimited):
+                                lats = varint_range{pbf_dense_nodes.get_view()};
+                                break;
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_sint64_lon, protozero::pbf_wire_type::length_delimited):
+                                lons = varint_range{pbf_dense_nodes.get_view()};
+                                break;
+                            case protozero::tag_and_type(OSMFormat::DenseNodes::packed_int32_keys_vals, protozero::pbf_wire_type::length_delimited):
+                                tags = varint_range{pbf_dense_nodes.get_view()};
+                                break;
+                            default:
+                                pbf_dense_nodes.skip();
+                        }
+                    }
+
+                    m_ids.decode(ids);
+
+                    columns.ids.reserve(columns.ids.size() + m_ids.size());
+                    columns.x.reserve(columns.x.size() + m_ids.size());
+                    columns.y.reserve(columns.y.size() + m_ids.size());
+
+                    osmium::DeltaDecode<int64_t> dense_latitude;
+                    osmium::DeltaDecode<int64_t> dense_longitude;
+
+                    for (std::size_t i = 0; i < m_ids.size(); ++i) {
+                        if (lons.empty() ||
+                            lats.empty()) {
+                            // this is against the spec, must have same number of elements
+                            throw osmium::pbf_error{"PBF format error"};
+                        }
+
+                        const auto lon = dense_longitude.update(lons.next_sint64());
+                        const auto lat = dense_latitude.update(lats.next_sint64());
+                        const bool visible = visibles.empty() || visibles.next_int32() != 0;
+                        add_node_column(columns, m_ids[i], lon, lat, visible);
+
+                        if (with_tags) {
+                            while (!tags.empty()) {
+                                const auto key = tags.next_uint32();
+                                if (key == 0) {
+                                    break;
+                                }
+                                if (tags.empty()) {
+                                    throw osmium::pbf_error{"PBF format error"}; // this is against the spec, keys/vals must come in pairs
+                                }
+                                columns.tags.push_back(check_string_index(key));
+                                columns.tags.push_back(check_string_index(tags.next_uint32()));
+                            }
+                            columns.tag_offsets.push_back(static_cast<uint32_t>(columns.tags.size() / 2));
+                        }
+                    }
+                }
+
             public:
 
-                PBFPrimitiveBlockDecoder(const data_view& data, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata) :
+                PBFPrimitiveBlockDecoder(const data_view& data, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata, const read_tags_filter& tags_filter, const object_parts& read_parts = object_parts{}) :
                     m_data(data),
                     m_read_types(read_types),
-                    m_read_metadata(read_metadata) {
+                    m_read_metadata(read_metadata),
+                    m_read_parts(read_parts),
+                    m_tags_filter(tags_filter) {
                 }
 
                 PBFPrimitiveBlockDecoder(const PBFPrimitiveBlockDecoder&) = delete;
@@ -767,6 +1205,51 @@ namespace osmium {
                     return std::move(m_buffer);
                 }
 
+                /**
+                 * Decode the nodes in this block into columns instead of
+                 * into a buffer. All other objects are ignored.
+                 *
+                 * @param columns The columns to fill. Will be cleared first.
+                 * @param with_tags Fill in the tags of the nodes, too.
+                 */
+                void decode_node_columns(node_columns& columns, const bool with_tags) {
+                    columns.clear();
+
+                    decode_primitive_block_metadata();
+
+                    if (with_tags) {
+                        std::size_t size = 0;
+                        for (const auto& str : m_stringtable) {
+                            size += str.second + 1;
+                        }
+                        columns.strings.reserve(size);
+                        columns.string_offsets.reserve(m_stringtable.size());
+                        for (const auto& str : m_stringtable) {
+                            columns.string_offsets.push_back(static_cast<uint32_t>(columns.strings.size()));
+                            columns.strings.append(str.first, str.second);
+                            columns.strings += '\0';
+                        }
+                        columns.tag_offsets.push_back(0);
+                    }
+
+                    protozero::pbf_message<OSMFormat::PrimitiveBlock> pbf_primitive_block{m_data};
+                    while (pbf_primitive_block.next(OSMFormat::PrimitiveBlock::repeated_PrimitiveGroup_primitivegroup, protozero::pbf_wire_type::length_delimited)) {
+                        protozero::pbf_message<OSMFormat::PrimitiveGroup> pbf_primitive_group = pbf_primitive_block.get_message();
+                        while (pbf_primitive_group.next()) {
+                            switch (pbf_primitive_group.tag_and_type()) {
+                                case protozero::tag_and_type(OSMFormat::PrimitiveGroup::repeated_Node_nodes, protozero::pbf_wire_type::length_delimited):
+                                    decode_node_column(pbf_primitive_group.get_view(), columns, with_tags);
+                                    break;
+                                case protozero::tag_and_type(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense, protozero::pbf_wire_type::length_delimited):
+                                    decode_dense_node_columns(pbf_primitive_group.get_view(), columns, with_tags);
+                                    break;
+                                default:
+                                    pbf_primitive_group.skip();
+                            }
+                        }
+                    }
+                }
+
             }; // class PBFPrimitiveBlockDecoder
 
             inline data_view decode_blob(const std::string& blob_data, std::string& output) {
@@ -881,6 +1364,141 @@ namespace osmium {
                     return box;
             }
 
+            /**
+             * Summary of the contents of a data blob as written by the
+             * Osmium PBF writer into the BlobHeader.indexdata field if the
+             * "pbf_blob_index" option is set.
+             */
+            struct pbf_blob_index {
+
+                /// The types of the entities in the blob.
+                osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::all;
+
+                /// Smallest ID in the blob.
+                osmium::object_id_type min_id = std::numeric_limits<osmium::object_id_type>::min();
+
+                /// Largest ID in the blob.
+                osmium::object_id_type max_id = std::numeric_limits<osmium::object_id_type>::max();
+
+                /// Bounding box of all locations in the blob. Undefined if unknown.
+                osmium::Box box{};
+
+                /**
+                 * Can the blob contain any objects of the specified entity
+                 * types inside the specified bounding box? An undefined
+                 * bounding box matches everything.
+                 */
+                bool can_match(osmium::osm_entity_bits::type read_types, const osmium::Box& bbox) const noexcept {
+                    if ((entities & read_types) == osmium::osm_entity_bits::nothing) {
+                        return false;
+                    }
+                    if (!bbox || !box) {
+                        return true;
+                    }
+                    return box.bottom_left().x() <= bbox.top_right().x() &&
+                           box.top_right().x()   >= bbox.bottom_left().x() &&
+                           box.bottom_left().y() <= bbox.top_right().y() &&
+                           box.top_right().y()   >= bbox.bottom_left().y();
+                }
+
+            }; // struct pbf_blob_index
+
+            /**
+             * Decode the contents of the BlobHeader.indexdata field. If the
+             * field was not written by Osmium, the returned index will
+             * match everything.
+             *
+             * @param data Input data
+             * @returns Blob index
+             * @throws osmium::pbf_error If there was a parsing error
+             */
+            inline pbf_blob_index decode_blob_index(const data_view& data) {
+                pbf_blob_index index;
+                data_view format;
+
+                protozero::pbf_message<OsmiumFormat::BlobIndex> pbf_blob_index_message{data};
+                while (pbf_blob_index_message.next()) {
+                    switch (pbf_blob_index_message.tag_and_type()) {
+                        case protozero::tag_and_type(OsmiumFormat::BlobIndex::required_string_format, protozero::pbf_wire_type::length_delimited):
+                            format = pbf_blob_index_message.get_view();
+                            break;
+                        case protozero::tag_and_type(OsmiumFormat::BlobIndex::required_uint32_entities, protozero::pbf_wire_type::varint):
+                            index.entities = static_cast<osmium::osm_entity_bits::type>(pbf_blob_index_message.get_uint32() & osmium::osm_entity_bits::all);
+                            break;
+                        case protozero::tag_and_type(OsmiumFormat::BlobIndex::optional_sint64_min_id, protozero::pbf_wire_type::varint):
+                            index.min_id = pbf_blob_index_message.get_sint64();
+                            break;
+                        case protozero::tag_and_type(OsmiumFormat::BlobIndex::optional_sint64_max_id, protozero::pbf_wire_type::varint):
+                            index.max_id = pbf_blob_index_message.get_sint64();
+                            break;
+                        case protozero::tag_and_type(OsmiumFormat::BlobIndex::optional_HeaderBBox_bbox, protozero::pbf_wire_type::length_delimited):
+                            index.box = decode_header_bbox(pbf_blob_index_message.get_view());
+                            break;
+                        default:
+                            pbf_blob_index_message.skip();
+                    }
+                }
+
+                if (format.size() != std::strlen(blob_index_format) ||
+                    std::strncmp(blob_index_format, format.data(), format.size()) != 0) {
+                    return pbf_blob_index{};
+                }
+
+                return index;
+            }
+
+            /**
+             * Decode the 4-byte size of a BlobHeader in network byte order.
+             */
+            inline uint32_t get_size_in_network_byte_order(const char* d) noexcept {
+                return (static_cast<uint32_t>(d[3])) |
+                       (static_cast<uint32_t>(d[2]) <<  8U) |
+                       (static_cast<uint32_t>(d[1]) << 16U) |
+                       (static_cast<uint32_t>(d[0]) << 24U);
+            }
+
+            /**
+             * Decode the BlobHeader. Make sure it contains the expected
+             * type. Return the size of the following Blob. If index is
+             * not nullptr, the index data from the BlobHeader (if any)
+             * is decoded into it.
+             */
+            inline size_t decode_blob_header(const protozero::data_view &data, const char* expected_type, pbf_blob_index* index = nullptr) {
+                protozero::pbf_message<FileFormat::BlobHeader> pbf_blob_header{data};
+                protozero::data_view blob_header_type;
+                size_t blob_header_datasize = 0;
+
+                while (pbf_blob_header.next()) {
+                    switch (pbf_blob_header.tag_and_type()) {
+                        case protozero::tag_and_type(FileFormat::BlobHeader::required_string_type, protozero::pbf_wire_type::length_delimited):
+                            blob_header_type = pbf_blob_header.get_view();
+                            break;
+                        case protozero::tag_and_type(FileFormat::BlobHeader::optional_bytes_indexdata, protozero::pbf_wire_type::length_delimited):
+                            if (index) {
+                                *index = decode_blob_index(pbf_blob_header.get_view());
+                            } else {
+                                pbf_blob_header.skip();
+                            }
+                            break;
+                        case protozero::tag_and_type(FileFormat::BlobHeader::required_int32_datasize, protozero::pbf_wire_type::varint):
+                            blob_header_datasize = pbf_blob_header.get_int32();
+                            break;
+                        default:
+                            pbf_blob_header.skip();
+                    }
+                }
+
+                if (blob_header_datasize == 0) {
+                    throw osmium::pbf_error{"PBF format error: BlobHeader.datasize missing or zero."};
+                }
+
+                if (std::strncmp(expected_type, blob_header_type.data(), blob_header_type.size()) != 0) {
+                    throw osmium::pbf_error{"blob does not have expected type (OSMHeader in first blob, OSMData in following blobs)"};
+                }
+
+                return blob_header_datasize;
+            }
+
             inline osmium::io::Header decode_header_block(const data_view& data) {
                 osmium::io::Header header;
                 int i = 0;
@@ -957,23 +1575,50 @@ namespace osmium {
                 std::shared_ptr<std::string> m_input_buffer;
                 osmium::osm_entity_bits::type m_read_types;
                 osmium::io::read_meta m_read_metadata;
+                read_tags_filter m_tags_filter;
+                object_parts m_read_parts;
 
             public:
 
-                PBFDataBlobDecoder(std::string&& input_buffer, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata) :
+                PBFDataBlobDecoder(std::string&& input_buffer, const osmium::osm_entity_bits::type read_types, const osmium::io::read_meta read_metadata, const read_tags_filter& tags_filter = read_tags_filter{}, const object_parts& read_parts = object_parts{}) :
                     m_input_buffer(std::make_shared<std::string>(std::move(input_buffer))),
                     m_read_types(read_types),
-                    m_read_metadata(read_metadata) {
+                    m_read_metadata(read_metadata),
+                    m_tags_filter(tags_filter),
+                    m_read_parts(read_parts) {
                 }
 
                 osmium::memory::Buffer operator()() {
                     std::string output;
-                    PBFPrimitiveBlockDecoder decoder{decode_blob(*m_input_buffer, output), m_read_types, m_read_metadata};
+                    PBFPrimitiveBlockDecoder decoder{decode_blob(*m_input_buffer, output), m_read_types, m_read_metadata, m_tags_filter, m_read_parts};
                     return decoder();
                 }
 
             }; // class PBFDataBlobDecoder
 
+            class PBFNodeColumnsBlobDecoder {
+
+                std::shared_ptr<std::string> m_input_buffer;
+                bool m_with_tags;
+
+            public:
+
+                PBFNodeColumnsBlobDecoder(std::string&& input_buffer, const bool with_tags) :
+                    m_input_buffer(std::make_shared<std::string>(std::move(input_buffer))),
+                    m_with_tags(with_tags) {
+                }
+
+                osmium::io::node_columns operator()() {
+                    std::string output;
+                    const read_tags_filter tags_filter{};
+                    PBFPrimitiveBlockDecoder decoder{decode_blob(*m_input_buffer, output), osmium::osm_entity_bits::node, osmium::io::read_meta::no, tags_filter};
+                    osmium::io::node_columns columns;
+                    decoder.decode_node_columns(columns, m_with_tags);
+                    return columns;
+                }
+
+            }; // class PBFNodeColumnsBlobDecoder
+
         } // namespace detail
 
     } // namespace io
@@ -33,17 +33,21 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/io/detail/direct_io.hpp>
 #include <osmium/io/detail/input_format.hpp>
+#include <osmium/io/detail/io_uring.hpp>
 #include <osmium/io/detail/pbf.hpp> // IWYU pragma: export
 #include <osmium/io/detail/pbf_decoder.hpp>
 #include <osmium/io/detail/protobuf_tags.hpp>
 #include <osmium/io/detail/read_write.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/thread/pool.hpp>
 #include <osmium/thread/util.hpp>
 #include <osmium/util/config.hpp>
+#include <osmium/util/file.hpp>
 
 #include <protozero/pbf_message.hpp>
 #include <protozero/types.hpp>
@@ -65,10 +69,22 @@ namespace osmium {
 
             class PBFParser final : public Parser {
 
+                enum : std::size_t {
+                    // Size of reads when using io_uring
+                    uring_read_block_size = 4UL * 1024UL * 1024UL
+                };
+
                 std::string m_input_buffer{};
                 std::atomic<std::size_t>* m_offset_ptr;
+                osmium::Box m_read_bbox;
+                read_tags_filter m_tags_filter;
+                pbf_blob_index m_blob_index{};
                 int m_fd;
                 bool m_want_buffered_pages_removed;
+                std::unique_ptr<osmium::io::detail::DirectFileReader> m_direct_reader;
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+                std::unique_ptr<osmium::io::detail::UringFileReader> m_uring_reader;
+#endif
 
                 /**
                  * Make sure the input data contains at least the specified
@@ -100,13 +116,6 @@ namespace osmium {
                     m_input_buffer.erase(0, size);
                 }
 
-                static uint32_t get_size_in_network_byte_order(const char* d) noexcept {
-                    return (static_cast<uint32_t>(d[3])) |
-                           (static_cast<uint32_t>(d[2]) <<  8U) |
-                           (static_cast<uint32_t>(d[1]) << 16U) |
-                           (static_cast<uint32_t>(d[0]) << 24U);
-                }
-
                 static uint32_t check_size(uint32_t size) {
                     if (size > static_cast<uint32_t>(max_blob_header_size)) {
                         throw osmium::pbf_error{"invalid BlobHeader size (> max_blob_header_size)"};
@@ -121,6 +130,22 @@ namespace osmium {
                  *          false if EOF was encountered
                  */
                 bool read_exactly(char* buffer, std::size_t size) {
+                    if (m_direct_reader) {
+                        if (!m_direct_reader->read_exactly(buffer, size)) {
+                            return false;
+                        }
+                        *m_offset_ptr += size;
+                        return true;
+                    }
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+                    if (m_uring_reader) {
+                        if (!m_uring_reader->read_exactly(buffer, size)) {
+                            return false;
+                        }
+                        *m_offset_ptr += size;
+                        return true;
+                    }
+#endif
                     std::size_t to_read = size;
 
                     while (to_read > 0) {
@@ -166,39 +191,6 @@ namespace osmium {
                     return size;
                 }
 
-                /**
-                 * Decode the BlobHeader. Make sure it contains the expected
-                 * type. Return the size of the following Blob.
-                 */
-                static size_t decode_blob_header(const protozero::data_view &data, const char* expected_type) {
-                    protozero::pbf_message<FileFormat::BlobHeader> pbf_blob_header{data};
-                    protozero::data_view blob_header_type;
-                    size_t blob_header_datasize = 0;
-
-                    while (pbf_blob_header.next()) {
-                        switch (pbf_blob_header.tag_and_type()) {
-                            case protozero::tag_and_type(FileFormat::BlobHeader::required_string_type, protozero::pbf_wire_type::length_delimited):
-                                blob_header_type = pbf_blob_header.get_view();
-                                break;
-                            case protozero::tag_and_type(FileFormat::BlobHeader::required_int32_datasize, protozero::pbf_wire_type::varint):
-                                blob_header_datasize = pbf_blob_header.get_int32();
-                                break;
-                            default:
-                                pbf_blob_header.skip();
-                        }
-                    }
-
-                    if (blob_header_datasize == 0) {
-                        throw osmium::pbf_error{"PBF format error: BlobHeader.datasize missing or zero."};
-                    }
-
-                    if (std::strncmp(expected_type, blob_header_type.data(), blob_header_type.size()) != 0) {
-                        throw osmium::pbf_error{"blob does not have expected type (OSMHeader in first blob, OSMData in following blobs)"};
-                    }
-
-                    return blob_header_datasize;
-                }
-
                 size_t check_type_and_get_blob_size(const char* expected_type) {
                     assert(expected_type);
 
@@ -207,14 +199,16 @@ namespace osmium {
                         return 0;
                     }
 
+                    m_blob_index = pbf_blob_index{};
+
                     if (m_fd != -1) {
                         auto const buffer = read_from_input_queue_with_check(size);
-                        const auto blob_size = decode_blob_header(protozero::data_view{buffer.data(), size}, expected_type);
+                        const auto blob_size = decode_blob_header(protozero::data_view{buffer.data(), size}, expected_type, &m_blob_index);
                         return blob_size;
                     }
 
                     ensure_available_in_input_queue(size);
-                    const auto blob_size = decode_blob_header(protozero::data_view{m_input_buffer.data(), size}, expected_type);
+                    const auto blob_size = decode_blob_header(protozero::data_view{m_input_buffer.data(), size}, expected_type, &m_blob_index);
                     pop_from_input_queue(size);
                     return blob_size;
                 }
@@ -241,6 +235,36 @@ namespace osmium {
                     return buffer;
                 }
 
+                /**
+                 * Skip over a blob without reading it if possible.
+                 *
+                 * @param size Size of the blob.
+                 */
+                void skip_blob(size_t size) {
+                    if (size > max_uncompressed_blob_size) {
+                        throw osmium::pbf_error{std::string{"invalid blob size: "} +
+                                                std::to_string(size)};
+                    }
+
+                    if (m_fd == -1) {
+                        ensure_available_in_input_queue(size);
+                        pop_from_input_queue(size);
+                        return;
+                    }
+
+                    bool has_reader = m_direct_reader != nullptr;
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+                    has_reader = has_reader || m_uring_reader != nullptr;
+#endif
+                    if (!has_reader && osmium::seek_forward(m_fd, size)) {
+                        *m_offset_ptr += size;
+                        return;
+                    }
+
+                    // Can't seek, read and discard the data instead.
+                    read_from_input_queue_with_check(size);
+                }
+
                 // Parse the header in the PBF OSMHeader blob.
                 void parse_header_blob() {
                     const auto size = check_type_and_get_blob_size("OSMHeader");
@@ -251,9 +275,14 @@ namespace osmium {
                 void parse_data_blobs() {
                     const bool use_pool = osmium::config::use_pool_threads_for_pbf_parsing();
                     while (const auto size = check_type_and_get_blob_size("OSMData")) {
+                        if (!m_blob_index.can_match(read_types(), m_read_bbox)) {
+                            skip_blob(size);
+                            continue;
+                        }
+
                         std::string input_buffer{read_from_input_queue_with_check(size)};
 
-                        PBFDataBlobDecoder data_blob_parser{std::move(input_buffer), read_types(), read_metadata()};
+                        PBFDataBlobDecoder data_blob_parser{std::move(input_buffer), read_types(), read_metadata(), m_tags_filter, read_parts()};
 
                         if (use_pool) {
                             send_to_output_queue(get_pool().submit(std::move(data_blob_parser)));
@@ -272,8 +301,19 @@ namespace osmium {
                 explicit PBFParser(parser_arguments& args) :
                     Parser(args),
                     m_offset_ptr(args.offset_ptr),
+                    m_read_bbox(args.read_bbox),
+                    m_tags_filter(args.tags_filter),
                     m_fd(args.fd),
                     m_want_buffered_pages_removed(args.want_buffered_pages_removed) {
+                    if (m_fd != -1 && osmium::io::detail::has_direct_io(m_fd)) {
+                        m_direct_reader.reset(new osmium::io::detail::DirectFileReader{m_fd});
+                        return;
+                    }
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+                    if (m_fd != -1) {
+                        m_uring_reader = osmium::io::detail::make_uring_reader(m_fd, uring_read_block_size);
+                    }
+#endif
                 }
 
                 PBFParser(const PBFParser&) = delete;
@@ -293,6 +333,10 @@ namespace osmium {
                         parse_data_blobs();
                     }
 
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+                    // Wait for outstanding reads before closing the file
+                    m_uring_reader.reset();
+#endif
                     osmium::io::detail::reliable_close(m_fd);
                 }
 
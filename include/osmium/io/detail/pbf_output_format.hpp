@@ -35,8 +35,10 @@ DEALINGS IN THE SOFTWARE.
 
 #include <cassert>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <limits>
 #include <memory>
 #include <string>
 #include <utility>
@@ -55,6 +57,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/memory/buffer.hpp>
 #include <osmium/memory/item_iterator.hpp>
 #include <osmium/osm/box.hpp>
+#include <osmium/osm/entity_bits.hpp>
 #include <osmium/osm/item_type.hpp>
 #include <osmium/osm/location.hpp>
 #include <osmium/osm/metadata_options.hpp>
@@ -76,8 +79,10 @@ DEALINGS IN THE SOFTWARE.
 #endif
 
 #include <protozero/pbf_builder.hpp>
+#include <protozero/pbf_reader.hpp>
 #include <protozero/pbf_writer.hpp>
 #include <protozero/types.hpp>
+#include <protozero/varint.hpp>
 
 namespace osmium {
 
@@ -111,6 +116,26 @@ namespace osmium {
                 /// Should node locations be added to ways?
                 bool locations_on_ways = false;
 
+                /**
+                 * Should a summary of the entity types, IDs, and locations
+                 * in each blob be added to the BlobHeader.indexdata field?
+                 */
+                bool add_blob_index = false;
+
+                /**
+                 * Should the string table of each block be sorted by how
+                 * often the strings are used?
+                 */
+                bool sort_stringtable = false;
+
+                /**
+                 * Target size of the uncompressed blocks in bytes. If this
+                 * is 0, blocks are cut after max_entities_per_block objects.
+                 * Otherwise only the size counts and blocks can contain
+                 * more than max_entities_per_block objects.
+                 */
+                std::size_t target_block_size = 0;
+
             }; // struct pbf_output_options
 
             /**
@@ -134,6 +159,120 @@ namespace osmium {
                 data = 1
             };
 
+            /// The number of bytes needed to encode value as varint.
+            inline std::size_t varint_length(uint64_t value) noexcept {
+                std::size_t length = 1;
+                while (value >= 0x80U) {
+                    value >>= 7U;
+                    ++length;
+                }
+                return length;
+            }
+
+            /// The number of bytes needed to encode value as zigzag varint.
+            inline std::size_t sint_varint_length(const int64_t value) noexcept {
+                return varint_length(protozero::encode_zigzag64(value));
+            }
+
+            /**
+             * Copy the current field from reader to writer unchanged. Only
+             * varint and length-delimited fields are supported, because
+             * the PBF writer doesn't create any others.
+             */
+            inline void copy_field(protozero::pbf_reader& reader, protozero::pbf_writer& writer) {
+                switch (reader.wire_type()) {
+                    case protozero::pbf_wire_type::varint:
+                        writer.add_uint64(reader.tag(), reader.get_uint64());
+                        break;
+                    case protozero::pbf_wire_type::length_delimited:
+                        writer.add_bytes(reader.tag(), reader.get_view());
+                        break;
+                    default:
+                        assert(false && "unexpected wire type");
+                        reader.skip();
+                }
+            }
+
+            /**
+             * Write a packed field with string table indexes replaced by
+             * the indexes from new_index. The indexes are never negative,
+             * so the encoding is the same for the int32 and uint32 fields
+             * used in the PBF format.
+             */
+            inline void add_remapped_indexes(protozero::pbf_writer& writer, const protozero::pbf_tag_type tag, const protozero::data_view& data, const std::vector<int32_t>& new_index) {
+                protozero::packed_field_uint32 field{writer, tag};
+                const char* it = data.data();
+                const char* const end = it + data.size();
+                while (it != end) {
+                    field.add_element(static_cast<uint32_t>(new_index.at(protozero::decode_varint(&it, end))));
+                }
+            }
+
+            /**
+             * Re-encode a Node, Way, or Relation message with all string
+             * table indexes replaced by the indexes from new_index. The
+             * keys, vals, and Info fields have the same tags in all three
+             * messages, the roles_tag is only set for relations.
+             */
+            inline std::string remap_string_indexes(const protozero::data_view& data, const std::vector<int32_t>& new_index, const protozero::pbf_tag_type roles_tag = 0) {
+                constexpr const auto keys_tag = protozero::pbf_tag_type(OSMFormat::Way::packed_uint32_keys);
+                constexpr const auto vals_tag = protozero::pbf_tag_type(OSMFormat::Way::packed_uint32_vals);
+                constexpr const auto info_tag = protozero::pbf_tag_type(OSMFormat::Way::optional_Info_info);
+
+                std::string output;
+                protozero::pbf_writer writer{output};
+
+                protozero::pbf_reader reader{data};
+                while (reader.next()) {
+                    const auto tag = reader.tag();
+                    if (tag == keys_tag || tag == vals_tag || tag == roles_tag) {
+                        add_remapped_indexes(writer, tag, reader.get_view(), new_index);
+                    } else if (tag == info_tag) {
+                        protozero::pbf_writer info_writer{writer, tag};
+                        protozero::pbf_reader info_reader{reader.get_view()};
+                        while (info_reader.next()) {
+                            if (info_reader.tag() == protozero::pbf_tag_type(OSMFormat::Info::optional_uint32_user_sid)) {
+                                info_writer.add_uint32(info_reader.tag(), static_cast<uint32_t>(new_index.at(info_reader.get_uint32())));
+                            } else {
+                                copy_field(info_reader, info_writer);
+                            }
+                        }
+                    } else {
+                        copy_field(reader, writer);
+                    }
+                }
+
+                return output;
+            }
+
+            /**
+             * Re-encode a PrimitiveGroup message with (non-dense) nodes,
+             * ways, or relations with all string table indexes replaced by
+             * the indexes from new_index.
+             */
+            inline std::string remap_string_indexes_in_group(const std::string& data, const std::vector<int32_t>& new_index) {
+                std::string output;
+                protozero::pbf_writer writer{output};
+
+                protozero::pbf_reader reader{data};
+                while (reader.next()) {
+                    switch (reader.tag()) {
+                        case protozero::pbf_tag_type(OSMFormat::PrimitiveGroup::repeated_Node_nodes):
+                        case protozero::pbf_tag_type(OSMFormat::PrimitiveGroup::repeated_Way_ways):
+                            writer.add_message(reader.tag(), remap_string_indexes(reader.get_view(), new_index));
+                            break;
+                        case protozero::pbf_tag_type(OSMFormat::PrimitiveGroup::repeated_Relation_relations):
+                            writer.add_message(reader.tag(), remap_string_indexes(reader.get_view(), new_index,
+                                                                                  protozero::pbf_tag_type(OSMFormat::Relation::packed_int32_roles_sid)));
+                            break;
+                        default:
+                            copy_field(reader, writer);
+                    }
+                }
+
+                return output;
+            }
+
             /**
              * Contains the code to pack any number of nodes into a DenseNode
              * structure.
@@ -166,6 +305,10 @@ namespace osmium {
                 osmium::DeltaEncode<int64_t, int64_t> m_delta_lat;
                 osmium::DeltaEncode<int64_t, int64_t> m_delta_lon;
 
+                // Estimated size of the encoded data. Only updated if a
+                // target block size is set.
+                std::size_t m_encoded_size = 0;
+
             public:
 
                 DenseNodes(StringTable* stringtable, const pbf_output_options* options) :
@@ -195,6 +338,9 @@ namespace osmium {
                 }
 
                 std::size_t size() const noexcept {
+                    if (m_options->target_block_size > 0) {
+                        return m_encoded_size;
+                    }
                     return m_ids.size() * 3 * sizeof(int64_t);
                 }
 
@@ -229,9 +375,72 @@ namespace osmium {
                         m_tags.push_back(m_stringtable->add(tag.value()));
                     }
                     m_tags.push_back(0);
+
+                    if (m_options->target_block_size > 0) {
+                        update_encoded_size();
+                    }
+                }
+
+                // Add the size of the last node to the estimated size of
+                // the encoded data. Uses the current string indexes.
+                void update_encoded_size() noexcept {
+                    m_encoded_size += sint_varint_length(m_ids.back()) +
+                                      sint_varint_length(m_lats.back()) +
+                                      sint_varint_length(m_lons.back());
+                    if (!m_versions.empty()) {
+                        m_encoded_size += varint_length(static_cast<uint64_t>(m_versions.back()));
+                    }
+                    if (!m_timestamps.empty()) {
+                        m_encoded_size += sint_varint_length(m_timestamps.back());
+                    }
+                    if (!m_changesets.empty()) {
+                        m_encoded_size += sint_varint_length(m_changesets.back());
+                    }
+                    if (!m_uids.empty()) {
+                        m_encoded_size += sint_varint_length(m_uids.back());
+                    }
+                    if (!m_user_sids.empty()) {
+                        m_encoded_size += sint_varint_length(m_user_sids.back());
+                    }
+                    if (!m_visibles.empty()) {
+                        ++m_encoded_size;
+                    }
+                    for (auto it = m_tags.rbegin() + 1; it != m_tags.rend() && *it != 0; ++it) {
+                        m_encoded_size += varint_length(static_cast<uint64_t>(*it));
+                    }
+                    ++m_encoded_size; // for the 0 after the tags
+                }
+
+                /**
+                 * Serialize the dense nodes. If new_index is not empty,
+                 * the string table indexes are replaced by the indexes
+                 * from new_index.
+                 */
+                std::string serialize(const std::vector<int32_t>& new_index) const {
+                    if (new_index.empty()) {
+                        return serialize(m_user_sids, m_tags);
+                    }
+
+                    std::vector<int32_t> user_sids;
+                    user_sids.reserve(m_user_sids.size());
+                    osmium::DeltaDecode<int32_t, int32_t> old_user_sid;
+                    osmium::DeltaEncode<int32_t, int32_t> new_user_sid;
+                    for (const auto delta : m_user_sids) {
+                        user_sids.push_back(new_user_sid.update(new_index.at(old_user_sid.update(delta))));
+                    }
+
+                    std::vector<int32_t> tags;
+                    tags.reserve(m_tags.size());
+                    for (const auto index : m_tags) {
+                        tags.push_back(new_index.at(index));
+                    }
+
+                    return serialize(user_sids, tags);
                 }
 
-                std::string serialize() const {
+            private:
+
+                std::string serialize(const std::vector<int32_t>& user_sids, const std::vector<int32_t>& tags) const {
                     std::string data;
                     protozero::pbf_builder<OSMFormat::DenseNodes> pbf_dense_nodes{data};
 
@@ -252,7 +461,7 @@ namespace osmium {
                             pbf_dense_info.add_packed_sint32(OSMFormat::DenseInfo::packed_sint32_uid, m_uids.cbegin(), m_uids.cend());
                         }
                         if (m_options->add_metadata.user()) {
-                            pbf_dense_info.add_packed_sint32(OSMFormat::DenseInfo::packed_sint32_user_sid, m_user_sids.cbegin(), m_user_sids.cend());
+                            pbf_dense_info.add_packed_sint32(OSMFormat::DenseInfo::packed_sint32_user_sid, user_sids.cbegin(), user_sids.cend());
                         }
                         if (m_options->add_visible_flag) {
                             pbf_dense_info.add_packed_bool(OSMFormat::DenseInfo::packed_bool_visible, m_visibles.cbegin(), m_visibles.cend());
@@ -262,7 +471,7 @@ namespace osmium {
                     pbf_dense_nodes.add_packed_sint64(OSMFormat::DenseNodes::packed_sint64_lat, m_lats.cbegin(), m_lats.cend());
                     pbf_dense_nodes.add_packed_sint64(OSMFormat::DenseNodes::packed_sint64_lon, m_lons.cbegin(), m_lons.cend());
 
-                    pbf_dense_nodes.add_packed_int32(OSMFormat::DenseNodes::packed_int32_keys_vals, m_tags.cbegin(), m_tags.cend());
+                    pbf_dense_nodes.add_packed_int32(OSMFormat::DenseNodes::packed_int32_keys_vals, tags.cbegin(), tags.cend());
 
                     return data;
                 }
@@ -278,12 +487,36 @@ namespace osmium {
                 std::unique_ptr<DenseNodes> m_dense_nodes{};
                 OSMFormat::PrimitiveGroup m_type;
                 int m_count = 0;
+                osmium::object_id_type m_min_id = std::numeric_limits<osmium::object_id_type>::max();
+                osmium::object_id_type m_max_id = std::numeric_limits<osmium::object_id_type>::min();
+                osmium::Box m_box{};
+
+                // Order of the strings in the string table and the mapping
+                // from old to new string indexes. Only used if the string
+                // table is sorted by frequency.
+                std::vector<int32_t> m_string_order{};
+                std::vector<int32_t> m_string_index{};
+
+                osmium::osm_entity_bits::type entities() const noexcept {
+                    switch (m_type) {
+                        case OSMFormat::PrimitiveGroup::repeated_Node_nodes:
+                        case OSMFormat::PrimitiveGroup::optional_DenseNodes_dense:
+                            return osmium::osm_entity_bits::node;
+                        case OSMFormat::PrimitiveGroup::repeated_Way_ways:
+                            return osmium::osm_entity_bits::way;
+                        case OSMFormat::PrimitiveGroup::repeated_Relation_relations:
+                            return osmium::osm_entity_bits::relation;
+                        default:
+                            break;
+                    }
+                    return osmium::osm_entity_bits::all;
+                }
 
             public:
 
                 explicit PrimitiveBlock(const pbf_output_options& options, OSMFormat::PrimitiveGroup type, size_t bucket_count) :
                     m_pbf_primitive_group(m_pbf_primitive_group_data),
-                    m_stringtable(StringTable::default_stringtable_chunk_size, bucket_count),
+                    m_stringtable(StringTable::default_stringtable_chunk_size, bucket_count, options.sort_stringtable),
                     m_options(options),
                     m_type(type) {
                 }
@@ -292,16 +525,40 @@ namespace osmium {
                     return m_stringtable.get_bucket_count();
                 }
 
+                /**
+                 * Sort the string table so that the most often used strings
+                 * get the smallest indexes and need the fewest bytes in the
+                 * varint encoding. Must be called before group_data() and
+                 * write_stringtable().
+                 */
+                void sort_stringtable() {
+                    m_string_order = m_stringtable.order_by_frequency();
+                    m_string_index.resize(m_string_order.size());
+                    for (std::size_t i = 0; i < m_string_order.size(); ++i) {
+                        m_string_index[static_cast<std::size_t>(m_string_order[i])] = static_cast<int32_t>(i);
+                    }
+                }
+
                 const std::string& group_data() {
                     if (m_dense_nodes) {
-                        m_pbf_primitive_group.add_message(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense, m_dense_nodes->serialize());
+                        m_pbf_primitive_group.add_message(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense, m_dense_nodes->serialize(m_string_index));
+                    } else if (!m_string_index.empty()) {
+                        m_pbf_primitive_group_data = remap_string_indexes_in_group(m_pbf_primitive_group_data, m_string_index);
                     }
                     return m_pbf_primitive_group_data;
                 }
 
                 void write_stringtable(protozero::pbf_builder<OSMFormat::StringTable>& pbf_string_table) {
-                    for (const char* s : m_stringtable) {
-                        pbf_string_table.add_bytes(OSMFormat::StringTable::repeated_bytes_s, s);
+                    if (m_string_order.empty()) {
+                        for (const char* s : m_stringtable) {
+                            pbf_string_table.add_bytes(OSMFormat::StringTable::repeated_bytes_s, s);
+                        }
+                        return;
+                    }
+
+                    const std::vector<const char*> strings(m_stringtable.begin(), m_stringtable.end());
+                    for (const auto index : m_string_order) {
+                        pbf_string_table.add_bytes(OSMFormat::StringTable::repeated_bytes_s, strings[static_cast<std::size_t>(index)]);
                     }
                 }
 
@@ -310,6 +567,52 @@ namespace osmium {
                     return m_pbf_primitive_group;
                 }
 
+                const pbf_output_options& options() const noexcept {
+                    return m_options;
+                }
+
+                /// Add the ID of an object to the blob index.
+                void add_to_index(osmium::object_id_type id) noexcept {
+                    if (id < m_min_id) {
+                        m_min_id = id;
+                    }
+                    if (id > m_max_id) {
+                        m_max_id = id;
+                    }
+                }
+
+                /// Add a location to the blob index. Invalid locations are ignored.
+                void add_to_index(const osmium::Location& location) noexcept {
+                    m_box.extend(location);
+                }
+
+                /**
+                 * Serialize the index for this block to be written into the
+                 * BlobHeader.indexdata field.
+                 */
+                std::string index_data() const {
+                    std::string data;
+                    protozero::pbf_builder<OsmiumFormat::BlobIndex> pbf_index{data};
+
+                    pbf_index.add_string(OsmiumFormat::BlobIndex::required_string_format, blob_index_format);
+                    pbf_index.add_uint32(OsmiumFormat::BlobIndex::required_uint32_entities, entities());
+
+                    if (m_min_id <= m_max_id) {
+                        pbf_index.add_sint64(OsmiumFormat::BlobIndex::optional_sint64_min_id, m_min_id);
+                        pbf_index.add_sint64(OsmiumFormat::BlobIndex::optional_sint64_max_id, m_max_id);
+                    }
+
+                    if (m_box) {
+                        protozero::pbf_builder<OSMFormat::HeaderBBox> pbf_bbox{pbf_index, OsmiumFormat::BlobIndex::optional_HeaderBBox_bbox};
+                        pbf_bbox.add_sint64(OSMFormat::HeaderBBox::required_sint64_left,   m_box.bottom_left().x() * resolution_convert);
+                        pbf_bbox.add_sint64(OSMFormat::HeaderBBox::required_sint64_right,  m_box.top_right().x()   * resolution_convert);
+                        pbf_bbox.add_sint64(OSMFormat::HeaderBBox::required_sint64_top,    m_box.top_right().y()   * resolution_convert);
+                        pbf_bbox.add_sint64(OSMFormat::HeaderBBox::required_sint64_bottom, m_box.bottom_left().y() * resolution_convert);
+                    }
+
+                    return data;
+                }
+
                 void add_dense_node(const osmium::Node& node) {
                     if (!m_dense_nodes) {
                         m_dense_nodes.reset(new DenseNodes{&m_stringtable, &m_options});
@@ -336,9 +639,14 @@ namespace osmium {
                     return m_count;
                 }
 
+                // Estimate of the size of the block. With a target block
+                // size the string table is counted with the size of its
+                // strings. Otherwise the number of strings is used as it
+                // always was, so blocks are cut at the same places as
+                // before.
                 std::size_t size() const noexcept {
                     return m_pbf_primitive_group_data.size() +
-                           m_stringtable.size() +
+                           (m_options.target_block_size > 0 ? m_stringtable.bytes() : m_stringtable.size()) +
                            (m_dense_nodes ? m_dense_nodes->size() : 0);
                 }
 
@@ -356,6 +664,9 @@ namespace osmium {
                     if (type != m_type) {
                         return false;
                     }
+                    if (m_options.target_block_size > 0) {
+                        return size() < m_options.target_block_size;
+                    }
                     if (count() >= max_entities_per_block) {
                         return false;
                     }
@@ -415,6 +726,10 @@ namespace osmium {
                  */
                 std::string operator()() {
                     if (m_block) {
+                        if (m_block->options().sort_stringtable) {
+                            m_block->sort_stringtable();
+                        }
+
                         protozero::pbf_builder<OSMFormat::PrimitiveBlock> primitive_block{m_msg};
 
                         {
@@ -453,6 +768,10 @@ namespace osmium {
 
                     pbf_blob_header.add_string(FileFormat::BlobHeader::required_string_type, m_blob_type == pbf_blob_type::data ? "OSMData" : "OSMHeader");
 
+                    if (m_block && m_block->options().add_blob_index) {
+                        pbf_blob_header.add_bytes(FileFormat::BlobHeader::optional_bytes_indexdata, m_block->index_data());
+                    }
+
                     // The static_cast is okay, because the size can never
                     // be much larger than max_uncompressed_blob_size. This
                     // is due to the assert above and the fact that the zlib
@@ -573,6 +892,21 @@ namespace osmium {
                     m_options.add_historical_information_flag = file.has_multiple_object_versions();
                     m_options.add_visible_flag = file.has_multiple_object_versions();
                     m_options.locations_on_ways = file.is_true("locations_on_ways");
+                    m_options.add_blob_index = file.is_true("pbf_blob_index");
+                    m_options.sort_stringtable = file.is_true("pbf_sort_stringtable");
+
+                    const auto pbs = file.get("pbf_block_size");
+                    if (!pbs.empty()) {
+                        char *end_ptr = nullptr;
+                        const auto val = std::strtoul(pbs.c_str(), &end_ptr, 10);
+                        if (*end_ptr != '\0' || pbs[0] == '-' || val == 0) {
+                            throw std::invalid_argument{"The 'pbf_block_size' option must be a positive integer."};
+                        }
+                        if (val > PrimitiveBlock::max_used_blob_size) {
+                            throw std::invalid_argument{"The 'pbf_block_size' option is too large."};
+                        }
+                        m_options.target_block_size = static_cast<std::size_t>(val);
+                    }
 
                     const auto pbl = file.get("pbf_compression_level");
                     if (pbl.empty()) {
@@ -679,11 +1013,20 @@ namespace osmium {
                 void node(const osmium::Node& node) {
                     if (m_options.use_dense_nodes) {
                         switch_primitive_block_type(OSMFormat::PrimitiveGroup::optional_DenseNodes_dense);
+                    } else {
+                        switch_primitive_block_type(OSMFormat::PrimitiveGroup::repeated_Node_nodes);
+                    }
+
+                    if (m_options.add_blob_index) {
+                        m_primitive_block->add_to_index(node.id());
+                        m_primitive_block->add_to_index(node.location());
+                    }
+
+                    if (m_options.use_dense_nodes) {
                         m_primitive_block->add_dense_node(node);
                         return;
                     }
 
-                    switch_primitive_block_type(OSMFormat::PrimitiveGroup::repeated_Node_nodes);
                     protozero::pbf_builder<OSMFormat::Node> pbf_node{m_primitive_block->group(), OSMFormat::PrimitiveGroup::repeated_Node_nodes};
 
                     pbf_node.add_sint64(OSMFormat::Node::required_sint64_id, node.id());
@@ -695,6 +1038,16 @@ namespace osmium {
 
                 void way(const osmium::Way& way) {
                     switch_primitive_block_type(OSMFormat::PrimitiveGroup::repeated_Way_ways);
+
+                    if (m_options.add_blob_index) {
+                        m_primitive_block->add_to_index(way.id());
+                        if (m_options.locations_on_ways) {
+                            for (const auto& node_ref : way.nodes()) {
+                                m_primitive_block->add_to_index(node_ref.location());
+                            }
+                        }
+                    }
+
                     protozero::pbf_builder<OSMFormat::Way> pbf_way{m_primitive_block->group(), OSMFormat::PrimitiveGroup::repeated_Way_ways};
 
                     pbf_way.add_int64(OSMFormat::Way::required_int64_id, way.id());
@@ -728,6 +1081,11 @@ namespace osmium {
 
                 void relation(const osmium::Relation& relation) {
                     switch_primitive_block_type(OSMFormat::PrimitiveGroup::repeated_Relation_relations);
+
+                    if (m_options.add_blob_index) {
+                        m_primitive_block->add_to_index(relation.id());
+                    }
+
                     protozero::pbf_builder<OSMFormat::Relation> pbf_relation{m_primitive_block->group(), OSMFormat::PrimitiveGroup::repeated_Relation_relations};
 
                     pbf_relation.add_int64(OSMFormat::Relation::required_int64_id, relation.id());
@@ -0,0 +1,341 @@
+#ifndef OSMIUM_IO_DETAIL_PBF_VARINT_HPP
+#define OSMIUM_IO_DETAIL_PBF_VARINT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <protozero/varint.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+# define OSMIUM_PBF_VARINT_USE_SSE2
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__)
+# include <tmmintrin.h>
+# define OSMIUM_PBF_VARINT_USE_SSSE3
+#endif
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * Number of values decode_packed_delta_sint64() might write
+             * past the end of the decoded data.
+             */
+            enum : std::size_t {
+                packed_delta_sint64_padding = 8
+            };
+
+            namespace varint {
+
+                inline unsigned int popcount16(unsigned int x) noexcept {
+                    x = x - ((x >> 1U) & 0x5555U);
+                    x = (x & 0x3333U) + ((x >> 2U) & 0x3333U);
+                    x = (x + (x >> 4U)) & 0x0f0fU;
+                    return (x + (x >> 8U)) & 0x1fU;
+                }
+
+                inline int64_t decode_zigzag(const uint64_t value) noexcept {
+                    return static_cast<int64_t>((value >> 1U) ^ static_cast<uint64_t>(-static_cast<int64_t>(value & 1U)));
+                }
+
+#ifdef OSMIUM_PBF_VARINT_USE_SSSE3
+                /**
+                 * Shuffle table for decoding varints of one or two bytes
+                 * length with SSSE3 (the "Masked VByte" algorithm by Plaisance,
+                 * Kurz, and Lemire). The table is indexed by the continuation
+                 * bits of the next 8 input bytes. Each entry contains a
+                 * shuffle mask moving the bytes of up to 8 varints into 16 bit
+                 * lanes, the number of varints decoded, and the number of
+                 * input bytes used by them.
+                 */
+                class shuffle_table {
+
+                public:
+
+                    struct entry {
+                        uint8_t shuffle[16];
+                        uint8_t count;
+                        uint8_t length;
+                    };
+
+                private:
+
+                    entry m_entries[256];
+
+                public:
+
+                    shuffle_table() noexcept {
+                        for (unsigned int mask = 0; mask < 256; ++mask) {
+                            entry& e = m_entries[mask];
+                            unsigned int pos = 0;
+                            unsigned int n = 0;
+                            while (pos < 8) {
+                                if ((mask & (1U << pos)) == 0) {
+                                    e.shuffle[n * 2] = static_cast<uint8_t>(pos);
+                                    e.shuffle[n * 2 + 1] = 0x80U; // becomes 0
+                                    ++pos;
+                                } else if (pos < 7 && (mask & (1U << (pos + 1))) == 0) {
+                                    e.shuffle[n * 2] = static_cast<uint8_t>(pos);
+                                    e.shuffle[n * 2 + 1] = static_cast<uint8_t>(pos + 1);
+                                    pos += 2;
+                                } else {
+                                    break;
+                                }
+                                ++n;
+                            }
+                            e.count = static_cast<uint8_t>(n);
+                            e.length = static_cast<uint8_t>(pos);
+                            for (; n < 8; ++n) {
+                                e.shuffle[n * 2] = 0x80U;
+                                e.shuffle[n * 2 + 1] = 0x80U;
+                            }
+                        }
+                    }
+
+                    const entry& operator[](const unsigned int mask) const noexcept {
+                        return m_entries[mask];
+                    }
+
+                }; // class shuffle_table
+
+                inline const shuffle_table& get_shuffle_table() {
+                    static const shuffle_table table;
+                    return table;
+                }
+#endif
+
+#ifdef OSMIUM_PBF_VARINT_USE_SSE2
+                // Decode 16 single-byte varints: zigzag decode the bytes,
+                // sign extend them to 16 bit and build prefix sums.
+                inline uint64_t decode_single_byte_block(const __m128i bytes, uint64_t value, int64_t* out) noexcept {
+                    const __m128i zero = _mm_setzero_si128();
+                    const __m128i half = _mm_and_si128(_mm_srli_epi16(bytes, 1), _mm_set1_epi8(0x7f));
+                    const __m128i sign = _mm_sub_epi8(zero, _mm_and_si128(bytes, _mm_set1_epi8(1)));
+                    const __m128i deltas = _mm_xor_si128(half, sign);
+                    const __m128i extend = _mm_cmpgt_epi8(zero, deltas);
+                    __m128i lo = _mm_unpacklo_epi8(deltas, extend);
+                    __m128i hi = _mm_unpackhi_epi8(deltas, extend);
+                    lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 2));
+                    hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 2));
+                    lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 4));
+                    hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 4));
+                    lo = _mm_add_epi16(lo, _mm_slli_si128(lo, 8));
+                    hi = _mm_add_epi16(hi, _mm_slli_si128(hi, 8));
+
+                    int16_t sums[16];
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums), lo);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + 8), hi);
+
+                    for (int i = 0; i < 8; ++i) {
+                        out[i] = static_cast<int64_t>(value + static_cast<uint64_t>(static_cast<int64_t>(sums[i])));
+                    }
+                    value += static_cast<uint64_t>(static_cast<int64_t>(sums[7]));
+                    for (int i = 8; i < 16; ++i) {
+                        out[i] = static_cast<int64_t>(value + static_cast<uint64_t>(static_cast<int64_t>(sums[i])));
+                    }
+                    return value + static_cast<uint64_t>(static_cast<int64_t>(sums[15]));
+                }
+#endif
+
+#ifdef OSMIUM_PBF_VARINT_USE_SSSE3
+                // Decode the one and two byte varints described by the
+                // shuffle table entry starting at byte offset (0 to 8) in
+                // bytes. Always writes 8 values.
+                inline uint64_t decode_short_varints(const __m128i bytes, const shuffle_table::entry& entry, const unsigned int offset, uint64_t value, int64_t* out) noexcept {
+                    // Move the bytes of each varint into its own 16 bit lane
+                    // and combine the 7 bit groups. Adding the offset to the
+                    // shuffle mask keeps the high bit of the entries for
+                    // unused bytes set, so they still become 0.
+                    const __m128i shuffle = _mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(entry.shuffle)),
+                                                         _mm_set1_epi8(static_cast<char>(offset)));
+                    const __m128i lanes = _mm_shuffle_epi8(bytes, shuffle);
+                    const __m128i values = _mm_or_si128(_mm_and_si128(lanes, _mm_set1_epi16(0x007f)),
+                                                        _mm_and_si128(_mm_srli_epi16(lanes, 1), _mm_set1_epi16(0x3f80)));
+
+                    // zigzag decode, the results are between -2^13 and 2^13-1
+                    const __m128i zero = _mm_setzero_si128();
+                    const __m128i deltas = _mm_xor_si128(_mm_srli_epi16(values, 1),
+                                                         _mm_sub_epi16(zero, _mm_and_si128(values, _mm_set1_epi16(1))));
+
+                    // Sign extend to 32 bit and calculate prefix sums
+                    const __m128i sign = _mm_srai_epi16(deltas, 15);
+                    __m128i lo = _mm_unpacklo_epi16(deltas, sign);
+                    __m128i hi = _mm_unpackhi_epi16(deltas, sign);
+                    lo = _mm_add_epi32(lo, _mm_slli_si128(lo, 4));
+                    hi = _mm_add_epi32(hi, _mm_slli_si128(hi, 4));
+                    lo = _mm_add_epi32(lo, _mm_slli_si128(lo, 8));
+                    hi = _mm_add_epi32(hi, _mm_slli_si128(hi, 8));
+                    hi = _mm_add_epi32(hi, _mm_shuffle_epi32(lo, 0xff));
+
+                    // Sign extend to 64 bit and add the previous value
+                    const __m128i base = _mm_set1_epi64x(static_cast<int64_t>(value));
+                    const __m128i lo_sign = _mm_srai_epi32(lo, 31);
+                    const __m128i hi_sign = _mm_srai_epi32(hi, 31);
+                    __m128i* const dest = reinterpret_cast<__m128i*>(out);
+                    _mm_storeu_si128(dest,     _mm_add_epi64(base, _mm_unpacklo_epi32(lo, lo_sign)));
+                    _mm_storeu_si128(dest + 1, _mm_add_epi64(base, _mm_unpackhi_epi32(lo, lo_sign)));
+                    _mm_storeu_si128(dest + 2, _mm_add_epi64(base, _mm_unpacklo_epi32(hi, hi_sign)));
+                    _mm_storeu_si128(dest + 3, _mm_add_epi64(base, _mm_unpackhi_epi32(hi, hi_sign)));
+
+                    // Unused lanes are zero, so the last lane has the sum of all deltas
+                    return value + static_cast<uint64_t>(static_cast<int64_t>(_mm_cvtsi128_si32(_mm_shuffle_epi32(hi, 0xff))));
+                }
+#endif
+
+            } // namespace varint
+
+            /**
+             * Count the number of varints in the data. Each varint has
+             * exactly one byte with the most significant bit not set, so
+             * we just have to count those.
+             */
+            inline std::size_t count_varints(const char* data, const char* end) noexcept {
+                std::size_t count = 0;
+#ifdef OSMIUM_PBF_VARINT_USE_SSE2
+                while (end - data >= 16) {
+                    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                    count += 16 - varint::popcount16(static_cast<unsigned int>(_mm_movemask_epi8(bytes)));
+                    data += 16;
+                }
+#endif
+                for (; data != end; ++data) {
+                    if ((static_cast<unsigned char>(*data) & 0x80U) == 0) {
+                        ++count;
+                    }
+                }
+                return count;
+            }
+
+            /**
+             * Decode packed zigzag-encoded and delta-encoded signed
+             * varints. This is how the PBF format stores IDs, coordinates,
+             * and way node references ("packed sint64" fields where every
+             * value is the difference to the previous one).
+             *
+             * On x86 CPUs blocks of 16 single-byte varints, which are
+             * very common for IDs, are decoded in one go with SSE2. If
+             * compiled with SSSE3 support (for instance with -mssse3 or
+             * -march=native) runs of varints with one or two bytes, which
+             * is what most small deltas look like, are decoded up to 8 at a
+             * time using a shuffle table. Everything else uses the normal
+             * protozero varint decoder.
+             *
+             * @param data Start of the packed data.
+             * @param end End of the packed data.
+             * @param out Output array. Must have space for at least
+             *            count_varints(data, end) +
+             *            packed_delta_sint64_padding values.
+             * @returns The number of values decoded into out.
+             * @throws protozero::end_of_buffer_exception If the last
+             *         varint is truncated.
+             * @throws protozero::varint_too_long_exception If a varint is
+             *         longer than 10 bytes.
+             */
+            inline std::size_t decode_packed_delta_sint64(const char* data, const char* end, int64_t* out) {
+                int64_t* const out_begin = out;
+
+                // Unsigned to get well-defined wrap-around on corrupt data
+                uint64_t value = 0;
+
+#ifdef OSMIUM_PBF_VARINT_USE_SSE2
+# ifdef OSMIUM_PBF_VARINT_USE_SSSE3
+                const varint::shuffle_table& table = varint::get_shuffle_table();
+# endif
+
+                while (end - data >= 16) {
+                    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                    const auto mask = static_cast<unsigned int>(_mm_movemask_epi8(bytes));
+
+                    if (mask == 0) {
+                        value = varint::decode_single_byte_block(bytes, value, out);
+                        data += 16;
+                        out += 16;
+                        continue;
+                    }
+
+# ifdef OSMIUM_PBF_VARINT_USE_SSSE3
+                    const auto& entry = table[mask & 0xffU];
+                    if (entry.count != 0) {
+                        value = varint::decode_short_varints(bytes, entry, 0, value, out);
+                        out += entry.count;
+
+                        // Decode more varints from the rest of the register
+                        const unsigned int offset = entry.length;
+                        const auto& next_entry = table[(mask >> offset) & 0xffU];
+                        value = varint::decode_short_varints(bytes, next_entry, offset, value, out);
+                        data += offset + next_entry.length;
+                        out += next_entry.count;
+                        continue;
+                    }
+
+                    // first varint is longer than two bytes
+                    value += static_cast<uint64_t>(varint::decode_zigzag(protozero::decode_varint(&data, end)));
+                    *out++ = static_cast<int64_t>(value);
+# else
+                    // Decode (at least) the next 64 bytes one by one, runs
+                    // of single-byte varints are usually much longer.
+                    const char* const block_end = data + std::min(end - data, static_cast<std::ptrdiff_t>(64));
+                    do {
+                        value += static_cast<uint64_t>(varint::decode_zigzag(protozero::decode_varint(&data, end)));
+                        *out++ = static_cast<int64_t>(value);
+                    } while (data < block_end);
+# endif
+                }
+#endif
+
+                while (data != end) {
+                    value += static_cast<uint64_t>(varint::decode_zigzag(protozero::decode_varint(&data, end)));
+                    *out++ = static_cast<int64_t>(value);
+                }
+
+                return static_cast<std::size_t>(out - out_begin);
+            }
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#undef OSMIUM_PBF_VARINT_USE_SSE2
+#undef OSMIUM_PBF_VARINT_USE_SSSE3
+
+#endif // OSMIUM_IO_DETAIL_PBF_VARINT_HPP
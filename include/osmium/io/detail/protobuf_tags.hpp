@@ -63,6 +63,22 @@ namespace osmium {
 
             } // namespace FileFormat
 
+            // Osmium-specific message stored in BlobHeader.indexdata. It
+            // summarizes the contents of a blob so that readers can skip
+            // blobs without decompressing them.
+
+            namespace OsmiumFormat {
+
+                enum class BlobIndex : protozero::pbf_tag_type {
+                    required_string_format   = 1,
+                    required_uint32_entities = 2,
+                    optional_sint64_min_id   = 3,
+                    optional_sint64_max_id   = 4,
+                    optional_HeaderBBox_bbox = 5
+                };
+
+            } // namespace OsmiumFormat
+
             // directly translated from
             // https://github.com/openstreetmap/OSM-binary/blob/master/src/osmformat.proto
 
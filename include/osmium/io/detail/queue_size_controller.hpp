@@ -0,0 +1,128 @@
+#ifndef OSMIUM_IO_DETAIL_QUEUE_SIZE_CONTROLLER_HPP
+#define OSMIUM_IO_DETAIL_QUEUE_SIZE_CONTROLLER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <cstddef>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * Adapts the maximum size of a queue to the observed sizes of
+             * the elements in it, the rates at which they are produced and
+             * consumed, and a memory budget.
+             *
+             * The consumer calls update() for each element it takes from
+             * the queue. If the consumer had to wait for the element, the
+             * producer is too slow and the queue is allowed to grow quickly
+             * to absorb bursts. If the queue was full, the consumer is the
+             * bottleneck and the queue is shrunk slowly, because more
+             * elements waiting in the queue would only use memory. The
+             * size never exceeds what fits into the memory budget given
+             * the average element size seen so far.
+             */
+            class QueueSizeController {
+
+                std::size_t m_memory_limit;
+                std::size_t m_min_size;
+                std::size_t m_size;
+                std::size_t m_average_element_size = 0;
+
+            public:
+
+                /**
+                 * @param memory_limit Memory budget for the elements in
+                 *                     the queue in bytes.
+                 * @param min_size Minimum size of the queue.
+                 */
+                explicit QueueSizeController(const std::size_t memory_limit, const std::size_t min_size = 2) noexcept :
+                    m_memory_limit(memory_limit),
+                    m_min_size(min_size),
+                    m_size(min_size) {
+                }
+
+                /// The current queue size.
+                std::size_t size() const noexcept {
+                    return m_size;
+                }
+
+                /// The moving average of the element size in bytes.
+                std::size_t average_element_size() const noexcept {
+                    return m_average_element_size;
+                }
+
+                /**
+                 * Update the queue size after an element was taken from
+                 * the queue.
+                 *
+                 * @param element_size Size of the element in bytes.
+                 * @param consumer_waited Did the consumer have to wait for
+                 *                        the element, because the queue
+                 *                        was empty or the element wasn't
+                 *                        ready yet?
+                 * @param queue_size Number of elements left in the queue.
+                 * @returns The new queue size.
+                 */
+                std::size_t update(const std::size_t element_size, const bool consumer_waited, const std::size_t queue_size) noexcept {
+                    if (m_average_element_size == 0) {
+                        m_average_element_size = element_size;
+                    } else {
+                        m_average_element_size = (m_average_element_size * 7 + element_size) / 8;
+                    }
+
+                    if (consumer_waited) {
+                        m_size *= 2;
+                    } else if (queue_size + 1 >= m_size) {
+                        --m_size;
+                    }
+
+                    const std::size_t max_size = m_memory_limit / std::max(m_average_element_size, static_cast<std::size_t>(1));
+                    m_size = std::max(m_min_size, std::min(m_size, max_size));
+
+                    return m_size;
+                }
+
+            }; // class QueueSizeController
+
+        } // namespace detail
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_DETAIL_QUEUE_SIZE_CONTROLLER_HPP
@@ -33,10 +33,13 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/io/detail/queue_size_controller.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/thread/queue.hpp>
 
 #include <cassert>
+#include <chrono>
+#include <cstddef>
 #include <exception>
 #include <future>
 #include <string>
@@ -97,10 +100,19 @@ namespace osmium {
                 return !buffer;
             }
 
+            inline std::size_t memory_size(const std::string& data) noexcept {
+                return data.capacity();
+            }
+
+            inline std::size_t memory_size(const osmium::memory::Buffer& buffer) noexcept {
+                return buffer.capacity();
+            }
+
             template <typename T>
             class queue_wrapper {
 
                 future_queue_type<T>& m_queue;
+                QueueSizeController* m_controller = nullptr;
                 bool m_has_reached_end_of_data;
 
             public:
@@ -134,15 +146,34 @@ namespace osmium {
                     return m_has_reached_end_of_data;
                 }
 
+                /**
+                 * Use the controller to adapt the maximum size of the
+                 * queue every time an element is popped from it.
+                 */
+                void set_controller(QueueSizeController* controller) {
+                    m_controller = controller;
+                    if (controller) {
+                        m_queue.set_max_size(controller->size());
+                    }
+                }
+
                 T pop() {
                     T data;
                     if (!m_has_reached_end_of_data) {
+                        bool consumer_waited = m_controller && m_queue.empty();
                         std::future<T> data_future;
                         m_queue.wait_and_pop(data_future);
                         assert(data_future.valid());
+                        // The futures in the queue might not be ready yet,
+                        // in that case the consumer has to wait, too.
+                        if (m_controller && !consumer_waited) {
+                            consumer_waited = data_future.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+                        }
                         data = std::move(data_future.get());
                         if (at_end_of_data(data)) {
                             m_has_reached_end_of_data = true;
+                        } else if (m_controller) {
+                            m_queue.set_max_size(m_controller->update(memory_size(data), consumer_waited, m_queue.size()));
                         }
                     }
                     return data;
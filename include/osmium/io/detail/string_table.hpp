@@ -35,15 +35,18 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/io/detail/pbf.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <iterator>
 #include <list>
+#include <numeric>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -238,6 +241,12 @@ namespace osmium {
                 StringStore m_strings;
                 std::unordered_map<const char*, int32_t, djb2_hash, str_equal> m_index;
                 int32_t m_size = 0;
+                std::size_t m_bytes = 0;
+
+                // How often each string was added. Only used if the table
+                // was created with count_usage set.
+                std::vector<uint32_t> m_counts;
+                bool m_count_usage;
 
             public:
 
@@ -257,16 +266,25 @@ namespace osmium {
                     min_bucket_count = 1
                 };
 
-                explicit StringTable(size_t size = default_stringtable_chunk_size, size_t bucket_count = min_bucket_count) :
+                explicit StringTable(size_t size = default_stringtable_chunk_size, size_t bucket_count = min_bucket_count, bool count_usage = false) :
                     m_strings(size),
-                    m_index(bucket_count) {
+                    m_index(bucket_count),
+                    m_count_usage(count_usage) {
                     m_strings.add("");
+                    if (m_count_usage) {
+                        m_counts.push_back(0);
+                    }
                 }
 
                 int32_t size() const noexcept {
                     return m_size + 1;
                 }
 
+                /// The number of bytes in all strings (including the 0 bytes).
+                std::size_t bytes() const noexcept {
+                    return m_bytes;
+                }
+
                 std::size_t get_bucket_count() const noexcept {
                     return m_index.bucket_count();
                 }
@@ -274,11 +292,18 @@ namespace osmium {
                 int32_t add(const char* s) {
                     const auto f = m_index.find(s);
                     if (f != m_index.end()) {
+                        if (m_count_usage) {
+                            ++m_counts[f->second];
+                        }
                         return f->second;
                     }
 
                     const char* cs = m_strings.add(s);
                     m_index[cs] = ++m_size;
+                    m_bytes += std::strlen(cs) + 1;
+                    if (m_count_usage) {
+                        m_counts.push_back(1);
+                    }
 
                     if (m_size > max_entries) {
                         throw osmium::pbf_error{"string table has too many entries"};
@@ -287,6 +312,26 @@ namespace osmium {
                     return m_size;
                 }
 
+                /**
+                 * Get an order of the strings in this table with the most
+                 * often added strings first, so that they can get the
+                 * smallest indexes. Element n of the result is the current
+                 * index of the string that should get index n. The empty
+                 * string at index 0 always stays there, strings added the
+                 * same number of times keep their relative order.
+                 *
+                 * @pre The table was created with count_usage set.
+                 */
+                std::vector<int32_t> order_by_frequency() const {
+                    assert(m_count_usage);
+                    std::vector<int32_t> order(static_cast<std::size_t>(size()));
+                    std::iota(order.begin(), order.end(), 0);
+                    std::stable_sort(std::next(order.begin()), order.end(), [this](const int32_t a, const int32_t b) {
+                        return m_counts[a] > m_counts[b];
+                    });
+                    return order;
+                }
+
                 StringStore::const_iterator begin() const {
                     return m_strings.begin();
                 }
@@ -35,6 +35,7 @@ DEALINGS IN THE SOFTWARE.
 
 #include <osmium/io/compression.hpp>
 #include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/writer_options.hpp>
 #include <osmium/thread/util.hpp>
 
 #include <exception>
@@ -52,14 +53,34 @@ namespace osmium {
             /**
              * This codes runs in its own thread, getting data from the given
              * queue, (optionally) compressing it, and writing it to the output
-             * file.
+             * file. If an output callback is set instead of a compressor, the
+             * data is handed to the callback.
              */
             class WriteThread {
 
                 queue_wrapper<std::string> m_queue;
                 std::unique_ptr<osmium::io::Compressor> m_compressor;
+                osmium::io::output_callback m_callback;
                 std::promise<std::size_t> m_promise;
                 std::atomic_bool* m_notification;
+                std::size_t m_callback_size = 0;
+
+                void write(std::string&& data) {
+                    if (m_callback) {
+                        m_callback_size += data.size();
+                        m_callback(std::move(data));
+                    } else {
+                        m_compressor->write(data);
+                    }
+                }
+
+                std::size_t close() {
+                    if (m_callback) {
+                        return m_callback_size;
+                    }
+                    m_compressor->close();
+                    return m_compressor->file_size();
+                }
 
             public:
 
@@ -73,6 +94,16 @@ namespace osmium {
                     m_notification(notification) {
                 }
 
+                WriteThread(future_string_queue_type& input_queue,
+                            osmium::io::output_callback&& callback,
+                            std::promise<std::size_t>&& promise,
+                            std::atomic_bool* notification) :
+                    m_queue(input_queue),
+                    m_callback(std::move(callback)),
+                    m_promise(std::move(promise)),
+                    m_notification(notification) {
+                }
+
                 WriteThread(const WriteThread&) = delete;
                 WriteThread& operator=(const WriteThread&) = delete;
 
@@ -86,14 +117,13 @@ namespace osmium {
 
                     try {
                         while (true) {
-                            const std::string data{m_queue.pop()};
+                            std::string data{m_queue.pop()};
                             if (at_end_of_data(data)) {
                                 break;
                             }
-                            m_compressor->write(data);
+                            write(std::move(data));
                         }
-                        m_compressor->close();
-                        m_promise.set_value(m_compressor->file_size());
+                        m_promise.set_value(close());
                     } catch (...) {
                         m_notification->store(true);
                         m_promise.set_exception(std::current_exception());
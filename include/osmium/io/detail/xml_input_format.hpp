@@ -37,6 +37,7 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/builder/osm_object_builder.hpp>
 #include <osmium/io/detail/input_format.hpp>
 #include <osmium/io/detail/queue_util.hpp>
+#include <osmium/io/detail/string_util.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file_format.hpp>
 #include <osmium/io/header.hpp>
@@ -54,11 +55,16 @@ DEALINGS IN THE SOFTWARE.
 #include <osmium/osm/types.hpp>
 #include <osmium/osm/types_from_string.hpp>
 #include <osmium/osm/way.hpp>
+#include <osmium/thread/pool.hpp>
 #include <osmium/thread/util.hpp>
+#include <osmium/util/config.hpp>
 
 #include <expat.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <exception>
 #include <future>
@@ -66,6 +72,7 @@ DEALINGS IN THE SOFTWARE.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace osmium {
 
@@ -81,17 +88,23 @@ namespace osmium {
         XML_Error error_code;
         std::string error_string;
 
-        explicit xml_error(const XML_Parser& parser) :
+        xml_error(uint64_t l, uint64_t col, XML_Error code) :
             io_error(std::string{"XML parsing error at line "}
-                    + std::to_string(XML_GetCurrentLineNumber(parser))
+                    + std::to_string(l)
                     + ", column "
-                    + std::to_string(XML_GetCurrentColumnNumber(parser))
+                    + std::to_string(col)
                     + ": "
-                    + XML_ErrorString(XML_GetErrorCode(parser))),
-            line(XML_GetCurrentLineNumber(parser)),
-            column(XML_GetCurrentColumnNumber(parser)),
-            error_code(XML_GetErrorCode(parser)),
-            error_string(XML_ErrorString(error_code)) {
+                    + XML_ErrorString(code)),
+            line(l),
+            column(col),
+            error_code(code),
+            error_string(XML_ErrorString(code)) {
+        }
+
+        explicit xml_error(const XML_Parser& parser) :
+            xml_error(XML_GetCurrentLineNumber(parser),
+                      XML_GetCurrentColumnNumber(parser),
+                      XML_GetErrorCode(parser)) {
         }
 
         explicit xml_error(const std::string& message) :
@@ -281,6 +294,10 @@ namespace osmium {
                         object.set_visible(false);
                     }
 
+                    return init_object_attributes(object, attrs);
+                }
+
+                static const char* init_object_attributes(osmium::OSMObject& object, const XML_Char** attrs) {
                     osmium::Location location;
                     const char* user = "";
 
@@ -325,7 +342,9 @@ namespace osmium {
                     builder.set_bounds(box);
                 }
 
-                void get_tag(osmium::builder::Builder& builder, const XML_Char** attrs) {
+                static void add_tag(osmium::builder::Builder& builder,
+                                    std::unique_ptr<osmium::builder::TagListBuilder>& tl_builder,
+                                    const XML_Char** attrs) {
                     const char* k = "";
                     const char* v = "";
 
@@ -337,10 +356,52 @@ namespace osmium {
                         }
                     });
 
-                    if (!m_tl_builder) {
-                        m_tl_builder.reset(new osmium::builder::TagListBuilder{builder});
+                    if (!tl_builder) {
+                        tl_builder.reset(new osmium::builder::TagListBuilder{builder});
+                    }
+                    tl_builder->add_tag(k, v);
+                }
+
+                void get_tag(osmium::builder::Builder& builder, const XML_Char** attrs) {
+                    add_tag(builder, m_tl_builder, attrs);
+                }
+
+                static void add_node_ref(osmium::builder::WayNodeListBuilder& builder, const XML_Char** attrs) {
+                    NodeRef nr;
+                    check_attributes(attrs, [&nr](const XML_Char* name, const XML_Char* value) {
+                        if (!std::strcmp(name, "ref")) {
+                            nr.set_ref(osmium::string_to_object_id(value));
+                        } else if (!std::strcmp(name, "lon")) {
+                            nr.location().set_lon(value);
+                        } else if (!std::strcmp(name, "lat")) {
+                            nr.location().set_lat(value);
+                        }
+                    });
+                    builder.add_node_ref(nr);
+                }
+
+                static void add_member(osmium::builder::RelationMemberListBuilder& builder, const XML_Char** attrs) {
+                    item_type type = item_type::undefined;
+                    object_id_type ref = 0;
+                    bool ref_is_set = false;
+                    const char* role = "";
+                    check_attributes(attrs, [&type, &ref, &ref_is_set, &role](const XML_Char* name, const XML_Char* value) {
+                        if (!std::strcmp(name, "type")) {
+                            type = char_to_item_type(value[0]);
+                        } else if (!std::strcmp(name, "ref")) {
+                            ref = osmium::string_to_object_id(value);
+                            ref_is_set = true;
+                        } else if (!std::strcmp(name, "role")) {
+                            role = static_cast<const char*>(value);
+                        }
+                    });
+                    if (type != item_type::node && type != item_type::way && type != item_type::relation) {
+                        throw osmium::xml_error{"Unknown type on relation <member>"};
+                    }
+                    if (!ref_is_set) {
+                        throw osmium::xml_error{"Missing ref on relation <member>"};
                     }
-                    m_tl_builder->add_tag(k, v);
+                    builder.add_member(type, ref, role);
                 }
 
                 void mark_header_as_done() {
@@ -511,17 +572,7 @@ namespace osmium {
                                         m_wnl_builder.reset(new osmium::builder::WayNodeListBuilder{*m_way_builder});
                                     }
 
-                                    NodeRef nr;
-                                    check_attributes(attrs, [&nr](const XML_Char* name, const XML_Char* value) {
-                                        if (!std::strcmp(name, "ref")) {
-                                            nr.set_ref(osmium::string_to_object_id(value));
-                                        } else if (!std::strcmp(name, "lon")) {
-                                            nr.location().set_lon(value);
-                                        } else if (!std::strcmp(name, "lat")) {
-                                            nr.location().set_lat(value);
-                                        }
-                                    });
-                                    m_wnl_builder->add_node_ref(nr);
+                                    add_node_ref(*m_wnl_builder, attrs);
                                 }
                             } else if (!std::strcmp(element, "tag")) {
                                 m_context_stack.push_back(context::tag);
@@ -545,27 +596,7 @@ namespace osmium {
                                         m_rml_builder.reset(new osmium::builder::RelationMemberListBuilder{*m_relation_builder});
                                     }
 
-                                    item_type type = item_type::undefined;
-                                    object_id_type ref = 0;
-                                    bool ref_is_set = false;
-                                    const char* role = "";
-                                    check_attributes(attrs, [&type, &ref, &ref_is_set, &role](const XML_Char* name, const XML_Char* value) {
-                                        if (!std::strcmp(name, "type")) {
-                                            type = char_to_item_type(value[0]);
-                                        } else if (!std::strcmp(name, "ref")) {
-                                            ref = osmium::string_to_object_id(value);
-                                            ref_is_set = true;
-                                        } else if (!std::strcmp(name, "role")) {
-                                            role = static_cast<const char*>(value);
-                                        }
-                                    });
-                                    if (type != item_type::node && type != item_type::way && type != item_type::relation) {
-                                        throw osmium::xml_error{"Unknown type on relation <member>"};
-                                    }
-                                    if (!ref_is_set) {
-                                        throw osmium::xml_error{"Missing ref on relation <member>"};
-                                    }
-                                    m_rml_builder->add_member(type, ref, role);
+                                    add_member(*m_rml_builder, attrs);
                                 }
                             } else if (!std::strcmp(element, "tag")) {
                                 m_context_stack.push_back(context::tag);
@@ -746,6 +777,1027 @@ namespace osmium {
                     }
                 }
 
+                enum {
+                    chunk_size = 1024UL * 1024UL
+                };
+
+                enum class scan_result {
+                    found,
+                    need_more,
+                    unsupported,
+                    stop
+                };
+
+                static bool is_space(const char c) noexcept {
+                    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+                }
+
+                template <std::size_t N>
+                static bool starts_with(const char* begin, const char* end, const char (&str)[N]) noexcept {
+                    return static_cast<std::size_t>(end - begin) >= N - 1 &&
+                           !std::memcmp(begin, str, N - 1);
+                }
+
+                // Find the string str in the data between begin and end and
+                // return a pointer to the first character after it or
+                // nullptr if it wasn't found.
+                template <std::size_t N>
+                static const char* find_after(const char* begin, const char* end, const char (&str)[N]) noexcept {
+                    const char* found = std::search(begin, end, str, str + N - 1);
+                    if (found == end) {
+                        return nullptr;
+                    }
+                    return found + N - 1;
+                }
+
+                // Scan the comment, processing instruction, or CDATA section
+                // starting at p. Sets *after to the first character after it.
+                static scan_result scan_special(const char* p, const char* end, const char** after) noexcept {
+                    if (starts_with(p, end, "<!--")) {
+                        *after = find_after(p + 4, end, "-->");
+                    } else if (starts_with(p, end, "<![CDATA[")) {
+                        *after = find_after(p + 9, end, "]]>");
+                    } else if (starts_with(p, end, "<?")) {
+                        *after = find_after(p + 2, end, "?>");
+                    } else {
+                        return scan_result::unsupported;
+                    }
+                    return *after ? scan_result::found : scan_result::need_more;
+                }
+
+                // Scan the start or end tag starting at p (after the '<')
+                // and set *tag_end to the closing '>'.
+                static scan_result scan_tag(const char* p, const char* end, const char** tag_end) noexcept {
+                    for (; p != end; ++p) {
+                        if (*p == '>') {
+                            *tag_end = p;
+                            return scan_result::found;
+                        }
+                        if (*p == '"' || *p == '\'') {
+                            p = static_cast<const char*>(std::memchr(p + 1, *p, static_cast<std::size_t>(end - p - 1)));
+                            if (!p) {
+                                return scan_result::need_more;
+                            }
+                        } else if (*p == '<') {
+                            return scan_result::unsupported;
+                        }
+                    }
+                    return scan_result::need_more;
+                }
+
+                // Scan the element starting at p (pointing to the '<') and
+                // set *element_end to the first character after it. This
+                // only counts start and end tags, it doesn't check that they
+                // match. That is left to the parser parsing the element.
+                static scan_result scan_element(const char* p, const char* end, const char** element_end) noexcept {
+                    int depth = 0;
+                    while (true) {
+                        const char* after = nullptr;
+                        if (end - p < 2) {
+                            return scan_result::need_more;
+                        }
+                        if (p[1] == '!' || p[1] == '?') {
+                            const auto result = scan_special(p, end, &after);
+                            if (result != scan_result::found) {
+                                return result;
+                            }
+                        } else {
+                            const auto result = scan_tag(p + 1, end, &after);
+                            if (result != scan_result::found) {
+                                return result;
+                            }
+                            if (p[1] == '/') {
+                                --depth;
+                            } else if (after[-1] != '/') {
+                                ++depth;
+                            }
+                            ++after;
+                            if (depth <= 0) {
+                                *element_end = after;
+                                return depth == 0 ? scan_result::found : scan_result::unsupported;
+                            }
+                        }
+                        p = static_cast<const char*>(std::memchr(after, '<', static_cast<std::size_t>(end - after)));
+                        if (!p) {
+                            return scan_result::need_more;
+                        }
+                    }
+                }
+
+                /**
+                 * Fast non-validating parser for chunks of OSM XML data
+                 * containing only complete nodes, ways, relations, and
+                 * changesets (and whitespace and comments between them).
+                 * It only understands the subset of XML used in normal OSM
+                 * files. Whenever it finds something else, parse() returns
+                 * false and the chunk has to be parsed with Expat which will
+                 * either handle it or create the proper error message.
+                 *
+                 * The data is changed while parsing: Attribute values are
+                 * unescaped and null-terminated in place.
+                 */
+                class FastChunkParser {
+
+                    const char* m_data;
+                    const char* m_end;
+                    osmium::memory::Buffer& m_buffer;
+                    osmium::osm_entity_bits::type m_read_types;
+
+                    // Unescaped and null-terminated attribute names and
+                    // values of the last start tag and their offsets. The
+                    // vector is only ever grown, m_attr_size is the part
+                    // of it used for the current start tag.
+                    std::vector<char> m_attr_data;
+                    std::size_t m_attr_size = 0;
+                    std::vector<std::size_t> m_attr_offsets;
+
+                    // Attribute names and values of the last start tag in
+                    // the same format Expat uses: name, value, ..., nullptr.
+                    std::vector<const XML_Char*> m_attrs;
+
+                    // Name of the last start tag (not null-terminated).
+                    const char* m_tag_name = nullptr;
+                    std::size_t m_tag_name_length = 0;
+                    bool m_tag_is_empty = false;
+
+                    static bool is_name_char(const char c) noexcept {
+                        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                               (c >= '0' && c <= '9') || c == '_' || c == ':' ||
+                               c == '-' || c == '.' || static_cast<unsigned char>(c) >= 0x80U;
+                    }
+
+                    template <std::size_t N>
+                    static bool is_name(const char* name, const std::size_t length, const char (&str)[N]) noexcept {
+                        return length == N - 1 && !std::memcmp(name, str, length);
+                    }
+
+                    void skip_space(const char** p) const noexcept {
+                        while (*p != m_end && is_space(**p)) {
+                            ++*p;
+                        }
+                    }
+
+                    // Decode the entity or character reference starting at
+                    // *p (pointing to the '&') and ending before end writing
+                    // the result to *out. This never writes more characters
+                    // than it reads.
+                    static bool decode_reference(const char** p, const char* end, char** out) {
+                        const char* s = *p + 1;
+                        const auto* semicolon = static_cast<const char*>(std::memchr(s, ';', static_cast<std::size_t>(end - s)));
+                        if (!semicolon) {
+                            return false;
+                        }
+                        const auto length = static_cast<std::size_t>(semicolon - s);
+                        if (length > 1 && s[0] == '#') {
+                            uint32_t value = 0;
+                            if (s[1] == 'x') {
+                                if (length < 3 || length > 8) {
+                                    return false;
+                                }
+                                for (const char* c = s + 2; c != semicolon; ++c) {
+                                    value <<= 4U;
+                                    if (*c >= '0' && *c <= '9') {
+                                        value += static_cast<uint32_t>(*c - '0');
+                                    } else if (*c >= 'a' && *c <= 'f') {
+                                        value += static_cast<uint32_t>(*c - 'a' + 10);
+                                    } else if (*c >= 'A' && *c <= 'F') {
+                                        value += static_cast<uint32_t>(*c - 'A' + 10);
+                                    } else {
+                                        return false;
+                                    }
+                                }
+                            } else {
+                                if (length > 8) {
+                                    return false;
+                                }
+                                for (const char* c = s + 1; c != semicolon; ++c) {
+                                    if (*c < '0' || *c > '9') {
+                                        return false;
+                                    }
+                                    value = value * 10 + static_cast<uint32_t>(*c - '0');
+                                }
+                            }
+                            // Leave everything that isn't an allowed XML
+                            // character to Expat to complain about.
+                            if ((value < 0x20U && value != 0x09U && value != 0x0aU && value != 0x0dU) ||
+                                (value >= 0xd800U && value <= 0xdfffU) ||
+                                value == 0xfffeU || value == 0xffffU || value > 0x10ffffU) {
+                                return false;
+                            }
+                            *out = append_codepoint_as_utf8(value, *out);
+                        } else if (length == 2 && s[0] == 'l' && s[1] == 't') {
+                            *(*out)++ = '<';
+                        } else if (length == 2 && s[0] == 'g' && s[1] == 't') {
+                            *(*out)++ = '>';
+                        } else if (length == 3 && !std::memcmp(s, "amp", 3)) {
+                            *(*out)++ = '&';
+                        } else if (length == 4 && !std::memcmp(s, "quot", 4)) {
+                            *(*out)++ = '"';
+                        } else if (length == 4 && !std::memcmp(s, "apos", 4)) {
+                            *(*out)++ = '\'';
+                        } else {
+                            return false;
+                        }
+                        *p += length + 2;
+                        return true;
+                    }
+
+                    // Parse the start tag at *p (pointing to the '<').
+                    bool parse_start_tag(const char** p) {
+                        const char* s = *p + 1;
+                        m_tag_name = s;
+                        while (s != m_end && is_name_char(*s)) {
+                            ++s;
+                        }
+                        m_tag_name_length = static_cast<std::size_t>(s - m_tag_name);
+                        if (m_tag_name_length == 0) {
+                            return false;
+                        }
+
+                        m_attr_size = 0;
+                        m_attr_offsets.clear();
+                        while (true) {
+                            const char* before_space = s;
+                            skip_space(&s);
+                            if (s == m_end) {
+                                return false;
+                            }
+                            if (*s == '>') {
+                                m_tag_is_empty = false;
+                                ++s;
+                                break;
+                            }
+                            if (*s == '/') {
+                                if (s + 1 == m_end || s[1] != '>') {
+                                    return false;
+                                }
+                                m_tag_is_empty = true;
+                                s += 2;
+                                break;
+                            }
+                            if (s == before_space) {
+                                return false;
+                            }
+
+                            const char* name = s;
+                            while (s != m_end && is_name_char(*s)) {
+                                ++s;
+                            }
+                            const auto name_length = static_cast<std::size_t>(s - name);
+                            if (name_length == 0) {
+                                return false;
+                            }
+                            skip_space(&s);
+                            if (s == m_end || *s != '=') {
+                                return false;
+                            }
+                            ++s;
+                            skip_space(&s);
+                            if (s == m_end || (*s != '"' && *s != '\'')) {
+                                return false;
+                            }
+                            const char quote = *s++;
+                            const auto* value_end = static_cast<const char*>(std::memchr(s, quote, static_cast<std::size_t>(m_end - s)));
+                            if (!value_end) {
+                                return false;
+                            }
+
+                            // The unescaped value is never longer than the
+                            // escaped one.
+                            const std::size_t name_offset = m_attr_size;
+                            const std::size_t value_offset = name_offset + name_length + 1;
+                            const std::size_t max_size = value_offset + static_cast<std::size_t>(value_end - s) + 1;
+                            if (max_size > m_attr_data.size()) {
+                                m_attr_data.resize(std::max(max_size, 2 * m_attr_data.size()));
+                            }
+                            std::memcpy(&m_attr_data[name_offset], name, name_length);
+                            m_attr_data[value_offset - 1] = '\0';
+
+                            // Unescape value and normalize whitespace like
+                            // any XML parser has to.
+                            char* out = &m_attr_data[value_offset];
+                            while (s != value_end) {
+                                if (*s == '<') {
+                                    return false;
+                                }
+                                if (*s == '&') {
+                                    if (!decode_reference(&s, value_end, &out)) {
+                                        return false;
+                                    }
+                                } else if (*s == '\r') {
+                                    *out++ = ' ';
+                                    ++s;
+                                    if (s != value_end && *s == '\n') {
+                                        ++s;
+                                    }
+                                } else if (*s == '\t' || *s == '\n') {
+                                    *out++ = ' ';
+                                    ++s;
+                                } else {
+                                    *out++ = *s++;
+                                }
+                            }
+                            *out++ = '\0';
+                            m_attr_size = static_cast<std::size_t>(out - m_attr_data.data());
+                            ++s;
+
+                            for (std::size_t i = 0; i < m_attr_offsets.size(); i += 2) {
+                                if (!std::strcmp(m_attr_data.data() + m_attr_offsets[i], m_attr_data.data() + name_offset)) {
+                                    return false;
+                                }
+                            }
+                            m_attr_offsets.push_back(name_offset);
+                            m_attr_offsets.push_back(value_offset);
+                        }
+
+                        m_attrs.clear();
+                        for (const auto offset : m_attr_offsets) {
+                            m_attrs.push_back(m_attr_data.data() + offset);
+                        }
+                        m_attrs.push_back(nullptr);
+
+                        *p = s;
+                        return true;
+                    }
+
+                    // Find the next start tag inside the element with the
+                    // given name and parse it. Returns 1 if a start tag was
+                    // found, 0 if the end tag of the element was found and
+                    // consumed, and -1 if something else was found.
+                    int next_tag(const char** p, const char* name, const std::size_t name_length) {
+                        while (true) {
+                            const char* s = static_cast<const char*>(std::memchr(*p, '<', static_cast<std::size_t>(m_end - *p)));
+                            if (!s || s + 1 == m_end) {
+                                return -1;
+                            }
+                            if (s[1] == '/') {
+                                s += 2;
+                                if (static_cast<std::size_t>(m_end - s) < name_length ||
+                                    std::memcmp(s, name, name_length) != 0) {
+                                    return -1;
+                                }
+                                s += name_length;
+                                skip_space(&s);
+                                if (s == m_end || *s != '>') {
+                                    return -1;
+                                }
+                                *p = s + 1;
+                                return 0;
+                            }
+                            if (s[1] == '!' || s[1] == '?') {
+                                const char* after = nullptr;
+                                if (scan_special(s, m_end, &after) != scan_result::found) {
+                                    return -1;
+                                }
+                                *p = after;
+                                continue;
+                            }
+                            *p = s;
+                            return parse_start_tag(p) ? 1 : -1;
+                        }
+                    }
+
+                    // Parse the content of an element up to and including
+                    // its end tag. The function func is called for each child
+                    // element after its start tag was parsed. It must return
+                    // false if the child is not allowed. Children can not
+                    // have any children themselves.
+                    template <typename TFunc>
+                    bool parse_content(const char** p, const char* name, const std::size_t name_length, TFunc&& func) {
+                        while (true) {
+                            const int result = next_tag(p, name, name_length);
+                            if (result <= 0) {
+                                return result == 0;
+                            }
+                            if (!func(m_tag_name, m_tag_name_length)) {
+                                return false;
+                            }
+                            if (!m_tag_is_empty && next_tag(p, m_tag_name, m_tag_name_length) != 0) {
+                                return false;
+                            }
+                        }
+                    }
+
+                    static bool is_allowed_child(osmium::osm_entity_bits::type type, const char* name, const std::size_t length) noexcept {
+                        if (is_name(name, length, "tag")) {
+                            return true;
+                        }
+                        switch (type) {
+                            case osmium::osm_entity_bits::way:
+                                return is_name(name, length, "nd") || is_name(name, length, "bbox") || is_name(name, length, "bounds");
+                            case osmium::osm_entity_bits::relation:
+                                return is_name(name, length, "member") || is_name(name, length, "bbox") || is_name(name, length, "bounds");
+                            default:
+                                break;
+                        }
+                        return false;
+                    }
+
+                    // Check the content of an object we are not interested
+                    // in up to and including its end tag.
+                    bool skip_object(const char** p, osmium::osm_entity_bits::type type, const char* name, const std::size_t name_length) {
+                        return parse_content(p, name, name_length, [&](const char* child_name, const std::size_t length) -> bool {
+                            return is_allowed_child(type, child_name, length);
+                        });
+                    }
+
+                    bool parse_node(const char** p) {
+                        {
+                            osmium::builder::NodeBuilder builder{m_buffer};
+                            builder.set_user(init_object_attributes(builder.object(), m_attrs.data()));
+                            if (!m_tag_is_empty) {
+                                std::unique_ptr<osmium::builder::TagListBuilder> tl_builder;
+                                const bool okay = parse_content(p, "node", 4, [&](const char* name, const std::size_t length) -> bool {
+                                    if (is_name(name, length, "tag")) {
+                                        add_tag(builder, tl_builder, m_attrs.data());
+                                        return true;
+                                    }
+                                    return false;
+                                });
+                                if (!okay) {
+                                    return false;
+                                }
+                            }
+                        }
+                        m_buffer.commit();
+                        return true;
+                    }
+
+                    bool parse_way(const char** p) {
+                        {
+                            osmium::builder::WayBuilder builder{m_buffer};
+                            builder.set_user(init_object_attributes(builder.object(), m_attrs.data()));
+                            if (!m_tag_is_empty) {
+                                std::unique_ptr<osmium::builder::TagListBuilder> tl_builder;
+                                std::unique_ptr<osmium::builder::WayNodeListBuilder> wnl_builder;
+                                const bool okay = parse_content(p, "way", 3, [&](const char* name, const std::size_t length) -> bool {
+                                    if (is_name(name, length, "nd")) {
+                                        tl_builder.reset();
+                                        if (!wnl_builder) {
+                                            wnl_builder.reset(new osmium::builder::WayNodeListBuilder{builder});
+                                        }
+                                        add_node_ref(*wnl_builder, m_attrs.data());
+                                        return true;
+                                    }
+                                    if (is_name(name, length, "tag")) {
+                                        wnl_builder.reset();
+                                        add_tag(builder, tl_builder, m_attrs.data());
+                                        return true;
+                                    }
+                                    return is_name(name, length, "bbox") || is_name(name, length, "bounds");
+                                });
+                                if (!okay) {
+                                    return false;
+                                }
+                            }
+                        }
+                        m_buffer.commit();
+                        return true;
+                    }
+
+                    bool parse_relation(const char** p) {
+                        {
+                            osmium::builder::RelationBuilder builder{m_buffer};
+                            builder.set_user(init_object_attributes(builder.object(), m_attrs.data()));
+                            if (!m_tag_is_empty) {
+                                std::unique_ptr<osmium::builder::TagListBuilder> tl_builder;
+                                std::unique_ptr<osmium::builder::RelationMemberListBuilder> rml_builder;
+                                const bool okay = parse_content(p, "relation", 8, [&](const char* name, const std::size_t length) -> bool {
+                                    if (is_name(name, length, "member")) {
+                                        tl_builder.reset();
+                                        if (!rml_builder) {
+                                            rml_builder.reset(new osmium::builder::RelationMemberListBuilder{builder});
+                                        }
+                                        add_member(*rml_builder, m_attrs.data());
+                                        return true;
+                                    }
+                                    if (is_name(name, length, "tag")) {
+                                        rml_builder.reset();
+                                        add_tag(builder, tl_builder, m_attrs.data());
+                                        return true;
+                                    }
+                                    return is_name(name, length, "bbox") || is_name(name, length, "bounds");
+                                });
+                                if (!okay) {
+                                    return false;
+                                }
+                            }
+                        }
+                        m_buffer.commit();
+                        return true;
+                    }
+
+                    // Changesets with discussions are left to Expat.
+                    bool parse_changeset(const char** p) {
+                        {
+                            osmium::builder::ChangesetBuilder builder{m_buffer};
+                            init_changeset(builder, m_attrs.data());
+                            if (!m_tag_is_empty) {
+                                std::unique_ptr<osmium::builder::TagListBuilder> tl_builder;
+                                const bool okay = parse_content(p, "changeset", 9, [&](const char* name, const std::size_t length) -> bool {
+                                    if (is_name(name, length, "tag")) {
+                                        add_tag(builder, tl_builder, m_attrs.data());
+                                        return true;
+                                    }
+                                    return false;
+                                });
+                                if (!okay) {
+                                    return false;
+                                }
+                            }
+                        }
+                        m_buffer.commit();
+                        return true;
+                    }
+
+                    bool parse_object(const char** p) {
+                        const char* name = m_tag_name;
+                        const std::size_t length = m_tag_name_length;
+
+                        osmium::osm_entity_bits::type type = osmium::osm_entity_bits::nothing;
+                        if (is_name(name, length, "node")) {
+                            type = osmium::osm_entity_bits::node;
+                        } else if (is_name(name, length, "way")) {
+                            type = osmium::osm_entity_bits::way;
+                        } else if (is_name(name, length, "relation")) {
+                            type = osmium::osm_entity_bits::relation;
+                        } else if (is_name(name, length, "changeset")) {
+                            type = osmium::osm_entity_bits::changeset;
+                        } else {
+                            return false;
+                        }
+
+                        if (!(m_read_types & type)) {
+                            return m_tag_is_empty || skip_object(p, type, name, length);
+                        }
+
+                        switch (type) {
+                            case osmium::osm_entity_bits::node:
+                                return parse_node(p);
+                            case osmium::osm_entity_bits::way:
+                                return parse_way(p);
+                            case osmium::osm_entity_bits::relation:
+                                return parse_relation(p);
+                            default:
+                                break;
+                        }
+                        return parse_changeset(p);
+                    }
+
+                public:
+
+                    FastChunkParser(const char* data, const char* end, osmium::memory::Buffer& buffer, osmium::osm_entity_bits::type read_types) :
+                        m_data(data),
+                        m_end(end),
+                        m_buffer(buffer),
+                        m_read_types(read_types) {
+                    }
+
+                    bool parse() {
+                        const char* p = m_data;
+                        while (true) {
+                            p = static_cast<const char*>(std::memchr(p, '<', static_cast<std::size_t>(m_end - p)));
+                            if (!p) {
+                                return true;
+                            }
+                            if (p + 1 != m_end && (p[1] == '!' || p[1] == '?')) {
+                                const char* after = nullptr;
+                                if (scan_special(p, m_end, &after) != scan_result::found) {
+                                    return false;
+                                }
+                                p = after;
+                                continue;
+                            }
+                            if (!parse_start_tag(&p) || !parse_object(&p)) {
+                                return false;
+                            }
+                        }
+                    }
+
+                }; // class FastChunkParser
+
+                /**
+                 * Parses a chunk of XML data containing complete top-level
+                 * OSM objects into a buffer. Objects of this class are
+                 * submitted to the thread pool. The chunk is parsed with
+                 * the FastChunkParser if possible and with Expat otherwise.
+                 */
+                class ChunkParser {
+
+                    std::shared_ptr<std::string> m_input;
+                    osmium::thread::Pool* m_pool;
+                    osmium::osm_entity_bits::type m_read_types;
+
+                    // Position of the chunk in the input for error messages.
+                    uint64_t m_line;
+                    uint64_t m_column;
+
+                    osmium::memory::Buffer parse_with_expat() const {
+                        static const char prefix[] = "<osm version=\"0.6\">";
+
+                        future_string_queue_type input_queue;
+                        future_buffer_queue_type output_queue;
+                        std::promise<osmium::io::Header> header_promise;
+                        parser_arguments args{*m_pool,
+                                              -1,
+                                              input_queue,
+                                              output_queue,
+                                              header_promise,
+                                              nullptr,
+                                              m_read_types,
+                                              osmium::Box{},
+                                              osmium::io::read_tags_filter{},
+                                              osmium::io::read_meta::yes,
+                                              object_parts{},
+                                              osmium::io::buffers_type::any,
+                                              false};
+
+                        add_to_queue(input_queue, std::string{prefix} + *m_input + "</osm>");
+                        add_end_of_data_to_queue(input_queue);
+
+                        XMLParser parser{args, false};
+                        parser.parse();
+
+                        osmium::memory::Buffer result{m_input->size() / 2, osmium::memory::Buffer::auto_grow::yes};
+                        queue_wrapper<osmium::memory::Buffer> output{output_queue};
+                        try {
+                            while (true) {
+                                const auto buffer = output.pop();
+                                if (at_end_of_data(buffer)) {
+                                    break;
+                                }
+                                result.add_buffer(buffer);
+                                result.commit();
+                            }
+                        } catch (const osmium::xml_error& e) {
+                            if (e.line == 0) {
+                                throw;
+                            }
+                            // Translate position of error to the position
+                            // in the whole input.
+                            const uint64_t prefix_length = sizeof(prefix) - 1;
+                            const uint64_t column = (e.line == 1 && e.column >= prefix_length) ? m_column + e.column - prefix_length : e.column;
+                            throw osmium::xml_error{m_line + e.line - 1, column, e.error_code};
+                        }
+
+                        return result;
+                    }
+
+                public:
+
+                    ChunkParser(std::string&& input, osmium::thread::Pool& pool, osmium::osm_entity_bits::type read_types, uint64_t line, uint64_t column) :
+                        m_input(std::make_shared<std::string>(std::move(input))),
+                        m_pool(&pool),
+                        m_read_types(read_types),
+                        m_line(line),
+                        m_column(column) {
+                    }
+
+                    osmium::memory::Buffer operator()() const {
+                        {
+                            const std::string& data = *m_input;
+                            osmium::memory::Buffer buffer{data.size() / 2, osmium::memory::Buffer::auto_grow::yes};
+                            FastChunkParser parser{data.data(), data.data() + data.size(), buffer, m_read_types};
+                            bool okay = false;
+                            try {
+                                okay = parser.parse();
+                            } catch (...) {
+                                // Expat will find the same problem again
+                                // and report it properly.
+                            }
+                            if (okay) {
+                                return buffer;
+                            }
+                        }
+                        return parse_with_expat();
+                    }
+
+                }; // class ChunkParser
+
+                /**
+                 * Splits the input into chunks of complete top-level OSM
+                 * objects which are parsed on the thread pool. Everything
+                 * else (the XML declaration, the <osm> element, <bounds>,
+                 * etc.) is fed to Expat on this thread. Newlines are fed
+                 * to Expat in place of the chunks so that the line numbers
+                 * in its error messages are still correct.
+                 *
+                 * Only data with an <osm> root element in UTF-8 encoding is
+                 * split. When anything unusual is found, the splitting stops
+                 * and the rest of the data is parsed by Expat as usual.
+                 */
+                class ChunkSplitter {
+
+                    XMLParser& m_parser;
+                    ExpatXMLParser& m_expat;
+
+                    std::string m_data;
+
+                    // Data not split into chunks that is waiting to be fed
+                    // to Expat.
+                    std::string m_skeleton;
+
+                    // Everything in m_data before this position is either
+                    // in a chunk or in the skeleton.
+                    std::size_t m_done = 0;
+
+                    // Current scanning position in m_data.
+                    std::size_t m_pos = 0;
+
+                    // The current chunk (if m_chunk_open is set).
+                    std::size_t m_chunk_begin = 0;
+                    std::size_t m_chunk_end = 0;
+                    bool m_chunk_open = false;
+                    osmium::item_type m_chunk_type = osmium::item_type::undefined;
+
+                    // Line numbers and columns are counted in the data
+                    // up to m_counted. m_line_begin is the position in the
+                    // whole input where the current line starts.
+                    uint64_t m_line = 1;
+                    uint64_t m_line_begin = 0;
+                    uint64_t m_erased = 0;
+                    std::size_t m_counted = 0;
+
+                    void count_lines_to(const std::size_t pos) noexcept {
+                        const char* const begin = m_data.data();
+                        const char* s = begin + m_counted;
+                        const char* const end = begin + pos;
+                        while ((s = static_cast<const char*>(std::memchr(s, '\n', static_cast<std::size_t>(end - s))))) {
+                            ++s;
+                            ++m_line;
+                            m_line_begin = m_erased + static_cast<uint64_t>(s - begin);
+                        }
+                        m_counted = pos;
+                    }
+
+                    uint64_t column(const std::size_t pos) const noexcept {
+                        return m_erased + pos - m_line_begin;
+                    }
+
+                    bool read_more_input() {
+                        if (m_parser.input_done()) {
+                            return false;
+                        }
+                        count_lines_to(m_done);
+                        m_data.erase(0, m_done);
+                        m_erased += m_done;
+                        m_pos -= m_done;
+                        m_chunk_begin -= m_chunk_open ? m_done : m_chunk_begin;
+                        m_chunk_end -= m_chunk_open ? m_done : m_chunk_end;
+                        m_counted = 0;
+                        m_done = 0;
+                        m_data.append(m_parser.get_input());
+                        return true;
+                    }
+
+                    void add_to_skeleton(const std::size_t pos) {
+                        m_skeleton.append(m_data, m_done, pos - m_done);
+                        m_done = pos;
+                    }
+
+                    bool send_chunk() {
+                        count_lines_to(m_chunk_begin);
+                        const uint64_t line = m_line;
+                        const uint64_t col = column(m_chunk_begin);
+                        count_lines_to(m_chunk_end);
+                        const auto lines = m_line - line;
+                        m_skeleton.append(static_cast<std::size_t>(lines), '\n');
+                        if (lines > 0) {
+                            m_skeleton.append(static_cast<std::size_t>(column(m_chunk_end)), ' ');
+                        }
+                        m_done = m_chunk_end;
+                        m_chunk_open = false;
+
+                        // Expat has to see everything before the chunk,
+                        // because the header might be in there.
+                        m_expat(m_skeleton, false);
+                        m_skeleton.clear();
+                        m_parser.mark_header_as_done();
+                        if (m_parser.read_types() == osmium::osm_entity_bits::nothing) {
+                            return false;
+                        }
+
+                        m_parser.send_to_output_queue(m_parser.get_pool().submit(
+                            ChunkParser{m_data.substr(m_chunk_begin, m_chunk_end - m_chunk_begin),
+                                        m_parser.get_pool(),
+                                        m_parser.read_types(),
+                                        line,
+                                        col}));
+                        return true;
+                    }
+
+                    // Check that the encoding given in the XML declaration
+                    // (between begin and end) is UTF-8 (or none is given).
+                    static bool is_utf8_declaration(const char* begin, const char* end) noexcept {
+                        const char* s = find_after(begin, end, "encoding");
+                        if (!s) {
+                            return true;
+                        }
+                        while (s != end && (is_space(*s) || *s == '=')) {
+                            ++s;
+                        }
+                        if (s == end || (*s != '"' && *s != '\'')) {
+                            return false;
+                        }
+                        const char quote = *s++;
+                        const char* utf8 = "utf-8";
+                        for (; *utf8; ++s, ++utf8) {
+                            if (s == end || (*s | 0x20) != *utf8) {
+                                return false;
+                            }
+                        }
+                        return s != end && *s == quote;
+                    }
+
+                    scan_result scan_prolog() {
+                        const char* const begin = m_data.data();
+                        const char* const end = begin + m_data.size();
+                        const char* s = begin;
+                        if (starts_with(s, end, "\xef\xbb\xbf")) { // UTF-8 BOM
+                            s += 3;
+                        }
+                        while (true) {
+                            while (s != end && is_space(*s)) {
+                                ++s;
+                            }
+                            if (end - s < 6) {
+                                return scan_result::need_more;
+                            }
+                            if (*s != '<') {
+                                return scan_result::unsupported;
+                            }
+                            const char* after = nullptr;
+                            if (s[1] == '!' || s[1] == '?') {
+                                if (starts_with(s, end, "<!D")) { // DOCTYPE
+                                    return scan_result::unsupported;
+                                }
+                                const auto result = scan_special(s, end, &after);
+                                if (result != scan_result::found) {
+                                    return result;
+                                }
+                                if (starts_with(s, end, "<?xml") && !is_utf8_declaration(s, after)) {
+                                    return scan_result::unsupported;
+                                }
+                                s = after;
+                                continue;
+                            }
+                            if (!starts_with(s, end, "<osm") || !(is_space(s[4]) || s[4] == '>')) {
+                                return scan_result::unsupported;
+                            }
+                            const auto result = scan_tag(s + 1, end, &after);
+                            if (result != scan_result::found) {
+                                return result;
+                            }
+                            if (after[-1] == '/') {
+                                return scan_result::unsupported;
+                            }
+                            m_pos = static_cast<std::size_t>(after + 1 - begin);
+                            return scan_result::found;
+                        }
+                    }
+
+                    static osmium::item_type object_type(const char* p, const char* end) noexcept {
+                        static const char* const names[] = {"node", "way", "relation", "changeset"};
+                        static const osmium::item_type types[] = {
+                            osmium::item_type::node,
+                            osmium::item_type::way,
+                            osmium::item_type::relation,
+                            osmium::item_type::changeset
+                        };
+                        for (std::size_t i = 0; i < 4; ++i) {
+                            const auto length = std::strlen(names[i]);
+                            if (static_cast<std::size_t>(end - p) > length &&
+                                !std::memcmp(p, names[i], length) &&
+                                (is_space(p[length]) || p[length] == '>' || p[length] == '/')) {
+                                return types[i];
+                            }
+                        }
+                        return osmium::item_type::undefined;
+                    }
+
+                    // Scan the next thing at the top level of the document.
+                    scan_result scan_next() {
+                        const char* const begin = m_data.data();
+                        const char* const end = begin + m_data.size();
+                        const char* s = static_cast<const char*>(std::memchr(begin + m_pos, '<', m_data.size() - m_pos));
+                        if (!s) {
+                            m_pos = m_data.size();
+                            return scan_result::need_more;
+                        }
+                        m_pos = static_cast<std::size_t>(s - begin);
+                        if (end - s < 12) {
+                            return scan_result::need_more;
+                        }
+                        if (s[1] == '/') { // end of <osm> element
+                            return scan_result::unsupported;
+                        }
+
+                        const char* after = nullptr;
+                        if (s[1] == '!' || s[1] == '?') {
+                            const auto result = scan_special(s, end, &after);
+                            if (result == scan_result::found) {
+                                m_pos = static_cast<std::size_t>(after - begin);
+                            }
+                            return result;
+                        }
+
+                        const auto result = scan_element(s, end, &after);
+                        if (result != scan_result::found) {
+                            return result;
+                        }
+                        const auto element_end = static_cast<std::size_t>(after - begin);
+
+                        const auto type = object_type(s + 1, end);
+                        if (type == osmium::item_type::undefined) {
+                            // Other elements (such as <bounds>) are left to
+                            // Expat.
+                            if (m_chunk_open && !send_chunk()) {
+                                return scan_result::stop;
+                            }
+                            m_pos = element_end;
+                            return scan_result::found;
+                        }
+
+                        const bool wanted = (m_parser.read_types() & osmium::osm_entity_bits::from_item_type(type)) != 0;
+                        if (m_chunk_open) {
+                            const bool split_by_type = m_parser.buffers_kind() != osmium::io::buffers_type::any;
+                            if (m_chunk_end - m_chunk_begin >= chunk_size ||
+                                (split_by_type && wanted && m_chunk_type != osmium::item_type::undefined && type != m_chunk_type)) {
+                                if (!send_chunk()) {
+                                    return scan_result::stop;
+                                }
+                            }
+                        }
+
+                        if (!m_chunk_open) {
+                            add_to_skeleton(m_pos);
+                            m_chunk_begin = m_pos;
+                            m_chunk_open = true;
+                            m_chunk_type = osmium::item_type::undefined;
+                        }
+                        if (wanted) {
+                            m_chunk_type = type;
+                        }
+                        m_chunk_end = element_end;
+                        m_pos = element_end;
+
+                        return scan_result::found;
+                    }
+
+                    // Send the current chunk (if any) and feed everything
+                    // else to Expat. Returns false if parsing should stop.
+                    bool finish() {
+                        if (m_chunk_open && !send_chunk()) {
+                            return false;
+                        }
+                        add_to_skeleton(m_data.size());
+                        m_expat(m_skeleton, m_parser.input_done());
+                        m_skeleton.clear();
+                        m_data.clear();
+                        return true;
+                    }
+
+                public:
+
+                    ChunkSplitter(XMLParser& parser, ExpatXMLParser& expat) :
+                        m_parser(parser),
+                        m_expat(expat) {
+                    }
+
+                    /**
+                     * Split input as long as possible. Returns false if
+                     * parsing should stop, true if the rest of the input
+                     * (if any) has to be parsed by Expat.
+                     */
+                    bool operator()() {
+                        scan_result result;
+                        while ((result = scan_prolog()) != scan_result::found) {
+                            if (result == scan_result::unsupported || !read_more_input()) {
+                                return finish();
+                            }
+                        }
+
+                        while (true) {
+                            result = scan_next();
+                            if (result == scan_result::stop) {
+                                return false;
+                            }
+                            if (result == scan_result::unsupported ||
+                                (result == scan_result::need_more && !read_more_input())) {
+                                return finish();
+                            }
+                        }
+                    }
+
+                }; // class ChunkSplitter
+
+                bool m_use_pool_threads = true;
+
+                XMLParser(parser_arguments& args, bool use_pool_threads) :
+                    ParserWithBuffer(args),
+                    m_use_pool_threads(use_pool_threads) {
+                }
+
             public:
 
                 explicit XMLParser(parser_arguments& args) :
@@ -766,7 +1818,13 @@ namespace osmium {
                     ExpatXMLParser parser{this};
                     m_expat_xml_parser = &parser;
 
-                    while (!input_done()) {
+                    bool go_on = true;
+                    if (m_use_pool_threads && osmium::config::use_pool_threads_for_xml_parsing()) {
+                        ChunkSplitter splitter{*this, parser};
+                        go_on = splitter();
+                    }
+
+                    while (go_on && !input_done()) {
                         const std::string data{get_input()};
                         parser(data, input_done());
                         if (read_types() == osmium::osm_entity_bits::nothing && header_is_done()) {
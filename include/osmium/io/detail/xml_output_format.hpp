@@ -96,11 +96,11 @@ namespace osmium {
                     out += ' ';
                     out += lat;
                     out += "=\"";
-                    osmium::detail::append_location_coordinate_to_string(std::back_inserter(out), location.y());
+                    osmium::detail::append_coordinate_to_string(out, location.y());
                     out += "\" ";
                     out += lon;
                     out += "=\"";
-                    osmium::detail::append_location_coordinate_to_string(std::back_inserter(out), location.x());
+                    osmium::detail::append_coordinate_to_string(out, location.x());
                     out += "\"";
                 }
 
@@ -120,6 +120,8 @@ namespace osmium {
 
                 xml_output_options m_options;
 
+                osmium::detail::iso_timestamp_formatter m_timestamp_formatter;
+
                 void write_spaces(int num) {
                     for (; num != 0; --num) {
                         *m_out += ' ';
@@ -152,7 +154,7 @@ namespace osmium {
 
                     if (m_options.add_metadata.timestamp() && object.timestamp()) {
                         *m_out += " timestamp=\"";
-                        *m_out += object.timestamp().to_iso_all();
+                        m_timestamp_formatter.append(*m_out, uint32_t(object.timestamp()));
                         *m_out += "\"";
                     }
 
@@ -198,7 +200,7 @@ namespace osmium {
                         *m_out += " user=\"";
                         append_xml_encoded_string(*m_out, comment.user());
                         *m_out += "\" date=\"";
-                        *m_out += comment.date().to_iso_all();
+                        m_timestamp_formatter.append(*m_out, uint32_t(comment.date()));
                         *m_out += "\">\n";
                         *m_out += "    <text>";
                         append_xml_encoded_string(*m_out, comment.text());
@@ -372,13 +374,13 @@ namespace osmium {
 
                     if (changeset.created_at()) {
                         *m_out += " created_at=\"";
-                        *m_out += changeset.created_at().to_iso();
+                        m_timestamp_formatter.append(*m_out, uint32_t(changeset.created_at()));
                         *m_out += "\"";
                     }
 
                     if (changeset.closed_at()) {
                         *m_out += " closed_at=\"";
-                        *m_out += changeset.closed_at().to_iso();
+                        m_timestamp_formatter.append(*m_out, uint32_t(changeset.closed_at()));
                         *m_out += "\" open=\"false\"";
                     } else {
                         *m_out += " open=\"true\"";
@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <cstddef>
 #include <iosfwd>
 
 namespace osmium {
@@ -57,11 +58,82 @@ namespace osmium {
             yes = 1
         };
 
+        /**
+         * Read the tags of OSM objects?
+         */
+        enum class read_tags : bool {
+            no  = false,
+            yes = true
+        };
+
+        /**
+         * Read the node references (and locations) of ways?
+         */
+        enum class read_way_nodes : bool {
+            no  = false,
+            yes = true
+        };
+
+        /**
+         * Read the roles of relation members? If not, all members will
+         * have an empty role.
+         */
+        enum class read_member_roles : bool {
+            no  = false,
+            yes = true
+        };
+
+        namespace detail {
+
+            /**
+             * Which parts of OSM objects should be read. Set from the
+             * read_tags, read_way_nodes, and read_member_roles options
+             * of the Reader.
+             */
+            struct object_parts {
+                bool tags = true;
+                bool way_nodes = true;
+                bool member_roles = true;
+            };
+
+        } // namespace detail
+
         enum class buffers_type {
             any    = 0,
             single = 1
         };
 
+        /**
+         * Read or write files bypassing the page cache (using O_DIRECT)?
+         * Only supported on Linux, ignored everywhere else.
+         */
+        enum class direct_io : bool {
+            no  = false,
+            yes = true
+        };
+
+        /**
+         * Memory budget (in bytes) for the data queued between the stages
+         * of a Reader. If this is set, the queue sizes are adapted to the
+         * observed data sizes and processing speeds so that they stay
+         * within this limit.
+         */
+        class memory_limit {
+
+            std::size_t m_bytes;
+
+        public:
+
+            explicit memory_limit(const std::size_t bytes) noexcept :
+                m_bytes(bytes) {
+            }
+
+            std::size_t bytes() const noexcept {
+                return m_bytes;
+            }
+
+        }; // class memory_limit
+
         inline const char* as_string(const file_format format) noexcept {
             switch (format) {
                 case file_format::xml:
@@ -0,0 +1,121 @@
+#ifndef OSMIUM_IO_MAKE_READ_TAGS_FILTER_HPP
+#define OSMIUM_IO_MAKE_READ_TAGS_FILTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/read_tags_filter.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/tags/matcher.hpp>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * Matcher for read_tags_filter with the rules copied out of a
+             * TagsFilter. The TagMatchers are only used through const
+             * functions which is thread safe.
+             */
+            class rules_tags_filter_matcher : public tags_filter_matcher {
+
+                std::vector<std::pair<bool, osmium::TagMatcher>> m_rules;
+                bool m_default_result;
+
+            public:
+
+                template <typename TFilter>
+                explicit rules_tags_filter_matcher(const TFilter& filter) :
+                    m_default_result(static_cast<bool>(filter.default_result())) {
+                    m_rules.reserve(filter.rules().size());
+                    for (const auto& rule : filter.rules()) {
+                        m_rules.emplace_back(static_cast<bool>(rule.first), rule.second);
+                    }
+                }
+
+                tags_filter_key_result match_key(const char* key) const noexcept override {
+                    for (const auto& rule : m_rules) {
+                        if (rule.second.key_matcher()(key)) {
+                            if (rule.second.has_value_matcher()) {
+                                return tags_filter_key_result::check_tag;
+                            }
+                            return rule.first ? tags_filter_key_result::match : tags_filter_key_result::no_match;
+                        }
+                    }
+                    return m_default_result ? tags_filter_key_result::match : tags_filter_key_result::no_match;
+                }
+
+                bool match_tag(const char* key, const char* value) const noexcept override {
+                    for (const auto& rule : m_rules) {
+                        if (rule.second(key, value)) {
+                            return rule.first;
+                        }
+                    }
+                    return m_default_result;
+                }
+
+            }; // class rules_tags_filter_matcher
+
+        } // namespace detail
+
+        /**
+         * Create a read_tags_filter option for the Reader from a filter.
+         * The rules of the filter are copied, so the filter is not needed
+         * any more afterwards.
+         *
+         * This is in its own header because it needs the tag matchers
+         * (and so Boost) which the I/O headers don't.
+         *
+         * @tparam TFilter Any kind of TagsFilterBase with a result
+         *                 type convertible to bool.
+         * @param filter The filter. The first rule matching a tag
+         *               decides whether the tag matches, if there is
+         *               no matching rule, the default result of the
+         *               filter is used.
+         * @param entities The entity types the filter is used for.
+         */
+        template <typename TFilter>
+        read_tags_filter make_read_tags_filter(const TFilter& filter, const osmium::osm_entity_bits::type entities = osmium::osm_entity_bits::nwr) {
+            return read_tags_filter{std::make_shared<const detail::rules_tags_filter_matcher>(filter), entities};
+        }
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_MAKE_READ_TAGS_FILTER_HPP
@@ -0,0 +1,161 @@
+#ifndef OSMIUM_IO_NODE_COLUMNS_HPP
+#define OSMIUM_IO_NODE_COLUMNS_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/types.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * The nodes from one block of an input file as a structure of
+         * arrays. This is filled by the NodeColumnsReader directly from
+         * the data in the file without creating osmium::Node objects.
+         * Element n of each of the ids, x, and y vectors belongs to the
+         * same node.
+         *
+         * The tags are only filled in if requested. The tags of node n are
+         * the pairs of key and value string indexes in the tags vector
+         * from 2 * tag_offsets[n] up to 2 * tag_offsets[n + 1]. Use the
+         * tag_count(), key(), and value() functions to access them.
+         */
+        struct node_columns {
+
+            /// The IDs of the nodes.
+            std::vector<osmium::object_id_type> ids;
+
+            /// The x coordinates (see osmium::Location::x()) of the nodes.
+            std::vector<int32_t> x;
+
+            /// The y coordinates (see osmium::Location::y()) of the nodes.
+            std::vector<int32_t> y;
+
+            /// Offsets of the tags of each node (size() + 1 entries).
+            std::vector<uint32_t> tag_offsets;
+
+            /// Indexes of key and value strings of all tags.
+            std::vector<uint32_t> tags;
+
+            /// Zero-terminated strings referenced from the tags.
+            std::string strings;
+
+            /// Offsets of the strings in the strings member.
+            std::vector<uint32_t> string_offsets;
+
+            /// The number of nodes.
+            std::size_t size() const noexcept {
+                return ids.size();
+            }
+
+            /// Are there no nodes?
+            bool empty() const noexcept {
+                return ids.empty();
+            }
+
+            /// Remove all nodes and strings. Keeps the memory allocated.
+            void clear() noexcept {
+                ids.clear();
+                x.clear();
+                y.clear();
+                tag_offsets.clear();
+                tags.clear();
+                strings.clear();
+                string_offsets.clear();
+            }
+
+            /**
+             * Get the location of node n. The location is undefined for
+             * deleted nodes.
+             */
+            osmium::Location location(const std::size_t n) const noexcept {
+                assert(n < size());
+                return osmium::Location{x[n], y[n]};
+            }
+
+            /// Have the tags been read?
+            bool has_tags() const noexcept {
+                return !tag_offsets.empty();
+            }
+
+            /**
+             * The number of tags of node n.
+             *
+             * @pre @code has_tags() @endcode
+             */
+            std::size_t tag_count(const std::size_t n) const noexcept {
+                assert(n < size() && has_tags());
+                return tag_offsets[n + 1] - tag_offsets[n];
+            }
+
+            /// Get string number index.
+            const char* string(const uint32_t index) const noexcept {
+                assert(index < string_offsets.size());
+                return strings.data() + string_offsets[index];
+            }
+
+            /**
+             * The key of tag t of node n.
+             *
+             * @pre @code t < tag_count(n) @endcode
+             */
+            const char* key(const std::size_t n, const std::size_t t) const noexcept {
+                assert(t < tag_count(n));
+                return string(tags[2 * (tag_offsets[n] + t)]);
+            }
+
+            /**
+             * The value of tag t of node n.
+             *
+             * @pre @code t < tag_count(n) @endcode
+             */
+            const char* value(const std::size_t n, const std::size_t t) const noexcept {
+                assert(t < tag_count(n));
+                return string(tags[2 * (tag_offsets[n] + t) + 1]);
+            }
+
+        }; // struct node_columns
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_NODE_COLUMNS_HPP
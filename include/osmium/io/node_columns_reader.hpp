@@ -0,0 +1,304 @@
+#ifndef OSMIUM_IO_NODE_COLUMNS_READER_HPP
+#define OSMIUM_IO_NODE_COLUMNS_READER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/io/detail/pbf.hpp>
+#include <osmium/io/detail/pbf_decoder.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/file_compression.hpp>
+#include <osmium/io/file_format.hpp>
+#include <osmium/io/header.hpp>
+#include <osmium/io/node_columns.hpp>
+#include <osmium/osm/box.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/thread/pool.hpp>
+#include <osmium/util/file.hpp>
+
+#include <protozero/types.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <initializer_list>
+#include <string>
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        /**
+         * Reads the nodes from an uncompressed OSM PBF file into
+         * node_columns, one block of the file at a time. This is much
+         * faster than reading the nodes with the Reader class if you
+         * only need the IDs, locations, and (optionally) tags of the
+         * nodes, because no OSM objects are created. Ways and relations
+         * are ignored. If the file has a blob index (see the
+         * pbf_blob_index output option), blocks without nodes are
+         * skipped without reading them.
+         *
+         * The blocks are decoded in the thread pool, the results are
+         * returned in the order they appear in the file. Deleted nodes
+         * (from history files) have an undefined location.
+         *
+         * Usage:
+         * @code
+         * osmium::io::NodeColumnsReader reader{"input.osm.pbf"};
+         * osmium::io::node_columns columns;
+         * while (reader.read(columns)) {
+         *     for (std::size_t n = 0; n < columns.size(); ++n) {
+         *         ... columns.ids[n], columns.x[n], columns.y[n] ...
+         *     }
+         * }
+         * @endcode
+         */
+        class NodeColumnsReader {
+
+            std::deque<std::future<osmium::io::node_columns>> m_results;
+            osmium::io::Header m_header;
+            osmium::thread::Pool* m_pool = nullptr;
+            std::size_t m_max_results = 0;
+            int m_fd = -1;
+            bool m_with_tags = false;
+            bool m_eof = false;
+
+            void set_option(osmium::thread::Pool& pool) noexcept {
+                m_pool = &pool;
+            }
+
+            void set_option(osmium::io::read_tags value) noexcept {
+                m_with_tags = (value == osmium::io::read_tags::yes);
+            }
+
+            bool read_exactly(char* data, std::size_t size) {
+                while (size > 0) {
+                    const auto nread = detail::reliable_read(m_fd, data, static_cast<unsigned int>(std::min(size, static_cast<std::size_t>(1024 * 1024 * 1024))));
+                    if (nread == 0) {
+                        return false;
+                    }
+                    data += nread;
+                    size -= static_cast<std::size_t>(nread);
+                }
+                return true;
+            }
+
+            std::string read_blob(const std::size_t size) {
+                if (size > detail::max_uncompressed_blob_size) {
+                    throw osmium::pbf_error{std::string{"invalid blob size: "} +
+                                            std::to_string(size)};
+                }
+                std::string data(size, '\0');
+                if (!read_exactly(&data[0], size)) {
+                    throw osmium::pbf_error{"truncated data (EOF encountered)"};
+                }
+                return data;
+            }
+
+            void skip_blob(const std::size_t size) {
+                if (!osmium::seek_forward(m_fd, size)) {
+                    read_blob(size);
+                }
+            }
+
+            // Returns the size of the next blob or 0 on EOF.
+            std::size_t read_blob_header(const char* expected_type, detail::pbf_blob_index* index) {
+                char size_data[4];
+                if (!read_exactly(size_data, sizeof(size_data))) {
+                    return 0; // EOF
+                }
+
+                const auto size = detail::get_size_in_network_byte_order(size_data);
+                if (size > static_cast<uint32_t>(detail::max_blob_header_size)) {
+                    throw osmium::pbf_error{"invalid BlobHeader size (> max_blob_header_size)"};
+                }
+
+                const std::string blob_header{read_blob(size)};
+                return detail::decode_blob_header(protozero::data_view{blob_header.data(), blob_header.size()}, expected_type, index);
+            }
+
+            void fill_results() {
+                while (!m_eof && m_results.size() < m_max_results) {
+                    detail::pbf_blob_index index;
+                    const auto size = read_blob_header("OSMData", &index);
+                    if (size == 0) {
+                        m_eof = true;
+                        return;
+                    }
+                    if (!index.can_match(osmium::osm_entity_bits::node, osmium::Box{})) {
+                        skip_blob(size);
+                        continue;
+                    }
+                    m_results.push_back(m_pool->submit(detail::PBFNodeColumnsBlobDecoder{read_blob(size), m_with_tags}));
+                }
+            }
+
+        public:
+
+            /**
+             * Create new NodeColumnsReader object.
+             *
+             * @param file The file (contains name and format info) to open.
+             *             Only uncompressed PBF files are supported.
+             * @param args All further arguments are optional and can
+             *             appear in any order:
+             *
+             * * osmium::io::read_tags: Fill in the tags of the nodes
+             *      (default: osmium::io::read_tags::no).
+             *
+             * * osmium::thread::Pool&: Reference to a thread pool that
+             *      should be used for decoding instead of the default
+             *      pool.
+             *
+             * @throws osmium::io_error If the file is not a PBF file or
+             *         is not in a file.
+             * @throws osmium::pbf_error If there was an error decoding
+             *         the file header.
+             * @throws std::system_error If the file could not be opened.
+             */
+            template <typename... TArgs>
+            explicit NodeColumnsReader(const osmium::io::File& file, TArgs&&... args) {
+                (void)std::initializer_list<int>{
+                    (set_option(args), 0)...
+                };
+
+                if (!m_pool) {
+                    m_pool = &osmium::thread::Pool::default_instance();
+                }
+                m_max_results = 2 * static_cast<std::size_t>(m_pool->num_threads());
+
+                file.check();
+                if (file.format() != osmium::io::file_format::pbf ||
+                    file.compression() != osmium::io::file_compression::none ||
+                    file.buffer()) {
+                    throw osmium::io_error{"NodeColumnsReader only supports uncompressed PBF files"};
+                }
+
+                m_fd = detail::open_for_reading(file.filename());
+
+                try {
+                    const auto size = read_blob_header("OSMHeader", nullptr);
+                    if (size == 0) {
+                        throw osmium::pbf_error{"missing OSMHeader"};
+                    }
+                    m_header = detail::decode_header(read_blob(size));
+                } catch (...) {
+                    close();
+                    throw;
+                }
+            }
+
+            template <typename... TArgs>
+            explicit NodeColumnsReader(const std::string& filename, TArgs&&... args) :
+                NodeColumnsReader(osmium::io::File(filename), std::forward<TArgs>(args)...) {
+            }
+
+            template <typename... TArgs>
+            explicit NodeColumnsReader(const char* filename, TArgs&&... args) :
+                NodeColumnsReader(osmium::io::File(filename), std::forward<TArgs>(args)...) {
+            }
+
+            NodeColumnsReader(const NodeColumnsReader&) = delete;
+            NodeColumnsReader& operator=(const NodeColumnsReader&) = delete;
+
+            NodeColumnsReader(NodeColumnsReader&&) = delete;
+            NodeColumnsReader& operator=(NodeColumnsReader&&) = delete;
+
+            ~NodeColumnsReader() noexcept {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            /**
+             * Close the file. Blocks that are still being decoded are
+             * discarded. Called automatically in the destructor.
+             */
+            void close() {
+                m_eof = true;
+                m_results.clear();
+                if (m_fd >= 0) {
+                    const int fd = m_fd;
+                    m_fd = -1;
+                    detail::reliable_close(fd);
+                }
+            }
+
+            /// Get the header data from the file.
+            const osmium::io::Header& header() const noexcept {
+                return m_header;
+            }
+
+            /**
+             * Read the nodes from the next block in the file containing
+             * any nodes.
+             *
+             * @param columns The nodes will be put here. Any previous
+             *                contents will be overwritten.
+             * @returns false if the end of the file was reached, true
+             *          otherwise.
+             * @throws osmium::pbf_error If there was an error decoding
+             *         the file.
+             * @throws std::system_error If there was an error reading
+             *         the file.
+             */
+            bool read(osmium::io::node_columns& columns) {
+                while (true) {
+                    fill_results();
+                    if (m_results.empty()) {
+                        return false;
+                    }
+                    // Remove the future before get() which might throw,
+                    // so that the next call doesn't try to use it again.
+                    auto result = std::move(m_results.front());
+                    m_results.pop_front();
+                    columns = result.get();
+                    if (!columns.empty()) {
+                        return true;
+                    }
+                }
+            }
+
+        }; // class NodeColumnsReader
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_NODE_COLUMNS_READER_HPP
@@ -0,0 +1,168 @@
+#ifndef OSMIUM_IO_READ_TAGS_FILTER_HPP
+#define OSMIUM_IO_READ_TAGS_FILTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <osmium/osm/entity_bits.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace osmium {
+
+    namespace io {
+
+        namespace detail {
+
+            /**
+             * The result of matching only the key of a tag.
+             */
+            enum class tags_filter_key_result : uint8_t {
+                no_match  = 0,
+                match     = 1,
+                check_tag = 2 // result depends on the value
+            };
+
+            /**
+             * Interface of the matcher used by read_tags_filter. It keeps
+             * the tag matching code (which needs Boost) out of the I/O
+             * headers. See make_read_tags_filter() for the implementation.
+             *
+             * Implementations are shared between all threads decoding
+             * data, so their functions must be thread safe.
+             */
+            class tags_filter_matcher {
+
+            public:
+
+                tags_filter_matcher() = default;
+
+                tags_filter_matcher(const tags_filter_matcher&) = delete;
+                tags_filter_matcher& operator=(const tags_filter_matcher&) = delete;
+
+                tags_filter_matcher(tags_filter_matcher&&) = delete;
+                tags_filter_matcher& operator=(tags_filter_matcher&&) = delete;
+
+                virtual ~tags_filter_matcher() noexcept = default;
+
+                /**
+                 * Match a key. Returns check_tag if the result depends
+                 * on the value of the tag.
+                 */
+                virtual tags_filter_key_result match_key(const char* key) const noexcept = 0;
+
+                /**
+                 * Match a tag.
+                 */
+                virtual bool match_tag(const char* key, const char* value) const noexcept = 0;
+
+            }; // class tags_filter_matcher
+
+        } // namespace detail
+
+        /**
+         * Option for the Reader: Only return objects with at least one tag
+         * matching a filter. Some input formats (currently only PBF) can
+         * check the tags while decoding the data and don't build objects
+         * that would be thrown away anyway. Other formats ignore this
+         * option.
+         *
+         * The filter is applied to objects of the specified entity types
+         * only, objects of all other types are returned unfiltered. Objects
+         * without tags never match.
+         *
+         * Create a read_tags_filter from a TagsFilter with
+         * make_read_tags_filter() from osmium/io/make_read_tags_filter.hpp.
+         *
+         * @code
+         * osmium::TagsFilter filter{false};
+         * filter.add_rule(true, "amenity");
+         * osmium::io::Reader reader{"input.osm.pbf",
+         *                           osmium::osm_entity_bits::node,
+         *                           osmium::io::make_read_tags_filter(filter)};
+         * @endcode
+         */
+        class read_tags_filter {
+
+            std::shared_ptr<const detail::tags_filter_matcher> m_matcher{};
+            osmium::osm_entity_bits::type m_entities = osmium::osm_entity_bits::nothing;
+
+        public:
+
+            /**
+             * Default constructed read_tags_filter doesn't filter anything.
+             */
+            read_tags_filter() = default;
+
+            /**
+             * Create a read_tags_filter using the specified matcher for
+             * objects of the specified entity types.
+             */
+            read_tags_filter(std::shared_ptr<const detail::tags_filter_matcher> matcher, const osmium::osm_entity_bits::type entities) :
+                m_matcher(std::move(matcher)),
+                m_entities(m_matcher ? entities : osmium::osm_entity_bits::nothing) {
+            }
+
+            /**
+             * Is the filter used for objects of the specified entity type?
+             */
+            bool applies_to(const osmium::osm_entity_bits::type entity) const noexcept {
+                return (m_entities & entity) != osmium::osm_entity_bits::nothing;
+            }
+
+            /**
+             * Match the key of a tag.
+             *
+             * @pre @code applies_to(...) == true @endcode for some entity type.
+             */
+            detail::tags_filter_key_result match_key(const char* key) const noexcept {
+                return m_matcher->match_key(key);
+            }
+
+            /**
+             * Match a tag.
+             *
+             * @pre @code applies_to(...) == true @endcode for some entity type.
+             */
+            bool operator()(const char* key, const char* value) const noexcept {
+                return m_matcher->match_tag(key, value);
+            }
+
+        }; // class read_tags_filter
+
+    } // namespace io
+
+} // namespace osmium
+
+#endif // OSMIUM_IO_READ_TAGS_FILTER_HPP
@@ -34,24 +34,32 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/io/compression.hpp>
+#include <osmium/io/detail/direct_io.hpp>
 #include <osmium/io/detail/input_format.hpp>
+#include <osmium/io/detail/queue_size_controller.hpp>
 #include <osmium/io/detail/queue_util.hpp>
 #include <osmium/io/detail/read_thread.hpp>
 #include <osmium/io/detail/read_write.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file.hpp>
 #include <osmium/io/header.hpp>
+#include <osmium/io/read_tags_filter.hpp>
 #include <osmium/memory/buffer.hpp>
+#include <osmium/osm/box.hpp>
 #include <osmium/osm/entity_bits.hpp>
 #include <osmium/thread/pool.hpp>
 #include <osmium/thread/util.hpp>
 #include <osmium/util/config.hpp>
 
+#include <algorithm>
 #include <cerrno>
+#include <cstddef>
 #include <cstdlib>
 #include <fcntl.h>
 #include <future>
+#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <system_error>
 #include <thread>
@@ -79,6 +87,62 @@ namespace osmium {
                 return osmium::config::get_max_queue_size("OSMDATA", 20);
             }
 
+            /**
+             * Parse the value of the "memory_limit" file option. It is a
+             * number of bytes optionally followed by "k", "M", or "G".
+             * An empty string means there is no limit and returns 0.
+             *
+             * @throws std::invalid_argument If the value is not valid.
+             */
+            inline std::size_t parse_memory_limit(const std::string& value) {
+                if (value.empty()) {
+                    return 0;
+                }
+
+                constexpr const std::size_t max_limit = std::numeric_limits<std::size_t>::max();
+
+                std::size_t pos = 0;
+                std::size_t limit = 0;
+                while (pos < value.size() && value[pos] >= '0' && value[pos] <= '9') {
+                    const auto digit = static_cast<std::size_t>(value[pos] - '0');
+                    if (limit > (max_limit - digit) / 10) {
+                        throw std::invalid_argument{"The 'memory_limit' option is too large."};
+                    }
+                    limit = limit * 10 + digit;
+                    ++pos;
+                }
+
+                if (pos == 0 || pos + 1 < value.size()) {
+                    throw std::invalid_argument{"The 'memory_limit' option must be a number optionally followed by 'k', 'M', or 'G'."};
+                }
+
+                std::size_t unit = 1;
+                if (pos < value.size()) {
+                    switch (value[pos]) {
+                        case 'k':
+                        case 'K':
+                            unit = 1024UL;
+                            break;
+                        case 'm':
+                        case 'M':
+                            unit = 1024UL * 1024UL;
+                            break;
+                        case 'g':
+                        case 'G':
+                            unit = 1024UL * 1024UL * 1024UL;
+                            break;
+                        default:
+                            throw std::invalid_argument{"The 'memory_limit' option must be a number optionally followed by 'k', 'M', or 'G'."};
+                    }
+                }
+
+                if (limit > max_limit / unit) {
+                    throw std::invalid_argument{"The 'memory_limit' option is too large."};
+                }
+
+                return limit * unit;
+            }
+
         } // namespace detail
 
         /**
@@ -100,6 +164,9 @@ namespace osmium {
 
             detail::ParserFactory::create_parser_type m_creator;
 
+            // Memory budget for the queues (0 = no limit).
+            std::size_t m_memory_limit;
+
             enum class status {
                 okay   = 0, // normal reading
                 error  = 1, // some error occurred while reading
@@ -113,11 +180,21 @@ namespace osmium {
 
             int m_fd;
 
+            // This has to be initialized before the read thread is started,
+            // because the read thread will close the file descriptor when
+            // it is done.
+            std::size_t m_file_size = 0;
+
             std::unique_ptr<osmium::io::Decompressor> m_decompressor;
 
             osmium::io::detail::ReadThreadManager m_read_thread_manager;
 
             detail::future_buffer_queue_type m_osmdata_queue;
+
+            // Adapts the size of the osmdata queue if there is a memory
+            // limit. Must be declared before the queue wrapper which uses it.
+            detail::QueueSizeController m_osmdata_queue_controller{0};
+
             detail::queue_wrapper<osmium::memory::Buffer> m_osmdata_queue_wrapper;
 
             std::future<osmium::io::Header> m_header_future{};
@@ -125,12 +202,15 @@ namespace osmium {
 
             osmium::thread::thread_handler m_thread{};
 
-            std::size_t m_file_size = 0;
             std::atomic<std::size_t> m_offset{0};
 
             osmium::osm_entity_bits::type m_read_which_entities = osmium::osm_entity_bits::all;
+            osmium::Box m_read_bbox{};
+            osmium::io::read_tags_filter m_tags_filter{};
             osmium::io::read_meta m_read_metadata = osmium::io::read_meta::yes;
+            osmium::io::detail::object_parts m_read_parts{};
             osmium::io::buffers_type m_buffers_kind = osmium::io::buffers_type::any;
+            osmium::io::direct_io m_direct_io = osmium::io::direct_io::no;
 
             void set_option(osmium::thread::Pool& pool) noexcept {
                 m_pool = &pool;
@@ -140,6 +220,14 @@ namespace osmium {
                 m_read_which_entities = value;
             }
 
+            void set_option(const osmium::Box& value) noexcept {
+                m_read_bbox = value;
+            }
+
+            void set_option(const osmium::io::read_tags_filter& value) {
+                m_tags_filter = value;
+            }
+
             void set_option(osmium::io::read_meta value) noexcept {
                 // Ignore this setting if we have a history/change file,
                 // because if this is set to "no", we don't see the difference
@@ -149,10 +237,30 @@ namespace osmium {
                 }
             }
 
+            void set_option(osmium::io::read_tags value) noexcept {
+                m_read_parts.tags = (value == osmium::io::read_tags::yes);
+            }
+
+            void set_option(osmium::io::read_way_nodes value) noexcept {
+                m_read_parts.way_nodes = (value == osmium::io::read_way_nodes::yes);
+            }
+
+            void set_option(osmium::io::read_member_roles value) noexcept {
+                m_read_parts.member_roles = (value == osmium::io::read_member_roles::yes);
+            }
+
             void set_option(osmium::io::buffers_type value) noexcept {
                 m_buffers_kind = value;
             }
 
+            void set_option(osmium::io::direct_io value) noexcept {
+                m_direct_io = value;
+            }
+
+            void set_option(osmium::io::memory_limit value) noexcept {
+                m_memory_limit = value.bytes();
+            }
+
             // This function will run in a separate thread.
             static void parser_thread(osmium::thread::Pool& pool,
                                       int fd,
@@ -162,7 +270,10 @@ namespace osmium {
                                       std::promise<osmium::io::Header>&& header_promise,
                                       std::atomic<std::size_t>* offset_ptr,
                                       osmium::osm_entity_bits::type read_which_entities,
+                                      const osmium::Box& read_bbox,
+                                      const osmium::io::read_tags_filter& tags_filter,
                                       osmium::io::read_meta read_metadata,
+                                      const osmium::io::detail::object_parts& read_parts,
                                       osmium::io::buffers_type buffers_kind,
                                       bool want_buffered_pages_removed) {
                 std::promise<osmium::io::Header> promise{std::move(header_promise)};
@@ -174,7 +285,10 @@ namespace osmium {
                     promise,
                     offset_ptr,
                     read_which_entities,
+                    read_bbox,
+                    tags_filter,
                     read_metadata,
+                    read_parts,
                     buffers_kind,
                     want_buffered_pages_removed
                 };
@@ -284,6 +398,24 @@ namespace osmium {
              *      input file. It can speed the read up significantly if
              *      objects that are not needed anyway are not parsed.
              *
+             * * osmium::Box: Only read data from the parts of the input
+             *      file which might contain objects inside this bounding
+             *      box. This only works with PBF files written with the
+             *      "pbf_blob_index" file option which stores a summary of
+             *      each blob in its header. Blobs with only nodes (or ways
+             *      if "locations_on_ways" was used) outside the bounding
+             *      box are skipped without decompressing them. Note that
+             *      this does not filter individual objects, the Reader can
+             *      still return objects outside the bounding box. The
+             *      osmium::osm_entities::bits are also used to skip blobs
+             *      with an index without decompressing them.
+             *
+             * * osmium::io::read_tags_filter: Only return objects with at
+             *      least one tag matching the filter. Objects of entity
+             *      types the filter is not used for are returned as usual.
+             *      Currently only used for PBF files, where the tags are
+             *      checked before the objects are built, ignored otherwise.
+             *
              * * osmium::io::read_meta: Read meta data or not. The default is
              *      osmium::io::read_meta::yes which means that meta data
              *      is read normally. If you set this to
@@ -294,6 +426,16 @@ namespace osmium {
              *      because you will loose the information whether an object
              *      is visible!
              *
+             * * osmium::io::read_tags, osmium::io::read_way_nodes,
+             *      osmium::io::read_member_roles: Set any of these to "no"
+             *      to leave out the tags of all objects, the node
+             *      references (and locations) of ways, or the roles of
+             *      relation members, respectively. The objects are then
+             *      returned without those parts, which makes the buffers
+             *      smaller and reading faster if they are not needed. Used
+             *      for PBF, O5M, and OPL files, ignored otherwise. The
+             *      default for all of them is "yes".
+             *
              * * osmium::io::buffers_type: Fill entities into buffers until
              *      the buffers are full (osmium::io::buffers_type::any) or
              *      only fill entities of the same type into a buffer
@@ -302,6 +444,24 @@ namespace osmium {
              *      use in "single" mode if the input file is not sorted by
              *      type, otherwise this will be rather inefficient.
              *
+             * * osmium::io::direct_io: Read the file bypassing the page
+             *      cache (using O_DIRECT on Linux). This is useful when
+             *      reading huge files once, because they will not push
+             *      other data (like memory mapped index files) out of the
+             *      cache. Currently only used for PBF files that are read
+             *      from a regular file, ignored otherwise. The default is
+             *      osmium::io::direct_io::no.
+             *
+             * * osmium::io::memory_limit: Memory budget in bytes for the
+             *      data queued between reading, parsing, and the caller of
+             *      read(). The queue for the parsed data then starts small,
+             *      grows while the caller has to wait for data, and shrinks
+             *      while the caller is slower than the parser, never using
+             *      more than the budget for the average buffer size seen.
+             *      This can also be set with the file option
+             *      "memory_limit", for instance "memory_limit=2G". The
+             *      default is no limit, the fixed queue sizes are used.
+             *
              * * osmium::thread::Pool&: Reference to a thread pool that should
              *      be used for reading instead of the default pool. Usually
              *      it is okay to use the statically initialized shared
@@ -316,13 +476,14 @@ namespace osmium {
             explicit Reader(const osmium::io::File& file, TArgs&&... args) :
                 m_file(file.check()),
                 m_creator(detail::ParserFactory::instance().get_creator_function(m_file)),
+                m_memory_limit(detail::parse_memory_limit(m_file.get("memory_limit"))),
                 m_input_queue(detail::get_input_queue_size(), "raw_input"),
                 m_fd(m_file.buffer() ? -1 : open_input_file_or_url(m_file.filename(), &m_childpid)),
+                m_file_size(m_fd > 2 ? osmium::file_size(m_fd) : 0),
                 m_decompressor(make_decompressor(m_file, m_fd)),
                 m_read_thread_manager(*m_decompressor, m_input_queue),
                 m_osmdata_queue(detail::get_osmdata_queue_size(), "parser_results"),
-                m_osmdata_queue_wrapper(m_osmdata_queue),
-                m_file_size(m_fd > 2 ? osmium::file_size(m_fd) : 0) {
+                m_osmdata_queue_wrapper(m_osmdata_queue) {
 
                 (void)std::initializer_list<int>{
                     (set_option(args), 0)...
@@ -334,6 +495,17 @@ namespace osmium {
 
                 m_decompressor->set_offset_ptr(&m_offset);
 
+                if (m_memory_limit > 0) {
+                    // Use up to an eighth of the budget for the raw input
+                    // data, the rest for the parsed OSM data.
+                    const std::size_t input_budget = m_memory_limit / 8;
+                    m_input_queue.set_max_size(std::max(static_cast<std::size_t>(2),
+                                                        std::min(detail::get_input_queue_size(),
+                                                                 input_budget / osmium::io::Decompressor::input_buffer_size)));
+                    m_osmdata_queue_controller = detail::QueueSizeController{m_memory_limit - input_budget};
+                    m_osmdata_queue_wrapper.set_controller(&m_osmdata_queue_controller);
+                }
+
                 std::promise<osmium::io::Header> header_promise;
                 m_header_future = header_promise.get_future();
 
@@ -343,10 +515,13 @@ namespace osmium {
                 }
 
                 const int fd_for_parser = m_decompressor->is_real() ? -1 : m_fd;
+                if (m_direct_io == osmium::io::direct_io::yes && fd_for_parser > 2) {
+                    osmium::io::detail::enable_direct_io(fd_for_parser);
+                }
                 m_thread = osmium::thread::thread_handler{parser_thread, std::ref(*m_pool), fd_for_parser, std::ref(m_creator),
                                                           std::ref(m_input_queue), std::ref(m_osmdata_queue),
                                                           std::move(header_promise), &m_offset, m_read_which_entities,
-                                                          m_read_metadata, m_buffers_kind,
+                                                          m_read_bbox, m_tags_filter, m_read_metadata, m_read_parts, m_buffers_kind,
                                                           m_decompressor->want_buffered_pages_removed()};
             }
 
@@ -34,12 +34,14 @@ DEALINGS IN THE SOFTWARE.
 */
 
 #include <osmium/io/compression.hpp>
+#include <osmium/io/detail/direct_io.hpp>
 #include <osmium/io/detail/output_format.hpp>
 #include <osmium/io/detail/queue_util.hpp>
 #include <osmium/io/detail/read_write.hpp>
 #include <osmium/io/detail/write_thread.hpp>
 #include <osmium/io/error.hpp>
 #include <osmium/io/file.hpp>
+#include <osmium/io/file_compression.hpp>
 #include <osmium/io/header.hpp>
 #include <osmium/io/writer_options.hpp>
 #include <osmium/memory/buffer.hpp>
@@ -133,13 +135,15 @@ namespace osmium {
             // Has the header already bin written to the file?
             bool m_header_written = false;
 
-            // This function will run in a separate thread.
+            // This function will run in a separate thread. The target is
+            // either a compressor writing to a file or an output callback.
+            template <typename TTarget>
             static void write_thread(detail::future_string_queue_type& output_queue,
-                                     std::unique_ptr<osmium::io::Compressor>&& compressor,
+                                     TTarget&& target,
                                      std::promise<std::size_t>&& write_promise,
                                      std::atomic_bool* notification) {
                 detail::WriteThread write_thread{output_queue,
-                                                 std::move(compressor),
+                                                 std::move(target),
                                                  std::move(write_promise),
                                                  notification};
                 write_thread();
@@ -201,7 +205,9 @@ namespace osmium {
                 osmium::io::Header header;
                 overwrite allow_overwrite = overwrite::no;
                 fsync sync = fsync::no;
+                osmium::io::direct_io direct = osmium::io::direct_io::no;
                 osmium::thread::Pool* pool = nullptr;
+                output_callback callback;
             };
 
             static void set_option(options_type& options, osmium::thread::Pool& pool) {
@@ -220,6 +226,14 @@ namespace osmium {
                 options.sync = value;
             }
 
+            static void set_option(options_type& options, osmium::io::direct_io value) {
+                options.direct = value;
+            }
+
+            static void set_option(options_type& options, const output_callback& callback) {
+                options.callback = callback;
+            }
+
             void do_close() {
                 if (m_status == status::okay) {
                     ensure_cleanup([&](){
@@ -253,6 +267,12 @@ namespace osmium {
              *       before closing it? Can be osmium::io::fsync::yes or
              *       osmium::io::fsync::no (default).
              *
+             * * osmium::io::direct_io: Write the file bypassing the page
+             *       cache (using O_DIRECT on Linux), so writing a huge file
+             *       does not push other data out of the cache. Only used
+             *       for uncompressed output to a regular file, ignored
+             *       otherwise. The default is osmium::io::direct_io::no.
+             *
              * * osmium::thread::Pool&: Reference to a thread pool that should
              *      be used for writing instead of the default pool. Usually
              *      it is okay to use the statically initialized shared
@@ -260,6 +280,14 @@ namespace osmium {
              *      For instance when your program will fork, using the
              *      statically initialized pool will not work.
              *
+             * * osmium::io::output_callback: Function that gets the encoded
+             *      data instead of it being written to a file. No file is
+             *      opened in this case, the file name is ignored. Only the
+             *      format and its options are used from the file. The data
+             *      can not be compressed (with gzip or bzip2) in this case,
+             *      but PBF blocks are compressed as usual. The callback is
+             *      called from the write thread.
+             *
              * @throws osmium::io_error If there was an error.
              * @throws std::system_error If the file could not be opened.
              */
@@ -279,16 +307,29 @@ namespace osmium {
 
                 m_header = options.header;
 
-                m_output = osmium::io::detail::OutputFormatFactory::instance().create_output(*options.pool, m_file, m_output_queue);
+                if (options.callback && m_file.compression() != file_compression::none) {
+                    throw io_error{"Writer with output callback can not compress output"};
+                }
 
-                std::unique_ptr<osmium::io::Compressor> compressor =
-                    CompressionFactory::instance().create_compressor(file.compression(),
-                                                                     osmium::io::detail::open_for_writing(m_file.filename(), options.allow_overwrite),
-                                                                     options.sync);
+                m_output = osmium::io::detail::OutputFormatFactory::instance().create_output(*options.pool, m_file, m_output_queue);
 
                 std::promise<std::size_t> write_promise;
                 m_write_future = write_promise.get_future();
-                m_thread = osmium::thread::thread_handler{write_thread, std::ref(m_output_queue), std::move(compressor), std::move(write_promise), &m_notification};
+
+                if (options.callback) {
+                    m_thread = osmium::thread::thread_handler{write_thread<output_callback>, std::ref(m_output_queue), std::move(options.callback), std::move(write_promise), &m_notification};
+                    return;
+                }
+
+                const int fd = osmium::io::detail::open_for_writing(m_file.filename(), options.allow_overwrite);
+                if (options.direct == osmium::io::direct_io::yes && file.compression() == file_compression::none && fd > 2) {
+                    osmium::io::detail::enable_direct_io(fd);
+                }
+
+                std::unique_ptr<osmium::io::Compressor> compressor =
+                    CompressionFactory::instance().create_compressor(file.compression(), fd, options.sync);
+
+                m_thread = osmium::thread::thread_handler{write_thread<std::unique_ptr<osmium::io::Compressor>>, std::ref(m_output_queue), std::move(compressor), std::move(write_promise), &m_notification};
             }
 
             template <typename... TArgs>
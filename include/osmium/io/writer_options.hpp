@@ -33,6 +33,9 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <functional>
+#include <string>
+
 namespace osmium {
 
     namespace io {
@@ -53,6 +56,14 @@ namespace osmium {
             yes = true
         };
 
+        /**
+         * Function that gets the encoded data from a Writer instead of
+         * writing it to a file. It is called from the write thread of the
+         * Writer for each block of data in order. The data is moved into
+         * the function, so it can keep the string without copying it.
+         */
+        using output_callback = std::function<void(std::string&&)>;
+
     } // namespace io
 
 } // namespace osmium
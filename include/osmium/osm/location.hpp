@@ -33,6 +33,8 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <osmium/util/number_format.hpp>
+
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
@@ -194,62 +196,30 @@ namespace osmium {
             return static_cast<int32_t>(result);
         }
 
+        /**
+         * Write integer as used by location for coordinates as decimal
+         * number into the buffer which must have space for at least 12
+         * characters (sign, 3 digits of the integer part of any int32_t
+         * value, decimal point, and 7 decimal places). No terminating
+         * null character is written.
+         *
+         * @returns Pointer to the character after the last one written.
+         */
+        inline char* format_location_coordinate(char* buffer, int32_t value) noexcept {
+            return format_fixed_point(buffer, value, coordinate_precision, 7);
+        }
+
         // Convert integer as used by location for coordinates into a string.
         template <typename T>
         inline T append_location_coordinate_to_string(T iterator, int32_t value) {
-            // need to special-case this, because later `value = -value` would overflow.
-            if (value == std::numeric_limits<int32_t>::min()) {
-                static const char minresult[] = "-214.7483648";
-                return std::copy_n(minresult, sizeof(minresult) - 1, iterator);
-            }
-
-            // handle negative values
-            if (value < 0) {
-                *iterator++ = '-';
-                value = -value;
-            }
-
-            // write digits into temporary buffer
-            int32_t v = value;
-            char temp[10];
-            char* t = temp;
-            do {
-                *t++ = static_cast<char>(v % 10) + '0'; // NOLINT(bugprone-narrowing-conversions, cppcoreguidelines-narrowing-conversions)
-                v /= 10;
-            } while (v != 0);
-
-            while (t - temp < 7) {
-                *t++ = '0';
-            }
-
-            // write out digits before decimal point
-            if (value >= coordinate_precision) {
-                if (value >= 10 * coordinate_precision) {
-                    if (value >= 100 * coordinate_precision) {
-                        *iterator++ = *--t;
-                    }
-                    *iterator++ = *--t;
-                }
-                *iterator++ = *--t;
-            } else {
-                *iterator++ = '0';
-            }
-
-            // remove trailing zeros
-            const char* tn = temp;
-            while (tn < t && *tn == '0') {
-                ++tn;
-            }
-
-            // decimal point
-            if (t != tn) {
-                *iterator++ = '.';
-                while (t != tn) {
-                    *iterator++ = *--t;
-                }
-            }
+            char buffer[12];
+            return std::copy(buffer, format_location_coordinate(buffer, value), iterator);
+        }
 
-            return iterator;
+        // Append integer as used by location for coordinates to a string.
+        inline void append_coordinate_to_string(std::string& out, int32_t value) {
+            char buffer[12];
+            out.append(buffer, format_location_coordinate(buffer, value));
         }
 
     } // namespace detail
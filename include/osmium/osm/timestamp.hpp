@@ -80,6 +80,45 @@ namespace osmium {
             out += static_cast<char>('0' + value);
         }
 
+        /**
+         * Returns the number of days since 1970-01-01 for the given date in
+         * the proleptic Gregorian calendar. Uses the "days_from_civil"
+         * algorithm by Howard Hinnant. Year must be positive.
+         */
+        constexpr int64_t days_from_civil(int64_t year, unsigned int month, unsigned int day) noexcept {
+            return (year - (month <= 2 ? 1 : 0)) / 400 * 146097 +
+                   (year - (month <= 2 ? 1 : 0)) % 400 * 365 +
+                   (year - (month <= 2 ? 1 : 0)) % 400 / 4 -
+                   (year - (month <= 2 ? 1 : 0)) % 400 / 100 +
+                   (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1 -
+                   719468;
+        }
+
+        struct civil_date {
+            int year;
+            int month;
+            int day;
+        };
+
+        /**
+         * Returns the date for the given number of days since 1970-01-01.
+         * This is the inverse of days_from_civil(). Days must not be
+         * negative.
+         */
+        inline civil_date civil_from_days(int64_t days) noexcept {
+            assert(days >= 0);
+            days += 719468;
+            const int64_t era = days / 146097;
+            const int64_t doe = days - era * 146097;
+            const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+            const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+            const int64_t mp = (5 * doy + 2) / 153;
+            const int64_t month = mp < 10 ? mp + 3 : mp - 9;
+            return civil_date{static_cast<int>(yoe + era * 400 + (month <= 2 ? 1 : 0)),
+                              static_cast<int>(month),
+                              static_cast<int>(doy - (153 * mp + 2) / 5 + 1)};
+        }
+
         inline time_t parse_timestamp(const char* str) {
             static const std::array<int, 12> mon_lengths = {{
                 31, 29, 31, 30, 31, 30,
@@ -106,35 +145,77 @@ namespace osmium {
                 str[17] >= '0' && str[17] <= '9' &&
                 str[18] >= '0' && str[18] <= '9' &&
                 str[19] == 'Z') {
-                std::tm tm; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-                tm.tm_year = (str[ 0] - '0') * 1000 +
-                             (str[ 1] - '0') *  100 +
-                             (str[ 2] - '0') *   10 +
-                             (str[ 3] - '0')        - 1900;
-                tm.tm_mon  = (str[ 5] - '0') * 10 + (str[ 6] - '0') - 1;
-                tm.tm_mday = (str[ 8] - '0') * 10 + (str[ 9] - '0');
-                tm.tm_hour = (str[11] - '0') * 10 + (str[12] - '0');
-                tm.tm_min  = (str[14] - '0') * 10 + (str[15] - '0');
-                tm.tm_sec  = (str[17] - '0') * 10 + (str[18] - '0');
-                tm.tm_wday = 0;
-                tm.tm_yday = 0;
-                tm.tm_isdst = 0;
-                if (tm.tm_year >= 0 &&
-                    tm.tm_mon  >= 0 && tm.tm_mon  <= 11 &&
-                    tm.tm_mday >= 1 && tm.tm_mday <= mon_lengths[tm.tm_mon] &&
-                    tm.tm_hour >= 0 && tm.tm_hour <= 23 &&
-                    tm.tm_min  >= 0 && tm.tm_min  <= 59 &&
-                    tm.tm_sec  >= 0 && tm.tm_sec  <= 60) {
-#ifndef _WIN32
-                    return timegm(&tm);
-#else
-                    return _mkgmtime(&tm);
-#endif
+                const int year = (str[ 0] - '0') * 1000 +
+                                 (str[ 1] - '0') *  100 +
+                                 (str[ 2] - '0') *   10 +
+                                 (str[ 3] - '0');
+                const int mon  = (str[ 5] - '0') * 10 + (str[ 6] - '0');
+                const int mday = (str[ 8] - '0') * 10 + (str[ 9] - '0');
+                const int hour = (str[11] - '0') * 10 + (str[12] - '0');
+                const int min  = (str[14] - '0') * 10 + (str[15] - '0');
+                const int sec  = (str[17] - '0') * 10 + (str[18] - '0');
+                if (year >= 1900 &&
+                    mon  >= 1 && mon  <= 12 &&
+                    mday >= 1 && mday <= mon_lengths[mon - 1] &&
+                    hour >= 0 && hour <= 23 &&
+                    min  >= 0 && min  <= 59 &&
+                    sec  >= 0 && sec  <= 60) {
+                    // Out of range values (Feb 29 in non-leap years and
+                    // leap seconds) roll over into the next day or minute
+                    // like they do with timegm().
+                    return static_cast<time_t>(days_from_civil(year, static_cast<unsigned int>(mon), static_cast<unsigned int>(mday)) * 86400 +
+                                               hour * 3600 + min * 60 + sec);
                 }
             }
             throw std::invalid_argument{std::string{"can not parse timestamp: '"} + str + "'"};
         }
 
+        /**
+         * Formats timestamps in ISO format. Remembers the date of the last
+         * timestamp formatted, so that the date has to be calculated only
+         * once for consecutive timestamps from the same day.
+         */
+        class iso_timestamp_formatter {
+
+            int64_t m_days = -1;
+            std::string m_date;
+
+        public:
+
+            /**
+             * Append the timestamp given as seconds since the epoch in ISO
+             * format ("yyyy-mm-ddThh:mm:ssZ") to the string.
+             */
+            void append(std::string& out, uint32_t seconds_since_epoch) {
+                const int64_t days = seconds_since_epoch / 86400;
+                if (days != m_days) {
+                    const civil_date date = civil_from_days(days);
+                    m_date.clear();
+                    add_4digit_int_to_string(date.year, m_date);
+                    m_date += '-';
+                    add_2digit_int_to_string(date.month, m_date);
+                    m_date += '-';
+                    add_2digit_int_to_string(date.day, m_date);
+                    m_date += 'T';
+                    m_days = days;
+                }
+                out += m_date;
+
+                int seconds = static_cast<int>(seconds_since_epoch % 86400);
+                const int hours = seconds / 3600;
+                seconds -= hours * 3600;
+                const int minutes = seconds / 60;
+                seconds -= minutes * 60;
+                add_2digit_int_to_string(hours, out);
+                out += ':';
+                add_2digit_int_to_string(minutes, out);
+                out += ':';
+                add_2digit_int_to_string(seconds, out);
+                out += 'Z';
+            }
+
+        }; // class iso_timestamp_formatter
+
     } // namespace detail
 
     /**
@@ -149,31 +230,7 @@ namespace osmium {
         uint32_t m_timestamp = 0;
 
         void to_iso_str(std::string& s) const {
-            std::tm tm; // NOLINT(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
-            time_t sse = seconds_since_epoch();
-#ifndef NDEBUG
-            auto result =
-#endif
-#ifndef _WIN32
-            gmtime_r(&sse, &tm);
-            assert(result != nullptr);
-#else
-            gmtime_s(&tm, &sse);
-            assert(result == 0);
-#endif
-
-            detail::add_4digit_int_to_string(tm.tm_year + 1900, s);
-            s += '-';
-            detail::add_2digit_int_to_string(tm.tm_mon + 1, s);
-            s += '-';
-            detail::add_2digit_int_to_string(tm.tm_mday, s);
-            s += 'T';
-            detail::add_2digit_int_to_string(tm.tm_hour, s);
-            s += ':';
-            detail::add_2digit_int_to_string(tm.tm_min, s);
-            s += ':';
-            detail::add_2digit_int_to_string(tm.tm_sec, s);
-            s += 'Z';
+            detail::iso_timestamp_formatter{}.append(s, m_timestamp);
         }
 
     public:
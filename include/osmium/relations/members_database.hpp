@@ -43,9 +43,11 @@ DEALINGS IN THE SOFTWARE.
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <tuple>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace osmium {
@@ -137,6 +139,116 @@ namespace osmium {
 
             std::vector<element> m_elements{};
 
+            /*
+             * After prepare_for_lookup() the sorted m_elements vector is
+             * indexed by an open addressing hash table with linear probing.
+             * Each slot contains the position of the first element with
+             * some member_id plus one or 0 for empty slots. Because most
+             * objects looked up are not members of any relation, a bit
+             * filter is checked first which will quickly reject most of
+             * them without touching the hash table or the elements.
+             *
+             * To keep the database small, the filter and the hash table
+             * share the m_index vector: The filter words come first, then
+             * the hash table slots. Their sizes are powers of two derived
+             * from the shift values.
+             */
+            std::vector<uint32_t> m_index{};
+            uint8_t m_index_shift = 64;
+            uint8_t m_filter_shift = 64;
+
+            static uint64_t index_hash(osmium::object_id_type id) noexcept {
+                return static_cast<uint64_t>(id) * 0x9e3779b97f4a7c15ULL;
+            }
+
+            static uint64_t filter_hash(osmium::object_id_type id) noexcept {
+                return static_cast<uint64_t>(id) * 0xc2b2ae3d27d4eb4fULL;
+            }
+
+            static uint8_t bits_for(std::size_t size) noexcept {
+                uint8_t bits = 5;
+                while ((std::size_t{1} << bits) < size) {
+                    ++bits;
+                }
+                return bits;
+            }
+
+            std::size_t filter_words() const noexcept {
+                return std::size_t{1} << (64U - m_filter_shift - 5U);
+            }
+
+            std::size_t index_mask() const noexcept {
+                return (std::size_t{1} << (64U - m_index_shift)) - 1;
+            }
+
+            bool filter_contains(osmium::object_id_type id) const noexcept {
+                const auto bit = filter_hash(id) >> m_filter_shift;
+                return (m_index[bit >> 5U] & (1U << (bit & 0x1fU))) != 0;
+            }
+
+            void build_index() {
+                // Positions are stored as 32bit values, fall back to binary
+                // search in the (unlikely) case that this is not enough.
+                if (m_elements.empty() || m_elements.size() >= std::numeric_limits<uint32_t>::max()) {
+                    return;
+                }
+
+                std::size_t num_ids = 1;
+                for (std::size_t i = 1; i < m_elements.size(); ++i) {
+                    if (m_elements[i].member_id != m_elements[i - 1].member_id) {
+                        ++num_ids;
+                    }
+                }
+
+                // Hash table with load factor below 0.5, filter with at
+                // least 8 bits per id.
+                const auto index_bits = bits_for(num_ids * 2);
+                const auto filter_bits = bits_for(num_ids * 8);
+                m_index_shift = static_cast<uint8_t>(64U - index_bits);
+                m_filter_shift = static_cast<uint8_t>(64U - filter_bits);
+                m_index.assign(filter_words() + index_mask() + 1, 0);
+
+                uint32_t* filter = m_index.data();
+                uint32_t* slots = m_index.data() + filter_words();
+                for (std::size_t i = 0; i < m_elements.size(); ++i) {
+                    const auto id = m_elements[i].member_id;
+                    if (i > 0 && m_elements[i - 1].member_id == id) {
+                        continue;
+                    }
+                    const auto bit = filter_hash(id) >> m_filter_shift;
+                    filter[bit >> 5U] |= 1U << (bit & 0x1fU);
+                    auto slot = static_cast<std::size_t>(index_hash(id) >> m_index_shift);
+                    while (slots[slot] != 0) {
+                        slot = (slot + 1) & index_mask();
+                    }
+                    slots[slot] = static_cast<uint32_t>(i + 1);
+                }
+            }
+
+            template <typename TIterator>
+            iterator_range<TIterator> find_in_index(TIterator begin, TIterator end, osmium::object_id_type id) const {
+                if (!filter_contains(id)) {
+                    return make_range(std::make_pair(end, end));
+                }
+
+                const uint32_t* slots = m_index.data() + filter_words();
+                const std::size_t mask = index_mask();
+                auto slot = static_cast<std::size_t>(index_hash(id) >> m_index_shift);
+                while (slots[slot] != 0) {
+                    const auto first = begin + (slots[slot] - 1);
+                    if (first->member_id == id) {
+                        auto last = first + 1;
+                        while (last != end && last->member_id == id) {
+                            ++last;
+                        }
+                        return make_range(std::make_pair(first, last));
+                    }
+                    slot = (slot + 1) & mask;
+                }
+
+                return make_range(std::make_pair(end, end));
+            }
+
         protected:
 
             osmium::ItemStash& m_stash;
@@ -152,10 +264,16 @@ namespace osmium {
             using const_iterator = std::vector<element>::const_iterator;
 
             iterator_range<iterator> find(osmium::object_id_type id) {
+                if (!m_index.empty()) {
+                    return find_in_index(m_elements.begin(), m_elements.end(), id);
+                }
                 return make_range(std::equal_range(m_elements.begin(), m_elements.end(), element{id}, compare_member_id{}));
             }
 
             iterator_range<const_iterator> find(osmium::object_id_type id) const {
+                if (!m_index.empty()) {
+                    return find_in_index(m_elements.cbegin(), m_elements.cend(), id);
+                }
                 return make_range(std::equal_range(m_elements.cbegin(), m_elements.cend(), element{id}, compare_member_id{}));
             }
 
@@ -186,6 +304,7 @@ namespace osmium {
              */
             std::size_t used_memory() const noexcept {
                 return sizeof(element) * m_elements.capacity() +
+                       sizeof(uint32_t) * m_index.capacity() +
                        sizeof(MembersDatabaseCommon);
             }
 
@@ -255,10 +374,14 @@ namespace osmium {
              * calling track() for all objects needed and before adding
              * the first object with add() or querying the first object
              * with get(). You can only call this function once.
+             *
+             * This sorts the members and builds a hash index on them, so
+             * that lookups in add() and get() take constant time.
              */
             void prepare_for_lookup() {
                 assert(m_init_phase && "Can not call MembersDatabase::prepare_for_lookup() twice.");
                 std::sort(m_elements.begin(), m_elements.end());
+                build_index();
 #ifndef NDEBUG
                 m_init_phase = false;
 #endif
@@ -294,8 +417,7 @@ namespace osmium {
              * return a pointer to it. Returns nullptr if there is no object
              * with that id in the database.
              *
-             * Complexity: Logarithmic in the number of members tracked (as
-             *             returned by size()).
+             * Complexity: Constant on average.
              */
             const osmium::OSMObject* get_object(osmium::object_id_type id) const {
                 assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling get_object().");
@@ -390,8 +512,7 @@ namespace osmium {
              * return a pointer to it. Returns nullptr if there is no object
              * with that id in the database.
              *
-             * Complexity: Logarithmic in the number of members tracked (as
-             *             returned by size()).
+             * Complexity: Constant on average.
              */
             const TObject* get(osmium::object_id_type id) const {
                 assert(!m_init_phase && "Call MembersDatabase::prepare_for_lookup() before calling get().");
@@ -0,0 +1,345 @@
+#ifndef OSMIUM_RELATIONS_RELATIONS_INDEX_HPP
+#define OSMIUM_RELATIONS_RELATIONS_INDEX_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <osmium/handler.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/io/error.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer_options.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/util/compatibility.hpp>
+#include <osmium/util/file.hpp>
+#include <osmium/util/memory_mapping.hpp>
+#include <osmium/visitor.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+
+namespace osmium {
+
+    /**
+     * Exception thrown when a relations index file can not be used.
+     */
+    struct OSMIUM_EXPORT relations_index_error : public io_error {
+
+        explicit relations_index_error(const std::string& what) :
+            io_error(std::string{"relations index error: "} + what) {
+        }
+
+        explicit relations_index_error(const char* what) :
+            io_error(std::string{"relations index error: "} + what) {
+        }
+
+    }; // struct relations_index_error
+
+    namespace relations {
+
+        namespace detail {
+
+            // The relations index file starts with this header...
+            struct relations_index_header {
+                char magic[8];
+                uint32_t version;
+                uint32_t align_bytes;
+            };
+
+            // ...followed by relations in the Osmium-internal format and
+            // then this trailer.
+            struct relations_index_trailer {
+                uint64_t data_size;
+                uint64_t count;
+            };
+
+            constexpr const char relations_index_magic[] = "OSMRELIX";
+
+            enum : uint32_t {
+                relations_index_version = 1
+            };
+
+        } // namespace detail
+
+        /**
+         * Handler writing all relations it sees into a relations index
+         * file. The relations are stored in the Osmium-internal format, so
+         * they can later be used with read_relations_from_index() without
+         * decompressing and parsing the original input file again.
+         *
+         * The index file is only usable on the same architecture it was
+         * written on. It is the responsibility of the caller to make sure
+         * the index file matches the OSM file it is used with.
+         */
+        class RelationsIndexWriter : public osmium::handler::Handler {
+
+            enum : std::size_t {
+                flush_size = 1024UL * 1024UL
+            };
+
+            osmium::memory::Buffer m_buffer{flush_size + osmium::memory::align_bytes};
+            detail::relations_index_trailer m_trailer{0, 0};
+            int m_fd;
+
+            void flush_buffer() {
+                osmium::io::detail::reliable_write(m_fd, m_buffer.data(), m_buffer.committed());
+                m_trailer.data_size += m_buffer.committed();
+                m_buffer.clear();
+            }
+
+        public:
+
+            /**
+             * Open the relations index file for writing.
+             *
+             * @param filename Name of the index file.
+             * @param allow_overwrite Allow overwriting of existing file?
+             * @throws std::system_error if the file can't be opened or written.
+             */
+            explicit RelationsIndexWriter(const std::string& filename, osmium::io::overwrite allow_overwrite = osmium::io::overwrite::no) :
+                m_fd(osmium::io::detail::open_for_writing(filename, allow_overwrite)) {
+                detail::relations_index_header header{};
+                std::memcpy(header.magic, detail::relations_index_magic, sizeof(header.magic));
+                header.version = detail::relations_index_version;
+                header.align_bytes = osmium::memory::align_bytes;
+                osmium::io::detail::reliable_write(m_fd, reinterpret_cast<const char*>(&header), sizeof(header));
+            }
+
+            RelationsIndexWriter(const RelationsIndexWriter&) = delete;
+            RelationsIndexWriter& operator=(const RelationsIndexWriter&) = delete;
+
+            RelationsIndexWriter(RelationsIndexWriter&&) = delete;
+            RelationsIndexWriter& operator=(RelationsIndexWriter&&) = delete;
+
+            /**
+             * Closes the index file if this hasn't been done before. Any
+             * errors are ignored, call close() if you want to see them.
+             */
+            ~RelationsIndexWriter() noexcept {
+                try {
+                    close();
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            void relation(const osmium::Relation& relation) {
+                m_buffer.add_item(relation);
+                m_buffer.commit();
+                ++m_trailer.count;
+                if (m_buffer.committed() >= flush_size) {
+                    flush_buffer();
+                }
+            }
+
+            /**
+             * Write out remaining data and close the index file. The index
+             * file is not valid before this was called.
+             *
+             * @throws std::system_error if writing or closing the file fails.
+             */
+            void close() {
+                if (m_fd < 0) {
+                    return;
+                }
+                flush_buffer();
+                osmium::io::detail::reliable_write(m_fd, reinterpret_cast<const char*>(&m_trailer), sizeof(m_trailer));
+                const int fd = m_fd;
+                m_fd = -1;
+                osmium::io::detail::reliable_close(fd);
+            }
+
+            /// The number of relations written to the index so far.
+            std::size_t count() const noexcept {
+                return static_cast<std::size_t>(m_trailer.count);
+            }
+
+        }; // class RelationsIndexWriter
+
+        /**
+         * A relations index file opened for reading. The file is memory
+         * mapped, so opening it is cheap regardless of its size, and the
+         * relations can be accessed through an osmium::memory::Buffer.
+         */
+        class RelationsIndex {
+
+            int m_fd;
+            osmium::MemoryMapping m_mapping;
+            osmium::memory::Buffer m_buffer;
+            std::size_t m_count = 0;
+
+            static osmium::MemoryMapping map_file(int fd) {
+                try {
+                    const std::size_t size = osmium::file_size(fd);
+                    if (size < sizeof(detail::relations_index_header) + sizeof(detail::relations_index_trailer)) {
+                        throw relations_index_error{"file too small"};
+                    }
+                    return osmium::MemoryMapping{size, osmium::MemoryMapping::mapping_mode::write_private, fd};
+                } catch (...) {
+                    osmium::io::detail::reliable_close(fd);
+                    throw;
+                }
+            }
+
+            void check() {
+                const auto* data = m_mapping.get_addr<const char>();
+
+                detail::relations_index_header header{};
+                std::memcpy(&header, data, sizeof(header));
+                if (std::memcmp(header.magic, detail::relations_index_magic, sizeof(header.magic)) != 0) {
+                    throw relations_index_error{"not a relations index file"};
+                }
+                if (header.version != detail::relations_index_version) {
+                    throw relations_index_error{"unknown version or byte order"};
+                }
+                if (header.align_bytes != osmium::memory::align_bytes) {
+                    throw relations_index_error{"written with incompatible alignment"};
+                }
+
+                detail::relations_index_trailer trailer{};
+                std::memcpy(&trailer, data + m_mapping.size() - sizeof(trailer), sizeof(trailer));
+                if (trailer.data_size != m_mapping.size() - sizeof(header) - sizeof(trailer)) {
+                    throw relations_index_error{"file truncated or not closed properly"};
+                }
+                m_count = static_cast<std::size_t>(trailer.count);
+            }
+
+            std::size_t data_size() const noexcept {
+                return m_mapping.size() - sizeof(detail::relations_index_header) - sizeof(detail::relations_index_trailer);
+            }
+
+        public:
+
+            /**
+             * Open and check a relations index file.
+             *
+             * @param filename Name of the index file.
+             * @throws std::system_error if the file can't be opened or mapped.
+             * @throws osmium::relations_index_error if the file is invalid.
+             */
+            explicit RelationsIndex(const std::string& filename) :
+                m_fd(osmium::io::detail::open_for_reading(filename)),
+                m_mapping(map_file(m_fd)) {
+                try {
+                    check();
+                    m_buffer = osmium::memory::Buffer{m_mapping.get_addr<unsigned char>() + sizeof(detail::relations_index_header), data_size()};
+                } catch (...) {
+                    m_mapping.unmap();
+                    osmium::io::detail::reliable_close(m_fd);
+                    throw;
+                }
+            }
+
+            RelationsIndex(const RelationsIndex&) = delete;
+            RelationsIndex& operator=(const RelationsIndex&) = delete;
+
+            RelationsIndex(RelationsIndex&&) = delete;
+            RelationsIndex& operator=(RelationsIndex&&) = delete;
+
+            ~RelationsIndex() noexcept {
+                try {
+                    m_mapping.unmap();
+                    osmium::io::detail::reliable_close(m_fd);
+                } catch (...) {
+                    // Ignore any exceptions because destructor must not throw.
+                }
+            }
+
+            /// The number of relations in the index.
+            std::size_t size() const noexcept {
+                return m_count;
+            }
+
+            /**
+             * The buffer containing all relations in the index. It is only
+             * valid as long as this object exists.
+             */
+            osmium::memory::Buffer& buffer() noexcept {
+                return m_buffer;
+            }
+
+        }; // class RelationsIndex
+
+        /**
+         * Read relations from the file and write them into a relations
+         * index file which can later be used with
+         * read_relations_from_index().
+         *
+         * @param file The file that should be opened with an osmium::io::Reader.
+         * @param index_filename Name of the index file.
+         * @param allow_overwrite Allow overwriting of existing index file?
+         * @returns The number of relations written.
+         */
+        inline std::size_t create_relations_index(const osmium::io::File& file, const std::string& index_filename, osmium::io::overwrite allow_overwrite = osmium::io::overwrite::no) {
+            RelationsIndexWriter writer{index_filename, allow_overwrite};
+            osmium::io::Reader reader{file, osmium::osm_entity_bits::relation};
+            osmium::apply(reader, writer);
+            reader.close();
+            writer.close();
+            return writer.count();
+        }
+
+        /**
+         * Feed all relations from a relations index file into all the
+         * managers specified as parameters. This does the same as
+         * read_relations(), but uses an index created with
+         * create_relations_index() or the RelationsIndexWriter instead
+         * of reading the OSM file.
+         *
+         * After the index is read, the prepare_for_lookup() function is
+         * called on all the managers making them ready for querying the
+         * data they have stored.
+         *
+         * @tparam TManager Any number of relation manager types.
+         * @param index_filename Name of the index file.
+         * @param managers Relation managers we want the relations to be sent
+         *                 to.
+         * @throws osmium::relations_index_error if the index file is invalid.
+         */
+        template <typename ...TManager>
+        void read_relations_from_index(const std::string& index_filename, TManager& ...managers) {
+            static_assert(sizeof...(TManager) > 0, "Need at least one manager as parameter.");
+            RelationsIndex index{index_filename};
+            osmium::apply(index.buffer(), managers...);
+            (void)std::initializer_list<int>{(managers.prepare_for_lookup(), 0)...};
+        }
+
+    } // namespace relations
+
+} // namespace osmium
+
+#endif // OSMIUM_RELATIONS_RELATIONS_INDEX_HPP
@@ -0,0 +1,541 @@
+#ifndef OSMIUM_TAGS_COMPILED_TAGS_FILTER_HPP
+#define OSMIUM_TAGS_COMPILED_TAGS_FILTER_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+#include <osmium/osm/tag.hpp>
+#include <osmium/tags/matcher.hpp>
+#include <osmium/tags/tags_filter.hpp>
+#include <osmium/util/string_matcher.hpp>
+
+#include <boost/iterator/filter_iterator.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace osmium {
+
+    namespace detail {
+
+        /**
+         * Hash table mapping strings to consecutive ids starting from 0.
+         * Uses open addressing with linear probing. It can be queried with
+         * C strings without creating std::string objects.
+         */
+        class string_id_map {
+
+            std::vector<std::string> m_strings{};
+            std::vector<uint32_t> m_hashes{};
+
+            // id + 1 of the string in this slot, 0 for empty slots
+            std::vector<uint32_t> m_slots = std::vector<uint32_t>(16, 0);
+
+            // FNV-1a
+            static uint32_t hash(const char* str) noexcept {
+                uint32_t h = 2166136261U;
+                for (; *str; ++str) {
+                    h ^= static_cast<unsigned char>(*str);
+                    h *= 16777619U;
+                }
+                return h;
+            }
+
+            std::size_t slot_for(uint32_t h) const noexcept {
+                // multiplicative hashing to spread the bits
+                return static_cast<std::size_t>((h * 2654435769U) >> 7U) & (m_slots.size() - 1);
+            }
+
+            void insert(std::size_t id) {
+                auto slot = slot_for(m_hashes[id]);
+                while (m_slots[slot] != 0) {
+                    slot = (slot + 1) & (m_slots.size() - 1);
+                }
+                m_slots[slot] = static_cast<uint32_t>(id + 1);
+            }
+
+        public:
+
+            enum : std::size_t {
+                not_found = std::numeric_limits<std::size_t>::max()
+            };
+
+            /**
+             * Look up string.
+             *
+             * @returns The id of the string or not_found.
+             */
+            std::size_t find(const char* str) const noexcept {
+                const auto h = hash(str);
+                auto slot = slot_for(h);
+                while (m_slots[slot] != 0) {
+                    const std::size_t id = m_slots[slot] - 1;
+                    if (m_hashes[id] == h && !std::strcmp(m_strings[id].c_str(), str)) {
+                        return id;
+                    }
+                    slot = (slot + 1) & (m_slots.size() - 1);
+                }
+                return not_found;
+            }
+
+            /**
+             * Add string if it isn't in the map already.
+             *
+             * If an exception is thrown (because memory can't be
+             * allocated), the map is unchanged.
+             *
+             * @returns The id of the string.
+             */
+            std::size_t add(const std::string& str) {
+                const auto id = find(str.c_str());
+                if (id != not_found) {
+                    return id;
+                }
+
+                // Allocate everything that's needed first, so that the
+                // map stays consistent if any allocation fails.
+                std::string copy{str};
+                if (m_strings.size() == m_strings.capacity()) {
+                    m_strings.reserve(std::max(m_strings.capacity() * 2, static_cast<std::size_t>(16)));
+                }
+                if (m_hashes.size() == m_hashes.capacity()) {
+                    m_hashes.reserve(std::max(m_hashes.capacity() * 2, static_cast<std::size_t>(16)));
+                }
+                const bool grow = (m_strings.size() + 1) * 2 > m_slots.size();
+                std::vector<uint32_t> slots;
+                if (grow) {
+                    slots.resize(m_slots.size() * 2, 0);
+                }
+
+                m_strings.push_back(std::move(copy));
+                m_hashes.push_back(hash(str.c_str()));
+
+                if (grow) {
+                    using std::swap;
+                    swap(m_slots, slots);
+                    for (std::size_t i = 0; i < m_strings.size(); ++i) {
+                        insert(i);
+                    }
+                } else {
+                    insert(m_strings.size() - 1);
+                }
+
+                return m_strings.size() - 1;
+            }
+
+            /// The number of strings in the map.
+            std::size_t size() const noexcept {
+                return m_strings.size();
+            }
+
+        }; // class string_id_map
+
+        /**
+         * Evaluates a set of StringMatchers on a string in one go and
+         * remembers the results for each string seen, so that they don't
+         * have to be evaluated again when the same string comes up again.
+         * This is used for regex matchers which are expensive, while the
+         * keys and values in OSM data repeat a lot.
+         *
+         * The number of strings remembered is limited. Once the limit is
+         * reached, matchers are evaluated directly for new strings.
+         *
+         * Not thread safe: Uses a cache which is updated in const member
+         * functions.
+         *
+         * Matching never throws. If there isn't enough memory to add a
+         * string to the cache, the matchers are evaluated directly.
+         */
+        class string_matcher_cache {
+
+            enum : std::size_t {
+                max_strings = 1UL << 16U
+            };
+
+            std::vector<osmium::StringMatcher> m_matchers{};
+            std::size_t m_words = 0;
+
+            mutable string_id_map m_strings{};
+
+            // m_words 64bit words with the results for each string
+            mutable std::vector<uint64_t> m_results{};
+
+        public:
+
+            /**
+             * Add a matcher to the set.
+             *
+             * @returns The index of the new matcher.
+             */
+            std::size_t add(const osmium::StringMatcher& matcher) {
+                assert(m_strings.size() == 0 && "Can not add matchers after using the cache.");
+                m_matchers.push_back(matcher);
+                m_words = (m_matchers.size() + 63) / 64;
+                return m_matchers.size() - 1;
+            }
+
+            /**
+             * Check whether matcher n matches the string.
+             */
+            bool operator()(std::size_t n, const char* str) const noexcept {
+                assert(n < m_matchers.size());
+                auto id = m_strings.find(str);
+                if (id == string_id_map::not_found) {
+                    if (m_strings.size() >= max_strings) {
+                        return m_matchers[n](str);
+                    }
+                    try {
+                        m_results.resize((m_strings.size() + 1) * m_words, 0);
+                        id = m_strings.add(str);
+                    } catch (const std::bad_alloc&) {
+                        return m_matchers[n](str);
+                    }
+                    for (std::size_t i = 0; i < m_matchers.size(); ++i) {
+                        if (m_matchers[i](str)) {
+                            m_results[id * m_words + (i >> 6U)] |= 1ULL << (i & 0x3fU);
+                        }
+                    }
+                }
+                return (m_results[id * m_words + (n >> 6U)] & (1ULL << (n & 0x3fU))) != 0;
+            }
+
+        }; // class string_matcher_cache
+
+    } // namespace detail
+
+    /**
+     * A CompiledTagsFilterBase is created from a TagsFilterBase and gives
+     * the same results, but it is much faster if there are many rules.
+     *
+     * All keys matched exactly (using StringMatcher::equal or
+     * StringMatcher::list) are interned in a hash table. For each of those
+     * keys, and for all other keys, a list of steps is precomputed
+     * containing only the rules that can possibly match a tag with that
+     * key in the order of the original rules. Runs of consecutive rules
+     * matching values exactly are combined into a single hash lookup.
+     * Rules using other matchers (prefix, substring, ...) are checked as
+     * usual and only where they are needed. So for most tags in typical
+     * data, which have keys the filter isn't interested in, a single hash
+     * lookup is all that's needed.
+     *
+     * All regex matchers for keys and all regex matchers for values are
+     * evaluated together the first time a string is seen and the results
+     * are cached (see detail::string_matcher_cache). Because of this
+     * cache, **a compiled filter is not thread safe** unlike the
+     * TagsFilter it was created from: A compiled filter containing regex
+     * rules must not be used from several threads at the same time. Use
+     * a copy in each thread.
+     *
+     * Changes to the original filter after the compiled filter was created
+     * will not be reflected in the compiled filter.
+     *
+     * @code
+     * osmium::TagsFilter filter{false};
+     * filter.add_rule(false, osmium::TagMatcher{"highway", "motorway"});
+     * filter.add_rule(true, osmium::TagMatcher{"highway"});
+     * ...
+     * const osmium::CompiledTagsFilter compiled_filter{filter};
+     *
+     * osmium::Tag& tag = ...;
+     * bool result = compiled_filter(tag);
+     * @endcode
+     */
+    template <typename TResult>
+    class CompiledTagsFilterBase {
+
+        enum class operation : uint8_t {
+            result      = 0, // the rule matches unconditionally
+            match_value = 1, // key matched already, check value of the rule
+            match_tag   = 2, // check key and value of the rule
+            lookup      = 3  // look up value in value map
+        };
+
+        struct step {
+            operation op;
+            uint32_t arg; // rule index or value map index for lookup
+        };
+
+        // For each value map: which rule matches a value id
+        struct value_map {
+            osmium::detail::string_id_map values{};
+            std::vector<uint32_t> rules{};
+        };
+
+        enum : uint32_t {
+            no_regex = std::numeric_limits<uint32_t>::max()
+        };
+
+        std::vector<std::pair<TResult, TagMatcher>> m_rules;
+
+        // For each rule: the index of the key and value matchers in the
+        // regex caches or no_regex if they are not regexes.
+        std::vector<uint32_t> m_key_regex{};
+        std::vector<uint32_t> m_value_regex{};
+
+        osmium::detail::string_matcher_cache m_key_regex_cache{};
+        osmium::detail::string_matcher_cache m_value_regex_cache{};
+
+        osmium::detail::string_id_map m_keys{};
+        std::vector<value_map> m_value_maps{};
+
+        // One program for each key in m_keys plus one for all other keys
+        std::vector<std::vector<step>> m_programs{};
+
+        TResult m_default_result;
+
+        enum class key_kind {
+            never,
+            exact,
+            other
+        };
+
+        static key_kind classify_key(const osmium::StringMatcher& matcher) noexcept {
+            if (matcher.get_if<osmium::StringMatcher::always_false>()) {
+                return key_kind::never;
+            }
+            if (matcher.get_if<osmium::StringMatcher::equal>() ||
+                matcher.get_if<osmium::StringMatcher::list>()) {
+                return key_kind::exact;
+            }
+            return key_kind::other;
+        }
+
+        static bool is_regex(const osmium::StringMatcher& matcher) noexcept {
+#ifdef OSMIUM_WITH_REGEX
+            return matcher.get_if<osmium::StringMatcher::regex>() != nullptr;
+#else
+            (void)matcher;
+            return false;
+#endif
+        }
+
+        bool match_key(uint32_t rule_num, const char* key) const {
+            if (m_key_regex[rule_num] != no_regex) {
+                return m_key_regex_cache(m_key_regex[rule_num], key);
+            }
+            return m_rules[rule_num].second.key_matcher()(key);
+        }
+
+        bool match_value(uint32_t rule_num, const char* value) const {
+            if (m_value_regex[rule_num] != no_regex) {
+                return m_value_regex_cache(m_value_regex[rule_num], value) != m_rules[rule_num].second.value_inverted();
+            }
+            return m_rules[rule_num].second.match_value(value);
+        }
+
+        template <typename TFunc>
+        static void for_each_string(const osmium::StringMatcher& matcher, TFunc&& func) {
+            if (const auto* m = matcher.get_if<osmium::StringMatcher::equal>()) {
+                func(m->str());
+            } else if (const auto* l = matcher.get_if<osmium::StringMatcher::list>()) {
+                for (const auto& str : l->strings()) {
+                    func(str);
+                }
+            }
+        }
+
+        // Add step for a rule where the key is known to match. Returns
+        // false if no further steps are needed because this always matches.
+        bool add_value_step(std::vector<step>& program, uint32_t rule_num) {
+            const osmium::TagMatcher& matcher = m_rules[rule_num].second;
+            const osmium::StringMatcher& vm = matcher.value_matcher();
+            const bool inverted = matcher.value_inverted();
+
+            if ((vm.get_if<osmium::StringMatcher::always_true>() && !inverted) ||
+                (vm.get_if<osmium::StringMatcher::always_false>() && inverted)) {
+                program.push_back(step{operation::result, rule_num});
+                return false;
+            }
+
+            if ((vm.get_if<osmium::StringMatcher::always_false>() && !inverted) ||
+                (vm.get_if<osmium::StringMatcher::always_true>() && inverted)) {
+                return true;
+            }
+
+            if (inverted || classify_key(vm) != key_kind::exact) {
+                program.push_back(step{operation::match_value, rule_num});
+                return true;
+            }
+
+            if (program.empty() || program.back().op != operation::lookup) {
+                program.push_back(step{operation::lookup, static_cast<uint32_t>(m_value_maps.size())});
+                m_value_maps.emplace_back();
+            }
+
+            auto& map = m_value_maps[program.back().arg];
+            for_each_string(vm, [&](const std::string& value) {
+                // first rule matching a value wins
+                if (map.values.add(value) == map.rules.size()) {
+                    map.rules.push_back(rule_num);
+                }
+            });
+
+            return true;
+        }
+
+        void compile() {
+            std::vector<key_kind> kinds;
+            std::vector<std::vector<std::size_t>> key_ids;
+
+            for (const auto& rule : m_rules) {
+                const osmium::TagMatcher& matcher = rule.second;
+                m_key_regex.push_back(is_regex(matcher.key_matcher()) ?
+                    static_cast<uint32_t>(m_key_regex_cache.add(matcher.key_matcher())) : no_regex);
+                m_value_regex.push_back(is_regex(matcher.value_matcher()) ?
+                    static_cast<uint32_t>(m_value_regex_cache.add(matcher.value_matcher())) : no_regex);
+
+                kinds.push_back(classify_key(rule.second.key_matcher()));
+                key_ids.emplace_back();
+                for_each_string(rule.second.key_matcher(), [&](const std::string& key) {
+                    key_ids.back().push_back(m_keys.add(key));
+                });
+            }
+
+            m_programs.resize(m_keys.size() + 1);
+
+            for (std::size_t key_id = 0; key_id < m_programs.size(); ++key_id) {
+                auto& program = m_programs[key_id];
+                for (uint32_t rule_num = 0; rule_num < m_rules.size(); ++rule_num) {
+                    if (kinds[rule_num] == key_kind::other) {
+                        program.push_back(step{operation::match_tag, rule_num});
+                    } else if (kinds[rule_num] == key_kind::exact &&
+                               std::find(key_ids[rule_num].cbegin(), key_ids[rule_num].cend(), key_id) != key_ids[rule_num].cend()) {
+                        if (!add_value_step(program, rule_num)) {
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+    public:
+
+        using iterator = boost::filter_iterator<CompiledTagsFilterBase, osmium::TagList::const_iterator>;
+
+        /**
+         * Constructor.
+         *
+         * @param filter The filter to compile.
+         */
+        explicit CompiledTagsFilterBase(const osmium::TagsFilterBase<TResult>& filter) :
+            m_rules(filter.rules()),
+            m_default_result(filter.default_result()) {
+            compile();
+        }
+
+        /**
+         * Matching function. Check the specified key and value against the
+         * rules.
+         *
+         * @param key The key of a tag.
+         * @param value The value of a tag.
+         * @returns The result of the first matching rule, or, if none of
+         *          the rules matched, the default result.
+         */
+        TResult operator()(const char* key, const char* value) const noexcept {
+            auto key_id = m_keys.find(key);
+            if (key_id == osmium::detail::string_id_map::not_found) {
+                key_id = m_keys.size();
+            }
+
+            for (const auto& s : m_programs[key_id]) {
+                switch (s.op) {
+                    case operation::result:
+                        return m_rules[s.arg].first;
+                    case operation::match_value:
+                        if (match_value(s.arg, value)) {
+                            return m_rules[s.arg].first;
+                        }
+                        break;
+                    case operation::match_tag:
+                        if (match_key(s.arg, key) && match_value(s.arg, value)) {
+                            return m_rules[s.arg].first;
+                        }
+                        break;
+                    case operation::lookup: {
+                            const auto& map = m_value_maps[s.arg];
+                            const auto value_id = map.values.find(value);
+                            if (value_id != osmium::detail::string_id_map::not_found) {
+                                return m_rules[map.rules[value_id]].first;
+                            }
+                        }
+                        break;
+                }
+            }
+
+            return m_default_result;
+        }
+
+        /**
+         * Matching function. Check the specified tag against the rules.
+         *
+         * @param tag A tag.
+         * @returns The result of the first matching rule, or, if none of
+         *          the rules matched, the default result.
+         */
+        TResult operator()(const osmium::Tag& tag) const noexcept {
+            return operator()(tag.key(), tag.value());
+        }
+
+        /**
+         * Return the number of rules in this filter.
+         *
+         * Complexity: Constant.
+         */
+        std::size_t count() const noexcept {
+            return m_rules.size();
+        }
+
+        /**
+         * Is this filter empty, ie are there no rules defined?
+         *
+         * Complexity: Constant.
+         */
+        bool empty() const noexcept {
+            return m_rules.empty();
+        }
+
+    }; // class CompiledTagsFilterBase
+
+    using CompiledTagsFilter = CompiledTagsFilterBase<bool>;
+
+} // namespace osmium
+
+
+#endif // OSMIUM_TAGS_COMPILED_TAGS_FILTER_HPP
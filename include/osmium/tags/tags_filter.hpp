@@ -134,6 +134,20 @@ namespace osmium {
             return m_default_result;
         }
 
+        /**
+         * The result returned if none of the rules matched.
+         */
+        TResult default_result() const noexcept {
+            return m_default_result;
+        }
+
+        /**
+         * Access the rules of this filter.
+         */
+        const std::vector<std::pair<TResult, TagMatcher>>& rules() const noexcept {
+            return m_rules;
+        }
+
         /**
          * Return the number of rules in this filter.
          *
@@ -33,6 +33,7 @@ DEALINGS IN THE SOFTWARE.
 
 */
 
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstddef>
@@ -42,7 +43,6 @@ DEALINGS IN THE SOFTWARE.
 #include <utility> // IWYU pragma: keep
 
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
-# include <atomic>
 # include <iostream>
 #endif
 
@@ -58,7 +58,7 @@ namespace osmium {
 
             /// Maximum size of this queue. If the queue is full pushing to
             /// the queue will block.
-            const std::size_t m_max_size;
+            std::atomic<std::size_t> m_max_size;
 
             /// Name of this queue (for debugging only).
             const std::string m_name;
@@ -95,6 +95,11 @@ namespace osmium {
             std::atomic<int> m_empty_counter;
 #endif
 
+            bool is_full() const {
+                const std::size_t max_size = m_max_size;
+                return max_size != 0 && size() >= max_size;
+            }
+
         public:
 
             /**
@@ -128,7 +133,7 @@ namespace osmium {
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
             ~Queue() {
                 std::cerr << "queue '" << m_name
-                          << "' with max_size=" << m_max_size
+                          << "' with max_size=" << m_max_size.load()
                           << " had largest size " << m_largest_size
                           << " and was full " << m_full_counter
                           << " times in " << m_push_counter
@@ -149,16 +154,15 @@ namespace osmium {
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
                 ++m_push_counter;
 #endif
-                if (m_max_size) {
-                    while (size() >= m_max_size) {
-                        std::unique_lock<std::mutex> lock{m_mutex};
-                        m_space_available.wait_for(lock, max_wait, [this] {
-                            return m_queue.size() < m_max_size;
-                        });
+                while (is_full()) {
+                    std::unique_lock<std::mutex> lock{m_mutex};
+                    m_space_available.wait_for(lock, max_wait, [this] {
+                        const std::size_t max_size = m_max_size;
+                        return max_size == 0 || m_queue.size() < max_size;
+                    });
 #ifdef OSMIUM_DEBUG_QUEUE_SIZE
-                        ++m_full_counter;
+                    ++m_full_counter;
 #endif
-                    }
                 }
                 std::lock_guard<std::mutex> lock{m_mutex};
                 m_queue.push(std::move(value));
@@ -219,6 +223,25 @@ namespace osmium {
                 return m_queue.empty();
             }
 
+            std::size_t max_size() const noexcept {
+                return m_max_size;
+            }
+
+            /**
+             * Change the maximum size of this queue. If the queue is
+             * already larger than the new size, elements are not removed,
+             * but pushing will block until the queue has shrunk below the
+             * new size. Setting the size to 0 makes the queue unlimited.
+             * This can be called while other threads use the queue.
+             */
+            void set_max_size(const std::size_t max_size) {
+                const auto old_size = m_max_size.exchange(max_size);
+                if (max_size == 0 || (old_size != 0 && max_size > old_size)) {
+                    std::lock_guard<std::mutex> lock{m_mutex};
+                    m_space_available.notify_all();
+                }
+            }
+
             std::size_t size() const {
                 std::lock_guard<std::mutex> lock{m_mutex};
                 return m_queue.size();
@@ -55,6 +55,21 @@ namespace osmium {
         }
 #endif
 
+        // Returns false if the environment variable is set to "off",
+        // "false", "no", or "0", true otherwise.
+        inline bool env_not_switched_off(const char* var) noexcept {
+            const char* env = getenv_wrapper(var);
+            if (env) {
+                if (!strcasecmp(env, "off") ||
+                    !strcasecmp(env, "false") ||
+                    !strcasecmp(env, "no") ||
+                    !strcasecmp(env, "0")) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
     } // namespace detail
 
     namespace config {
@@ -68,16 +83,23 @@ namespace osmium {
         }
 
         inline bool use_pool_threads_for_pbf_parsing() noexcept {
-            const char* env = osmium::detail::getenv_wrapper("OSMIUM_USE_POOL_THREADS_FOR_PBF_PARSING");
-            if (env) {
-                if (!strcasecmp(env, "off") ||
-                    !strcasecmp(env, "false") ||
-                    !strcasecmp(env, "no") ||
-                    !strcasecmp(env, "0")) {
-                    return false;
-                }
-            }
-            return true;
+            return osmium::detail::env_not_switched_off("OSMIUM_USE_POOL_THREADS_FOR_PBF_PARSING");
+        }
+
+        inline bool use_pool_threads_for_opl_parsing() noexcept {
+            return osmium::detail::env_not_switched_off("OSMIUM_USE_POOL_THREADS_FOR_OPL_PARSING");
+        }
+
+        inline bool use_pool_threads_for_xml_parsing() noexcept {
+            return osmium::detail::env_not_switched_off("OSMIUM_USE_POOL_THREADS_FOR_XML_PARSING");
+        }
+
+        inline bool use_pool_threads_for_o5m_parsing() noexcept {
+            return osmium::detail::env_not_switched_off("OSMIUM_USE_POOL_THREADS_FOR_O5M_PARSING");
+        }
+
+        inline bool use_io_uring() noexcept {
+            return osmium::detail::env_not_switched_off("OSMIUM_USE_IO_URING");
         }
 
         inline std::size_t get_max_queue_size(const char* queue_name, const std::size_t default_value) noexcept {
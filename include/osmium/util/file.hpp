@@ -222,6 +222,24 @@ namespace osmium {
             return static_cast<std::size_t>(offset);
         }
 
+        /**
+         * Move the offset of the file forward without reading the data.
+         * This does not work on pipes and similar, in that case the
+         * offset is not changed.
+         *
+         * @param fd Open file descriptor.
+         * @param size Number of bytes to skip.
+         * @returns true if the offset was changed, false otherwise.
+         */
+        inline bool seek_forward(int fd, std::size_t size) noexcept {
+#ifdef _MSC_VER
+            osmium::detail::disable_invalid_parameter_handler diph;
+            return _lseeki64(fd, static_cast<__int64>(size), SEEK_CUR) != -1;
+#else
+            return ::lseek(fd, static_cast<off_t>(size), SEEK_CUR) != -1;
+#endif
+        }
+
         /**
          * Check whether the file descriptor refers to a TTY.
          *
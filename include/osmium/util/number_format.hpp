@@ -0,0 +1,179 @@
+#ifndef OSMIUM_UTIL_NUMBER_FORMAT_HPP
+#define OSMIUM_UTIL_NUMBER_FORMAT_HPP
+
+/*
+
+This file is part of Osmium (https://osmcode.org/libosmium).
+
+Copyright 2013-2021 Jochen Topf <jochen@topf.org> and others (see README).
+
+Boost Software License - Version 1.0 - August 17th, 2003
+
+Permission is hereby granted, free of charge, to any person or organization
+obtaining a copy of the software and accompanying documentation covered by
+this license (the "Software") to use, reproduce, display, distribute,
+execute, and transmit the Software, and to prepare derivative works of the
+Software, and to permit third-parties to whom the Software is furnished to
+do so, all subject to the following:
+
+The copyright notices in the Software and this entire statement, including
+the above license grant, this restriction and the following disclaimer,
+must be included in all copies of the Software, in whole or in part, and
+all derivative works of the Software, unless such copies or derivative
+works are solely in the form of machine-executable object code generated by
+a source language processor.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+DEALINGS IN THE SOFTWARE.
+
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace osmium {
+
+    namespace detail {
+
+        /**
+         * Returns a pointer to a table with the two-digit decimal
+         * representations of all numbers from 0 to 99 ("00", "01", ...,
+         * "99").
+         */
+        inline const char* digit_pairs() noexcept {
+            static const char pairs[] =
+                "00010203040506070809"
+                "10111213141516171819"
+                "20212223242526272829"
+                "30313233343536373839"
+                "40414243444546474849"
+                "50515253545556575859"
+                "60616263646566676869"
+                "70717273747576777879"
+                "80818283848586878889"
+                "90919293949596979899";
+            return pairs;
+        }
+
+        /**
+         * Returns the number of decimal digits needed to write the value.
+         */
+        inline int count_decimal_digits(uint64_t value) noexcept {
+            int digits = 1;
+            while (true) {
+                if (value < 10U) {
+                    return digits;
+                }
+                if (value < 100U) {
+                    return digits + 1;
+                }
+                if (value < 1000U) {
+                    return digits + 2;
+                }
+                if (value < 10000U) {
+                    return digits + 3;
+                }
+                value /= 10000U;
+                digits += 4;
+            }
+        }
+
+        /**
+         * Write exactly num_digits decimal digits of the value (padded with
+         * zeros at the front) into the buffer ending at end. Writes two
+         * digits at a time using a lookup table.
+         */
+        inline void write_decimal_digits_backwards(char* end, uint64_t value, int num_digits) noexcept {
+            const char* pairs = digit_pairs();
+            while (num_digits >= 2) {
+                const auto index = static_cast<std::size_t>(value % 100U) * 2;
+                value /= 100U;
+                end -= 2;
+                std::memcpy(end, pairs + index, 2);
+                num_digits -= 2;
+            }
+            if (num_digits) {
+                *--end = static_cast<char>('0' + value % 10U);
+            }
+        }
+
+        /**
+         * Write the unsigned integer value in decimal into the buffer.
+         * The buffer must have space for at least 20 characters. No
+         * terminating null character is written.
+         *
+         * @returns Pointer to the character after the last one written.
+         */
+        inline char* format_unsigned_integer(char* buffer, uint64_t value) noexcept {
+            const int num_digits = count_decimal_digits(value);
+            char* end = buffer + num_digits;
+            write_decimal_digits_backwards(end, value, num_digits);
+            return end;
+        }
+
+        /**
+         * Write the integer value in decimal into the buffer. The buffer
+         * must have space for at least 20 characters. No terminating null
+         * character is written.
+         *
+         * @returns Pointer to the character after the last one written.
+         */
+        inline char* format_integer(char* buffer, int64_t value) noexcept {
+            auto uvalue = static_cast<uint64_t>(value);
+            if (value < 0) {
+                *buffer++ = '-';
+                uvalue = 0U - uvalue;
+            }
+            return format_unsigned_integer(buffer, uvalue);
+        }
+
+        /**
+         * Write fixed-point value with the given number of decimal places
+         * into the buffer. Trailing zeros after the decimal point and the
+         * decimal point itself if there are no non-zero decimal places are
+         * not written. No terminating null character is written.
+         *
+         * The buffer must have space for the sign, the digits of the
+         * integer part, the decimal point, and the number of decimal
+         * places. For arbitrary values this is 21 characters plus the
+         * number of decimal places, callers knowing the range of their
+         * values can use smaller buffers (see format_location_coordinate()).
+         *
+         * @returns Pointer to the character after the last one written.
+         */
+        inline char* format_fixed_point(char* buffer, int64_t value, uint64_t divisor, int decimal_places) noexcept {
+            assert(divisor > 0);
+            auto uvalue = static_cast<uint64_t>(value);
+            if (value < 0) {
+                *buffer++ = '-';
+                uvalue = 0U - uvalue;
+            }
+
+            buffer = format_unsigned_integer(buffer, uvalue / divisor);
+
+            const uint64_t fraction = uvalue % divisor;
+            if (fraction == 0) {
+                return buffer;
+            }
+
+            *buffer++ = '.';
+            char* end = buffer + decimal_places;
+            write_decimal_digits_backwards(end, fraction, decimal_places);
+            while (end[-1] == '0') {
+                --end;
+            }
+            return end;
+        }
+
+    } // namespace detail
+
+} // namespace osmium
+
+#endif // OSMIUM_UTIL_NUMBER_FORMAT_HPP
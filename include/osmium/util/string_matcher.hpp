@@ -136,6 +136,10 @@ namespace osmium {
                 return !std::strcmp(m_str.c_str(), test_string);
             }
 
+            const std::string& str() const noexcept {
+                return m_str;
+            }
+
             template <typename TChar, typename TTraits>
             void print(std::basic_ostream<TChar, TTraits>& out) const {
                 out << "equal[" << m_str << ']';
@@ -161,7 +165,9 @@ namespace osmium {
             }
 
             bool match(const char* test_string) const noexcept {
-                return m_str.compare(0, std::string::npos, test_string, 0, m_str.size()) == 0;
+                // Compares at most m_str.size() chars of the test string
+                // and never needs its length.
+                return std::strncmp(test_string, m_str.c_str(), m_str.size()) == 0;
             }
 
             template <typename TChar, typename TTraits>
@@ -251,12 +257,21 @@ namespace osmium {
             }
 
             bool match(const char* test_string) const noexcept {
+                // Calculate length only once and compare it first, so
+                // that most strings can be rejected without looking at
+                // the contents.
+                const std::size_t length = std::strlen(test_string);
                 return std::any_of(m_strings.cbegin(), m_strings.cend(),
-                                   [&test_string](const std::string& s){
-                    return s == test_string;
+                                   [&test_string, length](const std::string& s){
+                    return s.size() == length &&
+                           !std::memcmp(s.data(), test_string, length);
                 });
             }
 
+            const std::vector<std::string>& strings() const noexcept {
+                return m_strings;
+            }
+
             template <typename TChar, typename TTraits>
             void print(std::basic_ostream<TChar, TTraits>& out) const {
                 out << "list[";
@@ -413,6 +428,19 @@ namespace osmium {
             return operator()(str.c_str());
         }
 
+        /**
+         * Get access to the underlying matcher if it is of the specified
+         * type.
+         *
+         * @tparam TMatcher One of the matcher classes.
+         * @returns Pointer to the matcher or nullptr if this StringMatcher
+         *          contains a different kind of matcher.
+         */
+        template <typename TMatcher>
+        const TMatcher* get_if() const noexcept {
+            return boost::get<TMatcher>(&m_matcher);
+        }
+
         template <typename TChar, typename TTraits>
         void print(std::basic_ostream<TChar, TTraits>& out) const {
             boost::apply_visitor(print_visitor<TChar, TTraits>{out}, m_matcher);
@@ -95,7 +95,10 @@ static header_buffer_type parse_xml(std::string input) {
         header_promise,
         &offset,
         osmium::osm_entity_bits::all,
+        osmium::Box{},
+        osmium::io::read_tags_filter{},
         osmium::io::read_meta::yes,
+        osmium::io::detail::object_parts{},
         osmium::io::buffers_type::any,
         false
     };
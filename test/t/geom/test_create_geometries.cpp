@@ -0,0 +1,171 @@
+#include "catch.hpp"
+
+#include "area_helper.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/geom/create_geometries.hpp>
+#include <osmium/geom/geojson.hpp>
+#include <osmium/geom/wkb.hpp>
+#include <osmium/geom/wkt.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/thread/pool.hpp>
+
+#include <stdexcept>
+#include <string>
+
+using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+static void fill_test_buffer(osmium::memory::Buffer& buffer) {
+    osmium::builder::add_node(buffer, _id(1), _location(1.0, 2.0));
+
+    for (int i = 0; i < 100; ++i) {
+        const double x = i * 0.1;
+        if (i % 10 == 3) { // only one location
+            osmium::builder::add_way(buffer, _id(i + 1), _nodes({
+                {1, {x, 1.0}},
+                {2, {x, 1.0}}
+            }));
+        } else if (i % 10 == 7) { // undefined location
+            osmium::builder::add_way(buffer, _id(i + 1), _nodes({
+                {1, {x, 1.0}},
+                {2, osmium::Location{}}
+            }));
+        } else {
+            osmium::builder::add_way(buffer, _id(i + 1), _nodes({
+                {1, {x, 1.0}},
+                {2, {x + 0.05, 1.5}},
+                {3, {x, 2.0}}
+            }));
+        }
+    }
+
+    osmium::builder::add_relation(buffer, _id(1));
+}
+
+// Projection throwing an exception that isn't handled by create_geometries().
+struct ThrowingProjection {
+
+    osmium::geom::Coordinates operator()(osmium::Location location) const {
+        if (location.lon() > 5.0) {
+            throw std::runtime_error{"projection failed"};
+        }
+        return osmium::geom::Coordinates{location.lon(), location.lat()};
+    }
+
+    static int epsg() noexcept {
+        return 4326;
+    }
+
+    static std::string proj_string() noexcept {
+        return "+proj=longlat +datum=WGS84 +no_defs";
+    }
+
+};
+
+template <typename TFactory>
+static void check_geometries(const osmium::memory::Buffer& buffer, const TFactory& factory) {
+    osmium::thread::Pool pool{2};
+
+    for (const std::size_t block_size : {1, 7, 100, 1000}) {
+        const auto results = osmium::geom::create_geometries(pool, buffer, factory, block_size);
+
+        TFactory expected_factory{factory};
+        auto it = results.cbegin();
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            if (object.type() == osmium::item_type::way) {
+                REQUIRE(it != results.cend());
+                REQUIRE(it->object == &object);
+                try {
+                    const auto geometry = expected_factory.create_linestring(static_cast<const osmium::Way&>(object));
+                    REQUIRE(it->valid());
+                    REQUIRE(it->geometry == geometry);
+                } catch (const osmium::geometry_error& e) {
+                    REQUIRE_FALSE(it->valid());
+                    REQUIRE(it->error == e.what());
+                } catch (const osmium::invalid_location& e) {
+                    REQUIRE_FALSE(it->valid());
+                    REQUIRE(it->error == e.what());
+                }
+                ++it;
+            }
+        }
+        REQUIRE(it == results.cend());
+    }
+}
+
+TEST_CASE("Create WKT geometries in parallel") {
+    osmium::memory::Buffer buffer{10000, osmium::memory::Buffer::auto_grow::yes};
+    fill_test_buffer(buffer);
+
+    check_geometries(buffer, osmium::geom::WKTFactory<>{});
+}
+
+TEST_CASE("Create WKB geometries in parallel") {
+    osmium::memory::Buffer buffer{10000, osmium::memory::Buffer::auto_grow::yes};
+    fill_test_buffer(buffer);
+
+    check_geometries(buffer, osmium::geom::WKBFactory<>{osmium::geom::wkb_type::ewkb, osmium::geom::out_type::hex});
+}
+
+TEST_CASE("Create GeoJSON geometries in parallel") {
+    osmium::memory::Buffer buffer{10000, osmium::memory::Buffer::auto_grow::yes};
+    fill_test_buffer(buffer);
+
+    check_geometries(buffer, osmium::geom::GeoJSONFactory<>{});
+}
+
+TEST_CASE("Create geometries in parallel with default pool") {
+    osmium::memory::Buffer buffer{10000, osmium::memory::Buffer::auto_grow::yes};
+    fill_test_buffer(buffer);
+
+    const auto results = osmium::geom::create_geometries(buffer, osmium::geom::WKTFactory<>{});
+    REQUIRE(results.size() == 100);
+    REQUIRE(results[0].valid());
+    REQUIRE(results[0].object->id() == 1);
+    REQUIRE(results[0].geometry == "LINESTRING(0 1,0.05 1.5,0 2)");
+    REQUIRE_FALSE(results[3].valid());
+    REQUIRE(results[3].geometry.empty());
+    REQUIRE(results[99].object->id() == 100);
+}
+
+TEST_CASE("Create geometries for areas in parallel") {
+    osmium::memory::Buffer buffer{10000};
+    create_test_area_1outer_1inner(buffer);
+    create_test_area_2outer_2inner(buffer);
+
+    osmium::geom::WKTFactory<> factory;
+    osmium::thread::Pool pool{2};
+    const auto results = osmium::geom::create_geometries(pool, buffer, factory, 1);
+
+    REQUIRE(results.size() == 2);
+    auto it = results.cbegin();
+    for (const auto& area : buffer.select<osmium::Area>()) {
+        REQUIRE(it->object == &area);
+        REQUIRE(it->valid());
+        REQUIRE(it->geometry == factory.create_multipolygon(area));
+        ++it;
+    }
+}
+
+TEST_CASE("Create geometries in parallel for empty buffer") {
+    osmium::memory::Buffer buffer{1000};
+    osmium::thread::Pool pool{2};
+    const auto results = osmium::geom::create_geometries(pool, buffer, osmium::geom::WKTFactory<>{});
+    REQUIRE(results.empty());
+}
+
+TEST_CASE("Create geometries in parallel rethrows other exceptions after all tasks are done") {
+    osmium::memory::Buffer buffer{10000, osmium::memory::Buffer::auto_grow::yes};
+    fill_test_buffer(buffer);
+
+    osmium::geom::GeometryFactory<osmium::geom::detail::WKTFactoryImpl, ThrowingProjection> factory;
+    osmium::thread::Pool pool{2};
+    for (const std::size_t block_size : {1, 7, 1000}) {
+        REQUIRE_THROWS_AS(osmium::geom::create_geometries(pool, buffer, factory, block_size), const std::runtime_error&);
+    }
+
+    // pool is still usable
+    const auto results = osmium::geom::create_geometries(pool, buffer, osmium::geom::WKTFactory<>{});
+    REQUIRE(results.size() == 100);
+}
+
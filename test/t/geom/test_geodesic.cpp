@@ -0,0 +1,98 @@
+#include "catch.hpp"
+
+#include "wnl_helper.hpp"
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/geodesic.hpp>
+#include <osmium/geom/haversine.hpp>
+
+#include <cmath>
+#include <vector>
+
+TEST_CASE("Geodesic distance between two coordinates") {
+    // Flinders Peak to Buninyong, test data from Vincenty's paper
+    const osmium::geom::Coordinates c1{144.0 + 25.0 / 60 + 29.52440 / 3600, -(37.0 + 57.0 / 60 + 3.72030 / 3600)};
+    const osmium::geom::Coordinates c2{143.0 + 55.0 / 60 + 35.38390 / 3600, -(37.0 + 39.0 / 60 + 10.15610 / 3600)};
+    REQUIRE(std::abs(osmium::geom::geodesic::distance(c1, c2) - 54972.271) < 0.001);
+    REQUIRE(std::abs(osmium::geom::geodesic::distance(c2, c1) - 54972.271) < 0.001);
+}
+
+TEST_CASE("Geodesic distance along equator and meridian") {
+    const osmium::geom::Coordinates c0{0.0, 0.0};
+
+    // one degree along the equator
+    REQUIRE(osmium::geom::geodesic::distance(c0, osmium::geom::Coordinates{1.0, 0.0}) == Approx(111319.491).epsilon(0.0000001));
+
+    // equator to pole
+    REQUIRE(osmium::geom::geodesic::distance(c0, osmium::geom::Coordinates{0.0, 90.0}) == Approx(10001965.729).epsilon(0.0000001));
+
+    REQUIRE(osmium::geom::geodesic::distance(c0, c0) == 0.0);
+}
+
+TEST_CASE("Geodesic distance across the antimeridian") {
+    const osmium::geom::Coordinates c1{179.999, 10.0};
+    const osmium::geom::Coordinates c2{-179.999, 10.0};
+    const osmium::geom::Coordinates c3{179.0, 10.0};
+    const osmium::geom::Coordinates c4{-179.0, 10.0};
+
+    REQUIRE(osmium::geom::geodesic::distance(c1, c2) == Approx(219.3).epsilon(0.001));
+    REQUIRE(osmium::geom::geodesic::distance(c3, c4) == Approx(219.3 * 1000).epsilon(0.001));
+}
+
+TEST_CASE("Geodesic distance for nearly antipodal points falls back to spherical distance") {
+    const osmium::geom::Coordinates c1{0.0, 0.0};
+    const osmium::geom::Coordinates c2{179.7, 0.5};
+    const double d = osmium::geom::geodesic::distance(c1, c2);
+    REQUIRE(d > 19900000.0);
+    REQUIRE(d < 20040000.0);
+}
+
+TEST_CASE("Geodesic fast path for short segments agrees with Vincenty's formula") {
+    using osmium::geom::geodesic::detail::point;
+
+    for (const double lat : {-89.0, -60.0, -30.0, 0.0, 0.1, 45.0, 70.0, 85.0}) {
+        for (const double delta : {0.000001, 0.0001, 0.003, 0.00999}) {
+            const point p1{8.3, lat};
+            const point p2{8.3 + delta, lat - delta};
+            const double fast = osmium::geom::geodesic::detail::short_distance(p1, p2, delta);
+            const double exact = osmium::geom::geodesic::detail::vincenty_distance(p1, p2, delta);
+            REQUIRE(std::abs(fast - exact) < 0.0001);
+        }
+    }
+}
+
+TEST_CASE("Geodesic length of coordinates is close to haversine length") {
+    const std::vector<osmium::geom::Coordinates> coordinates{
+        osmium::geom::Coordinates{9.5, 47.1},
+        osmium::geom::Coordinates{9.5001, 47.1002},
+        osmium::geom::Coordinates{9.51, 47.12},
+        osmium::geom::Coordinates{9.51, 47.12},
+        osmium::geom::Coordinates{9.8, 47.3}
+    };
+
+    double sum = 0.0;
+    for (std::size_t i = 1; i < coordinates.size(); ++i) {
+        sum += osmium::geom::geodesic::distance(coordinates[i - 1], coordinates[i]);
+    }
+
+    const double length = osmium::geom::geodesic::distance(coordinates.data(), coordinates.size());
+    REQUIRE(length == sum);
+    REQUIRE(length == Approx(osmium::geom::haversine::distance(coordinates.data(), coordinates.size())).epsilon(0.005));
+}
+
+TEST_CASE("Geodesic length of way node list") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    const double expected = osmium::geom::geodesic::distance(osmium::geom::Coordinates{3.2, 4.2}, osmium::geom::Coordinates{3.5, 4.7}) +
+                            osmium::geom::geodesic::distance(osmium::geom::Coordinates{3.5, 4.7}, osmium::geom::Coordinates{3.6, 4.9});
+    REQUIRE(osmium::geom::geodesic::distance(wnl) == Approx(expected));
+}
+
+TEST_CASE("Geodesic length of way node list with undefined location") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_undefined_location(buffer);
+
+    REQUIRE_THROWS_AS(osmium::geom::geodesic::distance(wnl), const osmium::invalid_location&);
+}
+
@@ -0,0 +1,60 @@
+#include "catch.hpp"
+
+#include "wnl_helper.hpp"
+
+#include <osmium/geom/coordinates.hpp>
+#include <osmium/geom/haversine.hpp>
+
+#include <vector>
+
+TEST_CASE("Haversine distance between two coordinates") {
+    const osmium::geom::Coordinates c1{0.0, 0.0};
+    const osmium::geom::Coordinates c2{1.0, 0.0};
+    REQUIRE(osmium::geom::haversine::distance(c1, c2) == Approx(111226.3).epsilon(0.000001));
+    REQUIRE(osmium::geom::haversine::distance(c1, c1) == Approx(0.0));
+}
+
+TEST_CASE("Haversine length of coordinates is sum of segment distances") {
+    const std::vector<osmium::geom::Coordinates> coordinates{
+        osmium::geom::Coordinates{9.5, 47.1},
+        osmium::geom::Coordinates{9.5001, 47.1002},
+        osmium::geom::Coordinates{9.51, 47.12},
+        osmium::geom::Coordinates{9.51, 47.12},
+        osmium::geom::Coordinates{-120.3, -33.7},
+        osmium::geom::Coordinates{170.2, 10.4}
+    };
+
+    double sum = 0.0;
+    for (std::size_t i = 1; i < coordinates.size(); ++i) {
+        sum += osmium::geom::haversine::distance(coordinates[i - 1], coordinates[i]);
+    }
+
+    REQUIRE(osmium::geom::haversine::distance(coordinates.data(), coordinates.size()) == sum);
+    REQUIRE(osmium::geom::haversine::distance(coordinates.data(), 1) == 0.0);
+    REQUIRE(osmium::geom::haversine::distance(coordinates.data(), 0) == 0.0);
+}
+
+TEST_CASE("Haversine length of way node list") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    const double expected = osmium::geom::haversine::distance(osmium::geom::Coordinates{3.2, 4.2}, osmium::geom::Coordinates{3.5, 4.7}) +
+                            osmium::geom::haversine::distance(osmium::geom::Coordinates{3.5, 4.7}, osmium::geom::Coordinates{3.6, 4.9});
+    REQUIRE(osmium::geom::haversine::distance(wnl) == Approx(expected));
+    REQUIRE(osmium::geom::haversine::distance(static_cast<const osmium::NodeRefList&>(wnl)) == Approx(expected));
+}
+
+TEST_CASE("Haversine length of way node list with undefined location") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_undefined_location(buffer);
+
+    REQUIRE_THROWS_AS(osmium::geom::haversine::distance(wnl), const osmium::invalid_location&);
+}
+
+TEST_CASE("Haversine length of empty way node list") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_empty(buffer);
+
+    REQUIRE(osmium::geom::haversine::distance(wnl) == 0.0);
+}
+
@@ -2,6 +2,9 @@
 
 #include <osmium/geom/mercator_projection.hpp>
 
+#include <cstddef>
+#include <vector>
+
 TEST_CASE("Mercator projection") {
     const osmium::geom::MercatorProjection projection;
     REQUIRE(3857 == projection.epsg());
@@ -32,3 +35,71 @@ TEST_CASE("Mercator bounds") {
     REQUIRE(osmium::geom::detail::y_to_lat(osmium::geom::detail::lon_to_x(180.0)) == Approx(osmium::geom::MERCATOR_MAX_LAT).epsilon(0.0000001));
 }
 
+
+TEST_CASE("Mercator projection of many locations at once") {
+    const osmium::geom::MercatorProjection projection;
+
+    std::vector<osmium::Location> locations;
+    for (int i = -180; i <= 180; i += 3) {
+        locations.emplace_back(static_cast<double>(i), static_cast<double>(i) * 0.45);
+    }
+    std::vector<osmium::geom::Coordinates> coordinates(locations.size());
+
+    SECTION("all latitudes in range of polynomial") {
+        projection(locations.data() + 10, coordinates.data(), 15);
+        for (std::size_t i = 0; i < 15; ++i) {
+            REQUIRE(coordinates[i].x == projection(locations[i + 10]).x);
+            REQUIRE(coordinates[i].y == projection(locations[i + 10]).y);
+        }
+    }
+
+    SECTION("first latitude outside range of polynomial") {
+        projection(locations.data(), coordinates.data(), 10);
+        for (std::size_t i = 0; i < 10; ++i) {
+            REQUIRE(coordinates[i].x == projection(locations[i]).x);
+            REQUIRE(coordinates[i].y == projection(locations[i]).y);
+        }
+    }
+
+    SECTION("with latitudes outside range of polynomial") {
+        projection(locations.data(), coordinates.data(), locations.size());
+        for (std::size_t i = 0; i < locations.size(); ++i) {
+            REQUIRE(coordinates[i].x == projection(locations[i]).x);
+            REQUIRE(coordinates[i].y == projection(locations[i]).y);
+        }
+    }
+
+    SECTION("invalid location") {
+        locations[5] = osmium::Location{};
+        REQUIRE_THROWS_AS(projection(locations.data(), coordinates.data(), locations.size()), const osmium::invalid_location&);
+    }
+}
+
+TEST_CASE("Low level mercator function for many coordinates gives same results as for one") {
+    std::vector<osmium::geom::Coordinates> coordinates;
+    for (int i = -780000; i <= 780000; i += 7) {
+        coordinates.emplace_back(0.0, static_cast<double>(i) / 10000.0);
+    }
+    std::vector<osmium::geom::Coordinates> out(coordinates.size());
+
+    osmium::geom::lonlat_to_mercator(coordinates.data(), out.data(), coordinates.size());
+    for (std::size_t i = 0; i < coordinates.size(); ++i) {
+        REQUIRE(out[i].y == osmium::geom::lonlat_to_mercator(coordinates[i]).y);
+    }
+}
+
+TEST_CASE("Low level mercator function for many coordinates in place") {
+    std::vector<osmium::geom::Coordinates> coordinates{
+        osmium::geom::Coordinates{17.839, -3.249},
+        osmium::geom::Coordinates{-89.2, 15.915},
+        osmium::geom::Coordinates{180.0, 85.0}
+    };
+    const auto input = coordinates;
+
+    osmium::geom::lonlat_to_mercator(coordinates.data(), coordinates.data(), coordinates.size());
+    for (std::size_t i = 0; i < coordinates.size(); ++i) {
+        const auto c = osmium::geom::lonlat_to_mercator(input[i]);
+        REQUIRE(coordinates[i].x == c.x);
+        REQUIRE(coordinates[i].y == c.y);
+    }
+}
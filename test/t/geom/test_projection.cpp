@@ -4,6 +4,9 @@
 #include <osmium/geom/mercator_projection.hpp>
 #include <osmium/geom/projection.hpp>
 
+#include <cstddef>
+#include <vector>
+
 TEST_CASE("Indentity Projection") {
     osmium::geom::IdentityProjection projection;
     REQUIRE(4326 == projection.epsg());
@@ -106,3 +109,22 @@ TEST_CASE("MercatorProjection: Max latitude") {
     REQUIRE(projection(loc).y == Approx(c.y).epsilon(0.00001));
 }
 
+
+TEST_CASE("Projection of many locations at once") {
+    const std::vector<osmium::Location> locations{
+        osmium::Location{0.0, 0.0},
+        osmium::Location{180.0, 0.0},
+        osmium::Location{-12.5, 47.3},
+        osmium::Location{8.7, -60.0}
+    };
+    std::vector<osmium::geom::Coordinates> coordinates(locations.size());
+
+    for (const int epsg : {4326, 3857, 32632}) {
+        const osmium::geom::Projection projection{epsg};
+        projection(locations.data(), coordinates.data(), locations.size());
+        for (std::size_t i = 0; i < locations.size(); ++i) {
+            REQUIRE(coordinates[i].x == projection(locations[i]).x);
+            REQUIRE(coordinates[i].y == projection(locations[i]).y);
+        }
+    }
+}
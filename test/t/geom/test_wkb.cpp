@@ -1,5 +1,6 @@
 #include "catch.hpp"
 
+#include "area_helper.hpp"
 #include "wnl_helper.hpp"
 
 #include <osmium/geom/mercator_projection.hpp>
@@ -146,3 +147,100 @@ TEST_CASE("WKB geometry (byte-order-independent) of empty linestring") {
     REQUIRE_THROWS_AS(factory.create_linestring(wnl, osmium::geom::use_nodes::all, osmium::geom::direction::backward), const osmium::geometry_error&);
 }
 
+
+TEST_CASE("WKB buffer factory creates same geometries as WKB factory") {
+    osmium::memory::Buffer area_buffer{10000};
+    const osmium::Area& area = create_test_area_2outer_2inner(area_buffer);
+
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+    const auto& wnl_closed = create_test_wnl_closed(buffer);
+
+    for (const auto wtype : {osmium::geom::wkb_type::wkb, osmium::geom::wkb_type::ewkb}) {
+        for (const auto otype : {osmium::geom::out_type::binary, osmium::geom::out_type::hex}) {
+            osmium::geom::WKBFactory<osmium::geom::MercatorProjection> factory{wtype, otype};
+
+            std::string out{"foo"};
+            osmium::geom::WKBBufferFactory<osmium::geom::MercatorProjection> buffer_factory{out, wtype, otype};
+
+            std::string expected{"foo"};
+            expected += factory.create_point(osmium::Location{3.2, 4.2});
+            const auto point_size = expected.size() - 3;
+            REQUIRE(buffer_factory.create_point(osmium::Location{3.2, 4.2}) == point_size);
+
+            expected += factory.create_linestring(wnl);
+            expected += factory.create_linestring(wnl, osmium::geom::use_nodes::all, osmium::geom::direction::backward);
+            expected += factory.create_polygon(wnl_closed);
+            expected += factory.create_multipolygon(area);
+
+            const auto linestring_size = buffer_factory.create_linestring(wnl);
+            REQUIRE(out.size() == 3 + point_size + linestring_size);
+            buffer_factory.create_linestring(wnl, osmium::geom::use_nodes::all, osmium::geom::direction::backward);
+            buffer_factory.create_polygon(wnl_closed);
+            buffer_factory.create_multipolygon(area);
+
+            REQUIRE(out == expected);
+        }
+    }
+}
+
+TEST_CASE("WKB buffer factory leaves buffer unchanged on errors") {
+    osmium::memory::Buffer buffer{10000};
+    std::string out;
+    osmium::geom::WKBBufferFactory<> factory{out, osmium::geom::wkb_type::ewkb, osmium::geom::out_type::hex};
+
+    const auto size = factory.create_linestring(create_test_wnl_okay(buffer));
+    REQUIRE(out.size() == size);
+    const std::string data{out};
+
+    REQUIRE_THROWS_AS(factory.create_point(osmium::Location{}), const osmium::invalid_location&);
+    REQUIRE(out == data);
+
+    REQUIRE_THROWS_AS(factory.create_linestring(create_test_wnl_empty(buffer)), const osmium::geometry_error&);
+    REQUIRE(out == data);
+
+    REQUIRE_THROWS_AS(factory.create_linestring(create_test_wnl_same_location(buffer)), const osmium::geometry_error&);
+    REQUIRE(out == data);
+
+    REQUIRE_THROWS_AS(factory.create_linestring(create_test_wnl_undefined_location(buffer)), const osmium::invalid_location&);
+    REQUIRE(out == data);
+
+    REQUIRE_THROWS_AS(factory.create_polygon(create_test_wnl_okay(buffer)), const osmium::geometry_error&);
+    REQUIRE(out == data);
+
+    REQUIRE(factory.create_linestring(create_test_wnl_okay(buffer)) == size);
+    REQUIRE(out == data + data);
+}
+
+TEST_CASE("WKB buffer factory reserves space for all locations of a geometry") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    for (const auto otype : {osmium::geom::out_type::binary, osmium::geom::out_type::hex}) {
+        std::string out;
+        osmium::geom::WKBBufferFactory<> factory{out, osmium::geom::wkb_type::wkb, otype};
+
+        factory.linestring_start();
+        const auto num_points = factory.fill_linestring(wnl.cbegin(), wnl.cend());
+        const auto capacity = out.capacity();
+        const auto size = factory.linestring_finish(num_points);
+        REQUIRE(out.size() == size);
+        REQUIRE(capacity >= size);
+    }
+}
+
+TEST_CASE("WKB buffer factory removes unfinished geometry when creating point") {
+    osmium::memory::Buffer buffer{10000};
+    const auto& wnl = create_test_wnl_okay(buffer);
+
+    std::string out;
+    osmium::geom::WKBBufferFactory<> factory{out, osmium::geom::wkb_type::wkb, osmium::geom::out_type::hex};
+    osmium::geom::WKBFactory<> wkb_factory{osmium::geom::wkb_type::wkb, osmium::geom::out_type::hex};
+
+    factory.linestring_start();
+    factory.fill_linestring(wnl.cbegin(), wnl.cend());
+
+    const auto size = factory.create_point(osmium::Location{3.2, 4.2});
+    REQUIRE(out.size() == size);
+    REQUIRE(out == wkb_factory.create_point(osmium::Location{3.2, 4.2}));
+}
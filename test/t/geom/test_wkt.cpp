@@ -153,3 +153,57 @@ TEST_CASE("WKT geometry factory") {
 
 }
 
+
+// Mercator projection without the batch interface
+class ScalarMercatorProjection {
+
+public:
+
+    osmium::geom::Coordinates operator()(osmium::Location location) const {
+        return osmium::geom::MercatorProjection{}(location);
+    }
+
+    static int epsg() noexcept {
+        return 3857;
+    }
+
+    static std::string proj_string() noexcept {
+        return osmium::geom::MercatorProjection::proj_string();
+    }
+
+}; // class ScalarMercatorProjection
+
+TEST_CASE("WKT geometry factory with batch and scalar projection") {
+    REQUIRE(osmium::geom::detail::has_batch_projection<osmium::geom::MercatorProjection>::value);
+    REQUIRE_FALSE(osmium::geom::detail::has_batch_projection<ScalarMercatorProjection>::value);
+
+    // Use enough digits to see any difference between the results.
+    osmium::geom::WKTFactory<osmium::geom::MercatorProjection> factory{9};
+    osmium::geom::WKTFactory<ScalarMercatorProjection> scalar_factory{9};
+
+    osmium::memory::Buffer buffer{10000};
+
+    SECTION("linestring") {
+        const auto& wnl = create_test_wnl_okay(buffer);
+        const std::string wkt{factory.create_linestring(wnl, osmium::geom::use_nodes::all, osmium::geom::direction::backward)};
+        REQUIRE(wkt == scalar_factory.create_linestring(wnl, osmium::geom::use_nodes::all, osmium::geom::direction::backward));
+        osmium::geom::WKTFactory<osmium::geom::MercatorProjection> short_factory{2};
+        REQUIRE(short_factory.create_linestring(wnl, osmium::geom::use_nodes::all, osmium::geom::direction::backward) == "LINESTRING(400750.17 546131.63,389618.22 523789.37,389618.22 523789.37,356222.37 467961.14)");
+    }
+
+    SECTION("polygon") {
+        const auto& wnl = create_test_wnl_closed(buffer);
+        REQUIRE(factory.create_polygon(wnl) == scalar_factory.create_polygon(wnl));
+    }
+
+    SECTION("area") {
+        const osmium::Area& area = create_test_area_2outer_2inner(buffer);
+        REQUIRE(factory.create_multipolygon(area) == scalar_factory.create_multipolygon(area));
+    }
+
+    SECTION("linestring with undefined location") {
+        const auto& wnl = create_test_wnl_undefined_location(buffer);
+        REQUIRE_THROWS_AS(factory.create_linestring(wnl), const osmium::invalid_location&);
+        REQUIRE_THROWS_AS(scalar_factory.create_linestring(wnl), const osmium::invalid_location&);
+    }
+}
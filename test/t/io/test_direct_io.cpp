@@ -0,0 +1,58 @@
+#include "catch.hpp"
+
+#include <osmium/io/detail/direct_io.hpp>
+#include <osmium/io/detail/read_write.hpp>
+#include <osmium/util/file.hpp>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+static std::string make_test_data(const std::size_t size) {
+    std::string data;
+    data.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data += static_cast<char>('a' + (i * 7) % 26);
+    }
+    return data;
+}
+
+TEST_CASE("Aligned buffer is aligned") {
+    const osmium::io::detail::AlignedBuffer buffer;
+    REQUIRE(reinterpret_cast<std::uintptr_t>(buffer.data()) % osmium::io::detail::direct_io_alignment == 0);
+}
+
+TEST_CASE("Write and read file with direct I/O") {
+    const std::string filename{"test-direct-io.txt"};
+    const std::string data = make_test_data(osmium::io::detail::direct_io_buffer_size + 12345);
+
+    {
+        const int fd = osmium::io::detail::open_for_writing(filename, osmium::io::overwrite::allow);
+        REQUIRE(fd > 0);
+        osmium::io::detail::enable_direct_io(fd);
+        osmium::io::detail::DirectFileWriter writer{fd};
+        writer.write(data.data(), 10);
+        writer.write(data.data() + 10, data.size() - 10);
+        writer.finish();
+        REQUIRE_FALSE(osmium::io::detail::has_direct_io(fd));
+        osmium::io::detail::reliable_close(fd);
+    }
+
+    REQUIRE(osmium::file_size(filename) == data.size());
+
+    {
+        const int fd = osmium::io::detail::open_for_reading(filename);
+        REQUIRE(fd > 0);
+        osmium::io::detail::enable_direct_io(fd);
+        osmium::io::detail::DirectFileReader reader{fd};
+        std::string result(data.size(), '\0');
+        REQUIRE(reader.read_exactly(&result[0], 4));
+        REQUIRE(reader.read_exactly(&result[4], data.size() - 4));
+        REQUIRE(result == data);
+        char c = 0;
+        REQUIRE_FALSE(reader.read_exactly(&c, 1));
+        osmium::io::detail::reliable_close(fd);
+    }
+
+    REQUIRE(std::remove(filename.c_str()) == 0);
+}
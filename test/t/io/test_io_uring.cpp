@@ -0,0 +1,136 @@
+#define OSMIUM_WITH_IO_URING
+
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/io/compression.hpp>
+#include <osmium/io/detail/io_uring.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <string>
+
+#if defined(OSMIUM_WITH_IO_URING) && defined(__linux__)
+
+#include <unistd.h>
+
+static std::string make_test_data(const std::size_t size) {
+    std::string data;
+    data.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data += static_cast<char>('a' + (i * 7) % 26);
+    }
+    return data;
+}
+
+TEST_CASE("Read uncompressed file with io_uring backend enabled") {
+    const int count = count_fds();
+
+    const std::string input_file = with_data_dir("t/io/data.txt");
+    const int fd = osmium::io::detail::open_for_reading(input_file);
+    REQUIRE(fd > 0);
+
+    osmium::io::NoDecompressor decomp{fd};
+    const std::string data = decomp.read();
+    REQUIRE(data == "TESTDATA\n");
+    REQUIRE(decomp.read().empty());
+    decomp.close();
+
+    REQUIRE(count == count_fds());
+}
+
+TEST_CASE("Write and read back large file with io_uring backend enabled") {
+    const std::string filename{"test-io-uring.txt"};
+    const std::string data = make_test_data(3 * osmium::io::Decompressor::input_buffer_size / 2 + 17);
+
+    {
+        const int fd = osmium::io::detail::open_for_writing(filename, osmium::io::overwrite::allow);
+        REQUIRE(fd > 0);
+        osmium::io::NoCompressor comp{fd, osmium::io::fsync::no};
+        for (std::size_t pos = 0; pos < data.size(); pos += 100000) {
+            comp.write(data.substr(pos, 100000));
+        }
+        comp.close();
+        REQUIRE(comp.file_size() == data.size());
+    }
+
+    std::string result;
+    {
+        const int fd = osmium::io::detail::open_for_reading(filename);
+        REQUIRE(fd > 0);
+        osmium::io::NoDecompressor decomp{fd};
+        std::atomic<std::size_t> offset{0};
+        decomp.set_offset_ptr(&offset);
+        std::string buffer;
+        while (!(buffer = decomp.read()).empty()) {
+            result += buffer;
+        }
+        REQUIRE(offset == data.size());
+        decomp.close();
+    }
+
+    REQUIRE(result == data);
+
+    REQUIRE(std::remove(filename.c_str()) == 0);
+}
+
+TEST_CASE("Read file in pieces with io_uring reader") {
+    const std::string filename{"test-io-uring.txt"};
+    const std::string data = make_test_data(100000);
+
+    {
+        const int fd = osmium::io::detail::open_for_writing(filename, osmium::io::overwrite::allow);
+        osmium::io::detail::reliable_write(fd, data.data(), data.size());
+        osmium::io::detail::reliable_close(fd);
+    }
+
+    const int fd = osmium::io::detail::open_for_reading(filename);
+    REQUIRE(fd > 0);
+
+    {
+        auto reader = osmium::io::detail::make_uring_reader(fd, 1000);
+        if (reader) {
+            std::string result(data.size(), '\0');
+            REQUIRE(reader->read_exactly(&result[0], 4));
+            REQUIRE(reader->read_exactly(&result[4], 2500));
+            REQUIRE(reader->read_exactly(&result[2504], 17));
+            const std::string rest = reader->read();
+            REQUIRE(rest.size() == 1000 - 2521 % 1000);
+            std::copy(rest.begin(), rest.end(), result.begin() + 2521);
+            REQUIRE(reader->read_exactly(&result[3000], data.size() - 3000));
+            REQUIRE(result == data);
+
+            char c = 0;
+            REQUIRE_FALSE(reader->read_exactly(&c, 1));
+            REQUIRE(reader->read().empty());
+        } else {
+            WARN("io_uring not available, blocking fallback is used");
+        }
+    }
+
+    osmium::io::detail::reliable_close(fd);
+    REQUIRE(std::remove(filename.c_str()) == 0);
+}
+
+TEST_CASE("io_uring backend falls back for pipes") {
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+
+    REQUIRE_FALSE(osmium::io::detail::make_uring_reader(fds[0], 1000));
+    REQUIRE_FALSE(osmium::io::detail::make_uring_writer(fds[1]));
+
+    {
+        osmium::io::NoCompressor comp{fds[1], osmium::io::fsync::no};
+        comp.write("foo");
+        comp.close();
+    }
+
+    osmium::io::NoDecompressor decomp{fds[0]};
+    REQUIRE(decomp.read() == "foo");
+    REQUIRE(decomp.read().empty());
+    decomp.close();
+}
+
+#endif
@@ -0,0 +1,157 @@
+#include "catch.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/node_columns_reader.hpp>
+#include <osmium/io/pbf_input.hpp>
+#include <osmium/io/pbf_output.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/osm.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+
+static void write_test_file(const std::string& filename, const char* format) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+
+    for (osmium::object_id_type id = 1; id <= 10000; ++id) {
+        if (id % 100 == 0) {
+            osmium::builder::add_node(buffer, _id(id), _version(1), _location(1.0 + static_cast<double>(id) / 10000.0, -2.5),
+                                      _tag("amenity", "bench"), _tag("id", std::to_string(id)));
+        } else if (id % 1000 == 1) {
+            osmium::builder::add_node(buffer, _id(id), _version(2), _deleted());
+        } else {
+            osmium::builder::add_node(buffer, _id(id), _version(1), _location(1.0, static_cast<double>(id) / 10000.0));
+        }
+    }
+    osmium::builder::add_way(buffer, _id(1), _version(1), _nodes({1, 2, 3}), _tag("highway", "primary"));
+    osmium::builder::add_relation(buffer, _id(1), _version(1), _member(osmium::item_type::way, 1));
+
+    osmium::io::File file{filename, format};
+    file.set_has_multiple_object_versions(true);
+
+    osmium::io::Writer writer{file, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+}
+
+static void compare_with_reader(const std::string& filename, const bool with_tags) {
+    osmium::io::Reader reader{filename, osmium::osm_entity_bits::node};
+    osmium::io::NodeColumnsReader columns_reader{filename, with_tags ? osmium::io::read_tags::yes : osmium::io::read_tags::no};
+
+    REQUIRE(columns_reader.header().has_multiple_object_versions());
+
+    osmium::io::node_columns columns;
+    std::size_t n = 0;
+    std::size_t count = 0;
+    bool has_columns = false;
+
+    while (const osmium::memory::Buffer buffer = reader.read()) {
+        for (const auto& node : buffer.select<osmium::Node>()) {
+            if (!has_columns || n == columns.size()) {
+                REQUIRE(columns_reader.read(columns));
+                REQUIRE(columns.has_tags() == with_tags);
+                has_columns = true;
+                n = 0;
+            }
+            REQUIRE(columns.ids[n] == node.id());
+            if (node.visible()) {
+                REQUIRE(columns.location(n) == node.location());
+            } else {
+                REQUIRE_FALSE(columns.location(n).valid());
+            }
+            if (with_tags) {
+                REQUIRE(columns.tag_count(n) == node.tags().size());
+                std::size_t t = 0;
+                for (const auto& tag : node.tags()) {
+                    REQUIRE(std::string{columns.key(n, t)} == tag.key());
+                    REQUIRE(std::string{columns.value(n, t)} == tag.value());
+                    ++t;
+                }
+            }
+            ++n;
+            ++count;
+        }
+    }
+    reader.close();
+
+    REQUIRE(count == 10000);
+    REQUIRE(n == columns.size());
+    REQUIRE_FALSE(columns_reader.read(columns));
+    REQUIRE_FALSE(columns_reader.read(columns));
+}
+
+TEST_CASE("Read nodes from PBF file with dense nodes as columns") {
+    const std::string filename{"test-pbf-node-columns.osm.pbf"};
+    write_test_file(filename, "pbf,pbf_compression=none");
+
+    SECTION("without tags") {
+        compare_with_reader(filename, false);
+    }
+
+    SECTION("with tags") {
+        compare_with_reader(filename, true);
+    }
+
+    REQUIRE(std::remove(filename.c_str()) == 0);
+}
+
+TEST_CASE("Read nodes from PBF file with non-dense nodes and blob index as columns") {
+    const std::string filename{"test-pbf-node-columns.osm.pbf"};
+    write_test_file(filename, "pbf,pbf_dense_nodes=false,pbf_blob_index=true");
+
+    SECTION("without tags") {
+        compare_with_reader(filename, false);
+    }
+
+    SECTION("with tags") {
+        compare_with_reader(filename, true);
+    }
+
+    REQUIRE(std::remove(filename.c_str()) == 0);
+}
+
+TEST_CASE("Node columns reader only reads uncompressed PBF files") {
+    REQUIRE_THROWS_AS(osmium::io::NodeColumnsReader{"test.osm"}, const osmium::io_error&);
+    REQUIRE_THROWS_AS(osmium::io::NodeColumnsReader{"test.osm.pbf.gz"}, const osmium::io_error&);
+}
+
+TEST_CASE("Node columns reader continues with the next block after a decoding error") {
+    const std::string filename{"test-pbf-node-columns-broken.osm.pbf"};
+    write_test_file(filename, "pbf,pbf_compression=zlib");
+
+    std::string data;
+    {
+        std::ifstream in{filename, std::ios::binary};
+        data.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+    }
+
+    // Overwrite the middle of the compressed data of the first OSMData blob.
+    const auto first = data.find("OSMData");
+    REQUIRE(first != std::string::npos);
+    const auto second = data.find("OSMData", first + 1);
+    REQUIRE(second != std::string::npos);
+    const auto middle = first + (second - first) / 2;
+    data.replace(middle, 16, 16, '\xff');
+
+    {
+        std::ofstream out{filename, std::ios::binary | std::ios::trunc};
+        out << data;
+    }
+
+    osmium::io::NodeColumnsReader columns_reader{filename};
+    osmium::io::node_columns columns;
+    REQUIRE_THROWS(columns_reader.read(columns));
+    REQUIRE(columns_reader.read(columns));
+    REQUIRE(columns.size() == 2000);
+    REQUIRE(columns.ids[0] == 8001);
+    REQUIRE_FALSE(columns_reader.read(columns));
+    columns_reader.close();
+
+    REQUIRE(std::remove(filename.c_str()) == 0);
+}
@@ -0,0 +1,362 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/o5m_input.hpp>
+#include <osmium/io/o5m_output.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm.hpp>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace oid = osmium::io::detail;
+
+static osmium::memory::Buffer get_test_buffer() {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024 * 10, osmium::memory::Buffer::auto_grow::yes};
+
+    osmium::builder::add_node(buffer,
+        _id(-17),
+        _version(3),
+        _cid(1000),
+        _timestamp(osmium::Timestamp{"2021-01-02T03:04:05Z"}),
+        _uid(42),
+        _user("foo"),
+        _location(1.5, -2.25),
+        _tag("highway", "traffic_signals"),
+        _tag("name", "")
+    );
+
+    osmium::builder::add_node(buffer,
+        _id(18),
+        _version(1),
+        _cid(999),
+        _timestamp(osmium::Timestamp{"2021-01-02T03:04:05Z"}),
+        _location(-180.0, 90.0),
+        _tag("highway", "traffic_signals")
+    );
+
+    osmium::builder::add_way(buffer,
+        _id(20),
+        _version(2),
+        _cid(1001),
+        _timestamp(osmium::Timestamp{"2020-12-31T23:59:59Z"}),
+        _uid(42),
+        _user("foo"),
+        _nodes({18, -17, 18}),
+        _tag("highway", "primary")
+    );
+
+    osmium::builder::add_relation(buffer,
+        _id(30),
+        _version(1),
+        _cid(1001),
+        _timestamp(osmium::Timestamp{"2020-12-31T23:59:59Z"}),
+        _uid(43),
+        _user("bar"),
+        _member(osmium::item_type::way, 20, "outer"),
+        _member(osmium::item_type::node, -17, ""),
+        _member(osmium::item_type::relation, 30, "outer"),
+        _tag("type", "multipolygon")
+    );
+
+    return buffer;
+}
+
+TEST_CASE("Write o5m file and read it back") {
+    const std::string filename{"test-o5m-out.o5m"};
+
+    osmium::io::Header header;
+    header.add_box(osmium::Box{-1.0, -2.0, 3.0, 4.0});
+    header.set("timestamp", "2021-01-03T00:00:00Z");
+
+    osmium::io::Writer writer{filename, header, osmium::io::overwrite::allow};
+    writer(get_test_buffer());
+    writer.close();
+
+    osmium::io::Reader reader{filename};
+    const auto read_header = reader.header();
+    REQUIRE_FALSE(read_header.has_multiple_object_versions());
+    REQUIRE(read_header.joined_boxes() == osmium::Box(-1.0, -2.0, 3.0, 4.0));
+    REQUIRE(read_header.get("o5m_timestamp") == "2021-01-03T00:00:00Z");
+
+    const auto buffer = reader.read();
+    REQUIRE(buffer);
+    REQUIRE_FALSE(reader.read());
+    reader.close();
+
+    auto it = buffer.select<osmium::OSMObject>().cbegin();
+
+    const auto& node1 = static_cast<const osmium::Node&>(*it);
+    REQUIRE(node1.id() == -17);
+    REQUIRE(node1.version() == 3);
+    REQUIRE(node1.changeset() == 1000);
+    REQUIRE(node1.timestamp() == osmium::Timestamp{"2021-01-02T03:04:05Z"});
+    REQUIRE(node1.uid() == 42);
+    REQUIRE(std::string{node1.user()} == "foo");
+    REQUIRE(node1.visible());
+    REQUIRE(node1.location() == osmium::Location(1.5, -2.25));
+    REQUIRE(node1.tags().size() == 2);
+    REQUIRE(std::string{node1.tags().get_value_by_key("highway")} == "traffic_signals");
+    REQUIRE(std::string{node1.tags().get_value_by_key("name")}.empty());
+
+    const auto& node2 = static_cast<const osmium::Node&>(*++it);
+    REQUIRE(node2.id() == 18);
+    REQUIRE(node2.changeset() == 999);
+    REQUIRE(node2.uid() == 0);
+    REQUIRE(std::string{node2.user()}.empty());
+    REQUIRE(node2.location() == osmium::Location(-180.0, 90.0));
+    REQUIRE(std::string{node2.tags().get_value_by_key("highway")} == "traffic_signals");
+
+    const auto& way = static_cast<const osmium::Way&>(*++it);
+    REQUIRE(way.id() == 20);
+    REQUIRE(way.version() == 2);
+    REQUIRE(way.timestamp() == osmium::Timestamp{"2020-12-31T23:59:59Z"});
+    REQUIRE(std::string{way.user()} == "foo");
+    REQUIRE(way.nodes().size() == 3);
+    REQUIRE(way.nodes()[0].ref() == 18);
+    REQUIRE(way.nodes()[1].ref() == -17);
+    REQUIRE(way.nodes()[2].ref() == 18);
+    REQUIRE(std::string{way.tags().get_value_by_key("highway")} == "primary");
+
+    const auto& relation = static_cast<const osmium::Relation&>(*++it);
+    REQUIRE(relation.id() == 30);
+    REQUIRE(relation.uid() == 43);
+    REQUIRE(std::string{relation.user()} == "bar");
+    REQUIRE(relation.members().size() == 3);
+    auto mit = relation.members().cbegin();
+    REQUIRE(mit->type() == osmium::item_type::way);
+    REQUIRE(mit->ref() == 20);
+    REQUIRE(std::string{mit->role()} == "outer");
+    ++mit;
+    REQUIRE(mit->type() == osmium::item_type::node);
+    REQUIRE(mit->ref() == -17);
+    REQUIRE(std::string{mit->role()}.empty());
+    ++mit;
+    REQUIRE(mit->type() == osmium::item_type::relation);
+    REQUIRE(mit->ref() == 30);
+    REQUIRE(std::string{mit->role()} == "outer");
+    REQUIRE(std::string{relation.tags().get_value_by_key("type")} == "multipolygon");
+
+    REQUIRE(++it == buffer.select<osmium::OSMObject>().cend());
+}
+
+TEST_CASE("Write o5m file without metadata") {
+    const std::string filename{"test-o5m-out-no-metadata.o5m"};
+
+    osmium::io::Writer writer{osmium::io::File{filename, "o5m,add_metadata=false"}, osmium::io::overwrite::allow};
+    writer(get_test_buffer());
+    writer.close();
+
+    osmium::io::Reader reader{filename};
+    const auto buffer = reader.read();
+    REQUIRE(buffer);
+    reader.close();
+
+    REQUIRE(buffer.select<osmium::OSMObject>().size() == 4);
+    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+        REQUIRE(object.version() == 0);
+        REQUIRE(object.changeset() == 0);
+        REQUIRE(object.uid() == 0);
+        REQUIRE_FALSE(object.timestamp().valid());
+    }
+}
+
+TEST_CASE("Write o5c file with deleted objects") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    const std::string filename{"test-o5m-out.o5c"};
+
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(1), _version(2), _deleted(), _timestamp(osmium::Timestamp{"2021-01-02T03:04:05Z"}));
+    osmium::builder::add_way(buffer, _id(2), _version(3), _deleted(), _timestamp(osmium::Timestamp{"2021-01-02T03:04:05Z"}));
+    osmium::builder::add_node(buffer, _id(3), _version(1), _location(1, 1), _timestamp(osmium::Timestamp{"2021-01-02T03:04:05Z"}));
+
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    osmium::io::Reader reader{filename};
+    REQUIRE(reader.header().has_multiple_object_versions());
+    const auto read_buffer = reader.read();
+    REQUIRE(read_buffer);
+    reader.close();
+
+    std::vector<bool> visible;
+    for (const auto& object : read_buffer.select<osmium::OSMObject>()) {
+        visible.push_back(object.visible());
+    }
+    REQUIRE(visible == std::vector<bool>({false, false, true}));
+}
+
+TEST_CASE("o5m chunk parser decodes data starting at reset") {
+    // reset, node 1 with location (1, 2), reset, node 1 with
+    // location (2, 4) and tag "a"="b"
+    static const char data[] = "\xff\x10\x04\x02\x00\x02\x04"
+                               "\xff\x10\x09\x02\x00\x04\x08\x00" "a\0b\0";
+
+    oid::O5mChunkParser parser{std::string(data, sizeof(data) - 1), osmium::osm_entity_bits::all};
+    const auto buffer = parser();
+
+    std::vector<osmium::object_id_type> ids;
+    std::vector<osmium::Location> locations;
+    for (const auto& node : buffer.select<osmium::Node>()) {
+        ids.push_back(node.id());
+        locations.push_back(node.location());
+    }
+    REQUIRE(ids == std::vector<osmium::object_id_type>({1, 1}));
+    REQUIRE(locations[0] == osmium::Location(int32_t(1), int32_t(2)));
+    REQUIRE(locations[1] == osmium::Location(int32_t(2), int32_t(4)));
+}
+
+TEST_CASE("o5m chunk parser throws on reference to string not in table") {
+    // reset, node 1 with location (1, 2) and reference to string 1
+    static const char data1[] = "\xff\x10\x05\x02\x00\x02\x04\x01";
+    oid::O5mChunkParser parser1{std::string(data1, sizeof(data1) - 1), osmium::osm_entity_bits::all};
+    REQUIRE_THROWS_AS(parser1(), const osmium::o5m_error&);
+
+    // reset, node 1 with tag "a"="b", reset, node 1 with reference to
+    // string 1 which was removed by the reset
+    static const char data2[] = "\xff\x10\x09\x02\x00\x02\x04\x00" "a\0b\0"
+                                "\xff\x10\x05\x02\x00\x02\x04\x01";
+    oid::O5mChunkParser parser2{std::string(data2, sizeof(data2) - 1), osmium::osm_entity_bits::all};
+    REQUIRE_THROWS_AS(parser2(), const osmium::o5m_error&);
+}
+
+TEST_CASE("Write o5m file with changeset and node without location") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    const std::string filename{"test-o5m-out-no-location.o5m"};
+
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(1), _location(1.5, 2.5));
+    osmium::builder::add_changeset(buffer, _cid(10));
+    osmium::builder::add_node(buffer, _id(2), _tag("a", "b"));
+    osmium::builder::add_node(buffer, _id(3), _location(1.5, 2.5), _tag("c", "d"));
+
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+
+    osmium::io::Reader reader{filename};
+    const auto read_buffer = reader.read();
+    REQUIRE(read_buffer);
+    reader.close();
+
+    REQUIRE(read_buffer.select<osmium::Changeset>().size() == 0);
+
+    std::vector<osmium::object_id_type> ids;
+    std::vector<bool> visible;
+    std::vector<osmium::Location> locations;
+    for (const auto& node : read_buffer.select<osmium::Node>()) {
+        ids.push_back(node.id());
+        visible.push_back(node.visible());
+        locations.push_back(node.location());
+        if (node.id() == 2) {
+            REQUIRE(node.tags().empty());
+        }
+    }
+    REQUIRE(ids == std::vector<osmium::object_id_type>({1, 2, 3}));
+    REQUIRE(visible == std::vector<bool>({true, false, true}));
+    REQUIRE(locations[0] == osmium::Location(1.5, 2.5));
+    REQUIRE_FALSE(locations[1].is_defined());
+    REQUIRE(locations[2] == osmium::Location(1.5, 2.5));
+}
+
+static void write_large_o5m_file(const std::string& filename) {
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow};
+
+    // Every buffer is written as a block starting with a reset.
+    osmium::object_id_type id = 1;
+    for (int n = 0; n < 100; ++n) {
+        osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+        for (int i = 0; i < 1000; ++i) {
+            using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+            osmium::builder::add_node(buffer, _id(id++), _version(1), _location(1.5, 2.5),
+                                      _tag("name", std::to_string(i).c_str()));
+        }
+        writer(std::move(buffer));
+    }
+
+    // One large block with nodes and ways mixed which is too large to be
+    // decoded on the thread pool.
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+    for (int i = 0; i < 200000; ++i) {
+        using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+        osmium::builder::add_node(buffer, _id(id++), _version(1), _location(1.5, 2.5),
+                                  _tag("name", std::to_string(i).c_str()));
+    }
+    {
+        using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+        osmium::builder::add_way(buffer, _id(1), _version(1), _nodes({1, 2, 3}));
+        osmium::builder::add_node(buffer, _id(id++), _version(1), _location(1.5, 2.5));
+    }
+    writer(std::move(buffer));
+
+    for (int n = 0; n < 10; ++n) {
+        osmium::memory::Buffer way_buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+        for (int i = 0; i < 1000; ++i) {
+            using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+            osmium::builder::add_way(way_buffer, _id(id++), _version(1), _nodes({1, 2, 3}),
+                                     _tag("highway", "primary"));
+        }
+        writer(std::move(way_buffer));
+    }
+
+    writer.close();
+}
+
+TEST_CASE("Read large o5m file in chunks using Reader") {
+    const std::string filename{"test-o5m-out-large.o5m"};
+    write_large_o5m_file(filename);
+
+    SECTION("all objects") {
+        osmium::io::Reader reader{filename, osmium::io::buffers_type::single};
+
+        int nodes = 0;
+        int ways = 0;
+        osmium::object_id_type last_id = 0;
+        while (const auto buffer = reader.read()) {
+            const auto type = buffer.begin()->type();
+            for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                REQUIRE(object.type() == type);
+                if (object.type() == osmium::item_type::node) {
+                    ++nodes;
+                    REQUIRE(std::string{object.tags().get_value_by_key("name", "")} ==
+                            (object.id() <= 100000 ? std::to_string((object.id() - 1) % 1000)
+                                                   : (object.id() <= 300000 ? std::to_string(object.id() - 100001) : "")));
+                } else {
+                    ++ways;
+                }
+                if (object.type() == osmium::item_type::node || object.id() != 1) {
+                    REQUIRE(object.id() == last_id + 1);
+                    last_id = object.id();
+                }
+            }
+        }
+        reader.close();
+
+        REQUIRE(nodes == 300001);
+        REQUIRE(ways == 10001);
+    }
+
+    SECTION("only ways") {
+        osmium::io::Reader reader{filename, osmium::osm_entity_bits::way};
+
+        int ways = 0;
+        while (const auto buffer = reader.read()) {
+            for (const auto& object : buffer.select<osmium::OSMObject>()) {
+                REQUIRE(object.type() == osmium::item_type::way);
+                ++ways;
+            }
+        }
+        reader.close();
+
+        REQUIRE(ways == 10001);
+    }
+}
+
@@ -387,6 +387,58 @@ TEST_CASE("Parse OPL: valid timestamp with trailing data") {
     REQUIRE(std::string{data} == "xxx");
 }
 
+TEST_CASE("Parse OPL: string reference") {
+    std::string tmp;
+
+    SECTION("Without escapes the input is referenced") {
+        const char* data = "foo,bar";
+        const auto str = oid::opl_parse_string_ref(&data, tmp);
+        REQUIRE(str.first == data - 3);
+        REQUIRE(str.second == 3);
+        REQUIRE(*data == ',');
+        REQUIRE(tmp.empty());
+    }
+
+    SECTION("Empty string") {
+        const char* data = "=x";
+        const auto str = oid::opl_parse_string_ref(&data, tmp);
+        REQUIRE(str.second == 0);
+        REQUIRE(*data == '=');
+    }
+
+    SECTION("With escapes the string is unescaped into tmp") {
+        const char* data = "foo%20%bar baz";
+        const auto str = oid::opl_parse_string_ref(&data, tmp);
+        REQUIRE(str.first == tmp.data());
+        REQUIRE(std::string(str.first, str.second) == "foo bar");
+        REQUIRE(std::string{data} == " baz");
+    }
+}
+
+TEST_CASE("Parse OPL: find special characters at all positions and alignments") {
+    std::vector<char> buffer(128, 'x');
+    for (const char special : {'\0', ' ', '\t', ',', '=', '%'}) {
+        for (std::size_t start = 0; start < 20; ++start) {
+            for (std::size_t pos = start; pos < start + 40; ++pos) {
+                std::fill(buffer.begin(), buffer.end(), 'x');
+                buffer[pos] = special;
+                buffer[pos + 20] = '\0';
+                REQUIRE(oid::opl_find_special(buffer.data() + start) == buffer.data() + pos);
+            }
+        }
+    }
+}
+
+TEST_CASE("Parse OPL: long strings with escapes") {
+    const std::string part(37, 'a');
+    const std::string input = part + "%20%" + part + "%3d%" + part + "=rest";
+    const char* data = input.c_str();
+    std::string tmp;
+    const auto str = oid::opl_parse_string_ref(&data, tmp);
+    REQUIRE(std::string(str.first, str.second) == part + " " + part + "=" + part);
+    REQUIRE(std::string{data} == "=rest");
+}
+
 TEST_CASE("Parse OPL: tags") {
     osmium::memory::Buffer buffer{1024};
 
@@ -432,6 +484,24 @@ TEST_CASE("Parse OPL: tags") {
         REQUIRE(it == taglist.cend());
     }
 
+    SECTION("Tags with escapes") {
+        const char* data = "name=Main%20%Street,a%3d%b=c,x%20%=%20%y z";
+        oid::opl_parse_tags(data, buffer);
+        const auto& taglist = buffer.get<osmium::TagList>(0);
+        REQUIRE(taglist.size() == 3);
+        auto it = taglist.cbegin();
+        REQUIRE(std::string{it->key()} == "name");
+        REQUIRE(std::string{it->value()} == "Main Street");
+        ++it;
+        REQUIRE(std::string{it->key()} == "a=b");
+        REQUIRE(std::string{it->value()} == "c");
+        ++it;
+        REQUIRE(std::string{it->key()} == "x ");
+        REQUIRE(std::string{it->value()} == " y");
+        ++it;
+        REQUIRE(it == taglist.cend());
+    }
+
     SECTION("No equal signs") {
         const char* data = "a";
         REQUIRE_THROWS_WITH(oid::opl_parse_tags(data, buffer),
@@ -1301,3 +1371,91 @@ TEST_CASE("line_by_line for OPL parser 28") {
     check_lbl({"foo\nb", "ar"}, {"foo", "bar"});
 }
 
+
+TEST_CASE("OPL chunk parser") {
+    oid::OPLChunkParser parser{"n1 v1\n\nw2 v1\r\nr3 v1", 0, osmium::osm_entity_bits::all};
+    const auto buffer = parser();
+
+    std::vector<osmium::object_id_type> ids;
+    for (const auto& object : buffer.select<osmium::OSMObject>()) {
+        ids.push_back(object.id());
+    }
+    REQUIRE(ids == std::vector<osmium::object_id_type>({1, 2, 3}));
+}
+
+TEST_CASE("OPL chunk parser reports line numbers counted from first line") {
+    oid::OPLChunkParser parser{"n1 v1\n\nn2 v1\nX\n", 17, osmium::osm_entity_bits::all};
+
+    try {
+        parser();
+        REQUIRE(false);
+    } catch (const osmium::opl_error& e) {
+        REQUIRE(e.line == 19);
+    }
+}
+
+static std::string make_large_opl(const int count) {
+    std::string data;
+    for (int i = 1; i <= count; ++i) {
+        data += "n" + std::to_string(i) + " v1 x1.5 y2.5 Tname=" + std::string(20, 'a') + "\n";
+    }
+    for (int i = 1; i <= count / 10; ++i) {
+        data += "w" + std::to_string(i) + " v1 Nn1,n2,n3\r\n";
+    }
+    data += "r1 v1 Mn1@,w1@outer\n";
+    return data;
+}
+
+TEST_CASE("Read large OPL file in chunks using Reader") {
+    const int count = 100000;
+    const std::string data{make_large_opl(count)};
+    REQUIRE(data.size() > 4 * 1024 * 1024);
+
+    osmium::io::File file{data.data(), data.size(), "opl"};
+    osmium::io::Reader reader{file, osmium::io::buffers_type::single};
+
+    int nodes = 0;
+    int ways = 0;
+    int relations = 0;
+    osmium::object_id_type last_id = 0;
+    while (const auto buffer = reader.read()) {
+        const auto type = buffer.begin()->type();
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            REQUIRE(object.type() == type);
+            switch (object.type()) {
+                case osmium::item_type::node:
+                    REQUIRE(object.id() == last_id + 1);
+                    ++nodes;
+                    break;
+                case osmium::item_type::way:
+                    ++ways;
+                    break;
+                default:
+                    ++relations;
+                    break;
+            }
+            last_id = object.id();
+        }
+    }
+    reader.close();
+
+    REQUIRE(nodes == count);
+    REQUIRE(ways == count / 10);
+    REQUIRE(relations == 1);
+}
+
+TEST_CASE("Read large OPL file with error in chunks using Reader") {
+    std::string data{make_large_opl(100000)};
+    data += "X\n";
+
+    osmium::io::File file{data.data(), data.size(), "opl"};
+    osmium::io::Reader reader{file};
+
+    try {
+        while (reader.read()) {
+        }
+        REQUIRE(false);
+    } catch (const osmium::opl_error& e) {
+        REQUIRE(e.line == 110001);
+    }
+}
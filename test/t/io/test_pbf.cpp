@@ -2,9 +2,21 @@
 
 #include "utils.hpp"
 
+#include <osmium/builder/attr.hpp>
+#include <osmium/io/make_read_tags_filter.hpp>
 #include <osmium/io/pbf_input.hpp>
+#include <osmium/io/pbf_output.hpp>
 #include <osmium/io/reader.hpp>
-#include <osmium/osm/object.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/osm.hpp>
+#include <osmium/tags/tags_filter.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
 
 TEST_CASE("Get supported PBF compression types") {
     const auto types = osmium::io::supported_pbf_compression_types();
@@ -50,3 +62,409 @@ TEST_CASE("Read PBF file with version=-1 and changeset=-1 and DenseNodes (writte
     REQUIRE(object.version() == 0);
     REQUIRE(object.changeset() == 0);
 }
+
+TEST_CASE("Read PBF file with direct I/O") {
+    osmium::io::Reader reader{with_data_dir("t/io/data_pbf_version-1.osm.pbf"), osmium::io::direct_io::yes};
+    const osmium::memory::Buffer buffer = reader.read();
+    REQUIRE(buffer);
+    const osmium::OSMObject& object = *(buffer.cbegin<osmium::OSMObject>());
+    REQUIRE(object.version() == 0);
+    REQUIRE(object.changeset() == 0);
+    REQUIRE_FALSE(reader.read());
+    reader.close();
+    REQUIRE(reader.offset() == reader.file_size());
+}
+
+static void write_pbf_file_with_blob_index(const std::string& filename, const char* format) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+
+    // The first block is full with nodes near (1, 1), the second block
+    // contains nodes near (50, 50).
+    for (osmium::object_id_type id = 1; id <= 8000; ++id) {
+        osmium::builder::add_node(buffer, _id(id), _version(1), _location(1.0, 1.0 + static_cast<double>(id) / 10000.0));
+    }
+    for (osmium::object_id_type id = 8001; id <= 8010; ++id) {
+        osmium::builder::add_node(buffer, _id(id), _version(1), _location(50.0, 50.0));
+    }
+    osmium::builder::add_way(buffer, _id(1), _version(1), _nodes({1, 2, 3}));
+    osmium::builder::add_way(buffer, _id(2), _version(1), _nodes({8001, 8002}));
+    osmium::builder::add_relation(buffer, _id(1), _version(1), _member(osmium::item_type::way, 1));
+
+    osmium::io::Writer writer{osmium::io::File{filename, format}, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+}
+
+struct object_counts {
+    std::size_t nodes = 0;
+    std::size_t ways = 0;
+    std::size_t relations = 0;
+};
+
+template <typename... TArgs>
+static object_counts count_objects(const osmium::io::File& file, TArgs&&... args) {
+    object_counts counts;
+
+    osmium::io::Reader reader{file, std::forward<TArgs>(args)...};
+    while (const osmium::memory::Buffer buffer = reader.read()) {
+        counts.nodes += buffer.select<osmium::Node>().size();
+        counts.ways += buffer.select<osmium::Way>().size();
+        counts.relations += buffer.select<osmium::Relation>().size();
+    }
+    reader.close();
+    REQUIRE(reader.offset() == reader.file_size());
+
+    return counts;
+}
+
+TEST_CASE("Skip PBF blobs using the blob index") {
+    const std::string filename{"test-pbf-blob-index.osm.pbf"};
+    write_pbf_file_with_blob_index(filename, "pbf,pbf_blob_index=true");
+    const osmium::io::File file{filename};
+
+    SECTION("read everything") {
+        const auto counts = count_objects(file);
+        REQUIRE(counts.nodes == 8010);
+        REQUIRE(counts.ways == 2);
+        REQUIRE(counts.relations == 1);
+    }
+
+    SECTION("read only ways") {
+        const auto counts = count_objects(file, osmium::osm_entity_bits::way);
+        REQUIRE(counts.nodes == 0);
+        REQUIRE(counts.ways == 2);
+        REQUIRE(counts.relations == 0);
+    }
+
+    SECTION("read with bounding box around first block") {
+        const osmium::Box box{0.0, 0.0, 2.0, 2.0};
+        const auto counts = count_objects(file, box);
+        REQUIRE(counts.nodes == 8000);
+        REQUIRE(counts.ways == 2);
+        REQUIRE(counts.relations == 1);
+    }
+
+    SECTION("read nodes with bounding box around second block") {
+        const osmium::Box box{40.0, 40.0, 60.0, 60.0};
+        const auto counts = count_objects(file, box, osmium::osm_entity_bits::node);
+        REQUIRE(counts.nodes == 10);
+        REQUIRE(counts.ways == 0);
+        REQUIRE(counts.relations == 0);
+    }
+
+    SECTION("read with bounding box outside all blocks") {
+        const osmium::Box box{-10.0, -10.0, -5.0, -5.0};
+        const auto counts = count_objects(file, box);
+        REQUIRE(counts.nodes == 0);
+        REQUIRE(counts.ways == 2);
+        REQUIRE(counts.relations == 1);
+    }
+
+    SECTION("read from memory with bounding box") {
+        std::ifstream stream{filename, std::ios::binary};
+        const std::string data{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+        const osmium::io::File mem_file{data.data(), data.size(), "pbf"};
+
+        const osmium::Box box{0.0, 0.0, 2.0, 2.0};
+        osmium::io::Reader reader{mem_file, box, osmium::osm_entity_bits::node};
+        std::size_t nodes = 0;
+        while (const osmium::memory::Buffer buffer = reader.read()) {
+            nodes += buffer.select<osmium::Node>().size();
+        }
+        reader.close();
+        REQUIRE(nodes == 8000);
+    }
+
+    REQUIRE(std::remove(filename.c_str()) == 0);
+}
+
+TEST_CASE("Bounding box option does nothing on PBF files without blob index") {
+    const std::string filename{"test-pbf-no-blob-index.osm.pbf"};
+    write_pbf_file_with_blob_index(filename, "pbf");
+
+    const osmium::Box box{0.0, 0.0, 2.0, 2.0};
+    const auto counts = count_objects(osmium::io::File{filename}, box);
+    REQUIRE(counts.nodes == 8010);
+    REQUIRE(counts.ways == 2);
+    REQUIRE(counts.relations == 1);
+
+    REQUIRE(std::remove(filename.c_str()) == 0);
+}
+
+static void write_pbf_file_with_tags(const std::string& filename, const char* format) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+
+    for (osmium::object_id_type id = 1; id <= 100; ++id) {
+        const auto n = static_cast<int>(id);
+        const osmium::Location location{n * 1000, n * 2000};
+        if (id % 10 == 0) {
+            osmium::builder::add_node(buffer, _id(id), _version(n), _uid(n), _user(std::to_string(id).c_str()),
+                                      _timestamp(osmium::Timestamp{static_cast<uint32_t>(n * 100)}), _location(location),
+                                      _tag("amenity", id % 20 == 0 ? "pub" : "cafe"), _tag("name", "x"));
+        } else if (id % 10 == 5) {
+            osmium::builder::add_node(buffer, _id(id), _version(n), _uid(n), _user(std::to_string(id).c_str()),
+                                      _timestamp(osmium::Timestamp{static_cast<uint32_t>(n * 100)}), _location(location),
+                                      _tag("highway", "crossing"));
+        } else {
+            osmium::builder::add_node(buffer, _id(id), _version(n), _uid(n), _user(std::to_string(id).c_str()),
+                                      _timestamp(osmium::Timestamp{static_cast<uint32_t>(n * 100)}), _location(location));
+        }
+    }
+    osmium::builder::add_way(buffer, _id(1), _version(1), _nodes({1, 2, 3}), _tag("highway", "primary"));
+    osmium::builder::add_way(buffer, _id(2), _version(1), _nodes({4, 5}), _tag("amenity", "parking"));
+    osmium::builder::add_way(buffer, _id(3), _version(1), _nodes({6, 7}));
+    osmium::builder::add_relation(buffer, _id(1), _version(1), _member(osmium::item_type::way, 1, "foo"), _tag("type", "route"));
+
+    osmium::io::Writer writer{osmium::io::File{filename, format}, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+}
+
+static void check_amenity_nodes(const osmium::memory::Buffer& buffer, const bool with_metadata) {
+    osmium::object_id_type id = 0;
+    for (const auto& node : buffer.select<osmium::Node>()) {
+        id += 10;
+        const auto n = static_cast<int>(id);
+        REQUIRE(node.id() == id);
+        REQUIRE(node.location() == osmium::Location(n * 1000, n * 2000));
+        REQUIRE(std::string{node.tags()["amenity"]} == (id % 20 == 0 ? "pub" : "cafe"));
+        REQUIRE(node.tags().size() == 2);
+        if (with_metadata) {
+            REQUIRE(node.version() == static_cast<osmium::object_version_type>(n));
+            REQUIRE(node.uid() == static_cast<osmium::user_id_type>(n));
+            REQUIRE(std::string{node.user()} == std::to_string(id));
+            REQUIRE(node.timestamp() == osmium::Timestamp{static_cast<uint32_t>(n * 100)});
+        }
+    }
+    REQUIRE(id == 100);
+}
+
+static osmium::memory::Buffer read_all(osmium::io::Reader& reader) {
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    while (const osmium::memory::Buffer data = reader.read()) {
+        buffer.add_buffer(data);
+        buffer.commit();
+    }
+    reader.close();
+    return buffer;
+}
+
+static void check_read_with_tags_filter(const char* format, const bool with_metadata) {
+    const std::string filename{"test-pbf-tags-filter.osm.pbf"};
+    write_pbf_file_with_tags(filename, format);
+
+    osmium::TagsFilter filter{false};
+    filter.add_rule(true, "amenity");
+
+    {
+        osmium::io::Reader reader{filename, osmium::io::make_read_tags_filter(filter, osmium::osm_entity_bits::node)};
+        const auto buffer = read_all(reader);
+
+        check_amenity_nodes(buffer, with_metadata);
+        REQUIRE(buffer.select<osmium::Way>().size() == 3);
+        REQUIRE(buffer.select<osmium::Relation>().size() == 1);
+    }
+
+    {
+        osmium::io::Reader reader{filename, osmium::io::make_read_tags_filter(filter), osmium::io::read_meta::no};
+        const auto buffer = read_all(reader);
+
+        check_amenity_nodes(buffer, false);
+        REQUIRE(buffer.select<osmium::Way>().size() == 1);
+        REQUIRE(buffer.select<osmium::Way>().cbegin()->id() == 2);
+        REQUIRE(buffer.select<osmium::Relation>().empty());
+    }
+
+    {
+        // "name" tag matches through default result, "amenity=pub" too
+        osmium::TagsFilter value_filter{true};
+        value_filter.add_rule(false, "amenity", "cafe");
+        value_filter.add_rule(false, "highway");
+
+        osmium::io::Reader reader{filename, osmium::io::make_read_tags_filter(value_filter, osmium::osm_entity_bits::node)};
+        const auto buffer = read_all(reader);
+
+        std::vector<osmium::object_id_type> ids;
+        for (const auto& node : buffer.select<osmium::Node>()) {
+            ids.push_back(node.id());
+        }
+        REQUIRE(ids == std::vector<osmium::object_id_type>({10, 20, 30, 40, 50, 60, 70, 80, 90, 100}));
+    }
+
+    REQUIRE(std::remove(filename.c_str()) == 0);
+}
+
+TEST_CASE("Read PBF file with dense nodes with tags filter") {
+    check_read_with_tags_filter("pbf", true);
+}
+
+TEST_CASE("Read PBF file with dense nodes without metadata with tags filter") {
+    check_read_with_tags_filter("pbf,add_metadata=false", false);
+}
+
+TEST_CASE("Read PBF file with non-dense nodes with tags filter") {
+    check_read_with_tags_filter("pbf,pbf_dense_nodes=false", true);
+}
+
+TEST_CASE("Read PBF file with sorted string table with tags filter") {
+    check_read_with_tags_filter("pbf,pbf_sort_stringtable=true", true);
+}
+
+TEST_CASE("Read PBF file with non-dense nodes and sorted string table with tags filter") {
+    check_read_with_tags_filter("pbf,pbf_dense_nodes=false,pbf_sort_stringtable=true", true);
+}
+
+static void write_pbf_file_with_frequent_tags(const std::string& filename, const std::string& format) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+
+    // All objects have unique user names, the tags and roles only appear
+    // after all those user names are in the string table.
+    for (osmium::object_id_type id = 1; id <= 1000; ++id) {
+        const auto user = "user" + std::to_string(id);
+        if (id > 500) {
+            osmium::builder::add_node(buffer, _id(id), _version(1), _user(user.c_str()), _location(1.0, 2.0),
+                                      _tag("highway", "crossing"), _tag("crossing", id % 2 ? "zebra" : "uncontrolled"));
+        } else {
+            osmium::builder::add_node(buffer, _id(id), _version(1), _user(user.c_str()), _location(1.0, 2.0));
+        }
+    }
+    for (osmium::object_id_type id = 1; id <= 1000; ++id) {
+        const auto user = "user" + std::to_string(id);
+        if (id > 500) {
+            osmium::builder::add_way(buffer, _id(id), _version(1), _user(user.c_str()), _nodes({1, 2}), _tag("highway", "residential"));
+        } else {
+            osmium::builder::add_way(buffer, _id(id), _version(1), _user(user.c_str()), _nodes({1, 2}));
+        }
+    }
+    for (osmium::object_id_type id = 1; id <= 1000; ++id) {
+        const auto user = "user" + std::to_string(id);
+        if (id > 500) {
+            osmium::builder::add_relation(buffer, _id(id), _version(1), _user(user.c_str()),
+                                          _member(osmium::item_type::way, id, "outer"), _member(osmium::item_type::way, 1, "inner"),
+                                          _tag("type", "multipolygon"));
+        } else {
+            osmium::builder::add_relation(buffer, _id(id), _version(1), _user(user.c_str()), _member(osmium::item_type::node, id, "stop"));
+        }
+    }
+
+    osmium::io::Writer writer{osmium::io::File{filename, format}, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+}
+
+static void check_frequent_tags(const osmium::memory::Buffer& buffer) {
+    osmium::object_id_type id = 0;
+    for (const auto& node : buffer.select<osmium::Node>()) {
+        ++id;
+        REQUIRE(node.id() == id);
+        REQUIRE(std::string{node.user()} == "user" + std::to_string(id));
+        if (id > 500) {
+            REQUIRE(node.tags().size() == 2);
+            REQUIRE(std::string{node.tags()["highway"]} == "crossing");
+            REQUIRE(std::string{node.tags()["crossing"]} == (id % 2 ? "zebra" : "uncontrolled"));
+        } else {
+            REQUIRE(node.tags().empty());
+        }
+    }
+    REQUIRE(id == 1000);
+
+    id = 0;
+    for (const auto& way : buffer.select<osmium::Way>()) {
+        ++id;
+        REQUIRE(way.id() == id);
+        REQUIRE(std::string{way.user()} == "user" + std::to_string(id));
+        REQUIRE(way.nodes().size() == 2);
+        REQUIRE(way.tags().size() == (id > 500 ? 1 : 0));
+    }
+    REQUIRE(id == 1000);
+
+    id = 0;
+    for (const auto& relation : buffer.select<osmium::Relation>()) {
+        ++id;
+        REQUIRE(relation.id() == id);
+        REQUIRE(std::string{relation.user()} == "user" + std::to_string(id));
+        if (id > 500) {
+            REQUIRE(std::string{relation.tags()["type"]} == "multipolygon");
+            REQUIRE(relation.members().size() == 2);
+            auto it = relation.members().begin();
+            REQUIRE(it->ref() == id);
+            REQUIRE(std::string{it->role()} == "outer");
+            ++it;
+            REQUIRE(std::string{it->role()} == "inner");
+        } else {
+            REQUIRE(relation.members().size() == 1);
+            REQUIRE(relation.members().begin()->type() == osmium::item_type::node);
+            REQUIRE(std::string{relation.members().begin()->role()} == "stop");
+        }
+    }
+    REQUIRE(id == 1000);
+}
+
+static std::size_t write_and_check_frequent_tags(const std::string& format) {
+    const std::string filename{"test-pbf-frequent-tags.osm.pbf"};
+    write_pbf_file_with_frequent_tags(filename, format);
+
+    osmium::io::Reader reader{filename};
+    check_frequent_tags(read_all(reader));
+
+    const auto size = osmium::file_size(filename);
+    REQUIRE(std::remove(filename.c_str()) == 0);
+    return size;
+}
+
+TEST_CASE("Write PBF file with sorted string table") {
+    SECTION("dense nodes") {
+        const auto size_unsorted = write_and_check_frequent_tags("pbf,pbf_compression=none");
+        const auto size_sorted = write_and_check_frequent_tags("pbf,pbf_compression=none,pbf_sort_stringtable=true");
+        REQUIRE(size_sorted < size_unsorted);
+    }
+
+    SECTION("non-dense nodes") {
+        const auto size_unsorted = write_and_check_frequent_tags("pbf,pbf_compression=none,pbf_dense_nodes=false");
+        const auto size_sorted = write_and_check_frequent_tags("pbf,pbf_compression=none,pbf_dense_nodes=false,pbf_sort_stringtable=true");
+        REQUIRE(size_sorted < size_unsorted);
+    }
+}
+
+static std::size_t count_buffers(const std::string& filename) {
+    std::size_t count = 0;
+    osmium::io::Reader reader{filename};
+    while (const osmium::memory::Buffer buffer = reader.read()) {
+        ++count;
+    }
+    reader.close();
+    return count;
+}
+
+TEST_CASE("Write PBF file with target block size") {
+    const std::string filename{"test-pbf-frequent-tags.osm.pbf"};
+
+    write_pbf_file_with_frequent_tags(filename, "pbf");
+    const auto default_count = count_buffers(filename);
+
+    SECTION("small blocks with dense nodes") {
+        write_and_check_frequent_tags("pbf,pbf_block_size=2000");
+        write_pbf_file_with_frequent_tags(filename, "pbf,pbf_block_size=2000");
+        REQUIRE(count_buffers(filename) > default_count + 10);
+    }
+
+    SECTION("small blocks with non-dense nodes and sorted string table") {
+        write_and_check_frequent_tags("pbf,pbf_dense_nodes=false,pbf_sort_stringtable=true,pbf_block_size=2000");
+        write_pbf_file_with_frequent_tags(filename, "pbf,pbf_dense_nodes=false,pbf_sort_stringtable=true,pbf_block_size=2000");
+        REQUIRE(count_buffers(filename) > default_count + 10);
+    }
+
+    REQUIRE(std::remove(filename.c_str()) == 0);
+}
+
+TEST_CASE("Invalid PBF block size") {
+    for (const char* format : {"pbf,pbf_block_size=foo", "pbf,pbf_block_size=-1", "pbf,pbf_block_size=0", "pbf,pbf_block_size=100000000"}) {
+        REQUIRE_THROWS_AS(osmium::io::Writer(osmium::io::File{"test-pbf-block-size.osm.pbf", format}, osmium::io::overwrite::allow), const std::invalid_argument&);
+    }
+}
@@ -0,0 +1,98 @@
+#include "catch.hpp"
+
+#include <osmium/io/detail/pbf_varint.hpp>
+
+#include <protozero/exception.hpp>
+#include <protozero/varint.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+static std::string encode(const std::vector<int64_t>& values) {
+    std::string data;
+    int64_t last = 0;
+    for (const auto value : values) {
+        const auto delta = static_cast<int64_t>(static_cast<uint64_t>(value) - static_cast<uint64_t>(last));
+        protozero::write_varint(std::back_inserter(data), protozero::encode_zigzag64(delta));
+        last = value;
+    }
+    return data;
+}
+
+static std::vector<int64_t> decode(const std::string& data) {
+    const std::size_t count = osmium::io::detail::count_varints(data.data(), data.data() + data.size());
+    std::vector<int64_t> values(count + osmium::io::detail::packed_delta_sint64_padding);
+    const std::size_t decoded = osmium::io::detail::decode_packed_delta_sint64(data.data(), data.data() + data.size(), values.data());
+    REQUIRE(decoded == count);
+    values.resize(count);
+    return values;
+}
+
+TEST_CASE("Decode empty packed delta varints") {
+    const std::string data;
+    REQUIRE(decode(data).empty());
+}
+
+TEST_CASE("Decode packed delta varints with single-byte deltas") {
+    std::vector<int64_t> values;
+    int64_t value = 0;
+    for (int i = 0; i < 100; ++i) {
+        value += (i % 7) * 9 - 30;
+        values.push_back(value);
+    }
+    const std::string data = encode(values);
+    REQUIRE(data.size() == values.size());
+    REQUIRE(decode(data) == values);
+}
+
+TEST_CASE("Decode packed delta varints with extreme values") {
+    const std::vector<int64_t> values = {
+        0, 1, -1, 63, -64, 64, -65,
+        std::numeric_limits<int64_t>::max(),
+        std::numeric_limits<int64_t>::min(),
+        0, 1LL << 55U, -(1LL << 55U), 1LL << 56U, 0,
+        std::numeric_limits<int64_t>::min(),
+        std::numeric_limits<int64_t>::max(),
+        -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    };
+    REQUIRE(decode(encode(values)) == values);
+}
+
+TEST_CASE("Decode packed delta varints with random values of all lengths") {
+    std::mt19937_64 gen{42};
+    for (unsigned int run = 0; run < 200; ++run) {
+        std::vector<int64_t> values;
+        int64_t value = 0;
+        const unsigned int max_bits = 1 + run % 64;
+        for (unsigned int i = 0; i < 300; ++i) {
+            const unsigned int bits = 1 + static_cast<unsigned int>(gen() % max_bits);
+            const uint64_t delta = gen() >> (64 - bits);
+            value = static_cast<int64_t>(static_cast<uint64_t>(value) + ((gen() & 1U) ? delta : -delta));
+            values.push_back(value);
+        }
+        REQUIRE(decode(encode(values)) == values);
+    }
+}
+
+TEST_CASE("Decoding truncated packed delta varints throws") {
+    std::vector<int64_t> values(40, 5);
+    values.push_back(1LL << 40U);
+    std::string data = encode(values);
+    data.resize(data.size() - 1);
+
+    std::vector<int64_t> out(values.size() + osmium::io::detail::packed_delta_sint64_padding);
+    REQUIRE_THROWS_AS(osmium::io::detail::decode_packed_delta_sint64(data.data(), data.data() + data.size(), out.data()), const protozero::end_of_buffer_exception&);
+}
+
+TEST_CASE("Decoding packed delta varint that is too long throws") {
+    std::string data(12, '\x80');
+    data += std::string(20, '\x01');
+
+    std::vector<int64_t> out(data.size() + osmium::io::detail::packed_delta_sint64_padding);
+    REQUIRE_THROWS_AS(osmium::io::detail::decode_packed_delta_sint64(data.data(), data.data() + data.size(), out.data()), const protozero::varint_too_long_exception&);
+}
+
@@ -0,0 +1,96 @@
+#include "catch.hpp"
+
+#include <osmium/io/detail/queue_size_controller.hpp>
+#include <osmium/io/detail/queue_util.hpp>
+#include <osmium/memory/buffer.hpp>
+
+#include <future>
+
+TEST_CASE("Queue size controller starts with min size") {
+    const osmium::io::detail::QueueSizeController controller{1000};
+    REQUIRE(controller.size() == 2);
+    REQUIRE(controller.average_element_size() == 0);
+}
+
+TEST_CASE("Queue size controller grows queue if consumer has to wait") {
+    osmium::io::detail::QueueSizeController controller{1000};
+    REQUIRE(controller.update(10, true, 0) == 4);
+    REQUIRE(controller.update(10, true, 0) == 8);
+    REQUIRE(controller.update(10, false, 3) == 8);
+    REQUIRE(controller.average_element_size() == 10);
+}
+
+TEST_CASE("Queue size controller shrinks queue if consumer is slow") {
+    osmium::io::detail::QueueSizeController controller{1000};
+    controller.update(10, true, 0);
+    controller.update(10, true, 0);
+    REQUIRE(controller.size() == 8);
+    REQUIRE(controller.update(10, false, 7) == 7);
+    REQUIRE(controller.update(10, false, 6) == 6);
+    REQUIRE(controller.update(10, false, 1) == 6);
+}
+
+TEST_CASE("Queue size controller keeps queue within memory limit") {
+    osmium::io::detail::QueueSizeController controller{1000};
+    for (int i = 0; i < 10; ++i) {
+        controller.update(100, true, 0);
+    }
+    REQUIRE(controller.size() == 10);
+
+    // Larger elements make the queue smaller
+    for (int i = 0; i < 50; ++i) {
+        controller.update(500, false, 0);
+    }
+    REQUIRE(controller.size() == 2);
+}
+
+TEST_CASE("Queue size controller never goes below min size") {
+    osmium::io::detail::QueueSizeController controller{10, 3};
+    REQUIRE(controller.size() == 3);
+    REQUIRE(controller.update(1000, false, 2) == 3);
+}
+
+static osmium::memory::Buffer make_buffer() {
+    osmium::memory::Buffer buffer{100};
+    return buffer;
+}
+
+TEST_CASE("Queue size grows if consumer has to wait for futures that are not ready") {
+    osmium::io::detail::future_buffer_queue_type queue;
+    for (int i = 0; i < 4; ++i) {
+        queue.push(std::async(std::launch::deferred, make_buffer));
+    }
+    osmium::io::detail::add_end_of_data_to_queue(queue);
+
+    osmium::io::detail::QueueSizeController controller{100000};
+    osmium::io::detail::queue_wrapper<osmium::memory::Buffer> wrapper{queue};
+    wrapper.set_controller(&controller);
+
+    REQUIRE(wrapper.pop());
+    REQUIRE(controller.size() == 4);
+    REQUIRE(wrapper.pop());
+    REQUIRE(controller.size() == 8);
+    REQUIRE(wrapper.pop());
+    REQUIRE(wrapper.pop());
+    REQUIRE(controller.size() == 32);
+    REQUIRE_FALSE(wrapper.pop());
+}
+
+TEST_CASE("Queue size shrinks if consumer gets ready futures from a full queue") {
+    osmium::io::detail::future_buffer_queue_type queue;
+    for (int i = 0; i < 8; ++i) {
+        osmium::io::detail::add_to_queue(queue, make_buffer());
+    }
+    osmium::io::detail::add_end_of_data_to_queue(queue);
+
+    osmium::io::detail::QueueSizeController controller{100000, 2};
+    controller.update(100, true, 0);
+    controller.update(100, true, 0);
+    REQUIRE(controller.size() == 8);
+
+    osmium::io::detail::queue_wrapper<osmium::memory::Buffer> wrapper{queue};
+    wrapper.set_controller(&controller);
+
+    REQUIRE(wrapper.pop());
+    REQUIRE(controller.size() == 7);
+}
@@ -2,14 +2,20 @@
 
 #include "utils.hpp"
 
+#include <osmium/builder/attr.hpp>
 #include <osmium/handler.hpp>
 #include <osmium/io/any_compression.hpp>
 #include <osmium/io/any_input.hpp>
+#include <osmium/io/any_output.hpp>
 #include <osmium/memory/buffer.hpp>
 #include <osmium/visitor.hpp>
 
+#include <cstdio>
+#include <cstring>
 #include <iterator>
 #include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 struct CountHandler : public osmium::handler::Handler {
@@ -378,3 +384,134 @@ TEST_CASE("Reader with single object type per buffer") {
     check_buffer_counts("t/io/data-n5w1r0", {{5, 0, 0}, {0, 1, 0}}, osmium::io::buffers_type::single);
 }
 
+
+TEST_CASE("Parse memory limit") {
+    REQUIRE(osmium::io::detail::parse_memory_limit("") == 0);
+    REQUIRE(osmium::io::detail::parse_memory_limit("1000") == 1000);
+    REQUIRE(osmium::io::detail::parse_memory_limit("3k") == 3UL * 1024UL);
+    REQUIRE(osmium::io::detail::parse_memory_limit("100M") == 100UL * 1024UL * 1024UL);
+    REQUIRE(osmium::io::detail::parse_memory_limit("2G") == 2UL * 1024UL * 1024UL * 1024UL);
+    REQUIRE_THROWS_AS(osmium::io::detail::parse_memory_limit("G"), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(osmium::io::detail::parse_memory_limit("2X"), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(osmium::io::detail::parse_memory_limit("2GB"), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(osmium::io::detail::parse_memory_limit("99999999999999999999999"), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(osmium::io::detail::parse_memory_limit("99999999999999999999G"), const std::invalid_argument&);
+    REQUIRE_THROWS_AS(osmium::io::detail::parse_memory_limit("17179869184G"), const std::invalid_argument&);
+}
+
+TEST_CASE("Reader with memory limit") {
+    CountHandler handler;
+
+    SECTION("set as option") {
+        osmium::io::Reader reader{with_data_dir("t/io/data.osm"), osmium::io::memory_limit{1024UL * 1024UL}};
+        osmium::apply(reader, handler);
+    }
+
+    SECTION("set as file option") {
+        osmium::io::File file{with_data_dir("t/io/data.osm"), "osm,memory_limit=1M"};
+        osmium::io::Reader reader{file};
+        osmium::apply(reader, handler);
+    }
+
+    REQUIRE(handler.count == 1);
+}
+
+TEST_CASE("Reader with invalid memory limit file option") {
+    const osmium::io::File file{with_data_dir("t/io/data.osm"), "osm,memory_limit=foo"};
+    REQUIRE_THROWS_AS(osmium::io::Reader(file), const std::invalid_argument&);
+}
+
+static void write_file_with_all_parts(const std::string& filename, const char* format) {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    osmium::builder::add_node(buffer, _id(1), _version(1), _location(1.0, 2.0), _tag("amenity", "bench"));
+    osmium::builder::add_node(buffer, _id(2), _version(1), _location(1.5, 2.5));
+    osmium::builder::add_way(buffer, _id(10), _version(1), _nodes({1, 2}), _tag("highway", "primary"));
+    osmium::builder::add_relation(buffer, _id(20), _version(1), _member(osmium::item_type::way, 10, "outer"),
+                                  _member(osmium::item_type::node, 1, "a,b"), _tag("type", "multipolygon"));
+
+    osmium::io::Writer writer{osmium::io::File{filename, format}, osmium::io::overwrite::allow};
+    writer(std::move(buffer));
+    writer.close();
+}
+
+static void check_read_parts(const osmium::io::File& file, const bool tags, const bool way_nodes, const bool member_roles) {
+    osmium::io::Reader reader{file,
+                              tags ? osmium::io::read_tags::yes : osmium::io::read_tags::no,
+                              way_nodes ? osmium::io::read_way_nodes::yes : osmium::io::read_way_nodes::no,
+                              member_roles ? osmium::io::read_member_roles::yes : osmium::io::read_member_roles::no};
+    osmium::memory::Buffer buffer{1024, osmium::memory::Buffer::auto_grow::yes};
+    while (const osmium::memory::Buffer read_buffer = reader.read()) {
+        buffer.add_buffer(read_buffer);
+        buffer.commit();
+    }
+    reader.close();
+
+    auto nodes = buffer.select<osmium::Node>();
+    REQUIRE(std::distance(nodes.begin(), nodes.end()) == 2);
+    const auto& node = *nodes.begin();
+    REQUIRE(node.id() == 1);
+    REQUIRE(node.location() == osmium::Location(1.0, 2.0));
+    REQUIRE(node.tags().size() == (tags ? 1 : 0));
+
+    auto ways = buffer.select<osmium::Way>();
+    REQUIRE(std::distance(ways.begin(), ways.end()) == 1);
+    const auto& way = *ways.begin();
+    REQUIRE(way.id() == 10);
+    REQUIRE(way.tags().size() == (tags ? 1 : 0));
+    if (tags) {
+        REQUIRE(std::strcmp(way.tags().get_value_by_key("highway"), "primary") == 0);
+    }
+    REQUIRE(way.nodes().size() == (way_nodes ? 2 : 0));
+    if (way_nodes) {
+        REQUIRE(way.nodes()[1].ref() == 2);
+    }
+
+    auto relations = buffer.select<osmium::Relation>();
+    REQUIRE(std::distance(relations.begin(), relations.end()) == 1);
+    const auto& relation = *relations.begin();
+    REQUIRE(relation.id() == 20);
+    REQUIRE(relation.tags().size() == (tags ? 1 : 0));
+    REQUIRE(relation.members().size() == 2);
+    auto it = relation.members().begin();
+    REQUIRE(it->type() == osmium::item_type::way);
+    REQUIRE(it->ref() == 10);
+    REQUIRE(std::string{it->role()} == (member_roles ? "outer" : ""));
+    ++it;
+    REQUIRE(it->type() == osmium::item_type::node);
+    REQUIRE(it->ref() == 1);
+    REQUIRE(std::string{it->role()} == (member_roles ? "a,b" : ""));
+}
+
+static void check_read_parts_for_format(const char* format) {
+    const std::string filename{"test-reader-parts.data"};
+    write_file_with_all_parts(filename, format);
+    const osmium::io::File file{filename, format};
+
+    check_read_parts(file, true, true, true);
+    check_read_parts(file, false, true, true);
+    check_read_parts(file, true, false, true);
+    check_read_parts(file, true, true, false);
+    check_read_parts(file, false, false, false);
+
+    REQUIRE(std::remove(filename.c_str()) == 0);
+}
+
+TEST_CASE("Reader with options to skip parts of objects") {
+    SECTION("pbf") {
+        check_read_parts_for_format("pbf");
+    }
+
+    SECTION("pbf without dense nodes") {
+        check_read_parts_for_format("pbf,pbf_dense_nodes=false");
+    }
+
+    SECTION("o5m") {
+        check_read_parts_for_format("o5m");
+    }
+
+    SECTION("opl") {
+        check_read_parts_for_format("opl");
+    }
+}
@@ -5,6 +5,7 @@
 
 #include <iterator>
 #include <string>
+#include <vector>
 
 TEST_CASE("Empty StringStore") {
     const osmium::io::detail::StringStore ss{100};
@@ -129,3 +130,18 @@ TEST_CASE("Lots of strings in string table so chunk overflows") {
     REQUIRE(it == st.end());
 }
 
+
+TEST_CASE("Order strings in StringTable by frequency") {
+    osmium::io::detail::StringTable st{100, osmium::io::detail::StringTable::min_bucket_count, true};
+
+    REQUIRE(st.add("foo") == 1);
+    REQUIRE(st.add("bar") == 2);
+    REQUIRE(st.add("baz") == 3);
+    REQUIRE(st.add("baz") == 3);
+    REQUIRE(st.add("bar") == 2);
+    REQUIRE(st.add("baz") == 3);
+    REQUIRE(st.add("qux") == 4);
+
+    REQUIRE(st.order_by_frequency() == std::vector<int32_t>({0, 3, 2, 1, 4}));
+    REQUIRE(st.bytes() == 16);
+}
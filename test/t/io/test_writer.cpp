@@ -13,6 +13,7 @@
 #include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 static osmium::memory::Buffer get_buffer() {
     osmium::io::Reader reader{with_data_dir("t/io/data.osm")};
@@ -138,6 +139,85 @@ TEST_CASE("Writer: Successful writes using output iterator") {
     REQUIRE(buffer_check.select<osmium::OSMObject>().cbegin()->id() == 1);
 }
 
+TEST_CASE("Writer: Successful writes to output callback") {
+    const int count = count_fds();
+
+    auto buffer = get_and_check_buffer();
+    const auto num = buffer.select<osmium::OSMObject>().size();
+
+    std::vector<std::string> blocks;
+    osmium::io::output_callback callback = [&blocks](std::string&& data) {
+        blocks.push_back(std::move(data));
+    };
+
+    osmium::io::Writer writer{osmium::io::File{"", "xml"}, callback};
+    writer(std::move(buffer));
+    const auto size = writer.close();
+
+    REQUIRE(count == count_fds());
+    REQUIRE(blocks.size() > 1);
+
+    std::string data;
+    for (const auto& block : blocks) {
+        data += block;
+    }
+    REQUIRE(size == data.size());
+
+    osmium::io::Reader reader_check{osmium::io::File{data.data(), data.size(), "xml"}};
+    const osmium::memory::Buffer buffer_check = reader_check.read();
+    REQUIRE(buffer_check);
+    REQUIRE(buffer_check.select<osmium::OSMObject>().size() == num);
+    REQUIRE(buffer_check.select<osmium::OSMObject>().cbegin()->id() == 1);
+}
+
+TEST_CASE("Writer: Successful writes with direct I/O") {
+    const int count = count_fds();
+
+    auto buffer = get_and_check_buffer();
+    const auto num = buffer.select<osmium::OSMObject>().size();
+
+    const std::string filename = "test-writer-direct-io.osm";
+    osmium::io::Writer writer{filename, osmium::io::overwrite::allow, osmium::io::direct_io::yes};
+    writer(std::move(buffer));
+    const auto size = writer.close();
+
+    REQUIRE(count == count_fds());
+    REQUIRE(size == osmium::file_size(filename));
+
+    osmium::io::Reader reader_check{filename};
+    const osmium::memory::Buffer buffer_check = reader_check.read();
+    REQUIRE(buffer_check);
+    REQUIRE(buffer_check.select<osmium::OSMObject>().size() == num);
+    REQUIRE(buffer_check.select<osmium::OSMObject>().cbegin()->id() == 1);
+}
+
+TEST_CASE("Writer: Output callback can not be used with compression") {
+    osmium::io::output_callback callback = [](std::string&& /*data*/) {};
+
+    REQUIRE_THROWS_AS(osmium::io::Writer(osmium::io::File{"", "osm.gz"}, callback), const osmium::io_error&);
+}
+
+TEST_CASE("Writer: Exception from output callback") {
+    osmium::io::output_callback callback = [](std::string&& /*data*/) {
+        throw std::runtime_error{"callback error"};
+    };
+
+    osmium::io::Writer writer{osmium::io::File{"", "xml"}, callback};
+    auto buffer = get_buffer();
+
+    // The exception can show up in any call after the first write
+    bool error = false;
+    try {
+        writer(std::move(buffer));
+        writer.close();
+    } catch (const std::runtime_error& e) {
+        REQUIRE(std::string{e.what()} == "callback error");
+        error = true;
+    }
+
+    REQUIRE(error);
+}
+
 TEST_CASE("Writer: Interrupted writer after open") {
     const int count = count_fds();
 
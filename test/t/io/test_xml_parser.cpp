@@ -0,0 +1,202 @@
+#include "catch.hpp"
+
+#include <osmium/io/xml_input.hpp>
+#include <osmium/osm.hpp>
+
+#include <cstring>
+#include <string>
+
+static std::string make_large_xml(const int count) {
+    std::string data{"<?xml version='1.0' encoding='UTF-8'?>\n<osm version=\"0.6\" generator=\"test\">\n"};
+    data += "  <bounds minlat=\"1\" minlon=\"2\" maxlat=\"3\" maxlon=\"4\"/>\n";
+    for (int i = 1; i <= count; ++i) {
+        data += "  <node id=\"" + std::to_string(i) + "\" version=\"1\" user=\"a&amp;b\" lat=\"1.5\" lon=\"2.5\">\n";
+        data += "    <tag k=\"name\" v=\"" + std::string(20, 'a') + "\"/>\n";
+        data += "  </node>\n";
+    }
+    for (int i = 1; i <= count / 10; ++i) {
+        data += "  <way id=\"" + std::to_string(i) + "\" version=\"1\">\n    <nd ref=\"1\"/>\n    <nd ref=\"2\"/>\n  </way>\n";
+    }
+    data += "  <!-- comment -->\n";
+    data += "  <relation id=\"1\" version=\"1\">\n    <member type=\"node\" ref=\"1\" role=\"\"/>\n    <member type=\"way\" ref=\"1\" role=\"outer\"/>\n  </relation>\n";
+    data += "</osm>\n";
+    return data;
+}
+
+TEST_CASE("Read large XML file in chunks using Reader") {
+    const int count = 50000;
+    const std::string data{make_large_xml(count)};
+    REQUIRE(data.size() > 4 * 1024 * 1024);
+
+    osmium::io::File file{data.data(), data.size(), "osm"};
+    osmium::io::Reader reader{file, osmium::io::buffers_type::single};
+
+    const auto header = reader.header();
+    REQUIRE(header.get("generator") == "test");
+    REQUIRE(header.box() == osmium::Box(2.0, 1.0, 4.0, 3.0));
+
+    int nodes = 0;
+    int ways = 0;
+    int relations = 0;
+    osmium::object_id_type last_id = 0;
+    while (const auto buffer = reader.read()) {
+        const auto type = buffer.begin()->type();
+        for (const auto& object : buffer.select<osmium::OSMObject>()) {
+            REQUIRE(object.type() == type);
+            switch (object.type()) {
+                case osmium::item_type::node:
+                    REQUIRE(object.id() == last_id + 1);
+                    REQUIRE(std::strcmp(object.user(), "a&b") == 0);
+                    REQUIRE(object.tags().size() == 1);
+                    ++nodes;
+                    break;
+                case osmium::item_type::way:
+                    REQUIRE(static_cast<const osmium::Way&>(object).nodes().size() == 2);
+                    ++ways;
+                    break;
+                default:
+                    REQUIRE(static_cast<const osmium::Relation&>(object).members().size() == 2);
+                    ++relations;
+                    break;
+            }
+            last_id = object.id();
+        }
+    }
+    reader.close();
+
+    REQUIRE(nodes == count);
+    REQUIRE(ways == count / 10);
+    REQUIRE(relations == 1);
+}
+
+TEST_CASE("Read large XML file with only some entity types") {
+    const std::string data{make_large_xml(50000)};
+
+    osmium::io::File file{data.data(), data.size(), "osm"};
+    osmium::io::Reader reader{file, osmium::osm_entity_bits::way};
+
+    int ways = 0;
+    while (const auto buffer = reader.read()) {
+        for (const auto& item : buffer) {
+            REQUIRE(item.type() == osmium::item_type::way);
+            ++ways;
+        }
+    }
+    reader.close();
+
+    REQUIRE(ways == 5000);
+}
+
+TEST_CASE("Read large XML file with error reports correct position") {
+    std::string data{make_large_xml(50000)};
+    const auto pos = data.find("<node id=\"40000\"");
+    REQUIRE(pos != std::string::npos);
+    data.insert(pos + 5, "<");
+
+    osmium::io::File file{data.data(), data.size(), "osm"};
+    osmium::io::Reader reader{file};
+
+    try {
+        while (reader.read()) {
+        }
+        REQUIRE(false);
+    } catch (const osmium::xml_error& e) {
+        REQUIRE(e.line == 3 + 39999 * 3 + 1);
+        REQUIRE(e.column == 7);
+    }
+}
+
+TEST_CASE("Read XML with escaped attribute values") {
+    const std::string data{
+        "<osm version='0.6'>\n"
+        "<node id='1' user='&lt;&gt;&amp;&quot;&apos;'>\n"
+        "  <tag k='a' v='&#65;&#x42;&#xe9;&#x1F600;'/>\n"
+        "  <tag k='b' v='x\ty\r\nz'/>\n"
+        "</node>\n"
+        "</osm>\n"};
+
+    osmium::io::File file{data.data(), data.size(), "osm"};
+    osmium::io::Reader reader{file};
+    const auto buffer = reader.read();
+    reader.close();
+
+    const auto& node = buffer.get<osmium::Node>(0);
+    REQUIRE(std::string{node.user()} == "<>&\"'");
+    REQUIRE(std::string{node.tags().get_value_by_key("a")} == "AB\xc3\xa9\xf0\x9f\x98\x80");
+    REQUIRE(std::string{node.tags().get_value_by_key("b")} == "x y z");
+}
+
+TEST_CASE("Read XML changeset with discussion") {
+    const std::string data{
+        "<osm version='0.6'>\n"
+        "<changeset id='1' user='u' num_changes='1' comments_count='1'>\n"
+        "  <tag k='a' v='b'/>\n"
+        "  <discussion>\n"
+        "    <comment uid='1' user='x' date='2015-01-01T01:00:00Z'><text>a &amp; b</text></comment>\n"
+        "  </discussion>\n"
+        "</changeset>\n"
+        "</osm>\n"};
+
+    osmium::io::File file{data.data(), data.size(), "osm"};
+    osmium::io::Reader reader{file};
+    const auto buffer = reader.read();
+    reader.close();
+
+    const auto& changeset = buffer.get<osmium::Changeset>(0);
+    REQUIRE(changeset.id() == 1);
+    REQUIRE(changeset.tags().size() == 1);
+    REQUIRE(changeset.discussion().size() == 1);
+    REQUIRE(std::string{changeset.discussion().begin()->text()} == "a & b");
+}
+
+TEST_CASE("Read XML with escaped attribute values left to Expat") {
+    const std::string data{
+        "<osm version='0.6'>\n"
+        "<node id='1' user='&lt;&gt;&amp;&quot;&apos;'>\n"
+        "  <tag k='b' v='x\ty\r\nz'/>\n"
+        "</node>\n"
+        "<changeset id='1' user='u' num_changes='1' comments_count='1'>\n"
+        "  <discussion/>\n"
+        "</changeset>\n"
+        "</osm>\n"};
+
+    osmium::io::File file{data.data(), data.size(), "osm"};
+    osmium::io::Reader reader{file};
+    const auto buffer = reader.read();
+    reader.close();
+
+    const auto& node = buffer.get<osmium::Node>(0);
+    REQUIRE(std::string{node.user()} == "<>&\"'");
+    REQUIRE(std::string{node.tags().get_value_by_key("b")} == "x y z");
+}
+
+TEST_CASE("Read XML with unknown element in node") {
+    const std::string data{
+        "<osm version='0.6'>\n"
+        "<node id='1'><modify/></node>\n"
+        "</osm>\n"};
+
+    osmium::io::File file{data.data(), data.size(), "osm"};
+    osmium::io::Reader reader{file, osmium::osm_entity_bits::way};
+
+    REQUIRE_THROWS_WITH(reader.read(), "Unknown element in <node>: modify");
+}
+
+TEST_CASE("Read XML with duplicate attribute") {
+    const std::string data{
+        "<osm version='0.6'>\n"
+        "<node id='1' id='2'/>\n"
+        "</osm>\n"};
+
+    osmium::io::File file{data.data(), data.size(), "osm"};
+    osmium::io::Reader reader{file};
+
+    try {
+        while (reader.read()) {
+        }
+        REQUIRE(false);
+    } catch (const osmium::xml_error& e) {
+        REQUIRE(e.line == 2);
+        REQUIRE(e.column == 13);
+    }
+}
@@ -430,3 +430,13 @@ TEST_CASE("set lon/lat from string with trailing characters using partial") {
     REQUIRE(*y == ' ');
 }
 
+
+TEST_CASE("Formatting coordinates needs at most 12 characters") {
+    char buffer[12];
+
+    char* end = osmium::detail::format_location_coordinate(buffer, std::numeric_limits<int32_t>::min());
+    REQUIRE(std::string(buffer, end) == "-214.7483648");
+
+    end = osmium::detail::format_location_coordinate(buffer, std::numeric_limits<int32_t>::max());
+    REQUIRE(std::string(buffer, end) == "214.7483647");
+}
@@ -2,6 +2,8 @@
 
 #include <osmium/osm/timestamp.hpp>
 
+#include <cstdint>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -151,3 +153,46 @@ TEST_CASE("Invalid timestamps") {
     REQUIRE_THROWS_AS(osmium::Timestamp{"2000-03-32T00:00:00Z"}, const std::invalid_argument&);
 }
 
+
+TEST_CASE("Out of range timestamps roll over") {
+    REQUIRE(osmium::Timestamp{"2015-02-29T00:00:00Z"} == osmium::Timestamp{"2015-03-01T00:00:00Z"});
+    REQUIRE(osmium::Timestamp{"2016-12-31T23:59:60Z"} == osmium::Timestamp{"2017-01-01T00:00:00Z"});
+}
+
+TEST_CASE("Convert between dates and days since epoch") {
+    static_assert(osmium::detail::days_from_civil(1970, 1, 1) == 0, "epoch");
+    static_assert(osmium::detail::days_from_civil(2000, 3, 1) == 11017, "leap year");
+
+    for (int64_t days = 0; days < 50000; ++days) {
+        const auto date = osmium::detail::civil_from_days(days);
+        REQUIRE(osmium::detail::days_from_civil(date.year,
+                                                static_cast<unsigned int>(date.month),
+                                                static_cast<unsigned int>(date.day)) == days);
+    }
+
+    const auto date = osmium::detail::civil_from_days(11016);
+    REQUIRE(date.year == 2000);
+    REQUIRE(date.month == 2);
+    REQUIRE(date.day == 29);
+}
+
+TEST_CASE("Format timestamps with formatter") {
+    osmium::detail::iso_timestamp_formatter formatter;
+
+    std::string out;
+    formatter.append(out, 1);
+    REQUIRE(out == "1970-01-01T00:00:01Z");
+
+    out.clear();
+    formatter.append(out, 951782399);
+    formatter.append(out, 951782400);
+    REQUIRE(out == "2000-02-28T23:59:59Z2000-02-29T00:00:00Z");
+
+    out.clear();
+    formatter.append(out, 951868799);
+    REQUIRE(out == "2000-02-29T23:59:59Z");
+
+    out.clear();
+    formatter.append(out, std::numeric_limits<uint32_t>::max());
+    REQUIRE(out == "2106-02-07T06:28:15Z");
+}
@@ -192,3 +192,57 @@ TEST_CASE("Remove non-existing object from members database doesn't do anything"
     REQUIRE(mdb.size() == 6);
 }
 
+
+TEST_CASE("Member database lookup with many members") {
+    using namespace osmium::builder::attr; // NOLINT(google-build-using-namespace)
+    osmium::memory::Buffer buffer{1024 * 1024, osmium::memory::Buffer::auto_grow::yes};
+
+    // Relation with all ways with ids divisible by 3 as members, some
+    // of them twice.
+    {
+        osmium::builder::RelationBuilder builder{buffer};
+        builder.set_id(1);
+        osmium::builder::RelationMemberListBuilder mbuilder{builder};
+        for (osmium::object_id_type id = 3; id < 3000; id += 3) {
+            mbuilder.add_member(osmium::item_type::way, id, "");
+            if (id % 10 == 0) {
+                mbuilder.add_member(osmium::item_type::way, id, "");
+            }
+        }
+    }
+    buffer.commit();
+
+    osmium::ItemStash stash;
+    osmium::relations::RelationsDatabase rdb{stash};
+    osmium::relations::MembersDatabase<osmium::Way> mdb{stash, rdb};
+
+    const auto& relation = buffer.get<osmium::Relation>(0);
+    auto handle = rdb.add(relation);
+    std::size_t n = 0;
+    for (const auto& member : relation.members()) {
+        mdb.track(handle, member.ref(), n);
+        ++n;
+    }
+    mdb.prepare_for_lookup();
+
+    int complete = 0;
+    for (osmium::object_id_type id = 1; id <= 3000; ++id) {
+        osmium::memory::Buffer wbuffer{1024, osmium::memory::Buffer::auto_grow::yes};
+        osmium::builder::add_way(wbuffer, _id(id));
+        const bool added = mdb.add(wbuffer.get<osmium::Way>(0), [&](osmium::relations::RelationHandle& /*rel_handle*/) {
+            ++complete;
+        });
+        REQUIRE(added == (id % 3 == 0 && id < 3000));
+    }
+
+    REQUIRE(complete == 1);
+
+    for (osmium::object_id_type id = 1; id <= 3000; ++id) {
+        REQUIRE((mdb.get(id) != nullptr) == (id % 3 == 0 && id < 3000));
+    }
+
+    const auto c = mdb.count();
+    REQUIRE(c.tracked == 0);
+    REQUIRE(c.available == n);
+    REQUIRE(c.removed == 0);
+}
@@ -0,0 +1,82 @@
+#include "catch.hpp"
+
+#include "utils.hpp"
+
+#include <osmium/io/xml_input.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/relations/relations_index.hpp>
+#include <osmium/relations/relations_manager.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+struct CountRM : public osmium::relations::RelationsManager<CountRM, true, true, true> {
+
+    std::size_t count_complete_rels = 0;
+
+    void complete_relation(const osmium::Relation& /*relation*/) noexcept {
+        ++count_complete_rels;
+    }
+
+};
+
+TEST_CASE("Create relations index and use it with RelationsManager") {
+    osmium::io::File file{with_data_dir("t/relations/data.osm")};
+    const std::string index_filename{"test_relations_index.idx"};
+
+    const auto count = osmium::relations::create_relations_index(file, index_filename, osmium::io::overwrite::allow);
+    REQUIRE(count == 3);
+
+    {
+        osmium::relations::RelationsIndex index{index_filename};
+        REQUIRE(index.size() == 3);
+        REQUIRE(std::distance(index.buffer().select<osmium::Relation>().begin(),
+                              index.buffer().select<osmium::Relation>().end()) == 3);
+    }
+
+    CountRM manager_from_file;
+    osmium::relations::read_relations(file, manager_from_file);
+
+    CountRM manager_from_index;
+    osmium::relations::read_relations_from_index(index_filename, manager_from_index);
+
+    REQUIRE(manager_from_index.member_nodes_database().size()     == manager_from_file.member_nodes_database().size());
+    REQUIRE(manager_from_index.member_ways_database().size()      == manager_from_file.member_ways_database().size());
+    REQUIRE(manager_from_index.member_relations_database().size() == manager_from_file.member_relations_database().size());
+
+    osmium::io::Reader reader{file};
+    osmium::apply(reader, manager_from_index.handler());
+    reader.close();
+
+    REQUIRE(manager_from_index.count_complete_rels == 2);
+
+    std::remove(index_filename.c_str());
+}
+
+TEST_CASE("Relations index writer without relations") {
+    const std::string index_filename{"test_relations_index_empty.idx"};
+
+    {
+        osmium::relations::RelationsIndexWriter writer{index_filename, osmium::io::overwrite::allow};
+    }
+
+    osmium::relations::RelationsIndex index{index_filename};
+    REQUIRE(index.size() == 0);
+    REQUIRE(index.buffer().committed() == 0);
+
+    std::remove(index_filename.c_str());
+}
+
+TEST_CASE("Opening invalid relations index fails") {
+    const std::string index_filename{"test_relations_index_invalid.idx"};
+
+    {
+        std::ofstream out{index_filename};
+        out << "this is not a relations index file, but it is long enough";
+    }
+
+    REQUIRE_THROWS_AS(osmium::relations::RelationsIndex{index_filename}, const osmium::relations_index_error&);
+
+    std::remove(index_filename.c_str());
+}
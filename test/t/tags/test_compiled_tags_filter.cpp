@@ -0,0 +1,170 @@
+#include "catch.hpp"
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/tags/compiled_tags_filter.hpp>
+#include <osmium/tags/tags_filter.hpp>
+
+#include <functional>
+#include <iterator>
+#include <regex>
+#include <string>
+#include <vector>
+
+// Tag list with all combinations of some keys and values.
+static const osmium::TagList& all_tags(osmium::memory::Buffer& buffer) {
+    static const std::vector<std::string> keys = {
+        "highway", "amenity", "name", "name:de", "building", "source", "landuse", "foo", ""
+    };
+
+    static const std::vector<std::string> values = {
+        "primary", "secondary", "motorway", "restaurant", "yes", "no", "GPS", "Main Street", ""
+    };
+
+    {
+        osmium::builder::TagListBuilder builder{buffer};
+        for (const auto& key : keys) {
+            for (const auto& value : values) {
+                builder.add_tag(key, value);
+            }
+        }
+    }
+
+    return buffer.get<osmium::TagList>(buffer.commit());
+}
+
+template <typename TResult>
+static void check_same_results(const osmium::TagsFilterBase<TResult>& filter) {
+    osmium::memory::Buffer buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    const auto& tags = all_tags(buffer);
+
+    const osmium::CompiledTagsFilterBase<TResult> compiled{filter};
+    REQUIRE(compiled.count() == filter.count());
+
+    for (const auto& tag : tags) {
+        REQUIRE(compiled(tag) == filter(tag));
+    }
+}
+
+TEST_CASE("String id map keeps ids when growing") {
+    osmium::detail::string_id_map map;
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(map.add(std::to_string(i)) == static_cast<std::size_t>(i));
+    }
+    REQUIRE(map.size() == 1000);
+    REQUIRE(map.add("17") == 17);
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(map.find(std::to_string(i).c_str()) == static_cast<std::size_t>(i));
+    }
+    REQUIRE(map.find("x") == osmium::detail::string_id_map::not_found);
+}
+
+TEST_CASE("Compiled tags filter without rules") {
+    osmium::TagsFilter filter{true};
+    const osmium::CompiledTagsFilter compiled{filter};
+    REQUIRE(compiled.empty());
+    REQUIRE(compiled("highway", "primary"));
+    check_same_results(filter);
+}
+
+TEST_CASE("Compiled tags filter with key rules") {
+    osmium::TagsFilter filter;
+    filter.add_rule(true, "highway");
+    filter.add_rule(true, osmium::StringMatcher::list{{"amenity", "building"}});
+    filter.add_rule(false, "amenity");
+
+    const osmium::CompiledTagsFilter compiled{filter};
+    REQUIRE(compiled("highway", "primary"));
+    REQUIRE(compiled("amenity", "restaurant"));
+    REQUIRE_FALSE(compiled("name", "Main Street"));
+    check_same_results(filter);
+}
+
+TEST_CASE("Compiled tags filter keeps first match semantics") {
+    osmium::TagsFilter filter{false};
+    filter.add_rule(false, "highway", "motorway");
+    filter.add_rule(true, "highway", osmium::StringMatcher::list{{"primary", "motorway"}});
+    filter.add_rule(true, "highway", "secondary");
+    filter.add_rule(false, osmium::StringMatcher::prefix{"high"});
+    filter.add_rule(true, "highway");
+
+    const osmium::CompiledTagsFilter compiled{filter};
+    REQUIRE_FALSE(compiled("highway", "motorway"));
+    REQUIRE(compiled("highway", "primary"));
+    REQUIRE(compiled("highway", "secondary"));
+    REQUIRE_FALSE(compiled("highway", "yes"));
+    check_same_results(filter);
+}
+
+TEST_CASE("Compiled tags filter with all kinds of matchers") {
+    osmium::TagsFilterBase<int> filter{-1};
+    filter.add_rule(1, "amenity", "restaurant");
+    filter.add_rule(2, osmium::StringMatcher::substring{"ame"}, osmium::StringMatcher::equal{"Main Street"});
+    filter.add_rule(3, "name", "Main Street", true);
+    filter.add_rule(4, osmium::StringMatcher::prefix{"name:"});
+    filter.add_rule(5, "source", osmium::StringMatcher::prefix{"G"});
+    filter.add_rule(6, "source", osmium::StringMatcher::always_true{}, true);
+    filter.add_rule(7, "landuse", osmium::StringMatcher::always_false{}, true);
+    filter.add_rule(8, "landuse", "yes");
+    filter.add_rule(9, osmium::StringMatcher::always_false{});
+    filter.add_rule(10, "building", "no");
+    filter.add_rule(11, "building", osmium::StringMatcher::list{{"yes", "no"}});
+    filter.add_rule(12, osmium::StringMatcher::always_true{}, "yes");
+    filter.add_rule(13, "building");
+#ifdef OSMIUM_WITH_REGEX
+    filter.add_rule(14, std::regex{"^h"}, std::regex{"ary$"});
+#endif
+    filter.add_rule(15, osmium::StringMatcher::equal{""});
+
+    check_same_results(filter);
+}
+
+TEST_CASE("Compiled tags filter iterator filters tags") {
+    osmium::memory::Buffer buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    const auto& tags = all_tags(buffer);
+
+    osmium::TagsFilter filter;
+    filter.add_rule(true, "highway", "primary")
+          .add_rule(true, "source");
+    const osmium::CompiledTagsFilter compiled{filter};
+
+    const osmium::CompiledTagsFilter::iterator it{std::cref(compiled), tags.begin(), tags.end()};
+    const osmium::CompiledTagsFilter::iterator end{std::cref(compiled), tags.end(), tags.end()};
+
+    REQUIRE(10 == std::distance(it, end));
+    REQUIRE(std::string{"highway"} == it->key());
+    REQUIRE(std::string{"primary"} == it->value());
+}
+
+#ifdef OSMIUM_WITH_REGEX
+TEST_CASE("Compiled tags filter with many regex rules") {
+    osmium::TagsFilterBase<int> filter{-1};
+    int n = 0;
+    for (const char* re : {"^name", "de$", "^$", "[0-9]", "a"}) {
+        filter.add_rule(n++, std::regex{re});
+        filter.add_rule(n++, "highway", std::regex{re});
+        filter.add_rule(n++, "source", std::regex{re}, true);
+    }
+    // more than 64 regexes to check cache with several words per string
+    for (int i = 0; i < 70; ++i) {
+        filter.add_rule(n++, std::regex{"x" + std::to_string(i)}, std::regex{"y"});
+    }
+    filter.add_rule(n++, std::regex{"^b"}, std::regex{"^y"});
+
+    osmium::memory::Buffer buffer{10240, osmium::memory::Buffer::auto_grow::yes};
+    const auto& tags = all_tags(buffer);
+    const osmium::CompiledTagsFilterBase<int> compiled{filter};
+
+    // Run twice to check results taken from the cache.
+    for (int run = 0; run < 2; ++run) {
+        for (const auto& tag : tags) {
+            REQUIRE(compiled(tag) == filter(tag));
+        }
+    }
+
+    const auto copy = compiled;
+    for (const auto& tag : tags) {
+        REQUIRE(copy(tag) == filter(tag));
+    }
+}
+#endif
@@ -18,3 +18,17 @@ TEST_CASE("Queue can have max elements and can be named") {
     osmium::thread::Queue<int> queue{100, "Queue of max size 100"};
 }
 
+
+TEST_CASE("Max size of queue can be changed") {
+    osmium::thread::Queue<int> queue{2};
+    REQUIRE(queue.max_size() == 2);
+    queue.push(1);
+    queue.push(2);
+    queue.set_max_size(3);
+    REQUIRE(queue.max_size() == 3);
+    queue.push(3);
+    REQUIRE(queue.size() == 3);
+    queue.set_max_size(0);
+    queue.push(4);
+    REQUIRE(queue.size() == 4);
+}
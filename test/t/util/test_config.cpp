@@ -67,6 +67,50 @@ TEST_CASE("use_pool_threads_for_pbf_parsing") {
     REQUIRE(osmium::config::use_pool_threads_for_pbf_parsing());
 }
 
+TEST_CASE("use_pool_threads_for_opl_parsing") {
+    osmium::detail::env = nullptr;
+    REQUIRE(osmium::config::use_pool_threads_for_opl_parsing());
+    REQUIRE(osmium::detail::name == "OSMIUM_USE_POOL_THREADS_FOR_OPL_PARSING");
+
+    osmium::detail::env = "no";
+    REQUIRE_FALSE(osmium::config::use_pool_threads_for_opl_parsing());
+    osmium::detail::env = "yes";
+    REQUIRE(osmium::config::use_pool_threads_for_opl_parsing());
+}
+
+TEST_CASE("use_pool_threads_for_xml_parsing") {
+    osmium::detail::env = nullptr;
+    REQUIRE(osmium::config::use_pool_threads_for_xml_parsing());
+    REQUIRE(osmium::detail::name == "OSMIUM_USE_POOL_THREADS_FOR_XML_PARSING");
+
+    osmium::detail::env = "off";
+    REQUIRE_FALSE(osmium::config::use_pool_threads_for_xml_parsing());
+    osmium::detail::env = "on";
+    REQUIRE(osmium::config::use_pool_threads_for_xml_parsing());
+}
+
+TEST_CASE("use_pool_threads_for_o5m_parsing") {
+    osmium::detail::env = nullptr;
+    REQUIRE(osmium::config::use_pool_threads_for_o5m_parsing());
+    REQUIRE(osmium::detail::name == "OSMIUM_USE_POOL_THREADS_FOR_O5M_PARSING");
+
+    osmium::detail::env = "false";
+    REQUIRE_FALSE(osmium::config::use_pool_threads_for_o5m_parsing());
+    osmium::detail::env = "true";
+    REQUIRE(osmium::config::use_pool_threads_for_o5m_parsing());
+}
+
+TEST_CASE("use_io_uring") {
+    osmium::detail::env = nullptr;
+    REQUIRE(osmium::config::use_io_uring());
+    REQUIRE(osmium::detail::name == "OSMIUM_USE_IO_URING");
+
+    osmium::detail::env = "off";
+    REQUIRE_FALSE(osmium::config::use_io_uring());
+    osmium::detail::env = "yes";
+    REQUIRE(osmium::config::use_io_uring());
+}
+
 TEST_CASE("get_max_queue_size") {
     osmium::detail::env = nullptr;
     REQUIRE(osmium::config::get_max_queue_size("NAME", 0) == 2);
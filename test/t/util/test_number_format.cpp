@@ -0,0 +1,67 @@
+#include "catch.hpp"
+
+#include <osmium/util/number_format.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+static std::string format_integer(int64_t value) {
+    char buffer[20];
+    return std::string(buffer, osmium::detail::format_integer(buffer, value));
+}
+
+static std::string format_fixed_point(int64_t value) {
+    char buffer[21 + 7];
+    return std::string(buffer, osmium::detail::format_fixed_point(buffer, value, 10000000, 7));
+}
+
+TEST_CASE("Count decimal digits") {
+    REQUIRE(osmium::detail::count_decimal_digits(0) == 1);
+    REQUIRE(osmium::detail::count_decimal_digits(9) == 1);
+    REQUIRE(osmium::detail::count_decimal_digits(10) == 2);
+    REQUIRE(osmium::detail::count_decimal_digits(9999) == 4);
+    REQUIRE(osmium::detail::count_decimal_digits(10000) == 5);
+    REQUIRE(osmium::detail::count_decimal_digits(std::numeric_limits<uint64_t>::max()) == 20);
+}
+
+TEST_CASE("Format integers") {
+    REQUIRE(format_integer(0) == "0");
+    REQUIRE(format_integer(7) == "7");
+    REQUIRE(format_integer(-7) == "-7");
+    REQUIRE(format_integer(10) == "10");
+    REQUIRE(format_integer(100) == "100");
+    REQUIRE(format_integer(12345) == "12345");
+    REQUIRE(format_integer(-123456) == "-123456");
+    REQUIRE(format_integer(std::numeric_limits<int64_t>::max()) == "9223372036854775807");
+    REQUIRE(format_integer(std::numeric_limits<int64_t>::min()) == "-9223372036854775808");
+
+    int64_t value = 1;
+    for (int i = 0; i < 18; ++i) {
+        REQUIRE(format_integer(value) == std::to_string(value));
+        REQUIRE(format_integer(value - 1) == std::to_string(value - 1));
+        REQUIRE(format_integer(-value) == std::to_string(-value));
+        value *= 10;
+    }
+}
+
+TEST_CASE("Format unsigned integers") {
+    char buffer[20];
+    const auto max = std::numeric_limits<uint64_t>::max();
+    REQUIRE(std::string(buffer, osmium::detail::format_unsigned_integer(buffer, max)) == "18446744073709551615");
+}
+
+TEST_CASE("Format fixed point numbers") {
+    REQUIRE(format_fixed_point(0) == "0");
+    REQUIRE(format_fixed_point(1) == "0.0000001");
+    REQUIRE(format_fixed_point(-1) == "-0.0000001");
+    REQUIRE(format_fixed_point(10000000) == "1");
+    REQUIRE(format_fixed_point(-10000000) == "-1");
+    REQUIRE(format_fixed_point(15000000) == "1.5");
+    REQUIRE(format_fixed_point(1234567890) == "123.456789");
+    REQUIRE(format_fixed_point(1800000000) == "180");
+    REQUIRE(format_fixed_point(std::numeric_limits<int32_t>::max()) == "214.7483647");
+    REQUIRE(format_fixed_point(std::numeric_limits<int32_t>::min()) == "-214.7483648");
+    REQUIRE(format_fixed_point(std::numeric_limits<int64_t>::min()) == "-922337203685.4775808");
+    REQUIRE(format_fixed_point(std::numeric_limits<int64_t>::max()) == "922337203685.4775807");
+}
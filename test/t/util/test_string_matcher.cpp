@@ -77,6 +77,14 @@ TEST_CASE("String matcher: substring from std::string") {
     REQUIRE(m.match("xfoox"));
 }
 
+TEST_CASE("String matcher: prefix longer than test string") {
+    osmium::StringMatcher::prefix m{"foobar"};
+    REQUIRE(m.match("foobar"));
+    REQUIRE(m.match("foobarbaz"));
+    REQUIRE_FALSE(m.match("foo"));
+    REQUIRE_FALSE(m.match("fooba"));
+}
+
 TEST_CASE("String matcher: empty prefix") {
     osmium::StringMatcher::prefix m{""};
     REQUIRE(m.match("foo"));
@@ -113,6 +121,16 @@ TEST_CASE("String matcher: list") {
     REQUIRE_FALSE(m.match(""));
 }
 
+TEST_CASE("String matcher: list with strings of same length and empty string") {
+    osmium::StringMatcher::list m{{"foo", "fob", "", "fo"}};
+    REQUIRE(m.match("foo"));
+    REQUIRE(m.match("fob"));
+    REQUIRE(m.match("fo"));
+    REQUIRE(m.match(""));
+    REQUIRE_FALSE(m.match("fox"));
+    REQUIRE_FALSE(m.match("f"));
+}
+
 TEST_CASE("String matcher: list with add") {
     osmium::StringMatcher::list m;
     REQUIRE_FALSE(m.match("foo"));